@@ -4,75 +4,86 @@
 //
 
 #include "stdafx.h"
+#include "Ubuntu/UserCreation.h"
+#include "Ubuntu/UserDirectory.h"
+#include "Ubuntu/Utf8.h"
+#include "Ubuntu/WslProcess.h"
+
+using namespace Ubuntu::Messages::Catalog;
 
 bool DistributionInfo::CreateUser(std::wstring_view userName)
 {
-    // Create the user account.
-    DWORD exitCode;
-    std::wstring commandLine = L"adduser --quiet --gecos '' ";
-    commandLine += userName;
-    HRESULT hr = g_wslApi.WslLaunchInteractive(commandLine.c_str(), true, &exitCode);
-    if ((FAILED(hr)) || (exitCode != 0)) {
+    // Read once, as the user may need several attempts.
+    static const std::string nameRegex = [] {
+        Ubuntu::WslApiBackend wsl(g_wslApi);
+        return Ubuntu::UserCreation::ReadNameRegex(wsl);
+    }();
+
+    // Checking the name, adding the user, joining the groups and rolling back on failure all take
+    // a single launch, none if the name is refused on the host.
+    Ubuntu::WslApiBackend wsl(g_wslApi);
+    std::string name = Ubuntu::WideToUtf8(userName);
+    auto result = Ubuntu::UserCreation::Create(wsl, name, nameRegex);
+    using Outcome = Ubuntu::UserCreation::Result::Outcome;
+    switch (result.outcome) {
+    case Outcome::InvalidName:
+        Helpers::PrintMessage(MSG_INVALID_USERNAME, Ubuntu::Utf8ToWide(result.reason).c_str());
+        return false;
+
+    case Outcome::AlreadyExists:
+        Helpers::PrintMessage(MSG_USERNAME_ALREADY_EXISTS);
         return false;
-    }
 
-    // Add the user account to any relevant groups.
-    commandLine = L"usermod -aG adm,dialout,cdrom,floppy,sudo,audio,dip,video,plugdev,netdev ";
-    commandLine += userName;
-    hr = g_wslApi.WslLaunchInteractive(commandLine.c_str(), true, &exitCode);
-    if ((FAILED(hr)) || (exitCode != 0)) {
+    case Outcome::Created:
+        break;
 
-        // Delete the user if the group add command failed.
-        commandLine = L"deluser ";
-        commandLine += userName;
-        g_wslApi.WslLaunchInteractive(commandLine.c_str(), true, &exitCode);
+    default:
+        // Whatever happened, what was known of the users may be stale now.
+        Users().Invalidate();
         return false;
     }
 
+    // The new user is known without asking the distro again.
+    Users().Invalidate();
+    if (result.user) {
+        Users().Populate({*result.user});
+    }
+
     return true;
 }
 
 ULONG DistributionInfo::QueryUid(std::wstring_view userName)
 {
-    // Create a pipe to read the output of the launched process.
-    HANDLE readPipe;
-    HANDLE writePipe;
-    SECURITY_ATTRIBUTES sa{sizeof(sa), nullptr, true};
-    ULONG uid = UID_INVALID;
-    if (CreatePipe(&readPipe, &writePipe, &sa, 0)) {
-        // Query the UID of the supplied username.
-        std::wstring command = L"id -u ";
-        command += userName;
-        int returnValue = 0;
-        HANDLE child;
-        HRESULT hr = g_wslApi.WslLaunch(command.c_str(), true, GetStdHandle(STD_INPUT_HANDLE), writePipe, GetStdHandle(STD_ERROR_HANDLE), &child);
-        if (SUCCEEDED(hr)) {
-            // Wait for the child to exit and ensure process exited successfully.
-            WaitForSingleObject(child, INFINITE);
-            DWORD exitCode;
-            if ((GetExitCodeProcess(child, &exitCode) == false) || (exitCode != 0)) {
-                hr = E_INVALIDARG;
-            }
-
-            CloseHandle(child);
-            if (SUCCEEDED(hr)) {
-                char buffer[64];
-                DWORD bytesRead;
-
-                // Read the output of the command from the pipe and convert to a UID.
-                if (ReadFile(readPipe, buffer, (sizeof(buffer) - 1), &bytesRead, nullptr)) {
-                    buffer[bytesRead] = ANSI_NULL;
-                    try {
-                        uid = std::stoul(buffer, nullptr, 10);
-
-                    } catch( ... ) { }
-                }
-            }
+    // The default user is known to WSL itself.
+    if (userName.empty()) {
+        WslDistributionConfiguration configuration;
+        if (FAILED(g_wslApi.WslGetDistributionConfiguration(configuration))) {
+            return UID_INVALID;
         }
 
-        CloseHandle(readPipe);
-        CloseHandle(writePipe);
+        return configuration.defaultUid;
     }
 
-    return uid;
+    auto user = Users().FindByName(Ubuntu::WideToUtf8(userName));
+    return user ? user->uid : UID_INVALID;
+}
+
+Ubuntu::UserDirectory& DistributionInfo::Users()
+{
+    static Ubuntu::UserDirectory users{[](const Ubuntu::NssQuery& query) -> std::optional<std::vector<Ubuntu::UserEntry>> {
+        Ubuntu::WslProcess getent{Ubuntu::Utf8ToWide(query.Command())};
+        auto result = getent.run(g_wslApi, 10'000);
+        if (result.error.empty()) {
+            return Ubuntu::ParsePasswd(result.stdOut);
+        }
+
+        // Lookups report the keys not found through the exit code, still printing the others.
+        if ((query.kind != Ubuntu::NssQuery::Kind::Enumeration) && (result.exitCode == Ubuntu::NssQuery::NotFoundExitCode)) {
+            return Ubuntu::ParsePasswd(result.stdOut);
+        }
+
+        return std::nullopt;
+    }};
+
+    return users;
 }
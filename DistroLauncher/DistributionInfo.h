@@ -5,6 +5,11 @@
 
 #pragma once
 
+namespace Ubuntu
+{
+    class UserDirectory;
+}
+
 namespace DistributionInfo
 {
     // The name of the distribution. This will be displayed to the user via
@@ -21,6 +26,9 @@ namespace DistributionInfo
     // Create and configure a user account.
     bool CreateUser(std::wstring_view userName);
 
-    // Query the UID of the user account.
+    // Query the UID of the user account, or of the default user if the name is empty.
     ULONG QueryUid(std::wstring_view userName);
+
+    // The users of the distribution known so far in this run of the launcher.
+    Ubuntu::UserDirectory& Users();
 }
\ No newline at end of file
@@ -5,39 +5,117 @@
 
 #include "stdafx.h"
 
+using namespace Ubuntu::Messages::Catalog;
+
 // Commandline arguments: 
 #define ARG_CONFIG              L"config"
 #define ARG_CONFIG_DEFAULT_USER L"--default-user"
 #define ARG_INSTALL             L"install"
 #define ARG_INSTALL_ROOT        L"--root"
+#define ARG_INSTALL_INSTANCES   L"--instances"
+#define ARG_INSTALL_NAME_PREFIX L"--name-prefix"
+#define ARG_INSTALL_PARALLEL    L"--parallel"
 #define ARG_RUN                 L"run"
 #define ARG_RUN_C               L"-c"
+#define ARG_RUN_BATCH           L"--batch"
+#define ARG_RUN_BATCH_STDIN     L"-"
+#define ARG_RUN_STOP_ON_FAILURE L"--stop-on-failure"
+#define ARG_RUN_PARALLEL        L"--parallel"
+#define ARG_RUN_WARM            L"--warm"
+#define ARG_STATUS              L"status"
+#define ARG_BROKER              L"broker"
+#define ARG_SNAPSHOT            L"snapshot"
+#define ARG_RESET               L"reset"
+#define ARG_STATS               L"stats"
+#define ARG_STATS_PROMETHEUS    L"--prometheus"
 #define ARG_HELP                L"help"
+#define ARG_TRACE               L"--trace"
+
+// Environment variable naming a file to record the trace to, as does --trace.
+#define ENV_TRACE               L"UBUNTU_LAUNCHER_TRACE"
+
+// Environment variable which, set to 0, stops adding the durations of the launches to their statistics.
+#define ENV_STATS               L"UBUNTU_LAUNCHER_STATS"
+
+// Environment variable setting how many seconds cloud-init is given to finish during installation.
+#define ENV_CLOUD_INIT_TIMEOUT  L"UBUNTU_CLOUD_INIT_TIMEOUT"
+
+// How long the session broker waits for requests before exiting.
+#define BROKER_IDLE_TIMEOUT     std::chrono::minutes(15)
 
 // Helper class for calling WSL Functions:
 // https://msdn.microsoft.com/en-us/library/windows/desktop/mt826874(v=vs.85).aspx
 WslApiLoader g_wslApi(DistributionInfo::Name);
 
-static HRESULT InstallDistribution(bool createUser);
+// The configuration a snapshot in progress enters the distribution as root from, to restore on Ctrl-C.
+static WslDistributionConfiguration g_snapshotConfiguration;
+
+static HRESULT InstallDistribution(bool createUser, Ubuntu::ImageVerifier& imageVerifier);
+static HRESULT RegisterDistribution(WslApiLoader& api, const Ubuntu::ImageVerifier::Result& verification, bool report);
+static HRESULT InstallInstances(const std::vector<std::wstring_view>& arguments, Ubuntu::ImageVerifier& imageVerifier, DWORD& exitCode);
+static HRESULT ImportInstance(const std::wstring& name, const std::filesystem::path& directory, const std::filesystem::path& image, std::wstring& error);
+static bool ParseCount(std::wstring_view argument, size_t& count);
 static HRESULT SetDefaultUser(std::wstring_view userName);
+static HRESULT ReadCommands(std::wstring_view path, std::vector<std::string>& commands);
+static HRESULT RunBatch(const std::vector<std::wstring_view>& arguments, DWORD& exitCode);
+static HRESULT RunParallel(const std::vector<std::wstring_view>& arguments, DWORD& exitCode);
+static HRESULT RunBroker();
+static std::optional<DWORD> RunThroughBroker(const std::vector<std::wstring_view>& arguments);
+static HRESULT TakeSnapshot(DWORD& exitCode);
+static BOOL WINAPI RestoreSnapshotConfiguration(DWORD controlType);
+static HRESULT ResetDistribution();
+static std::filesystem::path SnapshotDirectory();
+static std::filesystem::path LocalDataDirectory();
+static DWORD PrintStatus();
+static DWORD PrintStats(const std::vector<std::wstring_view>& arguments);
+static std::filesystem::path LaunchStatsPath();
+static std::string LauncherVersion();
+static std::filesystem::path TracePath(std::vector<std::wstring_view>& arguments);
+static Ubuntu::CloudInit::WaitOptions CloudInitOptions();
 
-HRESULT InstallDistribution(bool createUser)
+HRESULT InstallDistribution(bool createUser, Ubuntu::ImageVerifier& imageVerifier)
 {
-    // Register the distribution.
+    Ubuntu::Trace::Span span("InstallDistribution");
     Helpers::PrintMessage(MSG_STATUS_INSTALLING);
-    HRESULT hr = g_wslApi.WslRegisterDistribution();
-    if (FAILED(hr)) {
-        return hr;
+
+    // Refuse to register a damaged image, which would otherwise fail only after a lengthy extraction.
+    auto verification = [&] {
+        Ubuntu::Trace::Span span("ImageVerifier::Wait");
+        return imageVerifier.Wait();
+    }();
+    if (FAILED(verification.hr)) {
+        Helpers::PrintMessage(MSG_INSTALL_IMAGE_CORRUPTED, verification.error.c_str());
+        return verification.hr;
+    }
+
+    if (verification.verified) {
+        Helpers::PrintMessage(MSG_INSTALL_IMAGE_VERIFIED,
+                              static_cast<DWORD>(verification.bytes / (1024 * 1024)),
+                              static_cast<DWORD>(verification.seconds * 1000),
+                              static_cast<DWORD>(verification.megabytesPerSecond()));
+    }
+
+    // Plan the default user out of the image contents while WSL extracts them.
+    std::future<std::shared_ptr<const Ubuntu::InstallPlan>> planning;
+    if (verification.index) {
+        planning = std::async(std::launch::async, Ubuntu::PlanFromImage, std::cref(*verification.index));
     }
 
-    // Delete /etc/resolv.conf to allow WSL to generate a version based on Windows networking information.
-    DWORD exitCode;
-    hr = g_wslApi.WslLaunchInteractive(L"rm /etc/resolv.conf", true, &exitCode);
+    // Register the distribution.
+    HRESULT hr = RegisterDistribution(g_wslApi, verification, true);
     if (FAILED(hr)) {
         return hr;
     }
 
-    if (Ubuntu::CheckInitTasks(g_wslApi, createUser)) {
+    std::shared_ptr<const Ubuntu::InstallPlan> plan;
+    if (planning.valid()) {
+        Ubuntu::Trace::Span span("PlanFromImage::get");
+        plan = planning.get();
+    }
+
+    // Delete /etc/resolv.conf, wait for cloud-init and possibly set the default user.
+    Ubuntu::WslApiBackend wsl(g_wslApi);
+    if (Ubuntu::CheckInitTasks(wsl, DistributionInfo::Users(), createUser, plan.get(), CloudInitOptions())) {
         return ERROR_SUCCESS;
     }
 
@@ -60,6 +138,219 @@ HRESULT InstallDistribution(bool createUser)
     return hr;
 }
 
+HRESULT RegisterDistribution(WslApiLoader& api, const Ubuntu::ImageVerifier::Result& verification, bool report)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto milliseconds = [&start]() {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+    };
+
+    // The decompressed copy spares WSL inflating the image again.
+    if (!verification.cachedImage.empty()) {
+        HRESULT hr = api.WslRegisterDistribution(verification.cachedImage.c_str());
+        if (SUCCEEDED(hr)) {
+            if (report) {
+                auto elapsed = milliseconds();
+                auto baseline = verification.gzipRegistrationMs;
+                if (baseline && (*baseline > elapsed)) {
+                    Helpers::PrintMessage(MSG_INSTALL_FROM_IMAGE_CACHE_SAVED, static_cast<DWORD>(elapsed), static_cast<DWORD>(*baseline - elapsed));
+                } else {
+                    Helpers::PrintMessage(MSG_INSTALL_FROM_IMAGE_CACHE, static_cast<DWORD>(elapsed));
+                }
+            }
+
+            return hr;
+        }
+
+        // The copy may have been tampered with since it was checked: the image is still there.
+        start = std::chrono::steady_clock::now();
+    }
+
+    HRESULT hr = api.WslRegisterDistribution();
+    if (SUCCEEDED(hr) && report && verification.cacheBuilt) {
+        // What the registrations from the copy will compare with.
+        auto cacheDirectory = Ubuntu::ImageCacheDirectory();
+        auto manifest = Ubuntu::ImageCache::Load(cacheDirectory);
+        if (manifest) {
+            manifest->gzipRegistrationMs = milliseconds();
+            Ubuntu::ImageCache::Save(cacheDirectory, *manifest);
+        }
+    }
+
+    return hr;
+}
+
+HRESULT InstallInstances(const std::vector<std::wstring_view>& arguments, Ubuntu::ImageVerifier& imageVerifier, DWORD& exitCode)
+{
+    // install --instances <count> --name-prefix <prefix> [--parallel <count>]
+    size_t count = 0;
+    std::wstring prefix;
+    Ubuntu::Instances::Options options;
+    for (size_t index = 1; index < arguments.size(); index += 2) {
+        if (index + 1 == arguments.size()) {
+            return E_INVALIDARG;
+        }
+
+        if (arguments[index] == ARG_INSTALL_INSTANCES) {
+            if (!ParseCount(arguments[index + 1], count)) {
+                return E_INVALIDARG;
+            }
+
+        } else if (arguments[index] == ARG_INSTALL_NAME_PREFIX) {
+            prefix = arguments[index + 1];
+
+        } else if (arguments[index] == ARG_INSTALL_PARALLEL) {
+            if (!ParseCount(arguments[index + 1], options.parallelism)) {
+                return E_INVALIDARG;
+            }
+
+        } else {
+            return E_INVALIDARG;
+        }
+    }
+
+    if ((count == 0) || (!Ubuntu::Instances::ValidName(prefix))) {
+        return E_INVALIDARG;
+    }
+
+    Ubuntu::Trace::Span span("InstallInstances");
+    Helpers::PrintMessage(MSG_STATUS_INSTALLING);
+
+    // The image is verified and planned from once for all the instances.
+    auto verification = [&] {
+        Ubuntu::Trace::Span span("ImageVerifier::Wait");
+        return imageVerifier.Wait();
+    }();
+    if (FAILED(verification.hr)) {
+        Helpers::PrintMessage(MSG_INSTALL_IMAGE_CORRUPTED, verification.error.c_str());
+        return verification.hr;
+    }
+
+    std::shared_ptr<const Ubuntu::InstallPlan> plan;
+    if (verification.index) {
+        plan = Ubuntu::PlanFromImage(*verification.index);
+    }
+
+    options.plan = plan.get();
+    options.cloudInit = CloudInitOptions();
+
+    // WslRegisterDistribution installs to the package's own directory, which only one distribution
+    // can live in: each instance is imported into a directory of its own instead.
+    auto instancesDirectory = LocalDataDirectory();
+    if (instancesDirectory.empty()) {
+        return HRESULT_FROM_WIN32(ERROR_ENVVAR_NOT_FOUND);
+    }
+
+    instancesDirectory /= L"Instances";
+    auto image = verification.cachedImage.empty() ? Ubuntu::InstallImagePath() : verification.cachedImage;
+
+    // Each instance is reached through a loader of its own, living as long as its backend.
+    auto registration = [&instancesDirectory, &image](const std::wstring& name, std::wstring& error) -> std::shared_ptr<Ubuntu::WslBackend> {
+        auto api = std::make_shared<WslApiLoader>(name);
+        if (api->WslIsDistributionRegistered()) {
+            error = L"a distribution of this name is already registered";
+            return nullptr;
+        }
+
+        HRESULT hr = ImportInstance(name, instancesDirectory / name, image, error);
+        if (FAILED(hr)) {
+            return nullptr;
+        }
+
+        return std::shared_ptr<Ubuntu::WslApiBackend>(new Ubuntu::WslApiBackend(*api), [api](Ubuntu::WslApiBackend* wsl) { delete wsl; });
+    };
+
+    auto finished = [](const Ubuntu::Instances::Instance& instance) {
+        if (!instance.Succeeded()) {
+            Helpers::PrintMessage(MSG_INSTANCE_FAILED, instance.name.c_str(), instance.error.c_str());
+            return;
+        }
+
+        auto milliseconds = [](std::chrono::nanoseconds duration) {
+            return static_cast<DWORD>(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+        };
+
+        Helpers::PrintMessage(MSG_INSTANCE_INSTALLED,
+                              instance.name.c_str(),
+                              milliseconds(instance.registration + instance.provisioning),
+                              milliseconds(instance.registration),
+                              milliseconds(instance.provisioning));
+    };
+
+    auto summary = Ubuntu::Instances::InstallAll(Ubuntu::Instances::Names(prefix, count), registration, options, finished);
+
+    // Every instance read the whole image, decompressed or not.
+    std::error_code error;
+    auto imageSize = std::filesystem::file_size(image, error);
+    auto seconds = std::chrono::duration<double>(summary.elapsed).count();
+    auto megabytesPerSecond = ((error) || (seconds <= 0)) ? 0 : static_cast<double>(imageSize) * summary.Succeeded() / (1024 * 1024) / seconds;
+    Helpers::PrintMessage(MSG_INSTANCES_SUMMARY,
+                          static_cast<DWORD>(summary.Succeeded()),
+                          static_cast<DWORD>(count),
+                          static_cast<DWORD>(std::chrono::duration_cast<std::chrono::milliseconds>(summary.elapsed).count()),
+                          static_cast<DWORD>((options.parallelism < count) ? options.parallelism : count),
+                          static_cast<DWORD>(summary.PerMinute()),
+                          static_cast<DWORD>(megabytesPerSecond));
+    exitCode = (summary.Succeeded() == count) ? 0 : 1;
+    return S_OK;
+}
+
+HRESULT ImportInstance(const std::wstring& name, const std::filesystem::path& directory, const std::filesystem::path& image, std::wstring& error)
+{
+    Ubuntu::Trace::Span span("ImportInstance", name);
+
+    // wsl --import leaves the virtual disk or root filesystem of the instance in its directory.
+    std::error_code created;
+    std::filesystem::create_directories(directory, created);
+    if (created) {
+        error = L"couldn't create " + directory.wstring();
+        return HRESULT_FROM_WIN32(created.value());
+    }
+
+    // A failed import leaves nothing behind for the next attempt to trip on.
+    auto fail = [&directory, &error](std::wstring reason, HRESULT hr) {
+        error = std::move(reason);
+        std::error_code removed;
+        std::filesystem::remove_all(directory, removed);
+        return hr;
+    };
+
+    wchar_t system[MAX_PATH] = {L'\0'};
+    UINT length = GetSystemDirectoryW(system, MAX_PATH);
+    if ((length == 0) || (length >= MAX_PATH)) {
+        return fail(L"couldn't find wsl.exe", HRESULT_FROM_WIN32(GetLastError()));
+    }
+
+    std::wstring command = L"\"" + (std::filesystem::path(system) / L"wsl.exe").wstring() + L"\" --import " + name +
+                           L" \"" + directory.wstring() + L"\" \"" + image.wstring() + L"\"";
+
+    // Without a window of its own, what it prints doesn't mix with the other instances' progress.
+    STARTUPINFOW startup{sizeof(startup)};
+    PROCESS_INFORMATION process{};
+    if (!CreateProcessW(nullptr, command.data(), nullptr, nullptr, FALSE, CREATE_NO_WINDOW, nullptr, nullptr, &startup, &process)) {
+        return fail(L"couldn't run wsl --import", HRESULT_FROM_WIN32(GetLastError()));
+    }
+
+    WaitForSingleObject(process.hProcess, INFINITE);
+    DWORD exitCode = 1;
+    GetExitCodeProcess(process.hProcess, &exitCode);
+    CloseHandle(process.hThread);
+    CloseHandle(process.hProcess);
+    if (exitCode != 0) {
+        return fail(L"wsl --import exited with code " + std::to_wstring(exitCode), E_FAIL);
+    }
+
+    return S_OK;
+}
+
+bool ParseCount(std::wstring_view argument, size_t& count)
+{
+    std::wstring digits(argument);
+    wchar_t* end = nullptr;
+    count = std::wcstoul(digits.c_str(), &end, 10);
+    return (!digits.empty()) && (*end == L'\0') && (count > 0);
+}
+
 HRESULT SetDefaultUser(std::wstring_view userName)
 {
     // Query the UID of the given user name and configure the distribution
@@ -77,6 +368,460 @@ HRESULT SetDefaultUser(std::wstring_view userName)
     return hr;
 }
 
+HRESULT ReadCommands(std::wstring_view path, std::vector<std::string>& commands)
+{
+    // Read the whole list upfront, so that no command competes with it for stdin.
+    std::string script;
+    if (path == ARG_RUN_BATCH_STDIN) {
+        _setmode(_fileno(stdin), _O_BINARY);
+        script.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+
+    } else {
+        std::ifstream file(std::filesystem::path(path), std::ios::binary);
+        if (!file) {
+            Helpers::PrintMessage(MSG_BATCH_READ_FAILED, std::wstring(path).c_str());
+            return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+        }
+
+        script.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    commands = Ubuntu::Batch::ParseScript(script);
+    return S_OK;
+}
+
+HRESULT RunBatch(const std::vector<std::wstring_view>& arguments, DWORD& exitCode)
+{
+    // run --batch [--stop-on-failure] <file|->
+    Ubuntu::Batch::Options options;
+    std::optional<std::wstring_view> path;
+    for (size_t index = 2; index < arguments.size(); index += 1) {
+        if (arguments[index] == ARG_RUN_STOP_ON_FAILURE) {
+            options.stopOnFailure = true;
+
+        } else if (!path) {
+            path = arguments[index];
+
+        } else {
+            return E_INVALIDARG;
+        }
+    }
+
+    if (!path) {
+        return E_INVALIDARG;
+    }
+
+    std::vector<std::string> commands;
+    HRESULT hr = ReadCommands(*path, commands);
+    if (FAILED(hr)) {
+        return hr;
+    }
+
+    options.windowsDirectory = Ubuntu::WideToUtf8(std::filesystem::current_path().wstring());
+
+    // The output goes out untouched, as with WslLaunchInteractive, each result on a line of its own.
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    bool atLineStart = true;
+    auto output = [&](std::string_view data) {
+        if (data.empty()) {
+            return;
+        }
+
+        fflush(stdout);
+        DWORD written = 0;
+        WriteFile(out, data.data(), static_cast<DWORD>(data.size()), &written, nullptr);
+        atLineStart = (data.back() == '\n');
+    };
+
+    auto finished = [&](const Ubuntu::Batch::CommandResult& result) {
+        if (!atLineStart) {
+            output("\n");
+        }
+
+        auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(result.elapsed);
+        Helpers::PrintMessage(MSG_BATCH_COMMAND_FINISHED,
+                              static_cast<DWORD>(result.index + 1),
+                              static_cast<DWORD>(commands.size()),
+                              result.exitCode,
+                              static_cast<DWORD>(milliseconds.count()),
+                              Ubuntu::Utf8ToWide(commands[result.index]).c_str());
+    };
+
+    Ubuntu::WslApiBackend wsl(g_wslApi);
+    auto result = Ubuntu::Batch::Run(wsl, commands, options, output, finished);
+    if (!result.error.empty()) {
+        Helpers::PrintMessage(MSG_BATCH_SESSION_FAILED, result.error.c_str());
+    }
+
+    DWORD succeeded = 0;
+    for (const auto& command : result.commands) {
+        succeeded += (command.exitCode == 0) ? 1 : 0;
+    }
+
+    Helpers::PrintMessage(MSG_BATCH_SUMMARY, succeeded, static_cast<DWORD>(commands.size()));
+    exitCode = result.ExitCode();
+    if ((exitCode == 0) && (!result.error.empty())) {
+        exitCode = 1;
+    }
+
+    return S_OK;
+}
+
+HRESULT RunParallel(const std::vector<std::wstring_view>& arguments, DWORD& exitCode)
+{
+    // run --parallel <jobs> <file|->
+    if (arguments.size() != 4) {
+        return E_INVALIDARG;
+    }
+
+    Ubuntu::Parallel::Options options;
+    if (!ParseCount(arguments[2], options.jobs)) {
+        return E_INVALIDARG;
+    }
+
+    std::vector<std::string> commands;
+    HRESULT hr = ReadCommands(arguments[3], commands);
+    if (FAILED(hr)) {
+        return hr;
+    }
+
+    options.windowsDirectory = Ubuntu::WideToUtf8(std::filesystem::current_path().wstring());
+
+    // Each line goes out untouched but for the number of the command it came from.
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    std::string prefixed;
+    auto line = [&](size_t index, std::string_view text) {
+        prefixed = "[" + std::to_string(index + 1) + "] ";
+        prefixed += text;
+        prefixed += '\n';
+        fflush(stdout);
+        DWORD written = 0;
+        WriteFile(out, prefixed.data(), static_cast<DWORD>(prefixed.size()), &written, nullptr);
+    };
+
+    auto finished = [&](const Ubuntu::Parallel::JobResult& job) {
+        auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(job.elapsed);
+        if (!job.exitCode) {
+            Helpers::PrintMessage(MSG_PARALLEL_JOB_FAILED,
+                                  static_cast<DWORD>(job.index + 1),
+                                  static_cast<DWORD>(commands.size()),
+                                  job.error.c_str(),
+                                  Ubuntu::Utf8ToWide(commands[job.index]).c_str());
+            return;
+        }
+
+        Helpers::PrintMessage(MSG_BATCH_COMMAND_FINISHED,
+                              static_cast<DWORD>(job.index + 1),
+                              static_cast<DWORD>(commands.size()),
+                              *job.exitCode,
+                              static_cast<DWORD>(milliseconds.count()),
+                              Ubuntu::Utf8ToWide(commands[job.index]).c_str());
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    Ubuntu::WslApiBackend wsl(g_wslApi);
+    auto result = Ubuntu::Parallel::Run(wsl, commands, options, line, finished);
+    auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    DWORD succeeded = 0;
+    for (const auto& job : result.jobs) {
+        succeeded += job.Succeeded() ? 1 : 0;
+    }
+
+    Helpers::PrintMessage(MSG_PARALLEL_SUMMARY,
+                          succeeded,
+                          static_cast<DWORD>(commands.size()),
+                          static_cast<DWORD>(milliseconds.count()),
+                          static_cast<DWORD>((options.jobs < commands.size()) ? options.jobs : commands.size()));
+    exitCode = result.ExitCode();
+    return S_OK;
+}
+
+HRESULT RunBroker()
+{
+    // Keep shells running, so that the VM neither shuts down nor has to boot for the next requests.
+    Ubuntu::WslApiBackend wsl(g_wslApi);
+    Ubuntu::Broker::Pool pool(wsl);
+    auto warm = pool.Prewarm();
+    auto minutes = std::chrono::duration_cast<std::chrono::minutes>(BROKER_IDLE_TIMEOUT);
+    Helpers::PrintMessage(MSG_BROKER_LISTENING, static_cast<DWORD>(warm), static_cast<DWORD>(minutes.count()));
+    HRESULT hr = Ubuntu::BrokerPipe::Serve(pool, BROKER_IDLE_TIMEOUT);
+    if (hr == HRESULT_FROM_WIN32(ERROR_ALREADY_EXISTS)) {
+        Helpers::PrintMessage(MSG_BROKER_ALREADY_RUNNING);
+    }
+
+    return hr;
+}
+
+std::optional<DWORD> RunThroughBroker(const std::vector<std::wstring_view>& arguments)
+{
+    // The broker runs commands without a terminal nor stdin: only those given no input at all, i.e.
+    // NUL or no handle, may be handed to it. Consoles, pipes and files are left to a launch.
+    HANDLE input = GetStdHandle(STD_INPUT_HANDLE);
+    DWORD mode = 0;
+    if ((input != nullptr) && (input != INVALID_HANDLE_VALUE) &&
+        ((GetFileType(input) != FILE_TYPE_CHAR) || GetConsoleMode(input, &mode))) {
+        return std::nullopt;
+    }
+
+    std::wstring command;
+    for (size_t index = 2; index < arguments.size(); index += 1) {
+        command += L" ";
+        command += arguments[index];
+    }
+
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    auto output = [&](std::string_view data) {
+        DWORD written = 0;
+        WriteFile(out, data.data(), static_cast<DWORD>(data.size()), &written, nullptr);
+    };
+
+    auto directory = Ubuntu::WideToUtf8(std::filesystem::current_path().wstring());
+    auto reply = Ubuntu::BrokerPipe::TryRun(Ubuntu::WideToUtf8(command), directory, output);
+    if (!reply) {
+        return std::nullopt;
+    }
+
+    if (!reply->exitCode) {
+        Helpers::PrintMessage(MSG_BROKER_REQUEST_FAILED, Ubuntu::Utf8ToWide(reply->error).c_str());
+        return 1;
+    }
+
+    return *reply->exitCode;
+}
+
+HRESULT TakeSnapshot(DWORD& exitCode)
+{
+    auto directory = SnapshotDirectory();
+    if (directory.empty()) {
+        return HRESULT_FROM_WIN32(ERROR_ENVVAR_NOT_FOUND);
+    }
+
+    // The snapshot is taken as root, which Ctrl-C would otherwise leave as the default user.
+    HRESULT hr = g_wslApi.WslGetDistributionConfiguration(g_snapshotConfiguration);
+    if (FAILED(hr)) {
+        return hr;
+    }
+
+    SetConsoleCtrlHandler(RestoreSnapshotConfiguration, TRUE);
+    Ubuntu::WslApiBackend wsl(g_wslApi);
+    auto result = Ubuntu::Snapshot::Take(wsl, directory);
+    SetConsoleCtrlHandler(RestoreSnapshotConfiguration, FALSE);
+    if (!result.Succeeded()) {
+        Helpers::PrintMessage(MSG_SNAPSHOT_FAILED, result.error.c_str());
+        exitCode = 1;
+        return S_OK;
+    }
+
+    Helpers::PrintMessage(MSG_SNAPSHOT_TAKEN,
+                          static_cast<DWORD>(result.bytes / (1024 * 1024)),
+                          static_cast<DWORD>(std::chrono::duration_cast<std::chrono::milliseconds>(result.elapsed).count()),
+                          static_cast<DWORD>(result.MegabytesPerSecond()));
+    exitCode = 0;
+    return S_OK;
+}
+
+BOOL WINAPI RestoreSnapshotConfiguration(DWORD)
+{
+    g_wslApi.WslConfigureDistribution(g_snapshotConfiguration.defaultUid, g_snapshotConfiguration.flags);
+
+    // The launcher still exits as it would have.
+    return FALSE;
+}
+
+HRESULT ResetDistribution()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    // Nothing is unregistered unless the snapshot checks out.
+    std::atomic<bool> cancelled{false};
+    auto snapshot = Ubuntu::Snapshot::Check(SnapshotDirectory(), cancelled);
+    if (!snapshot) {
+        Helpers::PrintMessage(MSG_SNAPSHOT_MISSING);
+        return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+    }
+
+    HRESULT hr = S_OK;
+    bool unregistered = false;
+    if (g_wslApi.WslIsDistributionRegistered()) {
+        hr = g_wslApi.WslUnregisterDistribution();
+        if (FAILED(hr)) {
+            return hr;
+        }
+
+        unregistered = true;
+    }
+
+    // Running out of space or the snapshot changing since it was checked leave no distribution.
+    hr = g_wslApi.WslRegisterDistribution(snapshot->image.c_str());
+    if (FAILED(hr)) {
+        if (unregistered) {
+            Helpers::PrintMessage(MSG_RESET_UNREGISTERED);
+        }
+
+        return hr;
+    }
+
+    // Registering leaves root as the default user and the default flags.
+    hr = g_wslApi.WslConfigureDistribution(snapshot->defaultUid, static_cast<WSL_DISTRIBUTION_FLAGS>(snapshot->flags));
+    if (FAILED(hr)) {
+        return hr;
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    Helpers::PrintMessage(MSG_RESET_SUCCESS, static_cast<DWORD>(elapsed.count()));
+    return S_OK;
+}
+
+std::filesystem::path SnapshotDirectory()
+{
+    auto directory = LocalDataDirectory();
+    return directory.empty() ? directory : directory / L"Snapshot";
+}
+
+std::filesystem::path LocalDataDirectory()
+{
+    wchar_t localAppData[MAX_PATH] = {L'\0'};
+    DWORD length = GetEnvironmentVariableW(L"LOCALAPPDATA", localAppData, MAX_PATH);
+    if ((length == 0) || (length >= MAX_PATH)) {
+        return {};
+    }
+
+    return std::filesystem::path(localAppData) / DistributionInfo::Name;
+}
+
+DWORD PrintStatus()
+{
+    // Neither call starts the distribution, let alone the VM.
+    if (!g_wslApi.WslIsOptionalComponentInstalled()) {
+        Helpers::PrintErrorMessage(HRESULT_FROM_WIN32(ERROR_LINUX_SUBSYSTEM_NOT_PRESENT));
+        return 1;
+    }
+
+    if (!g_wslApi.WslIsDistributionRegistered()) {
+        Helpers::PrintMessage(MSG_STATUS_NOT_INSTALLED);
+        return 1;
+    }
+
+    WslDistributionConfiguration configuration;
+    if (FAILED(g_wslApi.WslGetDistributionConfiguration(configuration))) {
+        return 1;
+    }
+
+    Helpers::PrintMessage(MSG_STATUS, configuration.version, configuration.defaultUid, configuration.flags);
+    for (const auto& variable : configuration.defaultEnvironment) {
+        Helpers::PrintMessage(MSG_STATUS_ENVIRONMENT_VARIABLE, variable.c_str());
+    }
+
+    return 0;
+}
+
+DWORD PrintStats(const std::vector<std::wstring_view>& arguments)
+{
+    std::filesystem::path prometheus;
+    if ((arguments.size() == 3) && (arguments[1] == ARG_STATS_PROMETHEUS)) {
+        prometheus = arguments[2];
+    } else if (arguments.size() != 1) {
+        Helpers::PrintMessage(MSG_USAGE);
+        return 1;
+    }
+
+    // Read even while recording is disabled, to look at what was recorded before.
+    auto directory = LocalDataDirectory();
+    if (directory.empty()) {
+        Helpers::PrintErrorMessage(HRESULT_FROM_WIN32(ERROR_ENVVAR_NOT_FOUND));
+        return 1;
+    }
+
+    auto path = directory / L"LaunchStats.txt";
+    auto store = Ubuntu::LaunchStats::Load(path);
+    if (!store) {
+        Helpers::PrintMessage(MSG_STATS_UNREADABLE, path.c_str());
+        return 1;
+    }
+
+    if (store->Empty()) {
+        Helpers::PrintMessage(MSG_STATS_EMPTY, path.c_str());
+    } else {
+        Helpers::PrintMessage(MSG_STATS, Ubuntu::LaunchStats::Report(*store).c_str());
+    }
+
+    if (!prometheus.empty() && !Ubuntu::LaunchStats::WritePrometheus(prometheus, *store)) {
+        Helpers::PrintMessage(MSG_STATS_PROMETHEUS_FAILED, prometheus.c_str());
+        return 1;
+    }
+
+    return 0;
+}
+
+std::filesystem::path LaunchStatsPath()
+{
+    wchar_t setting[8] = {L'\0'};
+    if ((GetEnvironmentVariableW(ENV_STATS, setting, ARRAYSIZE(setting)) != 0) &&
+        (std::wstring_view(setting) == L"0")) {
+        return {};
+    }
+
+    auto directory = LocalDataDirectory();
+    return directory.empty() ? directory : directory / L"LaunchStats.txt";
+}
+
+std::string LauncherVersion()
+{
+    // Statistics are kept by package version, telling releases apart.
+    UINT32 length = 0;
+    if (GetCurrentPackageId(&length, nullptr) != ERROR_INSUFFICIENT_BUFFER) {
+        return "unpackaged";
+    }
+
+    std::vector<BYTE> buffer(length);
+    if (GetCurrentPackageId(&length, buffer.data()) != ERROR_SUCCESS) {
+        return "unpackaged";
+    }
+
+    const auto& version = reinterpret_cast<const PACKAGE_ID*>(buffer.data())->version;
+    return std::to_string(version.Major) + "." + std::to_string(version.Minor) + "." +
+           std::to_string(version.Build) + "." + std::to_string(version.Revision);
+}
+
+std::filesystem::path TracePath(std::vector<std::wstring_view>& arguments)
+{
+    // The option comes first, so that it can't be mistaken for part of a command to run.
+    if ((arguments.size() > 1) && (arguments[0] == ARG_TRACE)) {
+        std::filesystem::path path = arguments[1];
+        arguments.erase(arguments.begin(), arguments.begin() + 2);
+        return path;
+    }
+
+    wchar_t* value = nullptr;
+    size_t size = 0;
+    std::filesystem::path path;
+    if ((_wdupenv_s(&value, &size, ENV_TRACE) == 0) && (value != nullptr)) {
+        path = value;
+        free(value);
+    }
+
+    return path;
+}
+
+Ubuntu::CloudInit::WaitOptions CloudInitOptions()
+{
+    Ubuntu::CloudInit::WaitOptions options;
+    wchar_t* value = nullptr;
+    size_t size = 0;
+    if ((_wdupenv_s(&value, &size, ENV_CLOUD_INIT_TIMEOUT) == 0) && (value != nullptr)) {
+        wchar_t* end = nullptr;
+        unsigned long seconds = wcstoul(value, &end, 10);
+        if ((end != value) && (*end == L'\0')) {
+            options.deadline = std::chrono::seconds(seconds);
+        }
+
+        free(value);
+    }
+
+    return options;
+}
+
 int DebugReportHook(int reportType, char *message, int *returnValue)
 {
     const auto type = [=]() -> std::string_view {
@@ -109,12 +854,44 @@ int wmain(int argc, wchar_t const *argv[])
         arguments.push_back(argv[index]);
     }
 
+    // Record where the time goes if asked to, written out when returning.
+    Ubuntu::Trace::Session traceSession(TracePath(arguments));
+
+    // Add the time spent in each phase to the statistics kept across runs, when returning.
+    Ubuntu::LaunchStats::Session statsSession(LaunchStatsPath(), LauncherVersion());
+    const auto launchStart = std::chrono::steady_clock::now();
+    Ubuntu::Trace::Span traceSpan("wmain");
+
     // Deal with possible help flag.
     if (!arguments.empty() && arguments.front() == ARG_HELP) {
         Helpers::PrintMessage(MSG_USAGE);
         return 0;
     }
 
+    // Report the state of the distribution, without installing nor starting it.
+    if (!arguments.empty() && arguments.front() == ARG_STATUS) {
+        return PrintStatus();
+    }
+
+    // Report the statistics of the previous launches.
+    if (!arguments.empty() && arguments.front() == ARG_STATS) {
+        return PrintStats(arguments);
+    }
+
+    // Hand the command to the session broker if asked to and one is running, sparing a launch.
+    // Otherwise it runs as any other, the broker not being told apart from the regular launch.
+    if ((arguments.size() > 2) && (arguments[0] == ARG_RUN) && (arguments[1] == ARG_RUN_WARM)) {
+        if (auto exitCode = RunThroughBroker(arguments)) {
+            return *exitCode;
+        }
+
+        arguments.erase(arguments.begin() + 1);
+    }
+
+    // Start reading the install image while WSL is probed, in case the distro needs installing. Nothing
+    // is written until an install waits for it.
+    Ubuntu::ImageVerifier imageVerifier(Ubuntu::InstallImagePath(), Ubuntu::ImageCacheDirectory());
+
     // Ensure that the Windows Subsystem for Linux optional component is installed.
     DWORD exitCode = 1;
     if (!g_wslApi.WslIsOptionalComponentInstalled()) {
@@ -126,6 +903,29 @@ int wmain(int argc, wchar_t const *argv[])
         return exitCode;
     }
 
+    // Install instances of the distribution under names of their own, leaving this one alone.
+    if ((arguments.size() > 1) && (arguments[0] == ARG_INSTALL) && (arguments[1] == ARG_INSTALL_INSTANCES)) {
+        HRESULT hr = InstallInstances(arguments, imageVerifier, exitCode);
+        if (FAILED(hr)) {
+            Helpers::PrintErrorMessage(hr);
+            return 1;
+        }
+
+        return exitCode;
+    }
+
+    // Register the distribution again from its snapshot, whether it is still there or not.
+    if ((arguments.size() == 1) && (arguments[0] == ARG_RESET)) {
+        imageVerifier.Cancel();
+        HRESULT hr = ResetDistribution();
+        if (FAILED(hr)) {
+            Helpers::PrintErrorMessage(hr);
+            return 1;
+        }
+
+        return 0;
+    }
+
     // Install the distribution if it is not already.
     bool installOnly = ((arguments.size() > 0) && (arguments[0] == ARG_INSTALL));
     HRESULT hr = S_OK;
@@ -133,7 +933,7 @@ int wmain(int argc, wchar_t const *argv[])
 
         // If the "--root" option is specified, do not create a user account.
         bool useRoot = ((installOnly) && (arguments.size() > 1) && (arguments[1] == ARG_INSTALL_ROOT));
-        hr = InstallDistribution(!useRoot);
+        hr = InstallDistribution(!useRoot, imageVerifier);
         if (FAILED(hr)) {
             if (hr == HRESULT_FROM_WIN32(ERROR_ALREADY_EXISTS)) {
                 Helpers::PrintMessage(MSG_INSTALL_ALREADY_EXISTS);
@@ -144,11 +944,17 @@ int wmain(int argc, wchar_t const *argv[])
         }
 
         exitCode = SUCCEEDED(hr) ? 0 : 1;
+
+    } else {
+        imageVerifier.Cancel();
     }
 
     // Parse the command line arguments.
     if ((SUCCEEDED(hr)) && (!installOnly)) {
         if (arguments.empty()) {
+            // WslLaunchInteractive only returns once the session ends: what comes before it is
+            // what delays the shell.
+            Ubuntu::LaunchStats::Record("UntilSession", std::chrono::steady_clock::now() - launchStart);
             hr = g_wslApi.WslLaunchInteractive(L"", false, &exitCode);
 
             // Check exitCode to see if wsl.exe returned that it could not start the Linux process
@@ -157,6 +963,21 @@ int wmain(int argc, wchar_t const *argv[])
                 Helpers::PromptForInput();
             }
 
+        } else if ((arguments[0] == ARG_RUN) && (arguments.size() > 1) && (arguments[1] == ARG_RUN_BATCH)) {
+            hr = RunBatch(arguments, exitCode);
+
+        } else if ((arguments[0] == ARG_RUN) && (arguments.size() > 1) && (arguments[1] == ARG_RUN_PARALLEL)) {
+            hr = RunParallel(arguments, exitCode);
+
+        } else if ((arguments[0] == ARG_SNAPSHOT) && (arguments.size() == 1)) {
+            hr = TakeSnapshot(exitCode);
+
+        } else if ((arguments[0] == ARG_BROKER) && (arguments.size() == 1)) {
+            hr = RunBroker();
+            if (SUCCEEDED(hr)) {
+                exitCode = 0;
+            }
+
         } else if ((arguments[0] == ARG_RUN) ||
                    (arguments[0] == ARG_RUN_C)) {
 
@@ -166,6 +987,7 @@ int wmain(int argc, wchar_t const *argv[])
                 command += arguments[index];
             }
 
+            Ubuntu::LaunchStats::Record("UntilSession", std::chrono::steady_clock::now() - launchStart);
             hr = g_wslApi.WslLaunchInteractive(command.c_str(), true, &exitCode);
 
         } else if (arguments[0] == ARG_CONFIG) {
@@ -5,14 +5,11 @@
 
 #include "stdafx.h"
 
-namespace {
-    HRESULT FormatMessageHelperVa(DWORD messageId, va_list vaList, std::wstring* message);
-    HRESULT PrintMessageVa(DWORD messageId, va_list vaList);
-}
+using namespace Ubuntu::Messages::Catalog;
 
-std::wstring Helpers::GetUserInput(DWORD promptMsg, DWORD maxCharacters)
+std::wstring Helpers::GetUserInput(const Ubuntu::Messages::Message<>& prompt, DWORD maxCharacters)
 {
-    Helpers::PrintMessage(promptMsg);
+    Helpers::PrintMessage(prompt);
     size_t bufferSize = maxCharacters + 1;
     std::unique_ptr<wchar_t[]> inputBuffer(new wchar_t[bufferSize]);
     std::wstring input;
@@ -41,7 +38,7 @@ void Helpers::PrintErrorMessage(HRESULT error)
                      0,
                      nullptr);
 
-    Helpers::PrintMessage(MSG_ERROR_CODE, error, buffer);
+    Helpers::PrintMessage(MSG_ERROR_CODE, error, (buffer != nullptr) ? buffer : L"");
     if (buffer != nullptr) {
         HeapFree(GetProcessHeap(), 0, buffer);
     }
@@ -49,15 +46,6 @@ void Helpers::PrintErrorMessage(HRESULT error)
     return;
 }
 
-HRESULT Helpers::PrintMessage(DWORD messageId, ...)
-{
-    va_list argList;
-    va_start(argList, messageId);
-    HRESULT hr = PrintMessageVa(messageId, argList);
-    va_end(argList);
-    return hr;
-}
-
 void Helpers::PromptForInput()
 {
     Helpers::PrintMessage(MSG_PRESS_A_KEY);
@@ -65,33 +53,8 @@ void Helpers::PromptForInput()
     return;
 }
 
-namespace {
-    HRESULT FormatMessageHelperVa(DWORD messageId, va_list vaList, std::wstring* message)
-    {
-        PWSTR buffer = nullptr; 
-        DWORD written = ::FormatMessageW(FORMAT_MESSAGE_FROM_HMODULE | FORMAT_MESSAGE_ALLOCATE_BUFFER,
-                                         nullptr,
-                                         messageId,
-                                         0,
-                                         (PWSTR)&buffer,
-                                         10,
-                                         &vaList);
-        *message = buffer;
-        if (buffer != nullptr) {
-            HeapFree(GetProcessHeap(), 0, buffer);
-        }
-
-        return (written > 0) ? S_OK : HRESULT_FROM_WIN32(GetLastError());
-    }
-
-    HRESULT PrintMessageVa(DWORD messageId, va_list vaList)
-    {
-        std::wstring message;
-        HRESULT hr = FormatMessageHelperVa(messageId, vaList, &message);
-        if (SUCCEEDED(hr)) {
-            wprintf(L"%ls", message.c_str());
-        }
-
-        return hr;
-    }
+void Helpers::WriteMessage(void* context, std::wstring_view text)
+{
+    UNREFERENCED_PARAMETER(context);
+    fwprintf(stdout, L"%.*ls", static_cast<int>(text.size()), text.data());
 }
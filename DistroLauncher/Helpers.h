@@ -9,8 +9,19 @@
 
 namespace Helpers
 {
-    std::wstring GetUserInput(DWORD promptMsg, DWORD maxCharacters);
+    std::wstring GetUserInput(const Ubuntu::Messages::Message<>& prompt, DWORD maxCharacters);
     void PrintErrorMessage(HRESULT hr);
-    HRESULT PrintMessage(DWORD messageId, ...);
     void PromptForInput();
+
+    // Writes formatted messages to stdout, as Ubuntu::Messages::Output flushes them.
+    void WriteMessage(void* context, std::wstring_view text);
+
+    // Prints [message] from the catalog compiled out of messages.mc, with [arguments] for its
+    // inserts, in a single write.
+    template <typename... Inserts>
+    void PrintMessage(const Ubuntu::Messages::Message<Inserts...>& message, typename Inserts::Type... arguments)
+    {
+        Ubuntu::Messages::Output output(WriteMessage, nullptr);
+        Ubuntu::Messages::Format(message, output, arguments...);
+    }
 }
\ No newline at end of file
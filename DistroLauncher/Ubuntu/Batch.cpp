@@ -0,0 +1,234 @@
+#include "Batch.h"
+#include "NssQuery.h"
+#include "SplitView.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <random>
+
+namespace Ubuntu::Batch {
+namespace {
+// Runs each command in a subshell, so that none can alter what the next ones see, e.g. with cd or
+// exit. The commands follow the definitions below, one step per command.
+constexpr char driverPrelude[] = R"sh(
+if [ -n "${cwd}" ]; then
+  cd "$(wslpath -u "${cwd}")" || exit 1
+fi
+
+step() {
+  start=$(date +%s%N)
+  (
+    if [ -n "$3" ]; then
+      cd "$(wslpath -u "$3")" || exit 1
+    fi
+    eval "$2"
+  ) </dev/null 2>&1
+  status=$?
+  end=$(date +%s%N)
+  printf '\n%s %d %d %d\n' "${marker}" "$1" "${status}" "$((end - start))"
+  if [ "${status}" -ne 0 ] && [ "${stop_on_failure}" = 1 ]; then
+    exit 0
+  fi
+}
+)sh";
+
+// Parses "<index> <exit code> <nanoseconds>".
+std::optional<CommandResult> parseRecord(std::string_view record);
+}  // namespace
+
+std::string NewMarker() {
+  std::random_device random;
+  std::uniform_int_distribution<std::uint64_t> bits;
+  char marker[64];
+  std::snprintf(marker, sizeof(marker), "ubuntu-batch-%016llx%016llx",
+                static_cast<unsigned long long>(bits(random)),
+                static_cast<unsigned long long>(bits(random)));
+  return marker;
+}
+
+std::vector<std::string> ParseScript(std::string_view script) {
+  std::vector<std::string> commands;
+  for (auto line : SplitView{script, '\n'}) {
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+    auto first = line.find_first_not_of(" \t");
+    if (first == std::string_view::npos || line[first] == '#') {
+      continue;
+    }
+    commands.emplace_back(line.substr(first));
+  }
+  return commands;
+}
+
+std::string DriverHeader(const Options& options, std::string_view marker) {
+  std::string script = "marker=" + ShellQuote(marker) + "\n";
+  script += options.stopOnFailure ? "stop_on_failure=1\n" : "stop_on_failure=0\n";
+  script += "cwd=" + ShellQuote(options.windowsDirectory) + "\n";
+  script += driverPrelude;
+  return script;
+}
+
+std::string StepLine(std::size_t index, std::string_view command,
+                     std::string_view windowsDirectory) {
+  std::string line = "step " + std::to_string(index) + ' ' + ShellQuote(command);
+  if (!windowsDirectory.empty()) {
+    line += ' ';
+    line += ShellQuote(windowsDirectory);
+  }
+  line += '\n';
+  return line;
+}
+
+std::string DriverScript(const std::vector<std::string>& commands, const Options& options,
+                         std::string_view marker) {
+  std::string script = DriverHeader(options, marker);
+  for (std::size_t i = 0; i < commands.size(); ++i) {
+    script += StepLine(i, commands[i]);
+  }
+  script += "exit 0\n";
+  return script;
+}
+
+Demuxer::Demuxer(std::string marker, OutputFunction output, ResultFunction result)
+    : needle_{'\n' + std::move(marker) + ' '},
+      output_{std::move(output)},
+      result_{std::move(result)} {}
+
+void Demuxer::Feed(std::string_view chunk) {
+  pending_ += chunk;
+  for (;;) {
+    auto found = pending_.find(needle_);
+    if (found == std::string::npos) {
+      break;
+    }
+    auto eol = pending_.find('\n', found + needle_.size());
+    if (eol == std::string::npos) {
+      // The rest of the record is yet to come.
+      if (found > 0) {
+        output_(std::string_view{pending_}.substr(0, found));
+        pending_.erase(0, found);
+      }
+      return;
+    }
+    auto record = parseRecord(std::string_view{pending_}.substr(found + needle_.size(),
+                                                                eol - found - needle_.size()));
+    if (!record) {
+      // Not a record after all, but output.
+      output_(std::string_view{pending_}.substr(0, eol + 1));
+    } else {
+      if (found > 0) {
+        output_(std::string_view{pending_}.substr(0, found));
+      }
+      ++results_;
+      result_(*record);
+    }
+    pending_.erase(0, eol + 1);
+  }
+
+  // Holds back the longest end that is also the start of a record.
+  std::size_t held = std::min(pending_.size(), needle_.size() - 1);
+  while (held > 0 &&
+         pending_.compare(pending_.size() - held, held, needle_, 0, held) != 0) {
+    --held;
+  }
+  if (pending_.size() > held) {
+    output_(std::string_view{pending_}.substr(0, pending_.size() - held));
+    pending_.erase(0, pending_.size() - held);
+  }
+}
+
+void Demuxer::Finish() {
+  if (!pending_.empty()) {
+    output_(pending_);
+    pending_.clear();
+  }
+}
+
+unsigned long Result::ExitCode() const {
+  for (const auto& command : commands) {
+    if (command.exitCode != 0) {
+      return command.exitCode;
+    }
+  }
+  return 0;
+}
+
+Result Run(WslBackend& wsl, const std::vector<std::string>& commands, const Options& options,
+           const Demuxer::OutputFunction& output, const Demuxer::ResultFunction& finished) {
+  Result result;
+  if (commands.empty()) {
+    return result;
+  }
+
+  Trace::Span span{"Batch::Run"};
+  auto marker = NewMarker();
+  Demuxer demuxer{marker, output, [&](const CommandResult& command) {
+                    result.commands.push_back(command);
+                    if (finished) {
+                      finished(command);
+                    }
+                  }};
+  // The script is fed through stdin, as a command line can't hold more than 128 KiB of it.
+  std::mutex mutex;
+  std::condition_variable changed;
+  bool ended = false;
+  auto session = wsl.Spawn(L"exec sh -s", [&](std::string_view data) {
+    if (data.empty()) {
+      std::scoped_lock lock{mutex};
+      ended = true;
+      changed.notify_all();
+    } else {
+      demuxer.Feed(data);
+    }
+    return true;
+  });
+  if (!session) {
+    result.error = L"the session couldn't be started";
+    return result;
+  }
+  // The shell may exit before reading it all, e.g. when stopping on a failure.
+  session->Write(DriverScript(commands, options, marker));
+  {
+    std::unique_lock lock{mutex};
+    changed.wait(lock, [&ended] { return ended; });
+  }
+  session.reset();
+  demuxer.Finish();
+
+  const bool stopped = options.stopOnFailure && result.ExitCode() != 0;
+  if (result.commands.size() < commands.size() && !stopped) {
+    result.error = L"the session ended before running every command";
+  }
+  span.SetDetail(std::to_string(result.commands.size()) + " of " +
+                 std::to_string(commands.size()) + " command(s) run");
+  return result;
+}
+
+namespace {
+std::optional<CommandResult> parseRecord(std::string_view record) {
+  CommandResult result;
+  unsigned long long nanoseconds = 0;
+  const char* end = record.data() + record.size();
+  auto parsed = std::from_chars(record.data(), end, result.index);
+  if (parsed.ec != std::errc{} || parsed.ptr == end || *parsed.ptr != ' ') {
+    return std::nullopt;
+  }
+  parsed = std::from_chars(parsed.ptr + 1, end, result.exitCode);
+  if (parsed.ec != std::errc{} || parsed.ptr == end || *parsed.ptr != ' ') {
+    return std::nullopt;
+  }
+  parsed = std::from_chars(parsed.ptr + 1, end, nanoseconds);
+  if (parsed.ec != std::errc{} || parsed.ptr != end) {
+    return std::nullopt;
+  }
+  result.elapsed = std::chrono::nanoseconds{nanoseconds};
+  return result;
+}
+}  // namespace
+}  // namespace Ubuntu::Batch
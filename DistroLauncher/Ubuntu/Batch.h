@@ -0,0 +1,92 @@
+#pragma once
+
+#include "WslBackend.h"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Running a list of commands through a single launched session, as `run --batch` does, instead of
+// launching a process per command. The session's output is the commands' output, stderr merged
+// into stdout, interleaved with a result record after each command. It doesn't depend on any Windows
+// API, the distro being reached through a WslBackend.
+namespace Ubuntu::Batch {
+// The commands of a batch [script]: one per line, blank lines and lines starting with # skipped.
+std::vector<std::string> ParseScript(std::string_view script);
+
+struct Options {
+  // Whether to skip the remaining commands once one exits with non-zero.
+  bool stopOnFailure = false;
+  // The Windows directory the commands run in, translated by wslpath. The home directory if empty.
+  std::string windowsDirectory;
+};
+
+struct CommandResult {
+  // The position of the command in the batch.
+  std::size_t index = 0;
+  unsigned long exitCode = 0;
+  std::chrono::nanoseconds elapsed{0};
+};
+
+// A marker no command output could contain by chance.
+std::string NewMarker();
+
+// The shell script running [commands] as told by [options], each in its own subshell with stdin
+// redirected from /dev/null. After each command it outputs a line made of a newline, [marker], the
+// index of the command, its exit code and the nanoseconds it took, as Demuxer expects.
+std::string DriverScript(const std::vector<std::string>& commands, const Options& options,
+                         std::string_view marker);
+
+// The parts of a driver script: the definitions, then one step per command, which may also run in
+// a [windowsDirectory] of its own. A shell reading its script from stdin can be fed steps one by
+// one.
+std::string DriverHeader(const Options& options, std::string_view marker);
+std::string StepLine(std::size_t index, std::string_view command,
+                     std::string_view windowsDirectory = {});
+
+// Splits the output of a driver script fed in chunks into the commands' output and their results.
+class Demuxer {
+ public:
+  using OutputFunction = std::function<void(std::string_view data)>;
+  using ResultFunction = std::function<void(const CommandResult& result)>;
+
+  Demuxer(std::string marker, OutputFunction output, ResultFunction result);
+
+  // Parses the next [chunk]. Output that may be the start of a result record is held back until the
+  // next chunk tells.
+  void Feed(std::string_view chunk);
+
+  // Hands out what was held back, once the session output has been read to its end.
+  void Finish();
+
+  // The results parsed so far.
+  std::size_t Results() const { return results_; }
+
+ private:
+  std::string needle_;
+  OutputFunction output_;
+  ResultFunction result_;
+  std::string pending_;
+  std::size_t results_ = 0;
+};
+
+struct Result {
+  // In the order the commands ran, which is that of the batch. Shorter than the batch if some were
+  // skipped or the session died.
+  std::vector<CommandResult> commands;
+  // Why the session failed, empty if it didn't.
+  std::wstring error;
+
+  // The exit code of the first command that failed, 0 if none did.
+  unsigned long ExitCode() const;
+};
+
+// Runs [commands] in a single session, a shell reading the driver script from stdin, handing their
+// output to [output] as it arrives and each result to [finished] as soon as the command exits.
+Result Run(WslBackend& wsl, const std::vector<std::string>& commands, const Options& options,
+           const Demuxer::OutputFunction& output, const Demuxer::ResultFunction& finished);
+}  // namespace Ubuntu::Batch
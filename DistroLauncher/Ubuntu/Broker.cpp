@@ -0,0 +1,272 @@
+#include "Broker.h"
+#include "Provisioning.h"
+#include "Trace.h"
+
+#include <charconv>
+#include <system_error>
+
+namespace Ubuntu::Broker {
+namespace {
+// Requests carry a command line and a directory, nothing near that big.
+constexpr std::size_t maxRequestSize = 1024 * 1024;
+
+// Replies carry output in chunks of at most the size of a pipe read.
+constexpr std::size_t maxReplySize = 16 * 1024 * 1024;
+}  // namespace
+
+std::unique_ptr<WarmShell> WarmShell::Start(WslBackend& wsl) {
+  Trace::Span span{"WarmShell::Start"};
+  std::unique_ptr<WarmShell> shell{new WarmShell{Batch::NewMarker()}};
+  shell->session_ = wsl.Spawn(L"exec sh -s", [raw = shell.get()](std::string_view data) {
+    raw->consume(data);
+    return true;
+  });
+  if (!shell->session_ || !shell->session_->Write(Batch::DriverHeader({}, shell->marker_))) {
+    return nullptr;
+  }
+  return shell;
+}
+
+WarmShell::WarmShell(std::string marker)
+    : marker_{marker},
+      demuxer_{std::move(marker),
+               [this](std::string_view data) {
+                 if (output_) {
+                   (*output_)(data);
+                 }
+               },
+               [this](const Batch::CommandResult& result) {
+                 result_ = result;
+                 changed_.notify_all();
+               }} {}
+
+std::optional<Batch::CommandResult> WarmShell::Run(std::string_view command,
+                                                   std::string_view windowsDirectory,
+                                                   const Batch::Demuxer::OutputFunction& output) {
+  std::unique_lock lock{mutex_};
+  if (ended_) {
+    return std::nullopt;
+  }
+  output_ = &output;
+  result_.reset();
+  auto index = commandsRun_++;
+  // The output may come back before Write returns.
+  lock.unlock();
+  bool written = session_->Write(Batch::StepLine(index, command, windowsDirectory));
+  lock.lock();
+  if (written) {
+    changed_.wait(lock, [this] { return result_.has_value() || ended_; });
+  }
+  output_ = nullptr;
+  if (!result_) {
+    ended_ = true;
+  }
+  return result_;
+}
+
+bool WarmShell::Alive() {
+  std::scoped_lock lock{mutex_};
+  return !ended_;
+}
+
+void WarmShell::consume(std::string_view data) {
+  std::scoped_lock lock{mutex_};
+  if (data.empty()) {
+    demuxer_.Finish();
+    ended_ = true;
+    changed_.notify_all();
+    return;
+  }
+  demuxer_.Feed(data);
+}
+
+std::size_t Pool::Prewarm() {
+  Trace::Span span{"Pool::Prewarm"};
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < options_.warmShells; ++i) {
+    {
+      std::scoped_lock lock{mutex_};
+      if (live_ >= options_.maxShells) {
+        break;
+      }
+      ++live_;
+      ++started_;
+    }
+    auto shell = WarmShell::Start(wsl_);
+    if (!shell) {
+      std::scoped_lock lock{mutex_};
+      --live_;
+      break;
+    }
+    release(std::move(shell));
+    ++count;
+  }
+  return count;
+}
+
+std::optional<Batch::CommandResult> Pool::Run(std::string_view command,
+                                              std::string_view windowsDirectory,
+                                              const Batch::Demuxer::OutputFunction& output) {
+  auto shell = acquire();
+  if (!shell) {
+    return std::nullopt;
+  }
+  auto result = shell->Run(command, windowsDirectory, output);
+  release(std::move(shell));
+  return result;
+}
+
+std::size_t Pool::ShellsStarted() const {
+  std::scoped_lock lock{mutex_};
+  return started_;
+}
+
+std::unique_ptr<WarmShell> Pool::acquire() {
+  // Destroyed once unlocked, as ending a shell may take a while.
+  std::vector<std::unique_ptr<WarmShell>> dead;
+  std::unique_lock lock{mutex_};
+  for (;;) {
+    while (!idle_.empty()) {
+      auto shell = std::move(idle_.back());
+      idle_.pop_back();
+      if (shell->Alive()) {
+        return shell;
+      }
+      --live_;
+      dead.push_back(std::move(shell));
+    }
+    if (live_ < options_.maxShells) {
+      ++live_;
+      ++started_;
+      lock.unlock();
+      auto shell = WarmShell::Start(wsl_);
+      if (!shell) {
+        lock.lock();
+        --live_;
+        released_.notify_one();
+      }
+      return shell;
+    }
+    released_.wait(lock);
+  }
+}
+
+void Pool::release(std::unique_ptr<WarmShell> shell) {
+  const bool alive = shell->Alive();
+  {
+    std::scoped_lock lock{mutex_};
+    if (alive) {
+      idle_.push_back(std::move(shell));
+    } else {
+      --live_;
+    }
+  }
+  released_.notify_one();
+}
+
+void Serve(Pool& pool, const ReadFunction& read, const WriteFunction& write) {
+  Trace::Span span{"Broker::Serve"};
+  std::string command;
+  std::string directory;
+  bool run = false;
+  Provisioning::RecordReader reader{maxRequestSize};
+  std::string buffer(4096, '\0');
+  for (bool wellFormed = true; !run && wellFormed;) {
+    auto count = read(buffer.data(), buffer.size());
+    if (count == 0) {
+      // Gone before asking anything.
+      return;
+    }
+    wellFormed = reader.Feed({buffer.data(), count}, [&](auto tag, auto payload) {
+      if (tag == "command") {
+        command = payload;
+      } else if (tag == "directory") {
+        directory = payload;
+      } else if (tag == "run") {
+        run = true;
+        return false;
+      }
+      return true;
+    });
+  }
+
+  std::string reply;
+  if (!run) {
+    Provisioning::AppendRecord(reply, "error", "ill-formed request");
+    write(reply);
+    return;
+  }
+  span.SetDetail(command);
+
+  // A client gone doesn't stop the command, whose output is then dropped.
+  bool connected = true;
+  auto result = pool.Run(command, directory, [&](std::string_view data) {
+    if (connected) {
+      reply.clear();
+      Provisioning::AppendRecord(reply, "output", data);
+      connected = write(reply);
+    }
+  });
+  reply.clear();
+  if (result) {
+    Provisioning::AppendRecord(reply, "exit", std::to_string(result->exitCode));
+  } else {
+    Provisioning::AppendRecord(reply, "error", "no warm shell could run the command to its end");
+  }
+  write(reply);
+}
+
+Reply Request(const ReadFunction& read, const WriteFunction& write, std::string_view command,
+              std::string_view windowsDirectory, const Batch::Demuxer::OutputFunction& output) {
+  Trace::Span span{"Broker::Request"};
+  Reply reply;
+  std::string request;
+  Provisioning::AppendRecord(request, "directory", windowsDirectory);
+  Provisioning::AppendRecord(request, "command", command);
+  Provisioning::AppendRecord(request, "run", {});
+  if (!write(request)) {
+    reply.error = "could not send the request";
+    return reply;
+  }
+
+  Provisioning::RecordReader reader{maxReplySize};
+  std::string buffer(64 * 1024, '\0');
+  for (bool done = false; !done;) {
+    auto count = read(buffer.data(), buffer.size());
+    if (count == 0) {
+      reply.error = "the broker hung up";
+      break;
+    }
+    bool wellFormed = reader.Feed({buffer.data(), count}, [&](auto tag, auto payload) {
+      if (tag == "output") {
+        output(payload);
+        return true;
+      }
+      if (tag == "exit") {
+        unsigned long exitCode = 0;
+        const char* last = payload.data() + payload.size();
+        auto [ptr, ec] = std::from_chars(payload.data(), last, exitCode);
+        if (ec == std::errc{} && ptr == last) {
+          reply.exitCode = exitCode;
+        } else {
+          reply.error = "ill-formed exit code";
+        }
+        done = true;
+        return false;
+      }
+      if (tag == "error") {
+        reply.error = payload;
+        done = true;
+        return false;
+      }
+      // Newer brokers may tell more.
+      return true;
+    });
+    if (!wellFormed && !done) {
+      reply.error = "ill-formed reply";
+      break;
+    }
+  }
+  return reply;
+}
+}  // namespace Ubuntu::Broker
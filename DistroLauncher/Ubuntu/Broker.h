@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Batch.h"
+#include "OutputPump.h"
+#include "WslBackend.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The warm session broker: a long-lived launcher process keeping shells running in the distro, so
+// that later invocations of `run` neither pay for a launch and a shell start-up nor, the VM being
+// kept busy, for a boot after an idle shutdown. Requests come over a byte stream, a named pipe on
+// Windows, framed as the provisioning records are (see Provisioning.h). It doesn't depend on any
+// Windows API, the distro being reached through a WslBackend and the stream through functions.
+namespace Ubuntu::Broker {
+// A shell reading a batch driver script (see Batch.h) from its stdin, fed a step per command.
+class WarmShell {
+ public:
+  // Starts a shell in the distro. Returns nullptr on failure, already reported.
+  static std::unique_ptr<WarmShell> Start(WslBackend& wsl);
+
+  // Runs [command] in the Windows directory [windowsDirectory], or in the home directory if empty,
+  // handing its output to [output] as it arrives. Returns std::nullopt if the shell died meanwhile.
+  // Commands run one at a time.
+  std::optional<Batch::CommandResult> Run(std::string_view command,
+                                          std::string_view windowsDirectory,
+                                          const Batch::Demuxer::OutputFunction& output);
+
+  // Whether the shell is still running.
+  bool Alive();
+
+ private:
+  explicit WarmShell(std::string marker);
+
+  // Receives the shell's output, from another thread.
+  void consume(std::string_view data);
+
+  std::string marker_;
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  // Where the output of the running command goes.
+  const Batch::Demuxer::OutputFunction* output_ = nullptr;
+  std::optional<Batch::CommandResult> result_;
+  bool ended_ = false;
+  std::size_t commandsRun_ = 0;
+  Batch::Demuxer demuxer_;
+  // Last, so that it is stopped before anything it calls back is destroyed.
+  std::unique_ptr<WslBackend::Session> session_;
+};
+
+struct PoolOptions {
+  // The shells started upfront by Prewarm.
+  std::size_t warmShells = 1;
+  // The shells running at most, thus the commands running at once.
+  std::size_t maxShells = 4;
+};
+
+// Hands out warm shells to the requests, starting more as needed up to a limit and replacing those
+// which died. Can be shared between threads.
+class Pool {
+ public:
+  explicit Pool(WslBackend& wsl, PoolOptions options = {}) : wsl_{wsl}, options_{options} {}
+
+  // Starts the warm shells, returning how many could be.
+  std::size_t Prewarm();
+
+  // Runs [command] in an idle shell, waiting for one if all are busy, as WarmShell::Run does.
+  // Returns std::nullopt if no shell could be started or the one running the command died.
+  std::optional<Batch::CommandResult> Run(std::string_view command,
+                                          std::string_view windowsDirectory,
+                                          const Batch::Demuxer::OutputFunction& output);
+
+  // The shells started so far, including those which died since.
+  std::size_t ShellsStarted() const;
+
+ private:
+  std::unique_ptr<WarmShell> acquire();
+  void release(std::unique_ptr<WarmShell> shell);
+
+  WslBackend& wsl_;
+  PoolOptions options_;
+  mutable std::mutex mutex_;
+  std::condition_variable released_;
+  std::vector<std::unique_ptr<WarmShell>> idle_;
+  // Idle, busy, or being started.
+  std::size_t live_ = 0;
+  std::size_t started_ = 0;
+};
+
+// Writes all of [data] to the stream. Returns false if it is broken.
+using WriteFunction = std::function<bool(std::string_view data)>;
+
+// Serves a single request read with [read], replying with [write]: the command's output as it
+// arrives, then its exit code, or an error.
+void Serve(Pool& pool, const ReadFunction& read, const WriteFunction& write);
+
+// What came back from a request.
+struct Reply {
+  // The exit code of the command, std::nullopt if it couldn't run to its end.
+  std::optional<unsigned long> exitCode;
+  // Why, if it didn't.
+  std::string error;
+};
+
+// Asks the broker at the other end of [read] and [write] to run [command] in [windowsDirectory],
+// handing its output to [output] as it arrives.
+Reply Request(const ReadFunction& read, const WriteFunction& write, std::string_view command,
+              std::string_view windowsDirectory, const Batch::Demuxer::OutputFunction& output);
+}  // namespace Ubuntu::Broker
@@ -0,0 +1,272 @@
+#include <stdafx.h>
+#include "BrokerPipe.h"
+#include "Trace.h"
+
+#include <sddl.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Ubuntu::BrokerPipe {
+namespace {
+// The pipe of this distro in the caller's logon session, as users of another session couldn't
+// reach a broker there anyway.
+std::wstring pipeName() {
+  DWORD sessionId = 0;
+  ProcessIdToSessionId(GetCurrentProcessId(), &sessionId);
+  return L"\\\\.\\pipe\\" + DistributionInfo::Name + L"-broker-" + std::to_wstring(sessionId);
+}
+
+// Waits for the overlapped operation started on [pipe], which returned [started].
+bool complete(HANDLE pipe, OVERLAPPED& overlapped, BOOL started, DWORD& transferred) {
+  if (started == FALSE && GetLastError() != ERROR_IO_PENDING) {
+    return false;
+  }
+  return GetOverlappedResult(pipe, &overlapped, &transferred, TRUE) != FALSE;
+}
+
+// Blocking reads and writes on a pipe opened for overlapped I/O, each through an event of its own.
+class Connection {
+ public:
+  explicit Connection(HANDLE pipe)
+      : pipe_{pipe},
+        readEvent_{CreateEventW(nullptr, TRUE, FALSE, nullptr)},
+        writeEvent_{CreateEventW(nullptr, TRUE, FALSE, nullptr)} {}
+
+  ~Connection() {
+    FlushFileBuffers(pipe_);
+    DisconnectNamedPipe(pipe_);
+    CloseHandle(pipe_);
+    CloseHandle(readEvent_);
+    CloseHandle(writeEvent_);
+  }
+
+  std::size_t Read(char* buffer, std::size_t size) {
+    OVERLAPPED overlapped{};
+    overlapped.hEvent = readEvent_;
+    DWORD readCount = 0;
+    BOOL started = ::ReadFile(pipe_, buffer, static_cast<DWORD>(size), &readCount, &overlapped);
+    if (!complete(pipe_, overlapped, started, readCount)) {
+      return 0;
+    }
+    return readCount;
+  }
+
+  bool Write(std::string_view data) {
+    while (!data.empty()) {
+      OVERLAPPED overlapped{};
+      overlapped.hEvent = writeEvent_;
+      DWORD written = 0;
+      BOOL started =
+          ::WriteFile(pipe_, data.data(), static_cast<DWORD>(data.size()), &written, &overlapped);
+      if (!complete(pipe_, overlapped, started, written)) {
+        return false;
+      }
+      data.remove_prefix(written);
+    }
+    return true;
+  }
+
+ private:
+  HANDLE pipe_;
+  HANDLE readEvent_;
+  HANDLE writeEvent_;
+};
+
+// The TOKEN_USER of [process], empty if it can't be queried.
+std::vector<BYTE> tokenUser(HANDLE process) {
+  HANDLE token = nullptr;
+  if (OpenProcessToken(process, TOKEN_QUERY, &token) == FALSE) {
+    return {};
+  }
+  DWORD size = 0;
+  GetTokenInformation(token, TokenUser, nullptr, 0, &size);
+  std::vector<BYTE> user(size);
+  if (size == 0 || GetTokenInformation(token, TokenUser, user.data(), size, &size) == FALSE) {
+    user.clear();
+  }
+  CloseHandle(token);
+  return user;
+}
+
+// Whether the server end of [pipe] runs as the caller's user. Anyone may create a pipe of the
+// broker's name before it does, so the client checks who it talks to before sending anything.
+bool servedByCaller(HANDLE pipe) {
+  ULONG serverId = 0;
+  if (GetNamedPipeServerProcessId(pipe, &serverId) == FALSE) {
+    return false;
+  }
+  HANDLE server = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, serverId);
+  if (server == nullptr) {
+    return false;
+  }
+  auto serverUser = tokenUser(server);
+  CloseHandle(server);
+  auto callerUser = tokenUser(GetCurrentProcess());
+  if (serverUser.empty() || callerUser.empty()) {
+    return false;
+  }
+  return EqualSid(reinterpret_cast<TOKEN_USER*>(serverUser.data())->User.Sid,
+                  reinterpret_cast<TOKEN_USER*>(callerUser.data())->User.Sid) != FALSE;
+}
+
+// A new instance of the pipe, the first one failing if another broker already created it.
+HANDLE createInstance(const std::wstring& name, bool first) {
+  // Full access for the owner and the system, nothing for anyone else.
+  PSECURITY_DESCRIPTOR descriptor = nullptr;
+  if (ConvertStringSecurityDescriptorToSecurityDescriptorW(
+          L"D:P(A;;GA;;;OW)(A;;GA;;;SY)", SDDL_REVISION_1, &descriptor, nullptr) == FALSE) {
+    return INVALID_HANDLE_VALUE;
+  }
+  SECURITY_ATTRIBUTES sa{sizeof(sa), descriptor, FALSE};
+  DWORD openMode = PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED;
+  if (first) {
+    openMode |= FILE_FLAG_FIRST_PIPE_INSTANCE;
+  }
+  HANDLE pipe = CreateNamedPipeW(name.c_str(), openMode,
+                                 PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_REJECT_REMOTE_CLIENTS,
+                                 PIPE_UNLIMITED_INSTANCES, 64 * 1024, 64 * 1024, 0, &sa);
+  LocalFree(descriptor);
+  return pipe;
+}
+}  // namespace
+
+HRESULT Serve(Broker::Pool& pool, std::chrono::seconds idleTimeout) {
+  Trace::Span span{"BrokerPipe::Serve"};
+  const auto name = pipeName();
+  HANDLE pipe = createInstance(name, true);
+  if (pipe == INVALID_HANDLE_VALUE) {
+    auto error = GetLastError();
+    // A broker holding the pipe denies the others access to it.
+    return HRESULT_FROM_WIN32(error == ERROR_ACCESS_DENIED ? ERROR_ALREADY_EXISTS : error);
+  }
+
+  HANDLE connected = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+  // The requests being served, and when the last one ended.
+  std::mutex mutex;
+  std::condition_variable ended;
+  std::size_t active = 0;
+  auto lastActivity = std::chrono::steady_clock::now();
+  HRESULT hr = S_OK;
+  for (;;) {
+    OVERLAPPED overlapped{};
+    overlapped.hEvent = connected;
+    ResetEvent(connected);
+    bool clientConnected = ConnectNamedPipe(pipe, &overlapped) != FALSE;
+    if (!clientConnected) {
+      auto error = GetLastError();
+      if (error == ERROR_PIPE_CONNECTED) {
+        clientConnected = true;
+      } else if (error != ERROR_IO_PENDING) {
+        hr = HRESULT_FROM_WIN32(error);
+        CloseHandle(pipe);
+        break;
+      }
+    }
+
+    // Checks every so often whether the broker has been idle for long enough.
+    bool idle = false;
+    while (!clientConnected) {
+      if (WaitForSingleObject(connected, 1'000) == WAIT_OBJECT_0) {
+        DWORD unused = 0;
+        clientConnected = GetOverlappedResult(pipe, &overlapped, &unused, FALSE) != FALSE;
+        break;
+      }
+      std::scoped_lock lock{mutex};
+      if (active == 0 && std::chrono::steady_clock::now() - lastActivity >= idleTimeout) {
+        idle = true;
+        break;
+      }
+    }
+    if (idle) {
+      CancelIo(pipe);
+      DWORD unused = 0;
+      GetOverlappedResult(pipe, &overlapped, &unused, TRUE);
+      CloseHandle(pipe);
+      break;
+    }
+    if (!clientConnected) {
+      // A client which left as soon as it connected: the instance waits for the next one.
+      DisconnectNamedPipe(pipe);
+      continue;
+    }
+
+    // The next client is served by a new instance, this one by a thread of its own.
+    {
+      std::scoped_lock lock{mutex};
+      ++active;
+    }
+    std::thread{[&, pipe] {
+      {
+        Connection connection{pipe};
+        Broker::Serve(
+            pool, [&](char* buffer, std::size_t size) { return connection.Read(buffer, size); },
+            [&](std::string_view data) { return connection.Write(data); });
+      }
+      std::scoped_lock lock{mutex};
+      --active;
+      lastActivity = std::chrono::steady_clock::now();
+      ended.notify_all();
+    }}.detach();
+    pipe = createInstance(name, false);
+    if (pipe == INVALID_HANDLE_VALUE) {
+      hr = HRESULT_FROM_WIN32(GetLastError());
+      break;
+    }
+  }
+
+  // The pool must outlive the requests.
+  std::unique_lock lock{mutex};
+  ended.wait(lock, [&] { return active == 0; });
+  CloseHandle(connected);
+  return hr;
+}
+
+std::optional<Broker::Reply> TryRun(std::string_view command, std::string_view windowsDirectory,
+                                    const Batch::Demuxer::OutputFunction& output) {
+  const auto name = pipeName();
+  HANDLE pipe = INVALID_HANDLE_VALUE;
+  // The broker may be between two instances, busy creating the next one.
+  for (int attempt = 0; attempt < 2 && pipe == INVALID_HANDLE_VALUE; ++attempt) {
+    pipe = CreateFileW(name.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING,
+                       SECURITY_SQOS_PRESENT | SECURITY_IDENTIFICATION, nullptr);
+    if (pipe == INVALID_HANDLE_VALUE &&
+        (GetLastError() != ERROR_PIPE_BUSY || WaitNamedPipeW(name.c_str(), 2'000) == FALSE)) {
+      return std::nullopt;
+    }
+  }
+  if (pipe == INVALID_HANDLE_VALUE) {
+    return std::nullopt;
+  }
+  if (!servedByCaller(pipe)) {
+    CloseHandle(pipe);
+    return std::nullopt;
+  }
+
+  Trace::Span span{"BrokerPipe::TryRun"};
+  auto reply = Broker::Request(
+      [pipe](char* buffer, std::size_t size) -> std::size_t {
+        DWORD readCount = 0;
+        if (::ReadFile(pipe, buffer, static_cast<DWORD>(size), &readCount, nullptr) == FALSE) {
+          return 0;
+        }
+        return readCount;
+      },
+      [pipe](std::string_view data) {
+        while (!data.empty()) {
+          DWORD written = 0;
+          if (::WriteFile(pipe, data.data(), static_cast<DWORD>(data.size()), &written, nullptr) ==
+              FALSE) {
+            return false;
+          }
+          data.remove_prefix(written);
+        }
+        return true;
+      },
+      command, windowsDirectory, output);
+  CloseHandle(pipe);
+  return reply;
+}
+}  // namespace Ubuntu::BrokerPipe
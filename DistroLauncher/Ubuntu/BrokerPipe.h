@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Broker.h"
+
+#include <chrono>
+#include <optional>
+#include <string_view>
+
+// The named pipe the session broker (see Broker.h) listens on, one per distro and logon session,
+// only the user running the broker being allowed to connect.
+namespace Ubuntu::BrokerPipe {
+// Serves requests from the pipe, each on its own thread, until none came nor ran for
+// [idleTimeout]. Fails with HRESULT_FROM_WIN32(ERROR_ALREADY_EXISTS) if a broker already listens.
+HRESULT Serve(Broker::Pool& pool, std::chrono::seconds idleTimeout);
+
+// Hands [command] to the broker listening, if any and running as the caller's user, or returns
+// std::nullopt for the caller to run it itself. Once the broker accepted the request, it tells what
+// became of it.
+std::optional<Broker::Reply> TryRun(std::string_view command, std::string_view windowsDirectory,
+                                    const Batch::Demuxer::OutputFunction& output);
+}  // namespace Ubuntu::BrokerPipe
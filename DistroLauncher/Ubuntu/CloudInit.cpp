@@ -0,0 +1,338 @@
+#include "CloudInit.h"
+#include "Json.h"
+#include "Provisioning.h"
+#include "SplitView.h"
+#include "Trace.h"
+#include "Utf8.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+namespace Ubuntu::CloudInit {
+// Runs as root, as the provisioning script. The systemd checks are those the launcher always made
+// before waiting for cloud-init.
+const wchar_t PollScript[] = LR"(
+export LC_ALL=C
+emit() { printf '%s %d\n%s\n' "$1" "${#2}" "$2"; }
+
+if status=$(systemctl is-system-running 2>/dev/null) || [ "${status}" != "offline" ] && systemctl is-enabled --quiet cloud-init.service 2>/dev/null; then
+  out=$(cloud-init status --format json 2>/dev/null)
+  case "${out}" in
+    "{"*) ;;
+    *) out=$(cloud-init status 2>/dev/null) ;;
+  esac
+  emit status "${out}"
+fi
+
+# What the progress log gained since the last poll, 64 KiB at most. The trailing x keeps the command
+# substitution from eating the trailing newlines.
+log=$(tail -c +$((${log_offset:-0} + 1)) /var/log/cloud-init-output.log 2>/dev/null | head -c 65536; echo x)
+emit log "${log%x}"
+
+printf 'end 0\n\n'
+)";
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// The boot stages, in the order they run.
+constexpr const char* stageNames[] = {"init-local", "init", "modules-config", "modules-final"};
+
+std::optional<Status::State> stateFromName(std::string_view name);
+
+std::optional<Status> parseJsonStatus(std::string_view output);
+
+// Plain `cloud-init status` outputs "status: <state>" and possibly more lines.
+std::optional<Status> parseTextStatus(std::string_view output);
+
+WaitResult::Outcome outcomeOf(Status::State state);
+}  // namespace
+
+std::optional<double> StageTiming::Seconds() const {
+  if (!start || !finished) {
+    return std::nullopt;
+  }
+  return *finished - *start;
+}
+
+std::optional<Status> ParseStatus(std::string_view output) {
+  auto first = output.find_first_not_of(" \t\r\n");
+  if (first == std::string_view::npos) {
+    return std::nullopt;
+  }
+  output.remove_prefix(first);
+  if (output.front() == '{') {
+    return parseJsonStatus(output);
+  }
+  return parseTextStatus(output);
+}
+
+LogTail::LogTail(std::size_t maxLines, std::size_t maxLineLength)
+    : maxLineLength_{maxLineLength}, lines_(maxLines) {}
+
+void LogTail::Feed(std::string_view chunk) {
+  bytesSeen_ += chunk.size();
+  while (!chunk.empty()) {
+    auto eol = chunk.find('\n');
+    auto piece = chunk.substr(0, eol);
+    if (eol != std::string_view::npos && !piece.empty() && piece.back() == '\r') {
+      piece.remove_suffix(1);
+    }
+    // Carriage returns redraw a line in place, only the last drawing matters.
+    if (auto cr = piece.rfind('\r'); cr != std::string_view::npos) {
+      partial_.clear();
+      piece.remove_prefix(cr + 1);
+    }
+    if (partial_.size() < maxLineLength_) {
+      partial_ += piece.substr(0, maxLineLength_ - partial_.size());
+    }
+    if (eol == std::string_view::npos) {
+      break;
+    }
+    push(std::move(partial_));
+    partial_.clear();
+    chunk.remove_prefix(eol + 1);
+  }
+}
+
+std::string LogTail::Text() const {
+  std::string text;
+  // The line in progress takes the place of the oldest one.
+  std::size_t skip = !partial_.empty() && count_ == lines_.size() ? 1 : 0;
+  for (std::size_t i = skip; i < count_; ++i) {
+    const auto& line = lines_[(head_ + i) % lines_.size()];
+    text += line;
+    text += '\n';
+  }
+  if (!partial_.empty() && !lines_.empty()) {
+    text += partial_;
+    text += '\n';
+  }
+  return text;
+}
+
+void LogTail::push(std::string line) {
+  if (lines_.empty()) {
+    return;
+  }
+  if (count_ < lines_.size()) {
+    lines_[(head_ + count_) % lines_.size()] = std::move(line);
+    ++count_;
+    return;
+  }
+  lines_[head_] = std::move(line);
+  head_ = (head_ + 1) % lines_.size();
+}
+
+WaitResult Wait(WslBackend& wsl, const WaitOptions& options) {
+  Trace::Span span{"CloudInit::Wait"};
+  WaitResult result;
+  LogTail tail{options.progressLines};
+  bool showingProgress = false;
+  auto start = Clock::now();
+  auto backoff = options.initialBackoff;
+  for (;;) {
+    auto remaining = options.deadline - std::chrono::duration_cast<std::chrono::milliseconds>(
+                                            Clock::now() - start);
+    std::wstring command = L"log_offset=" + std::to_wstring(tail.BytesSeen()) + L"\n";
+    command += PollScript;
+    auto [error, exitCode, output, errors] =
+        wsl.Run(command, std::max(remaining, std::chrono::milliseconds{1}));
+    ++result.polls;
+    const bool expired = Clock::now() - start >= options.deadline;
+    if (!error.empty()) {
+      if (expired) {
+        result.outcome = WaitResult::Outcome::TimedOut;
+        break;
+      }
+      wsl.Print(L"failed to poll cloud-init: ");
+      wsl.Print(error);
+      if (!errors.empty()) {
+        wsl.Print(Utf8ToWide(errors));
+      }
+      result.outcome = WaitResult::Outcome::Unavailable;
+      break;
+    }
+
+    auto records = Provisioning::ParseReply(output);
+    if (!records) {
+      wsl.Print(L"ERROR: unexpected reply when polling cloud-init");
+      result.outcome = WaitResult::Outcome::Unavailable;
+      break;
+    }
+    std::optional<std::string_view> statusOutput;
+    for (const auto& [type, payload] : *records) {
+      if (type == Provisioning::RecordType::Status) {
+        statusOutput = payload;
+      } else if (type == Provisioning::RecordType::Log && !payload.empty()) {
+        // Fed even if not shown, to know where the next poll resumes reading.
+        tail.Feed(payload);
+        if (options.progressLines > 0) {
+          wsl.ShowProgress(Utf8ToWide(tail.Text()));
+          showingProgress = true;
+        }
+      }
+    }
+
+    if (!statusOutput) {
+      result.outcome = WaitResult::Outcome::Disabled;
+      break;
+    }
+    auto status = ParseStatus(*statusOutput);
+    if (!status) {
+      wsl.Print(L"ERROR: unexpected cloud-init status: ");
+      wsl.Print(Utf8ToWide(*statusOutput));
+      result.outcome = WaitResult::Outcome::Unavailable;
+      break;
+    }
+    result.status = std::move(status.value());
+    if (result.status.Finished()) {
+      result.outcome = outcomeOf(result.status.state);
+      break;
+    }
+    if (expired) {
+      result.outcome = WaitResult::Outcome::TimedOut;
+      break;
+    }
+
+    remaining = options.deadline -
+                std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start);
+    std::this_thread::sleep_for(std::min(backoff, remaining));
+    backoff = std::min(backoff + backoff / 2, options.maxBackoff);
+  }
+
+  if (showingProgress) {
+    wsl.ShowProgress({});
+  }
+  result.elapsed = Clock::now() - start;
+  span.SetDetail(FormatStageTimings(result.status));
+  return result;
+}
+
+std::string FormatStageTimings(const Status& status) {
+  std::string text;
+  for (const auto& stage : status.stages) {
+    if (!stage.start) {
+      continue;
+    }
+    text += stage.name;
+    if (auto seconds = stage.Seconds(); seconds) {
+      char formatted[32];
+      std::snprintf(formatted, sizeof(formatted), ": %.1f s\n", *seconds);
+      text += formatted;
+    } else {
+      text += ": running\n";
+    }
+  }
+  return text;
+}
+
+namespace {
+std::optional<Status::State> stateFromName(std::string_view name) {
+  if (name == "running" || name == "degraded running") {
+    return Status::State::Running;
+  }
+  if (name == "done") {
+    return Status::State::Done;
+  }
+  if (name == "degraded done") {
+    return Status::State::Degraded;
+  }
+  if (name == "error" || name == "degraded error") {
+    return Status::State::Error;
+  }
+  if (name == "disabled") {
+    return Status::State::Disabled;
+  }
+  // Older versions say "not run".
+  if (name == "not started" || name == "not run") {
+    return Status::State::NotStarted;
+  }
+  return std::nullopt;
+}
+
+std::optional<Status> parseJsonStatus(std::string_view output) {
+  auto document = Json::Parse(output);
+  if (!document) {
+    return std::nullopt;
+  }
+  // Newer versions tell degraded states apart in extended_status only.
+  const Json::Value* name = document->Find("extended_status");
+  if (name == nullptr || name->AsString() == nullptr) {
+    name = document->Find("status");
+  }
+  if (name == nullptr || name->AsString() == nullptr) {
+    return std::nullopt;
+  }
+  auto state = stateFromName(*name->AsString());
+  if (!state) {
+    return std::nullopt;
+  }
+
+  Status status;
+  status.state = state.value();
+  if (const auto* stage = document->Find("stage"); stage && stage->AsString()) {
+    status.stage = *stage->AsString();
+  }
+  if (const auto* errors = document->Find("errors"); errors && errors->AsArray()) {
+    for (const auto& error : *errors->AsArray()) {
+      if (error.AsString()) {
+        status.errors.push_back(*error.AsString());
+      }
+    }
+  }
+  for (const char* stageName : stageNames) {
+    const auto* stage = document->Find(stageName);
+    if (stage == nullptr || stage->AsObject() == nullptr) {
+      continue;
+    }
+    StageTiming timing{stageName};
+    if (const auto* start = stage->Find("start"); start && start->AsNumber()) {
+      timing.start = *start->AsNumber();
+    }
+    if (const auto* finished = stage->Find("finished"); finished && finished->AsNumber()) {
+      timing.finished = *finished->AsNumber();
+    }
+    status.stages.push_back(std::move(timing));
+  }
+  return status;
+}
+
+std::optional<Status> parseTextStatus(std::string_view output) {
+  static constexpr std::string_view prefix = "status:";
+  for (auto line : SplitView{output, '\n'}) {
+    if (line.substr(0, prefix.size()) != prefix) {
+      continue;
+    }
+    line.remove_prefix(prefix.size());
+    auto first = line.find_first_not_of(' ');
+    auto last = line.find_last_not_of(" \r");
+    if (first == std::string_view::npos) {
+      return std::nullopt;
+    }
+    auto state = stateFromName(line.substr(first, last - first + 1));
+    if (!state) {
+      return std::nullopt;
+    }
+    Status status;
+    status.state = state.value();
+    return status;
+  }
+  return std::nullopt;
+}
+
+WaitResult::Outcome outcomeOf(Status::State state) {
+  switch (state) {
+    case Status::State::Done:
+      return WaitResult::Outcome::Done;
+    case Status::State::Degraded:
+      return WaitResult::Outcome::Degraded;
+    case Status::State::Disabled:
+      return WaitResult::Outcome::Disabled;
+    default:
+      return WaitResult::Outcome::Error;
+  }
+}
+}  // namespace
+}  // namespace Ubuntu::CloudInit
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "WslBackend.h"
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Waiting for cloud-init to finish its first boot, polling `cloud-init status --format json` with a
+// growing delay until it is done or a deadline expires, while showing the tail of its progress log.
+// It doesn't depend on any Windows API, the distro being reached through a WslBackend.
+namespace Ubuntu::CloudInit {
+// The shell script run at each poll. It replies with the provisioning protocol records (see
+// Provisioning.h): a `status` record, only if cloud-init is enabled, then a `log` record with what
+// the progress log gained past the offset in ${log_offset}.
+extern const wchar_t PollScript[];
+
+// When one of the boot stages ran, as cloud-init reports it.
+struct StageTiming {
+  // One of init-local, init, modules-config and modules-final.
+  std::string name;
+  // Seconds since the epoch, std::nullopt if not yet.
+  std::optional<double> start;
+  std::optional<double> finished;
+
+  // Seconds spent in the stage, std::nullopt if it isn't finished.
+  std::optional<double> Seconds() const;
+};
+
+// What cloud-init says about itself.
+struct Status {
+  enum class State {
+    // The boot stages haven't started yet.
+    NotStarted,
+    Running,
+    Done,
+    // Done, with recoverable errors.
+    Degraded,
+    Error,
+    Disabled,
+  };
+
+  State state = State::NotStarted;
+  // The stage running, if any.
+  std::string stage;
+  std::vector<std::string> errors;
+  // In boot order, those cloud-init told about.
+  std::vector<StageTiming> stages;
+
+  // Whether cloud-init won't do anything else this boot.
+  bool Finished() const { return state != State::NotStarted && state != State::Running; }
+};
+
+// Parses the output of `cloud-init status --format json`, or of plain `cloud-init status` as older
+// versions only know the latter. Returns std::nullopt if it is neither.
+std::optional<Status> ParseStatus(std::string_view output);
+
+// Keeps the last lines of a log fed in chunks, as they would show on a terminal.
+class LogTail {
+ public:
+  // Keeps at most [maxLines] lines, each cut to [maxLineLength] bytes.
+  explicit LogTail(std::size_t maxLines, std::size_t maxLineLength = 120);
+
+  // Adds the next [chunk] of the log. Lines may span chunks.
+  void Feed(std::string_view chunk);
+
+  // The lines kept, oldest first, each followed by a newline, the line in progress included.
+  std::string Text() const;
+
+  // The bytes fed so far.
+  std::size_t BytesSeen() const { return bytesSeen_; }
+
+ private:
+  void push(std::string line);
+
+  std::size_t maxLineLength_;
+  // A ring of complete lines, the oldest at head_ once full.
+  std::vector<std::string> lines_;
+  std::size_t head_ = 0;
+  std::size_t count_ = 0;
+  std::string partial_;
+  std::size_t bytesSeen_ = 0;
+};
+
+struct WaitOptions {
+  // How long cloud-init is given overall, after which the launcher stops waiting for it.
+  std::chrono::milliseconds deadline = std::chrono::minutes{10};
+  // The delay between the first two polls, growing by half at each poll up to maxBackoff.
+  std::chrono::milliseconds initialBackoff{250};
+  std::chrono::milliseconds maxBackoff{2000};
+  // The lines of the progress log shown on the console, none to show nothing.
+  std::size_t progressLines = 5;
+};
+
+struct WaitResult {
+  enum class Outcome {
+    Done,
+    Degraded,
+    Error,
+    // cloud-init isn't enabled, thus nothing was waited for.
+    Disabled,
+    // Gave up waiting once the deadline expired.
+    TimedOut,
+    // Polling failed, already reported.
+    Unavailable,
+  };
+
+  Outcome outcome = Outcome::Unavailable;
+  // The last status polled, carrying the timings of each stage.
+  Status status;
+  std::size_t polls = 0;
+  std::chrono::steady_clock::duration elapsed{};
+};
+
+// Polls cloud-init until it finishes or the deadline of [options] expires, showing the tail of
+// /var/log/cloud-init-output.log through WslBackend::ShowProgress meanwhile.
+WaitResult Wait(WslBackend& wsl, const WaitOptions& options = {});
+
+// One line per stage that started, such as "modules-final: 12.3 s" or "init: running".
+std::string FormatStageTimings(const Status& status);
+}  // namespace Ubuntu::CloudInit
@@ -0,0 +1,204 @@
+#include "DefaultUserSources.h"
+#include "Trace.h"
+#include "Utf8.h"
+
+#include <atomic>
+#include <cstdio>
+#include <future>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace Ubuntu {
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// What a source answered and how long it took.
+template <typename T>
+struct Timed {
+  T value;
+  Clock::duration elapsed;
+};
+
+template <typename Source>
+auto timed(const char* name, Source&& source) -> Timed<decltype(source())> {
+  Trace::Span span{name};
+  auto start = Clock::now();
+  auto value = source();
+  return {std::move(value), Clock::now() - start};
+}
+
+// A search for the default user candidate, along with the queries it ran.
+struct SearchOutcome {
+  DefaultUserSearch search;
+  std::vector<NssQueryRecord> records;
+};
+
+bool isCancelled(const std::atomic<bool>* cancelled) {
+  return cancelled != nullptr && cancelled->load(std::memory_order_relaxed);
+}
+
+// Streams the output of [query] into [search], stopping it as soon as the candidate can no longer
+// change or [cancelled] is set. Returns false if the NSS passwd database couldn't be read or the
+// query was cancelled.
+bool runNssQuery(WslBackend& wsl, const NssQuery& query, DefaultUserSearch& search,
+                 const std::atomic<bool>* cancelled);
+
+// Runs the queries of [plan] in order until one can find the default user candidate named [name],
+// or the first regular user if empty. Gives up as soon as [cancelled], if given, is set.
+SearchOutcome searchDefaultUser(WslBackend& wsl, const std::string& name,
+                                const std::vector<NssQuery>& plan,
+                                const std::atomic<bool>* cancelled = nullptr);
+}  // namespace
+
+WslConf ReadWslConf(WslBackend& wsl) {
+  auto contents = wsl.ReadFile("etc/wsl.conf");
+  if (!contents) {
+    return {};
+  }
+  return WslConf::Parse(std::move(contents.value()));
+}
+
+DefaultUserResolution ResolveDefaultUser(WslBackend& wsl) {
+  Trace::Span span{"ResolveDefaultUser"};
+  auto start = Clock::now();
+  // Set once the first regular user is no longer worth looking for.
+  std::atomic<bool> cancelled{false};
+  auto wslConf = std::async(std::launch::async, [&wsl] {
+    return timed("ReadWslConf", [&wsl] { return ReadWslConf(wsl); });
+  });
+  auto registry = std::async(std::launch::async, [&wsl] {
+    return timed("GetConfiguration", [&wsl] { return wsl.GetConfiguration(); });
+  });
+  auto firstRegular = std::async(std::launch::async, [&wsl, &cancelled] {
+    return timed("SearchFirstRegularUser", [&wsl, &cancelled] {
+      auto nsswitch = wsl.ReadFile("etc/nsswitch.conf");
+      return searchDefaultUser(wsl, {}, PlanNssQueries({}, nsswitch ? &nsswitch.value() : nullptr),
+                               &cancelled);
+    });
+  });
+  // However this is left, the futures wait for their tasks, which must then give up quickly.
+  struct CancelOnExit {
+    std::atomic<bool>& cancelled;
+    ~CancelOnExit() { cancelled = true; }
+  } cancelOnExit{cancelled};
+
+  DefaultUserResolution resolution;
+  auto settle = [&resolution, &span, start](DefaultUserSource source, Clock::duration elapsed) {
+    resolution.source = source;
+    resolution.serial += elapsed;
+    resolution.wall = Clock::now() - start;
+    auto saved = std::chrono::duration_cast<std::chrono::microseconds>(resolution.Saved());
+    span.SetDetail("overlap saved " + std::to_string(saved.count()) + " us");
+  };
+
+  // 1. The user named in wsl.conf, whose lookup can only start once the name is known.
+  auto [conf, confElapsed] = wslConf.get();
+  resolution.serial += confElapsed;
+  if (std::string name{conf.DefaultUser()}; !name.empty()) {
+    cancelled = true;
+    auto [named, namedElapsed] = timed("SearchNamedUser", [&wsl, &name] {
+      return searchDefaultUser(wsl, name, PlanNssQueries(name, nullptr));
+    });
+    resolution.search = std::move(named.search);
+    resolution.records = std::move(named.records);
+    resolution.choice = ChooseDefaultUser(resolution.search,
+                                          [] { return static_cast<unsigned long>(-1); });
+    settle(DefaultUserSource::WslConf, namedElapsed);
+    return resolution;
+  }
+
+  // 2. The registry, unless WSL still defaults to root.
+  auto [configuration, registryElapsed] = registry.get();
+  if (!configuration || configuration->defaultUid != 0) {
+    cancelled = true;
+    settle(DefaultUserSource::Registry, registryElapsed);
+    return resolution;
+  }
+  resolution.serial += registryElapsed;
+
+  // 3. The first regular user.
+  auto [found, foundElapsed] = firstRegular.get();
+  resolution.search = std::move(found.search);
+  resolution.records = std::move(found.records);
+  resolution.choice = ChooseDefaultUser(resolution.search, [] { return 0ul; });
+  settle(DefaultUserSource::FirstRegularUser, foundElapsed);
+  return resolution;
+}
+
+std::string FormatResolutionTimes(const DefaultUserResolution& resolution) {
+  const char* source = "";
+  switch (resolution.source) {
+    case DefaultUserSource::WslConf:
+      source = "in wsl.conf";
+      break;
+    case DefaultUserSource::Registry:
+      source = "in the registry";
+      break;
+    case DefaultUserSource::FirstRegularUser:
+      source = "among the regular users";
+      break;
+  }
+  using std::chrono::milliseconds;
+  auto wall = std::chrono::duration_cast<milliseconds>(resolution.wall);
+  auto saved = std::chrono::duration_cast<milliseconds>(resolution.Saved());
+  char text[128];
+  std::snprintf(text, sizeof(text),
+                "Default user found %s in %lld ms, %lld ms less than one source at a time.\n", source,
+                static_cast<long long>(wall.count()), static_cast<long long>(saved.count()));
+  return text;
+}
+
+namespace {
+bool runNssQuery(WslBackend& wsl, const NssQuery& query, DefaultUserSearch& search,
+                 const std::atomic<bool>* cancelled) {
+  ConsumeFunction feed = [&search, cancelled](std::string_view chunk) {
+    return !isCancelled(cancelled) && search.Feed(chunk);
+  };
+  auto [error, exitCode, output, errors] =
+      wsl.Run(Utf8ToWide(query.Command()), std::chrono::seconds{10}, &feed);
+  // Whatever it found is incomplete and nobody waits for it anymore.
+  if (isCancelled(cancelled)) {
+    return false;
+  }
+  // Lookups report the keys not found through the exit code.
+  if (!error.empty() &&
+      !(query.kind != NssQuery::Kind::Enumeration && exitCode == NssQuery::NotFoundExitCode)) {
+    wsl.Print(L"failed to read passwd database: ");
+    wsl.Print(error);
+    if (exitCode != 0) {
+      wsl.Print(std::to_wstring(exitCode));
+    }
+    if (!errors.empty()) {
+      wsl.Print(Utf8ToWide(errors));
+    }
+    return false;
+  }
+
+  search.Finish();
+  return true;
+}
+
+SearchOutcome searchDefaultUser(WslBackend& wsl, const std::string& name,
+                                const std::vector<NssQuery>& plan,
+                                const std::atomic<bool>* cancelled) {
+  SearchOutcome outcome;
+  for (const auto& query : plan) {
+    if (isCancelled(cancelled)) {
+      break;
+    }
+    // The name must be known upfront to stop the query once found.
+    DefaultUserSearch search{name};
+    auto start = Clock::now();
+    bool ok = runNssQuery(wsl, query, search, cancelled);
+    bool conclusive = ok && query.IsConclusive(search);
+    outcome.records.push_back({query.kind, Clock::now() - start, search.UsersSeen(), conclusive});
+    if (conclusive) {
+      outcome.search = std::move(search);
+      break;
+    }
+  }
+  return outcome;
+}
+}  // namespace
+}  // namespace Ubuntu
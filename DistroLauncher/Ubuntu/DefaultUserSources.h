@@ -0,0 +1,63 @@
+#pragma once
+
+#include "NssQuery.h"
+#include "Passwd.h"
+#include "WslBackend.h"
+#include "WslConf.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Working out who the default user should be from each of the places telling about it, while the
+// distro is running. It doesn't depend on any Windows API, the distro being reached through a
+// WslBackend.
+namespace Ubuntu {
+// Reads /etc/wsl.conf straight from the distro's filesystem. Returns an empty configuration if
+// there is no such file or it couldn't be read.
+WslConf ReadWslConf(WslBackend& wsl);
+
+// The sources of the default user, from the highest priority to the lowest.
+enum class DefaultUserSource {
+  // The user named in /etc/wsl.conf.
+  WslConf,
+  // The UID WSL already defaults to, kept in the registry.
+  Registry,
+  // The lowest regular user found in the NSS passwd database.
+  FirstRegularUser,
+};
+
+// What came out of ResolveDefaultUser.
+struct DefaultUserResolution {
+  // The search for the candidate of the deciding source, if it was a search at all.
+  DefaultUserSearch search;
+  DefaultUserChoice choice;
+  DefaultUserSource source = DefaultUserSource::FirstRegularUser;
+  // The NSS queries run by that search.
+  std::vector<NssQueryRecord> records;
+  // The time spent by each source the decision was made from, summed, i.e. about what asking them
+  // one after the other would have cost.
+  std::chrono::steady_clock::duration serial{};
+  // The time it actually took to decide.
+  std::chrono::steady_clock::duration wall{};
+
+  // The wall time the overlap saved.
+  std::chrono::steady_clock::duration Saved() const {
+    return serial > wall ? serial - wall : std::chrono::steady_clock::duration{};
+  }
+};
+
+// Decides the default user as ChooseDefaultUser does, asking all the sources at once instead of one
+// after the other: wsl.conf is read over the 9P share, the current default UID asked to WSL and the
+// first regular user searched for in the NSS passwd database, concurrently. As soon as a source
+// settles the answer, those of lower priority are cancelled, which stops a running getent at its
+// next chunk of output. The time saved is attached to the trace, see also FormatResolutionTimes.
+//
+// [wsl] must bear being called from several threads at once.
+DefaultUserResolution ResolveDefaultUser(WslBackend& wsl);
+
+// A line telling where [resolution] found the default user, how long it took and the wall time the
+// overlap saved, e.g. "Default user found in wsl.conf in 40 ms, 25 ms less than one source at a
+// time.\n".
+std::string FormatResolutionTimes(const DefaultUserResolution& resolution);
+}  // namespace Ubuntu
@@ -0,0 +1,218 @@
+#include "DelimiterScanner.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define UBUNTU_SCAN_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC lets any function use any intrinsic, GCC and Clang need to be told per function.
+#if defined(UBUNTU_SCAN_X86) && !defined(_MSC_VER)
+#define UBUNTU_TARGET(isa) __attribute__((target(isa)))
+#else
+#define UBUNTU_TARGET(isa)
+#endif
+
+namespace Ubuntu {
+namespace {
+// The scalar kernel, also used for the tails of the vectorized ones.
+void scanScalar(const char* data, std::size_t size, std::uint32_t base,
+                std::vector<std::uint32_t>& positions);
+
+#ifdef UBUNTU_SCAN_X86
+bool cpuHasSse2();
+bool cpuHasAvx2();
+void scanSse2(std::string_view buffer, std::vector<std::uint32_t>& positions);
+void scanAvx2(std::string_view buffer, std::vector<std::uint32_t>& positions);
+#endif
+}  // namespace
+
+bool IsSupported(ScanKernel kernel) {
+  switch (kernel) {
+    case ScanKernel::Scalar:
+      return true;
+#ifdef UBUNTU_SCAN_X86
+    case ScanKernel::Sse2:
+      return cpuHasSse2();
+    case ScanKernel::Avx2:
+      return cpuHasAvx2();
+#endif
+    default:
+      return false;
+  }
+}
+
+ScanKernel BestScanKernel() {
+  static const ScanKernel best = [] {
+    for (auto kernel : {ScanKernel::Avx2, ScanKernel::Sse2}) {
+      if (IsSupported(kernel)) {
+        return kernel;
+      }
+    }
+    return ScanKernel::Scalar;
+  }();
+  return best;
+}
+
+void ScanDelimiters(std::string_view buffer, std::vector<std::uint32_t>& positions) {
+  ScanDelimiters(BestScanKernel(), buffer, positions);
+}
+
+void ScanDelimiters(ScanKernel kernel, std::string_view buffer,
+                    std::vector<std::uint32_t>& positions) {
+  switch (kernel) {
+#ifdef UBUNTU_SCAN_X86
+    case ScanKernel::Sse2:
+      scanSse2(buffer, positions);
+      return;
+    case ScanKernel::Avx2:
+      scanAvx2(buffer, positions);
+      return;
+#endif
+    default:
+      scanScalar(buffer.data(), buffer.size(), 0, positions);
+      return;
+  }
+}
+
+namespace {
+bool isDelimiter(char c) {
+  return c == '\n' || c == ':';
+}
+
+void scanScalar(const char* data, std::size_t size, std::uint32_t base,
+                std::vector<std::uint32_t>& positions) {
+  for (std::size_t i = 0; i < size; ++i) {
+    if (isDelimiter(data[i])) {
+      positions.push_back(base + static_cast<std::uint32_t>(i));
+    }
+  }
+}
+
+#ifdef UBUNTU_SCAN_X86
+// Appends positions through a raw pointer, so the vectorized loops don't pay for push_back's
+// capacity check on every delimiter found.
+class PositionWriter {
+ public:
+  explicit PositionWriter(std::vector<std::uint32_t>& positions)
+      : positions_{positions}, size_{positions.size()} {}
+
+  // Drops the unused room.
+  ~PositionWriter() { positions_.resize(size_); }
+
+  PositionWriter(const PositionWriter&) = delete;
+  PositionWriter& operator=(const PositionWriter&) = delete;
+
+  // Appends the positions of the bits set in [mask], offset by [base].
+  void AppendMask(std::uint32_t base, std::uint32_t mask) {
+    if (positions_.size() - size_ < 32) {
+      positions_.resize(std::max<std::size_t>(positions_.size() * 2, size_ + 1024));
+    }
+    std::uint32_t* out = positions_.data() + size_;
+    while (mask != 0) {
+      *out++ = base + countTrailingZeros(mask);
+      mask &= mask - 1;
+    }
+    size_ = out - positions_.data();
+  }
+
+ private:
+  static std::uint32_t countTrailingZeros(std::uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+  }
+
+  std::vector<std::uint32_t>& positions_;
+  std::size_t size_;
+};
+
+bool cpuHasSse2() {
+#if defined(_M_X64) || defined(__x86_64__)
+  // Part of the x64 baseline.
+  return true;
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  return (info[3] & (1 << 26)) != 0;
+#else
+  return __builtin_cpu_supports("sse2");
+#endif
+}
+
+bool cpuHasAvx2() {
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  // The OS must also preserve the YMM registers across context switches.
+  constexpr int osxsave = 1 << 27;
+  constexpr int avx = 1 << 28;
+  __cpuid(info, 1);
+  if ((info[2] & osxsave) == 0 || (info[2] & avx) == 0 || (_xgetbv(0) & 0x6) != 0x6) {
+    return false;
+  }
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  // Checks the OS support as well.
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+UBUNTU_TARGET("sse2")
+void scanSse2(std::string_view buffer, std::vector<std::uint32_t>& positions) {
+  const char* data = buffer.data();
+  const std::size_t size = buffer.size();
+  std::size_t i = 0;
+  {
+    PositionWriter writer{positions};
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i colon = _mm_set1_epi8(':');
+    for (; i + 16 <= size; i += 16) {
+      __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+      __m128i found = _mm_or_si128(_mm_cmpeq_epi8(block, newline), _mm_cmpeq_epi8(block, colon));
+      auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(found));
+      if (mask != 0) {
+        writer.AppendMask(static_cast<std::uint32_t>(i), mask);
+      }
+    }
+  }
+  scanScalar(data + i, size - i, static_cast<std::uint32_t>(i), positions);
+}
+
+UBUNTU_TARGET("avx2")
+void scanAvx2(std::string_view buffer, std::vector<std::uint32_t>& positions) {
+  const char* data = buffer.data();
+  const std::size_t size = buffer.size();
+  std::size_t i = 0;
+  {
+    PositionWriter writer{positions};
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i colon = _mm256_set1_epi8(':');
+    for (; i + 32 <= size; i += 32) {
+      __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+      __m256i found =
+          _mm256_or_si256(_mm256_cmpeq_epi8(block, newline), _mm256_cmpeq_epi8(block, colon));
+      auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(found));
+      if (mask != 0) {
+        writer.AppendMask(static_cast<std::uint32_t>(i), mask);
+      }
+    }
+  }
+  scanScalar(data + i, size - i, static_cast<std::uint32_t>(i), positions);
+}
+#endif
+}  // namespace
+}  // namespace Ubuntu
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Finding the field and record separators of colon-separated databases, such as the output of
+// getent, in a single pass over the buffer. It doesn't depend on any Windows API.
+namespace Ubuntu {
+// The instruction sets the scanner can be run with.
+enum class ScanKernel {
+  Scalar,
+  Sse2,
+  Avx2,
+};
+
+// Whether the running CPU (and OS) can run [kernel].
+bool IsSupported(ScanKernel kernel);
+
+// The fastest kernel supported by the running CPU, detected once.
+ScanKernel BestScanKernel();
+
+// Appends to [positions] the offsets of every '\n' and ':' in [buffer], in increasing order, using
+// the best kernel available. [buffer] must be smaller than 4 GiB.
+void ScanDelimiters(std::string_view buffer, std::vector<std::uint32_t>& positions);
+
+// Same as above with a specific [kernel], which must be supported. Meant for tests and benchmarks.
+void ScanDelimiters(ScanKernel kernel, std::string_view buffer,
+                    std::vector<std::uint32_t>& positions);
+}  // namespace Ubuntu
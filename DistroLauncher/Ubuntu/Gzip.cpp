@@ -0,0 +1,516 @@
+#include "Gzip.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+namespace Ubuntu::Gzip {
+namespace {
+using Byte = unsigned char;
+
+// Thrown internally to bail out of the decoder, converted into a Status at the API boundary.
+struct Failure {
+  Status status;
+};
+
+constexpr std::array<std::uint32_t, 256> makeCrcTable() {
+  std::array<std::uint32_t, 256> table{};
+  for (std::uint32_t n = 0; n < 256; ++n) {
+    std::uint32_t c = n;
+    for (int k = 0; k < 8; ++k) {
+      c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+    }
+    table[n] = c;
+  }
+  return table;
+}
+constexpr auto crcTable = makeCrcTable();
+
+// Reads the deflate bit stream LSB first. Reading past the end of the input yields zero bits, so
+// the Huffman decoder can always peek its maximum code length, but consuming more than a few of
+// those is reported as a truncated stream.
+class BitReader {
+  const Byte* p_;
+  const Byte* end_;
+  std::uint64_t bits_ = 0;
+  unsigned count_ = 0;
+  unsigned padding_ = 0;
+
+ public:
+  BitReader(const Byte* begin, const Byte* end) : p_{begin}, end_{end} {}
+
+  // Ensures at least n <= 56 bits are buffered.
+  void need(unsigned n) {
+    if (count_ >= n) {
+      return;
+    }
+    if (end_ - p_ >= 8) {
+      // Fast path: top the buffer up with as many whole bytes as fit.
+      std::uint64_t word = 0;
+      for (int i = 7; i >= 0; --i) {
+        word = (word << 8) | p_[i];
+      }
+      bits_ |= word << count_;
+      p_ += (63 - count_) / 8;
+      count_ |= 56;
+      return;
+    }
+    while (count_ < n) {
+      std::uint64_t byte = 0;
+      if (p_ != end_) {
+        byte = *p_++;
+      } else if (++padding_ > 8) {
+        throw Failure{Status::Truncated};
+      }
+      bits_ |= byte << count_;
+      count_ += 8;
+    }
+  }
+
+  unsigned peek(unsigned n) {
+    need(n);
+    return static_cast<unsigned>(bits_ & ((std::uint64_t{1} << n) - 1));
+  }
+
+  void drop(unsigned n) {
+    bits_ >>= n;
+    count_ -= n;
+  }
+
+  unsigned take(unsigned n) {
+    if (n == 0) {
+      return 0;
+    }
+    auto value = peek(n);
+    drop(n);
+    return value;
+  }
+
+  void alignToByte() { drop(count_ % 8); }
+
+  // The next unread byte of the input. Only meaningful at a byte boundary.
+  const Byte* position() const {
+    unsigned buffered = count_ / 8;
+    if (padding_ > buffered) {
+      throw Failure{Status::Truncated};
+    }
+    return p_ - (buffered - padding_);
+  }
+
+  // Continues reading from [position], discarding anything buffered.
+  void seek(const Byte* position) {
+    p_ = position;
+    bits_ = 0;
+    count_ = 0;
+    padding_ = 0;
+  }
+
+  const Byte* end() const { return end_; }
+};
+
+// Canonical Huffman decoder backed by a single-level lookup table indexed by the next maxLen bits.
+class Huffman {
+  // (symbol << 4) | code length. A zero length marks an invalid code.
+  std::vector<std::uint32_t> table_;
+  unsigned maxLen_ = 0;
+
+  static unsigned reverse(unsigned code, unsigned length) {
+    unsigned result = 0;
+    for (unsigned i = 0; i < length; ++i) {
+      result = (result << 1) | (code & 1);
+      code >>= 1;
+    }
+    return result;
+  }
+
+ public:
+  void build(const Byte* lengths, unsigned n) {
+    unsigned count[16] = {0};
+    for (unsigned i = 0; i < n; ++i) {
+      ++count[lengths[i]];
+    }
+    count[0] = 0;
+
+    maxLen_ = 0;
+    int left = 1;
+    for (unsigned len = 1; len < 16; ++len) {
+      left = (left << 1) - static_cast<int>(count[len]);
+      if (left < 0) {
+        // Over-subscribed code. Incomplete ones are allowed by RFC 1951.
+        throw Failure{Status::BadData};
+      }
+      if (count[len] != 0) {
+        maxLen_ = len;
+      }
+    }
+
+    unsigned next[16] = {0};
+    unsigned code = 0;
+    for (unsigned len = 1; len < 16; ++len) {
+      code = (code + count[len - 1]) << 1;
+      next[len] = code;
+    }
+
+    table_.assign(std::size_t{1} << maxLen_, 0);
+    for (unsigned symbol = 0; symbol < n; ++symbol) {
+      unsigned len = lengths[symbol];
+      if (len == 0) {
+        continue;
+      }
+      std::uint32_t entry = (symbol << 4) | len;
+      const std::size_t step = std::size_t{1} << len;
+      for (std::size_t i = reverse(next[len]++, len); i < table_.size(); i += step) {
+        table_[i] = entry;
+      }
+    }
+  }
+
+  unsigned decode(BitReader& in) const {
+    auto entry = table_[in.peek(maxLen_)];
+    unsigned len = entry & 15;
+    if (len == 0) {
+      throw Failure{Status::BadData};
+    }
+    in.drop(len);
+    return entry >> 4;
+  }
+};
+
+// The decompressed output of a single member: a sliding window big enough for any back-reference
+// plus room to accumulate a reasonably sized chunk before handing it to the sink.
+class Output {
+  static constexpr std::size_t windowSize = 32 * 1024;
+  static constexpr std::size_t maxMatch = 258;
+
+  std::vector<Byte> buffer_ = std::vector<Byte>(windowSize + 256 * 1024);
+  std::size_t pos_ = 0;
+  std::size_t flushed_ = 0;
+  std::uint64_t total_ = 0;
+  std::uint32_t crc_ = 0;
+  const Sink& sink_;
+  Stats& stats_;
+
+  void flush() {
+    if (pos_ == flushed_) {
+      return;
+    }
+    std::string_view chunk{reinterpret_cast<const char*>(buffer_.data() + flushed_),
+                           pos_ - flushed_};
+    crc_ = Crc32(crc_, chunk);
+    total_ += chunk.size();
+    stats_.uncompressedBytes += chunk.size();
+    flushed_ = pos_;
+    if (sink_ && !sink_(chunk)) {
+      throw Failure{Status::Aborted};
+    }
+  }
+
+  // Guarantees room for at least n more bytes, keeping the last window in the buffer.
+  void reserve(std::size_t n) {
+    if (pos_ + n <= buffer_.size()) {
+      return;
+    }
+    flush();
+    std::memmove(buffer_.data(), buffer_.data() + pos_ - windowSize, windowSize);
+    pos_ = flushed_ = windowSize;
+  }
+
+ public:
+  Output(const Sink& sink, Stats& stats) : sink_{sink}, stats_{stats} {}
+
+  void literal(Byte b) {
+    reserve(1);
+    buffer_[pos_++] = b;
+  }
+
+  void match(unsigned distance, unsigned length) {
+    if (distance > pos_) {
+      throw Failure{Status::BadData};
+    }
+    reserve(maxMatch);
+    Byte* dst = buffer_.data() + pos_;
+    const Byte* src = dst - distance;
+    // Overlapping copies are meant to repeat the pattern, so no memcpy here.
+    for (unsigned i = 0; i < length; ++i) {
+      dst[i] = src[i];
+    }
+    pos_ += length;
+  }
+
+  void stored(const Byte* data, std::size_t length) {
+    while (length > 0) {
+      reserve(1);
+      std::size_t n = std::min(length, buffer_.size() - pos_);
+      std::memcpy(buffer_.data() + pos_, data, n);
+      pos_ += n;
+      data += n;
+      length -= n;
+    }
+  }
+
+  void finish() { flush(); }
+  std::uint64_t total() const { return total_; }
+  std::uint32_t crc() const { return crc_; }
+};
+
+constexpr unsigned short lengthBase[] = {3,  4,  5,  6,  7,  8,  9,   10,  11,  13,
+                                         15, 17, 19, 23, 27, 31, 35,  43,  51,  59,
+                                         67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr Byte lengthExtra[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr unsigned short distanceBase[] = {
+    1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+    193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr Byte distanceExtra[] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                  6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+const Huffman& fixedLiterals() {
+  static const Huffman table = [] {
+    Byte lengths[288];
+    std::fill(lengths, lengths + 144, Byte{8});
+    std::fill(lengths + 144, lengths + 256, Byte{9});
+    std::fill(lengths + 256, lengths + 280, Byte{7});
+    std::fill(lengths + 280, lengths + 288, Byte{8});
+    Huffman h;
+    h.build(lengths, 288);
+    return h;
+  }();
+  return table;
+}
+
+const Huffman& fixedDistances() {
+  static const Huffman table = [] {
+    Byte lengths[30];
+    std::fill(lengths, lengths + 30, Byte{5});
+    Huffman h;
+    h.build(lengths, 30);
+    return h;
+  }();
+  return table;
+}
+
+void readDynamicTables(BitReader& in, Huffman& literals, Huffman& distances) {
+  static constexpr Byte order[19] = {16, 17, 18, 0,  8, 7,  9, 6,  10, 5,
+                                     11, 4,  12, 3, 13, 2, 14, 1, 15};
+  unsigned nlen = in.take(5) + 257;
+  unsigned ndist = in.take(5) + 1;
+  unsigned ncode = in.take(4) + 4;
+  if (nlen > 286 || ndist > 30) {
+    throw Failure{Status::BadData};
+  }
+
+  Byte lengths[286 + 30] = {0};
+  for (unsigned i = 0; i < ncode; ++i) {
+    lengths[order[i]] = static_cast<Byte>(in.take(3));
+  }
+  Huffman codeLengths;
+  codeLengths.build(lengths, 19);
+
+  std::fill(std::begin(lengths), std::end(lengths), Byte{0});
+  for (unsigned i = 0; i < nlen + ndist;) {
+    unsigned symbol = codeLengths.decode(in);
+    if (symbol < 16) {
+      lengths[i++] = static_cast<Byte>(symbol);
+      continue;
+    }
+    Byte value = 0;
+    unsigned repeat = 0;
+    if (symbol == 16) {
+      if (i == 0) {
+        throw Failure{Status::BadData};
+      }
+      value = lengths[i - 1];
+      repeat = 3 + in.take(2);
+    } else if (symbol == 17) {
+      repeat = 3 + in.take(3);
+    } else {
+      repeat = 11 + in.take(7);
+    }
+    if (i + repeat > nlen + ndist) {
+      throw Failure{Status::BadData};
+    }
+    std::fill(lengths + i, lengths + i + repeat, value);
+    i += repeat;
+  }
+
+  // A block without an end-of-block code could never terminate.
+  if (lengths[256] == 0) {
+    throw Failure{Status::BadData};
+  }
+  literals.build(lengths, nlen);
+  distances.build(lengths + nlen, ndist);
+}
+
+void inflateCodes(BitReader& in, Output& out, const Huffman& literals, const Huffman& distances) {
+  for (;;) {
+    unsigned symbol = literals.decode(in);
+    if (symbol < 256) {
+      out.literal(static_cast<Byte>(symbol));
+      continue;
+    }
+    if (symbol == 256) {
+      return;
+    }
+    symbol -= 257;
+    if (symbol >= 29) {
+      throw Failure{Status::BadData};
+    }
+    unsigned length = lengthBase[symbol] + in.take(lengthExtra[symbol]);
+    symbol = distances.decode(in);
+    if (symbol >= 30) {
+      throw Failure{Status::BadData};
+    }
+    unsigned distance = distanceBase[symbol] + in.take(distanceExtra[symbol]);
+    out.match(distance, length);
+  }
+}
+
+// Decodes a raw deflate stream starting at [begin]. Returns the position right after it.
+const Byte* inflateMember(const Byte* begin, const Byte* end, Output& out) {
+  BitReader in{begin, end};
+  Huffman literals;
+  Huffman distances;
+  bool last = false;
+  while (!last) {
+    last = in.take(1) == 1;
+    switch (in.take(2)) {
+      case 0: {
+        in.alignToByte();
+        const Byte* p = in.position();
+        if (end - p < 4) {
+          throw Failure{Status::Truncated};
+        }
+        unsigned length = p[0] | (p[1] << 8);
+        unsigned complement = p[2] | (p[3] << 8);
+        if (length != (~complement & 0xFFFF)) {
+          throw Failure{Status::BadData};
+        }
+        p += 4;
+        if (static_cast<std::size_t>(end - p) < length) {
+          throw Failure{Status::Truncated};
+        }
+        out.stored(p, length);
+        in.seek(p + length);
+        break;
+      }
+      case 1:
+        inflateCodes(in, out, fixedLiterals(), fixedDistances());
+        break;
+      case 2:
+        readDynamicTables(in, literals, distances);
+        inflateCodes(in, out, literals, distances);
+        break;
+      default:
+        throw Failure{Status::BadData};
+    }
+  }
+  in.alignToByte();
+  return in.position();
+}
+
+// Skips the member header starting at [p]. Returns the position of the deflate data.
+const Byte* skipHeader(const Byte* p, const Byte* end) {
+  if (end - p < 10) {
+    throw Failure{Status::Truncated};
+  }
+  if (p[0] != 0x1F || p[1] != 0x8B || p[2] != 8) {
+    throw Failure{Status::BadHeader};
+  }
+  const Byte flags = p[3];
+  p += 10;
+  auto skip = [&p, end](std::size_t n) {
+    if (static_cast<std::size_t>(end - p) < n) {
+      throw Failure{Status::Truncated};
+    }
+    p += n;
+  };
+  auto skipString = [&p, end] {
+    p = std::find(p, end, Byte{0});
+    if (p == end) {
+      throw Failure{Status::Truncated};
+    }
+    ++p;
+  };
+
+  if (flags & 0x04) {  // FEXTRA
+    skip(2);
+    skip(p[-2] | (p[-1] << 8));
+  }
+  if (flags & 0x08) {  // FNAME
+    skipString();
+  }
+  if (flags & 0x10) {  // FCOMMENT
+    skipString();
+  }
+  if (flags & 0x02) {  // FHCRC
+    skip(2);
+  }
+  return p;
+}
+
+std::uint32_t readLE32(const Byte* p) {
+  return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8) |
+         (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+}
+}  // namespace
+
+std::uint32_t Crc32(std::uint32_t crc, std::string_view data) {
+  crc = ~crc;
+  for (unsigned char c : data) {
+    crc = crcTable[(crc ^ c) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+Status Inflate(std::string_view input, const Sink& sink, Stats* stats) {
+  Stats local;
+  Stats& st = stats ? *stats : local;
+  st = {};
+
+  const Byte* begin = reinterpret_cast<const Byte*>(input.data());
+  const Byte* end = begin + input.size();
+  const Byte* p = begin;
+  try {
+    do {
+      Output out{sink, st};
+      p = inflateMember(skipHeader(p, end), end, out);
+      out.finish();
+
+      if (end - p < 8) {
+        throw Failure{Status::Truncated};
+      }
+      if (readLE32(p) != out.crc() || readLE32(p + 4) != (out.total() & 0xFFFFFFFF)) {
+        throw Failure{Status::BadChecksum};
+      }
+      p += 8;
+      st.compressedBytes = p - begin;
+      ++st.members;
+      // Some tools pad the stream with zeros. Anything else must be another member.
+    } while (!std::all_of(p, end, [](Byte b) { return b == 0; }));
+  } catch (const Failure& failure) {
+    return failure.status;
+  }
+
+  st.compressedBytes = input.size();
+  return Status::Ok;
+}
+
+const wchar_t* Describe(Status status) {
+  switch (status) {
+    case Status::Ok:
+      return L"ok";
+    case Status::Truncated:
+      return L"unexpected end of file";
+    case Status::BadHeader:
+      return L"not a gzip file";
+    case Status::BadData:
+      return L"invalid compressed data";
+    case Status::BadChecksum:
+      return L"checksum mismatch";
+    case Status::Aborted:
+      return L"aborted";
+  }
+  return L"unknown error";
+}
+}  // namespace Ubuntu::Gzip
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+// A dependency-free gzip (RFC 1952) decoder, enough to walk and validate the install image without
+// relying on WSL. It doesn't depend on any Windows API.
+namespace Ubuntu::Gzip {
+enum class Status {
+  Ok,
+  // The input ended before the last member was complete.
+  Truncated,
+  // Not a gzip stream or unsupported compression method.
+  BadHeader,
+  // Invalid deflate data.
+  BadData,
+  // The CRC32 or size recorded in a member trailer doesn't match its contents.
+  BadChecksum,
+  // The sink asked to stop.
+  Aborted,
+};
+
+struct Stats {
+  std::uint64_t compressedBytes = 0;
+  std::uint64_t uncompressedBytes = 0;
+  std::uint32_t members = 0;
+};
+
+// Receives the decompressed data in order, in chunks of unspecified sizes.
+// Returning false stops the decompression, which then reports Status::Aborted.
+using Sink = std::function<bool(std::string_view chunk)>;
+
+// Decompresses all members of the gzip stream in [input], checking each member trailer.
+// [stats] is optional and is filled even if decompression fails.
+Status Inflate(std::string_view input, const Sink& sink, Stats* stats = nullptr);
+
+// Human readable description of a status.
+const wchar_t* Describe(Status status);
+
+// Updates a running CRC32 (as used by gzip) with [data]. Start with crc = 0.
+std::uint32_t Crc32(std::uint32_t crc, std::string_view data);
+}  // namespace Ubuntu::Gzip
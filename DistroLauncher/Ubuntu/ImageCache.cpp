@@ -0,0 +1,291 @@
+#include "ImageCache.h"
+#include "Gzip.h"
+#include "SplitView.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <system_error>
+
+namespace Ubuntu::ImageCache {
+namespace fs = std::filesystem;
+
+namespace {
+// Bounds the memory held by the chunks waiting to be written.
+constexpr std::size_t maxQueued = 16 * 1024 * 1024;
+
+// Parses the [base] number in [text], all of it.
+template <typename T>
+std::optional<T> parseNumber(std::string_view text, int base = 10) {
+  T value{};
+  const char* end = text.data() + text.size();
+  auto [ptr, ec] = std::from_chars(text.data(), end, value, base);
+  if (text.empty() || ec != std::errc{} || ptr != end) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+// The CRC32 of the [index]th block of the copy at [path].
+std::optional<std::uint32_t> blockCrc(const fs::path& path, std::uint64_t index, std::uint64_t size,
+                                      const std::atomic<bool>& cancelled);
+}  // namespace
+
+std::string Manifest::Format() const {
+  std::string contents = "source " + source + "\nsize " + std::to_string(size) + "\n";
+  for (auto crc : blocks) {
+    char line[32];
+    std::snprintf(line, sizeof(line), "block %08x\n", static_cast<unsigned>(crc));
+    contents += line;
+  }
+  if (gzipRegistrationMs) {
+    contents += "gzip-registration-ms " + std::to_string(*gzipRegistrationMs) + "\n";
+  }
+  if (defaultUid) {
+    contents += "default-uid " + std::to_string(*defaultUid) + "\n";
+  }
+  if (flags) {
+    contents += "flags " + std::to_string(*flags) + "\n";
+  }
+  return contents;
+}
+
+std::optional<Manifest> Manifest::Parse(std::string_view contents) {
+  Manifest manifest;
+  bool sized = false;
+  for (auto line : SplitView{contents, '\n'}) {
+    if (line.empty()) {
+      continue;
+    }
+    auto space = line.find(' ');
+    if (space == std::string_view::npos) {
+      return std::nullopt;
+    }
+    auto key = line.substr(0, space);
+    auto value = line.substr(space + 1);
+    if (key == "source") {
+      manifest.source = value;
+    } else if (key == "size") {
+      auto size = parseNumber<std::uint64_t>(value);
+      if (!size) {
+        return std::nullopt;
+      }
+      manifest.size = *size;
+      sized = true;
+    } else if (key == "block") {
+      auto crc = parseNumber<std::uint32_t>(value, 16);
+      if (!crc) {
+        return std::nullopt;
+      }
+      manifest.blocks.push_back(*crc);
+    } else if (key == "gzip-registration-ms") {
+      manifest.gzipRegistrationMs = parseNumber<std::uint64_t>(value);
+    } else if (key == "default-uid") {
+      manifest.defaultUid = parseNumber<unsigned long>(value);
+    } else if (key == "flags") {
+      manifest.flags = parseNumber<unsigned long>(value);
+    }
+    // Newer launchers may tell more.
+  }
+  if (manifest.source.empty() || !sized ||
+      manifest.blocks.size() != (manifest.size + BlockSize - 1) / BlockSize) {
+    return std::nullopt;
+  }
+  return manifest;
+}
+
+fs::path ImagePath(const fs::path& directory) { return directory / "install.tar"; }
+
+fs::path ManifestPath(const fs::path& directory) { return directory / "install.tar.manifest"; }
+
+std::optional<Manifest> Load(const fs::path& directory) {
+  std::ifstream file{ManifestPath(directory), std::ios::binary};
+  if (!file) {
+    return std::nullopt;
+  }
+  std::string contents{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+  return Manifest::Parse(contents);
+}
+
+bool Save(const fs::path& directory, const Manifest& manifest) {
+  auto temporary = ManifestPath(directory);
+  temporary += ".new";
+  {
+    std::ofstream file{temporary, std::ios::binary | std::ios::trunc};
+    file << manifest.Format();
+    if (!file.flush()) {
+      return false;
+    }
+  }
+  std::error_code error;
+  fs::rename(temporary, ManifestPath(directory), error);
+  return !error;
+}
+
+bool Validate(const fs::path& directory, const Manifest& manifest,
+              const std::atomic<bool>& cancelled, unsigned threads) {
+  Trace::Span span{"ImageCache::Validate"};
+  const auto path = ImagePath(directory);
+  std::error_code error;
+  if (fs::file_size(path, error) != manifest.size || error) {
+    return false;
+  }
+
+  if (threads == 0) {
+    threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  std::atomic<std::size_t> next{0};
+  std::atomic<bool> valid{true};
+  auto check = [&] {
+    for (auto index = next++; index < manifest.blocks.size() && valid; index = next++) {
+      auto crc = blockCrc(path, index, manifest.size, cancelled);
+      if (!crc || *crc != manifest.blocks[index]) {
+        valid = false;
+      }
+    }
+  };
+  std::vector<std::thread> workers;
+  const auto count = std::min<std::size_t>(threads, manifest.blocks.size());
+  for (std::size_t i = 1; i < count; ++i) {
+    workers.emplace_back(check);
+  }
+  check();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  return valid && !cancelled;
+}
+
+Writer::Writer(fs::path directory) : directory_{std::move(directory)} {
+  std::error_code error;
+  fs::create_directories(directory_, error);
+  auto partial = ImagePath(directory_);
+  partial += ".partial";
+  file_.open(partial, std::ios::binary | std::ios::trunc);
+  failed_ = !file_;
+  thread_ = std::thread{&Writer::write, this};
+}
+
+Writer::~Writer() {
+  stop();
+  if (!committed_) {
+    file_.close();
+    auto partial = ImagePath(directory_);
+    partial += ".partial";
+    std::error_code error;
+    fs::remove(partial, error);
+  }
+}
+
+bool Writer::Append(std::string_view chunk) {
+  std::unique_lock lock{mutex_};
+  changed_.wait(lock, [this] { return queued_ < maxQueued || failed_; });
+  if (failed_) {
+    return false;
+  }
+  queue_.emplace_back(chunk);
+  queued_ += chunk.size();
+  changed_.notify_all();
+  return true;
+}
+
+bool Writer::Commit(std::string source) {
+  Trace::Span span{"ImageCache::Commit"};
+  stop();
+  if (failed_ || !file_.flush()) {
+    return false;
+  }
+  file_.close();
+  if (blockFill_ > 0) {
+    manifest_.blocks.push_back(crc_);
+  }
+  manifest_.source = std::move(source);
+
+  // A manifest left behind must never describe another copy than its own.
+  auto partial = ImagePath(directory_);
+  partial += ".partial";
+  std::error_code error;
+  fs::remove(ManifestPath(directory_), error);
+  fs::rename(partial, ImagePath(directory_), error);
+  if (error || !Save(directory_, manifest_)) {
+    return false;
+  }
+  committed_ = true;
+  return true;
+}
+
+void Writer::write() {
+  std::vector<std::string> chunks;
+  for (;;) {
+    {
+      std::unique_lock lock{mutex_};
+      changed_.wait(lock, [this] { return !queue_.empty() || stopping_; });
+      if (queue_.empty()) {
+        return;
+      }
+      chunks.swap(queue_);
+    }
+
+    bool written = true;
+    for (std::string_view chunk : chunks) {
+      written = written && !failed_ && file_.write(chunk.data(), chunk.size());
+      manifest_.size += chunk.size();
+      // The checksums follow the block boundaries, whatever the chunk sizes.
+      while (!chunk.empty()) {
+        auto room = static_cast<std::size_t>(BlockSize - blockFill_);
+        auto part = chunk.substr(0, room);
+        crc_ = Gzip::Crc32(crc_, part);
+        blockFill_ += part.size();
+        chunk.remove_prefix(part.size());
+        if (blockFill_ == BlockSize) {
+          manifest_.blocks.push_back(crc_);
+          crc_ = 0;
+          blockFill_ = 0;
+        }
+      }
+    }
+
+    std::scoped_lock lock{mutex_};
+    for (const auto& chunk : chunks) {
+      queued_ -= chunk.size();
+    }
+    chunks.clear();
+    failed_ = failed_ || !written;
+    changed_.notify_all();
+  }
+}
+
+void Writer::stop() {
+  {
+    std::scoped_lock lock{mutex_};
+    stopping_ = true;
+    changed_.notify_all();
+  }
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+namespace {
+std::optional<std::uint32_t> blockCrc(const fs::path& path, std::uint64_t index, std::uint64_t size,
+                                      const std::atomic<bool>& cancelled) {
+  std::ifstream file{path, std::ios::binary};
+  if (!file.seekg(static_cast<std::streamoff>(index * BlockSize))) {
+    return std::nullopt;
+  }
+  auto remaining = std::min(BlockSize, size - index * BlockSize);
+  std::string buffer(1024 * 1024, '\0');
+  std::uint32_t crc = 0;
+  while (remaining > 0 && !cancelled) {
+    auto count = static_cast<std::size_t>(std::min<std::uint64_t>(buffer.size(), remaining));
+    if (!file.read(buffer.data(), static_cast<std::streamsize>(count))) {
+      return std::nullopt;
+    }
+    crc = Gzip::Crc32(crc, {buffer.data(), count});
+    remaining -= count;
+  }
+  return crc;
+}
+}  // namespace
+}  // namespace Ubuntu::ImageCache
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// A copy of the install image kept decompressed in a directory of the user's, for WSL to register
+// the distro from without inflating the gzip stream again, which is most of what a registration
+// costs. The copy is written while ImageVerifier inflates the image anyway, and checked against
+// the CRC32 of each of its blocks before use, the blocks being checked in parallel. It doesn't
+// depend on any Windows API.
+namespace Ubuntu::ImageCache {
+// The size of the blocks checksummed on their own.
+constexpr std::uint64_t BlockSize = 64 * 1024 * 1024;
+
+// What is known of the cached copy, stored next to it.
+struct Manifest {
+  // The SHA-256 digest of the compressed image it was inflated from, in lowercase hex.
+  std::string source;
+  // The size of the decompressed image.
+  std::uint64_t size = 0;
+  // The CRC32 of each block of the decompressed image.
+  std::vector<std::uint32_t> blocks;
+  // How long registering from the compressed image took, once measured.
+  std::optional<std::uint64_t> gzipRegistrationMs;
+  // For snapshots of a provisioned distro, its default user.
+  std::optional<unsigned long> defaultUid;
+  // And its WSL_DISTRIBUTION_FLAGS.
+  std::optional<unsigned long> flags;
+
+  std::string Format() const;
+  // Returns std::nullopt if [contents] is ill-formed, or doesn't account for [size] bytes.
+  static std::optional<Manifest> Parse(std::string_view contents);
+};
+
+// Where the decompressed image and its manifest are in [directory].
+std::filesystem::path ImagePath(const std::filesystem::path& directory);
+std::filesystem::path ManifestPath(const std::filesystem::path& directory);
+
+// The manifest of the copy in [directory], if any.
+std::optional<Manifest> Load(const std::filesystem::path& directory);
+
+// Stores [manifest] in [directory], replacing the previous one at once.
+bool Save(const std::filesystem::path& directory, const Manifest& manifest);
+
+// Whether the copy in [directory] matches [manifest], reading its blocks with up to [threads]
+// threads. Gives up early once [cancelled].
+bool Validate(const std::filesystem::path& directory, const Manifest& manifest,
+              const std::atomic<bool>& cancelled, unsigned threads = 0);
+
+// Writes a new copy into [directory] from a thread of its own, as the decompressed image is handed
+// to Append, replacing the previous copy on Commit only. Abandoned if destroyed before.
+class Writer {
+ public:
+  explicit Writer(std::filesystem::path directory);
+  ~Writer();
+
+  Writer(const Writer&) = delete;
+  Writer& operator=(const Writer&) = delete;
+
+  // Queues the next [chunk], waiting while too much is queued already. Returns false once writing
+  // failed, e.g. for lack of disk space.
+  bool Append(std::string_view chunk);
+
+  // Completes the copy, inflated from the image whose SHA-256 digest is [source]. Returns false if
+  // it couldn't be written.
+  bool Commit(std::string source);
+
+ private:
+  // Writes what is queued until told to stop.
+  void write();
+  // Waits for what is queued to be written, and the thread to exit.
+  void stop();
+
+  std::filesystem::path directory_;
+  std::ofstream file_;
+  Manifest manifest_;
+  std::uint32_t crc_ = 0;
+  std::uint64_t blockFill_ = 0;
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  std::vector<std::string> queue_;
+  std::size_t queued_ = 0;
+  bool stopping_ = false;
+  bool failed_ = false;
+  bool committed_ = false;
+  // Last, so that it is started once everything else is ready.
+  std::thread thread_;
+};
+}  // namespace Ubuntu::ImageCache
@@ -0,0 +1,367 @@
+#include <stdafx.h>
+#include "ImageVerifier.h"
+#include "Gzip.h"
+#include "ImageCache.h"
+
+#include <bcrypt.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <system_error>
+
+namespace Ubuntu {
+
+namespace fs = std::filesystem;
+
+namespace {
+// A read-only view of a whole file mapped into memory.
+class MappedFile {
+  HANDLE file_ = INVALID_HANDLE_VALUE;
+  HANDLE mapping_ = nullptr;
+  const char* view_ = nullptr;
+  std::uint64_t size_ = 0;
+
+ public:
+  explicit MappedFile(const fs::path& path) {
+    file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                        FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+      throw std::system_error{static_cast<int>(GetLastError()), std::system_category(),
+                              "couldn't open " + path.string()};
+    }
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file_, &size) == FALSE) {
+      throw std::system_error{static_cast<int>(GetLastError()), std::system_category(),
+                              "couldn't query the size of " + path.string()};
+    }
+    size_ = static_cast<std::uint64_t>(size.QuadPart);
+    if (size_ == 0) {
+      // Empty files cannot be mapped, but there is nothing to read either.
+      return;
+    }
+    mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ == nullptr) {
+      throw std::system_error{static_cast<int>(GetLastError()), std::system_category(),
+                              "couldn't map " + path.string()};
+    }
+    view_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (view_ == nullptr) {
+      throw std::system_error{static_cast<int>(GetLastError()), std::system_category(),
+                              "couldn't map a view of " + path.string()};
+    }
+  }
+
+  ~MappedFile() {
+    if (view_) {
+      UnmapViewOfFile(view_);
+    }
+    if (mapping_) {
+      CloseHandle(mapping_);
+    }
+    if (file_ != INVALID_HANDLE_VALUE) {
+      CloseHandle(file_);
+    }
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  std::string_view contents() const { return {view_, static_cast<std::size_t>(size_)}; }
+};
+
+// Computes the SHA-256 digest of [data] as a lowercase hex string, or the empty string if
+// cancelled.
+std::string sha256Hex(std::string_view data, const std::atomic<bool>& cancelled) {
+  BCRYPT_ALG_HANDLE algorithm = nullptr;
+  if (!NT_SUCCESS(BCryptOpenAlgorithmProvider(&algorithm, BCRYPT_SHA256_ALGORITHM, nullptr, 0))) {
+    throw std::runtime_error{"couldn't open the SHA-256 algorithm provider"};
+  }
+  BCRYPT_HASH_HANDLE hash = nullptr;
+  if (!NT_SUCCESS(BCryptCreateHash(algorithm, &hash, nullptr, 0, nullptr, 0, 0))) {
+    BCryptCloseAlgorithmProvider(algorithm, 0);
+    throw std::runtime_error{"couldn't create a SHA-256 hash object"};
+  }
+
+  // Hashing in chunks keeps the cancellation responsive.
+  static constexpr std::size_t chunkSize = 4 * 1024 * 1024;
+  bool ok = true;
+  while (ok && !data.empty() && !cancelled) {
+    auto chunk = data.substr(0, chunkSize);
+    ok = NT_SUCCESS(BCryptHashData(hash, reinterpret_cast<PUCHAR>(const_cast<char*>(chunk.data())),
+                                   static_cast<ULONG>(chunk.size()), 0));
+    data.remove_prefix(chunk.size());
+  }
+
+  UCHAR digest[32];
+  ok = ok && NT_SUCCESS(BCryptFinishHash(hash, digest, sizeof(digest), 0));
+  BCryptDestroyHash(hash);
+  BCryptCloseAlgorithmProvider(algorithm, 0);
+  if (!ok) {
+    throw std::runtime_error{"failed to compute the SHA-256 digest"};
+  }
+  if (cancelled) {
+    return {};
+  }
+
+  static constexpr char hex[] = "0123456789abcdef";
+  std::string result;
+  result.reserve(2 * sizeof(digest));
+  for (auto byte : digest) {
+    result.push_back(hex[byte >> 4]);
+    result.push_back(hex[byte & 0xF]);
+  }
+  return result;
+}
+
+// Converts an exception message into a wide string.
+std::wstring describe(const std::exception& err) {
+  const char* what = err.what();
+  int length = static_cast<int>(std::strlen(what));
+  std::wstring result(MultiByteToWideChar(CP_THREAD_ACP, 0, what, length, nullptr, 0), L'\0');
+  MultiByteToWideChar(CP_THREAD_ACP, 0, what, length, result.data(),
+                      static_cast<int>(result.size()));
+  return result;
+}
+
+// Whether the launcher needs the contents of [entry] to plan the first boot.
+bool isWorthCapturing(const Tar::Entry& entry) {
+  return entry.name == "etc/wsl.conf" || entry.name == "etc/passwd" ||
+         entry.name == "etc/nsswitch.conf" || Tar::IsUnder(entry.name, "etc/cloud");
+}
+
+// Reads the expected digest from the sha256sum-formatted manifest next to the image, if any.
+std::optional<std::string> expectedDigest(const fs::path& image) {
+  auto manifest = image;
+  manifest += ".sha256";
+  std::ifstream file{manifest};
+  std::string digest;
+  if (!(file >> digest)) {
+    return std::nullopt;
+  }
+  std::transform(digest.begin(), digest.end(), digest.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return digest;
+}
+
+// Checks the copy in [cacheDirectory] of the image mapped at [contents], whose digest is [expected]
+// if known, and indexes it. Returns std::nullopt if there is no such copy or it doesn't check out.
+std::optional<ImageVerifier::Result> verifyCache(const fs::path& cacheDirectory,
+                                                 std::string_view contents,
+                                                 const std::optional<std::string>& expected,
+                                                 const std::atomic<bool>& cancelled) {
+  auto manifest = ImageCache::Load(cacheDirectory);
+  if (!manifest || (expected && *expected != manifest->source)) {
+    return std::nullopt;
+  }
+
+  // The digest of the image, the blocks of the copy and the index are computed at once.
+  auto start = std::chrono::steady_clock::now();
+  std::future<std::string> digest;
+  if (!expected) {
+    digest = std::async(std::launch::async, sha256Hex, contents, std::cref(cancelled));
+  }
+  auto valid = std::async(std::launch::async, ImageCache::Validate, std::cref(cacheDirectory),
+                          std::cref(*manifest), std::cref(cancelled), 0u);
+  MappedFile copy{ImageCache::ImagePath(cacheDirectory)};
+  Tar::Indexer indexer{isWorthCapturing};
+  bool indexing = true;
+  static constexpr std::size_t chunkSize = 4 * 1024 * 1024;
+  for (auto rest = copy.contents(); indexing && !rest.empty() && !cancelled;) {
+    indexing = indexer.Feed(rest.substr(0, chunkSize));
+    rest.remove_prefix(rest.size() < chunkSize ? rest.size() : chunkSize);
+  }
+  const bool blocksMatch = valid.get();
+  const bool sourceMatches = !digest.valid() || digest.get() == manifest->source;
+  if (cancelled || !blocksMatch || !sourceMatches) {
+    return std::nullopt;
+  }
+
+  ImageVerifier::Result result;
+  result.verified = true;
+  result.hashChecked = expected.has_value();
+  result.bytes = manifest->size;
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  if (indexing && indexer.Finished()) {
+    result.index = std::make_shared<const Tar::Index>(indexer.Take());
+  }
+  result.cachedImage = ImageCache::ImagePath(cacheDirectory);
+  result.gzipRegistrationMs = manifest->gzipRegistrationMs;
+  return result;
+}
+
+// Writes the decompressed image mapped at [contents] into [cacheDirectory], keyed by its digest,
+// [expected] if known, and keeps it if [sound] tells so once written. Returns whether it was kept.
+bool buildCache(const fs::path& cacheDirectory, std::string_view contents,
+                const std::optional<std::string>& expected, const std::atomic<bool>& cancelled,
+                const std::function<bool()>& sound) {
+  std::future<std::string> digest;
+  if (!expected) {
+    digest = std::async(std::launch::async, sha256Hex, contents, std::cref(cancelled));
+  }
+  ImageCache::Writer writer{cacheDirectory};
+  bool written = true;
+  auto status = Gzip::Inflate(contents, [&cancelled, &writer, &written](std::string_view chunk) {
+    written = writer.Append(chunk);
+    return written && !cancelled;
+  });
+  auto source = expected ? *expected : digest.get();
+  return status == Gzip::Status::Ok && written && !cancelled && sound() && writer.Commit(source);
+}
+
+// Only reads the image, as it starts before the launcher knows whether it installs anything.
+ImageVerifier::Result verify(const fs::path& image, const std::atomic<bool>& cancelled) try {
+  ImageVerifier::Result result;
+  std::error_code ec;
+  if (!fs::exists(image, ec)) {
+    // Not our business: WslRegisterDistribution will fail with a meaningful error.
+    return result;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  MappedFile mapped{image};
+  auto contents = mapped.contents();
+
+  auto expected = expectedDigest(image);
+  std::future<std::string> digest;
+  if (expected) {
+    digest = std::async(std::launch::async, sha256Hex, contents, std::cref(cancelled));
+  }
+
+  // A tar stream that doesn't parse is not worth failing the installation for: WSL is the judge.
+  Tar::Indexer indexer{isWorthCapturing};
+  bool indexing = true;
+  Gzip::Stats stats;
+  auto status = Gzip::Inflate(
+      contents,
+      [&cancelled, &indexer, &indexing](std::string_view chunk) {
+        indexing = indexing && indexer.Feed(chunk);
+        return !cancelled;
+      },
+      &stats);
+  std::string actual = digest.valid() ? digest.get() : std::string{};
+
+  if (cancelled) {
+    result.hr = E_ABORT;
+    result.error = L"verification cancelled";
+    return result;
+  }
+
+  result.verified = true;
+  result.hashChecked = expected.has_value();
+  result.bytes = contents.size();
+  result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  if (expected && actual != *expected) {
+    result.hr = HRESULT_FROM_WIN32(ERROR_FILE_CORRUPT);
+    result.error = L"SHA-256 digest doesn't match the manifest";
+  } else if (status != Gzip::Status::Ok) {
+    result.hr = HRESULT_FROM_WIN32(ERROR_FILE_CORRUPT);
+    result.error = Gzip::Describe(status);
+  } else if (indexing && indexer.Finished()) {
+    result.index = std::make_shared<const Tar::Index>(indexer.Take());
+  }
+  return result;
+} catch (const std::system_error& err) {
+  ImageVerifier::Result result;
+  result.hr = HRESULT_FROM_WIN32(err.code().value());
+  result.error = describe(err);
+  return result;
+} catch (const std::exception& err) {
+  ImageVerifier::Result result;
+  result.hr = E_FAIL;
+  result.error = describe(err);
+  return result;
+}
+
+// Completes the [inspection] of [image] with the copy in [cacheDirectory], checked or made now that
+// an install is going to happen, alongside the inspection still running. A copy which checks out
+// makes the inflation of the image needless, so it is cancelled. Failing to cache the image, e.g.
+// for lack of space, is no reason to fail the install.
+ImageVerifier::Result useCache(const fs::path& image, const fs::path& cacheDirectory,
+                               std::future<ImageVerifier::Result>& inspection,
+                               std::atomic<bool>& cancelled) {
+  std::optional<MappedFile> mapped;
+  std::optional<std::string> expected;
+  try {
+    mapped.emplace(image);
+    expected = expectedDigest(image);
+    if (auto cached = verifyCache(cacheDirectory, mapped->contents(), expected, cancelled)) {
+      cancelled = true;
+      inspection.wait();
+      return *cached;
+    }
+  } catch (const std::exception&) {
+    return inspection.get();
+  }
+
+  // The copy is inflated again while the inspection completes, and only kept if it found no fault.
+  std::atomic<bool> stopped{false};
+  std::promise<bool> sound;
+  auto built = std::async(std::launch::async, [&, verdict = sound.get_future()]() mutable {
+    try {
+      return buildCache(cacheDirectory, mapped->contents(), expected, stopped,
+                        [&verdict] { return verdict.get(); });
+    } catch (const std::exception&) {
+      return false;
+    }
+  });
+  auto result = inspection.get();
+  stopped = !result.verified || FAILED(result.hr);
+  sound.set_value(!stopped);
+  result.cacheBuilt = built.get();
+  return result;
+}
+}  // namespace
+
+fs::path InstallImagePath() {
+  // The image is deployed at the package root, next to the launcher executable.
+  wchar_t executable[MAX_PATH] = {L'\0'};
+  if (GetModuleFileNameW(nullptr, executable, MAX_PATH) == 0) {
+    return L"install.tar.gz";
+  }
+  return fs::path{executable}.parent_path() / L"install.tar.gz";
+}
+
+fs::path ImageCacheDirectory() {
+  wchar_t setting[8] = {L'\0'};
+  if (GetEnvironmentVariableW(L"UBUNTU_LAUNCHER_IMAGE_CACHE", setting, 8) != 0 &&
+      std::wstring_view{setting} == L"0") {
+    return {};
+  }
+  wchar_t localAppData[MAX_PATH] = {L'\0'};
+  auto length = GetEnvironmentVariableW(L"LOCALAPPDATA", localAppData, MAX_PATH);
+  if (length == 0 || length >= MAX_PATH) {
+    return {};
+  }
+  return fs::path{localAppData} / DistributionInfo::Name / L"ImageCache";
+}
+
+ImageVerifier::ImageVerifier(fs::path image, fs::path cacheDirectory)
+    : image_{std::move(image)},
+      cacheDirectory_{std::move(cacheDirectory)},
+      result_{std::async(std::launch::async, verify, image_, std::cref(cancelled_))} {}
+
+ImageVerifier::~ImageVerifier() {
+  Cancel();
+  if (result_.valid()) {
+    result_.wait();
+  }
+}
+
+void ImageVerifier::Cancel() {
+  cancelled_ = true;
+}
+
+ImageVerifier::Result ImageVerifier::Wait() {
+  if (cacheDirectory_.empty()) {
+    return result_.get();
+  }
+  return useCache(image_, cacheDirectory_, result_, cancelled_);
+}
+}  // namespace Ubuntu
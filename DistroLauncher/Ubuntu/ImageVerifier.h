@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "TarIndex.h"
+
+namespace Ubuntu {
+// The path of the install image (install.tar.gz) shipped alongside the launcher.
+std::filesystem::path InstallImagePath();
+
+// Where the decompressed copy of the install image is kept (see ImageCache.h), under
+// %LOCALAPPDATA%. Empty if there is no such directory or UBUNTU_LAUNCHER_IMAGE_CACHE is 0.
+std::filesystem::path ImageCacheDirectory();
+
+// Checks the integrity of the install image in the background, so a truncated or corrupted image is
+// rejected before WSL spends minutes extracting it.
+//
+// The image is memory-mapped and walked by two worker threads: one computes its SHA-256 digest, to
+// be compared with the manifest shipped next to the image (install.tar.gz.sha256, in sha256sum
+// format), while the other decompresses the gzip stream checking every member trailer. The
+// decompressed stream is indexed on the fly, capturing the few files the launcher needs to plan the
+// default user (/etc/wsl.conf, /etc/passwd, /etc/nsswitch.conf and everything under /etc/cloud).
+//
+// Until Wait() tells that an install is going to happen, the image is only read: the verification
+// starts with the launcher, before it knows whether the distro is registered. Given a cache
+// directory, Wait() then checks the copy there, or writes one if it doesn't hold a copy of this
+// very image.
+class ImageVerifier {
+ public:
+  struct Result {
+    // S_OK if the image is sound or couldn't be found (WSL will report that).
+    HRESULT hr = S_OK;
+    std::wstring error;
+    // Whether the image was actually verified.
+    bool verified = false;
+    // Whether its digest was compared against a manifest.
+    bool hashChecked = false;
+    std::uint64_t bytes = 0;
+    double seconds = 0;
+    // Entries of the root filesystem tarball, if it could be indexed completely.
+    std::shared_ptr<const Tar::Index> index;
+    // The decompressed copy to register from, if one of this image was there and checked out.
+    std::filesystem::path cachedImage;
+    // Whether a copy was written by this verification instead, for the next registrations.
+    bool cacheBuilt = false;
+    // How long registering from the compressed image took, if it was measured before.
+    std::optional<std::uint64_t> gzipRegistrationMs;
+
+    double megabytesPerSecond() const {
+      return seconds > 0 ? static_cast<double>(bytes) / (1024 * 1024) / seconds : 0;
+    }
+  };
+
+  // Starts verifying [image] right away, caching it in [cacheDirectory] if not empty once waited
+  // for.
+  explicit ImageVerifier(std::filesystem::path image, std::filesystem::path cacheDirectory = {});
+
+  // Cancels any work in progress.
+  ~ImageVerifier();
+
+  ImageVerifier(const ImageVerifier&) = delete;
+  ImageVerifier& operator=(const ImageVerifier&) = delete;
+
+  // Asks the workers to stop as soon as possible, e.g. when the distro turns out to be registered.
+  void Cancel();
+
+  // Blocks until the verification completes, and the image is cached. Must be called at most once,
+  // and only to install.
+  Result Wait();
+
+ private:
+  std::filesystem::path image_;
+  std::filesystem::path cacheDirectory_;
+  std::atomic<bool> cancelled_{false};
+  // Last, so that it starts once the rest is set.
+  std::future<Result> result_;
+};
+}  // namespace Ubuntu
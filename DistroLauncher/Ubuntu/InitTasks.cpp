@@ -1,495 +1,324 @@
-#include <stdafx.h>
 #include "InitTasks.h"
+#include "DefaultUserSources.h"
+#include "NssQuery.h"
+#include "Passwd.h"
+#include "Provisioning.h"
+#include "Trace.h"
+#include "UserDirectory.h"
+#include "Utf8.h"
+#include "WslConf.h"
 
 #include <algorithm>
 #include <charconv>
+#include <chrono>
 #include <exception>
-#include <filesystem>
 #include <optional>
+#include <string>
 #include <vector>
-#include <system_error>
 
 namespace Ubuntu {
 
 namespace {
-// Blocks the current thread until all initialization tasks finish.
-void waitForInitTasks(WslApiLoader& api);
+// Everything the launcher needs to know about a freshly registered distro, collected by running the
+// provisioning script once.
+struct ProvisioningSnapshot {
+  // All users found in the NSS passwd database, sorted by UID.
+  std::vector<UserEntry> users;
+  // The contents of /etc/wsl.conf, empty if there is no such file.
+  WslConf wslConf;
+  // UID of the current default user.
+  unsigned long defaultUid = static_cast<unsigned long>(-1);
+  // Output of `systemctl is-system-running`, "offline" if systemd is not running, "skipped" if the
+  // launcher knew there was no cloud-init to wait for.
+  std::string systemdState;
+  // Whether cloud-init is to be waited for, in which case nothing else is collected.
+  bool cloudInit = false;
+  // Exit codes of each step performed by the script, in the order they ran.
+  std::vector<std::pair<std::string, int>> steps;
+};
+
+// What the provisioning script can leave out, because the launcher already knows the answer.
+struct ProvisioningOptions {
+  // Don't enumerate the NSS passwd database.
+  bool skipUsers = false;
+  // Don't check whether cloud-init has to be waited for.
+  bool skipCloudInit = false;
+};
+
+// Runs all post-registration steps in a single launch of the provisioning script and collects the
+// results. Returns std::nullopt if the script couldn't run or replied with something unexpected.
+std::optional<ProvisioningSnapshot> provision(WslBackend& wsl, ProvisioningOptions options);
+
+// Whether waiting for cloud-init could be needed, worked out on the host without launching anything
+// in the distro. Only a definitive "no" spares the wait.
+bool needsCloudInitWait(WslBackend& wsl, const InstallPlan* plan);
+
+// Deletes /etc/resolv.conf to allow WSL to generate a version based on Windows networking
+// information.
+void removeResolvConf(WslBackend& wsl);
+
+// Blocks the current thread until cloud-init finishes or its deadline expires, reporting anything
+// worth knowing.
+void waitForCloudInit(WslBackend& wsl, const CloudInit::WaitOptions& options);
 
 // Enforces the existence of a default WSL user either:
 // - defined in /etc/wsl.conf (which might not be in effect yet)
 // - defined in WSL API/registry
 // - or the lowest non-system account with UID >= 1000 in the NSS passwd database
-// Returns false if a default user couldn't be set.
-bool enforceDefaultUser(WslApiLoader& api);
+// all asked at once. Whoever is found along the way is added to [users]. Returns false if a default
+// user couldn't be set.
+bool enforceDefaultUser(WslBackend& wsl, UserDirectory& users);
+
+// Same as above, deciding solely from the information already collected in the snapshot.
+bool enforceDefaultUser(WslBackend& wsl, UserDirectory& users,
+                        const ProvisioningSnapshot& snapshot);
 }  // namespace
 
-bool CheckInitTasks(WslApiLoader& api, bool checkDefaultUser) {
-  waitForInitTasks(api);
+struct InstallPlan {
+  // The contents of the image's /etc/wsl.conf, empty if there is no such file.
+  WslConf wslConf;
+  // Users found in the image's /etc/passwd, sorted by UID.
+  std::vector<UserEntry> users;
+  // Whether the users above are all the distro will know about at first boot, i.e. the NSS passwd
+  // database is local and cloud-init won't get a chance to create anyone.
+  bool usersAreFinal = false;
+  // Whether cloud-init will run at first boot.
+  bool cloudInit = true;
+};
 
-  if (!checkDefaultUser) {
-    return true;
+std::shared_ptr<const InstallPlan> PlanFromImage(const Tar::Index& image) {
+  Trace::Span span{"PlanFromImage"};
+  auto plan = std::make_shared<InstallPlan>();
+  if (const std::string* wslConf = image.Contents("etc/wsl.conf"); wslConf) {
+    plan->wslConf = WslConf::Parse(*wslConf);
   }
+  // cloud-init only runs under systemd, which must be enabled in wsl.conf.
+  plan->cloudInit = plan->wslConf.Systemd() && image.Contents("etc/cloud/cloud.cfg") != nullptr &&
+                    image.Find("etc/cloud/cloud-init.disabled") == nullptr;
 
-  return enforceDefaultUser(api);
-}
-
-namespace {
-void waitForInitTasks(WslApiLoader& api) {
-  // Wait for cloud-init to finish if systemd and its service is enabled.
-  static constexpr wchar_t script[] = LR"(
-if status=$(LANG=C systemctl is-system-running 2>/dev/null) || [ "${status}" != "offline" ] && systemctl is-enabled --quiet cloud-init.service 2>/dev/null; then
-  cloud-init status --wait > /dev/null 2>&1 || true
-fi
-)";
-  DWORD exitCode = -1;
-  auto hr = api.WslLaunchInteractive(script, FALSE, &exitCode);
-  if (FAILED(hr)) {
-    Helpers::PrintErrorMessage(hr);
-    return;
+  const std::string* passwd = image.Contents("etc/passwd");
+  if (passwd == nullptr) {
+    return plan;
   }
-}
+  plan->users = ParsePasswd(*passwd);
 
-namespace fs = std::filesystem;
-fs::path wslConfPath() {
-  // init-once, lazily.
-  static fs::path etcWslConf =
-      fs::path{L"\\\\wsl.localhost"} / DistributionInfo::Name / "etc\\wsl.conf";
-  return etcWslConf;
-}
-
-bool setDefaultUserViaWslApi(WslApiLoader& api, unsigned long uid) {
-  if (auto hr = api.WslConfigureDistribution(uid, WSL_DISTRIBUTION_FLAGS_DEFAULT); FAILED(hr)) {
-    _putws(L"ERROR: failed to set default user: ");
-    Helpers::PrintErrorMessage(hr);
-    return false;
-  }
-  return true;
+  // Without nsswitch.conf glibc only looks into the local files.
+  const std::string* nsswitch = image.Contents("etc/nsswitch.conf");
+  bool local = nsswitch == nullptr || PasswdIsLocal(*nsswitch);
+  plan->usersAreFinal = local && !plan->cloudInit;
+  return plan;
 }
-// Groups the pieces of information from a single user entry in the passwd database we care about.
-struct UserEntry {
-  std::string name;
-  ULONG uid = -1;
-  bool hasLogin = false;
-};
-
-// Collects all users found in the NSS passwd database, sorted by UID.
-std::vector<UserEntry> getAllUsers(WslApiLoader& api);
-
-// Returns the defaultUser set in /etc/wsl.conf or the empty string if none is set.
-std::string defaultUserInWslConf();
 
-// Converts a multi-byte null-terminated string into a wide string.
-std::wstring str2wide(std::string_view str, UINT codePage = CP_THREAD_ACP);
-
-bool enforceDefaultUser(WslApiLoader& api) try {
-  auto users = getAllUsers(api);
-
-  if (users.empty()) {
-    // unexpectedly nothing to do
-    _putws(L"ERROR: couldn't find any users in NSS database\n");
-    return false;
-  }
-  // 1. We read the default user name from /etc/wsl.conf
-  if (auto name = defaultUserInWslConf(); !name.empty()) {
-    // We still need the UID to be able to call the WSL API.
-    auto found = std::find_if(users.begin(), users.end(),
-                              [&name](const UserEntry& u) { return u.name == name; });
-    if (found == users.end()) {
-      // no UID, nothing to do, the system is in a bad state where the user requested in wsl.conf
-      // doesn't exist. We won't fix that.
+bool CheckInitTasks(WslBackend& wsl, UserDirectory& users, bool checkDefaultUser,
+                    const InstallPlan* plan, const CloudInit::WaitOptions& cloudInit) {
+  Trace::Span span{"CheckInitTasks"};
+  // No need to ask the distro for the users the install image already told us about.
+  const bool usersKnown = checkDefaultUser && plan && plan->usersAreFinal;
+  const bool waitCloudInit = needsCloudInitWait(wsl, plan);
+  if (auto snapshot = provision(wsl, {usersKnown, !waitCloudInit}); snapshot) {
+    if (snapshot->cloudInit) {
+      // cloud-init may create users and write wsl.conf, which are only worth asking about after.
+      waitForCloudInit(wsl, cloudInit);
+      return !checkDefaultUser || enforceDefaultUser(wsl, users);
+    }
+    if (!checkDefaultUser) {
       return true;
     }
-    return setDefaultUserViaWslApi(api, found->uid);
+    if (usersKnown) {
+      snapshot->users = plan->users;
+    }
+    return enforceDefaultUser(wsl, users, *snapshot);
   }
-  // 2. Check for the Windows registry
-  // This call returns the UID of the current default user, most likely root, unless someone set a
-  // different UID via the registry editor or WSL API, for which case we are done.
-  if (auto uid = DistributionInfo::QueryUid(L""); uid != 0) {
-    return true;
+
+  // Fallback to performing each step in its own Linux process.
+  removeResolvConf(wsl);
+  if (waitCloudInit) {
+    waitForCloudInit(wsl, cloudInit);
   }
 
-  // 3. Finally, search for the first non-system user.
-  auto found = std::find_if(users.begin(), users.end(),
-                            [](const UserEntry& u) { return u.uid > 999 && u.hasLogin; });
-  if (found != users.end()) {
-    return setDefaultUserViaWslApi(api, found->uid);
+  if (!checkDefaultUser) {
+    return true;
   }
 
-  return false;
-} catch (const std::exception& err) {
-  _putws(L"ERROR: Unexpected failure when enforcing the default user: ");
-  _putws(str2wide(err.what()).c_str());
-  return false;
+  return enforceDefaultUser(wsl, users);
 }
 
-// A truly temporary file copy.
-//
-// Invariant: while this object exists, so does the underlying file,
-// being auto-deleted by the OS when this object goes out of scope.
-class TempFileCopy {
-  fs::path p;
-  HANDLE h = nullptr;
-
- public:
-  ~TempFileCopy() {
-    if (h) {
-      CloseHandle(h);
-    }
-  }
-  const fs::path& path() const { return p; }
-
-  // Creates a temporary copy of the source file configured for auto removal by the OS when this
-  // object goes out of scope under the system's preferred temporary directory.
-  explicit TempFileCopy(const fs::path& source) {
-    // When debugging fs::temp_directory_path() returns a path like LOCALAPPDATA\Temp, but once
-    // packaged it should point inside LOCALAPPDATA\Packages\<PackageFullName>\...
-    auto path = fs::temp_directory_path();
-
-    wchar_t rawDestination[MAX_PATH] = {'\0'};
-    if (auto uniqueCode = GetTempFileNameW(path.native().c_str(), L"wsl", 0, rawDestination);
-        uniqueCode == 0) {
-      std::string msg{"couldn't create a temporary file inside "};
-      msg += path.string();
-      throw std::system_error{static_cast<int>(GetLastError()), std::system_category(), msg};
-    }
-    fs::path destination{rawDestination};
-
-    // GetTempFileNameA would have created a file for us thus we need to overwrite it.
-    fs::copy_file(source, destination, fs::copy_options::overwrite_existing);
-    fs::permissions(destination, fs::perms::owner_read | fs::perms::owner_write);
-
-    // Allow others to read but not write it, and configure it to be deleted automatically when the
-    // handle is closed (what's the destructor does automatically no matter what).
-    HANDLE file = CreateFileW(
-        rawDestination, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
-        FILE_ATTRIBUTE_TEMPORARY | FILE_ATTRIBUTE_READONLY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
-    if (file == INVALID_HANDLE_VALUE) {
-      std::string msg{"couldn't open file in auto-delete mode: "};
-      msg += path.string();
-      throw std::system_error{static_cast<int>(GetLastError()), std::system_category(), msg};
-    }
+namespace {
+void removeResolvConf(WslBackend& wsl) { wsl.LaunchInteractive(L"rm /etc/resolv.conf", true); }
 
-    // fully initializes the object.
-    p = destination;
-    h = file;
+bool needsCloudInitWait(WslBackend& wsl, const InstallPlan* plan) {
+  // WSL 1 doesn't run systemd.
+  if (auto configuration = wsl.GetConfiguration(); configuration && configuration->version == 1) {
+    return false;
   }
-};
 
-// Reads [user].default from an existing wsl.conf file located at the ini path provided.
-std::string readIniDefaultUser(const fs::path& ini) {
-  // `getconf LOGIN_NAME_MAX` returns 256, but glibc restricts user login names to 32 chars long.
-  static constexpr auto utNameSize = 33;  // With room for the NULL terminator just in case.
-  char uname[utNameSize] = {'\0'};
-  auto len =
-      GetPrivateProfileStringA("user", "default", nullptr, uname, utNameSize, ini.string().c_str());
-
-  // GetPrivateProfileStringA set errno to ERROR_FILE_NOT_FOUND if the file
-  // or section or key are not found or if the file is ill-formed. We know the file exists.
-  // Absent user.default entry is a common case, we don't want to spam users for that.
-  // I don't see what other errors that could raise.
-  if (auto e = GetLastError(); len == 0 && e == ERROR_FILE_NOT_FOUND) {
-    return {};
+  if (plan) {
+    return plan->cloudInit;
   }
 
-  return uname;
+  // Without the image contents, wsl.conf is the next best source: no systemd, no cloud-init.
+  return ReadWslConf(wsl).Systemd();
 }
 
-std::string defaultUserInWslConf() try {
-  auto etcWslConf = wslConfPath();
-  if (!fs::exists(etcWslConf)) {
-    return {};
+void waitForCloudInit(WslBackend& wsl, const CloudInit::WaitOptions& options) {
+  using Outcome = CloudInit::WaitResult::Outcome;
+  auto result = CloudInit::Wait(wsl, options);
+  // Whatever went wrong, the distro is still usable, as it was when waiting without a deadline.
+  switch (result.outcome) {
+    case Outcome::TimedOut: {
+      auto seconds = std::chrono::duration_cast<std::chrono::seconds>(options.deadline).count();
+      wsl.Print(L"WARNING: cloud-init didn't finish within " + std::to_wstring(seconds) +
+                L" seconds, not waiting any longer. Time spent per stage:");
+      break;
+    }
+    case Outcome::Error:
+    case Outcome::Degraded:
+      wsl.Print(L"WARNING: cloud-init reported errors:");
+      for (const auto& error : result.status.errors) {
+        wsl.Print(Utf8ToWide(error));
+      }
+      wsl.Print(L"Time spent per stage:");
+      break;
+    default:
+      return;
   }
-  // Copy /etc/wsl.conf to a temporary local path (guaranteed by the OS to be auto-deleted) from
-  // where GetPrivateProfileStringA can read it.
-  TempFileCopy copy(etcWslConf);
-  return readIniDefaultUser(copy.path());
-
-} catch (std::system_error const& err) {
-  // std::filesystem_error is child of std::system_error
-  std::wcout << L"ERROR: failed to read /etc/wsl.conf: " << err.code() << ": "
-             << str2wide(err.what());
-  return {};
+  wsl.Print(Utf8ToWide(CloudInit::FormatStageTimings(result.status)));
 }
 
-std::wstring str2wide(std::string_view str, UINT codePage) {
-  if (str.empty() || str.size() >= INT_MAX) return {};
-
-  int inputSize = static_cast<int>(str.size());
-  int required = ::MultiByteToWideChar(codePage, 0, str.data(), inputSize, NULL, 0);
-  if (0 == required) return {};
-
-  std::wstring str2;
-  str2.resize(required);
-
-  int converted = ::MultiByteToWideChar(codePage, 0, str.data(), inputSize, &str2[0], required);
-  if (0 == converted) return {};
-
-  return str2;
+bool setDefaultUserViaWslApi(WslBackend& wsl, unsigned long uid) {
+  if (!wsl.SetDefaultUid(uid)) {
+    wsl.Print(L"ERROR: failed to set default user");
+    return false;
+  }
+  return true;
 }
 
-// A non-interactive WSL process, turned into a class so we don't have to worry about closing
-// the process and pipe's handles.
-class WslProcess {
- private:
-  HANDLE process_ = nullptr;
-  HANDLE readPipe_ = nullptr;
-  HANDLE writePipe_ = nullptr;
-  std::wstring command_;
-
-  static constexpr auto MaxOutputSize = 4096;
-
- public:
-  ~WslProcess() {
-    if (process_) {
-      CloseHandle(process_);
-    }
-    if (writePipe_) {
-      CloseHandle(writePipe_);
-    }
-    if (readPipe_) {
-      CloseHandle(readPipe_);
-    }
+// Sets the default user according to the [choice] made out of [search].
+bool applyDefaultUserChoice(WslBackend& wsl, const DefaultUserSearch& search,
+                            const DefaultUserChoice& choice) {
+  if (search.UsersSeen() == 0) {
+    wsl.Print(L"ERROR: couldn't find any users in NSS database");
   }
-
-  struct Result {
-    std::wstring error;
-    std::size_t exitCode = static_cast<std::size_t>(-1);
-    std::string stdOut;
-  };
-
-  // Runs the process via WSL api and wait for timeout milliseconds.
-  Result run(WslApiLoader& api, DWORD timeout);
-
-  explicit WslProcess(std::wstring command_) : command_{command_} {};
-};
-
-// Views a string as a collection of (most likely non-null terminated) substring slices split by the
-// provided delimiter, visited unidirectionally. The backing string is required to outlive this for
-// safe usage. Useful for lazy iteration.
-class SplitView {
- private:
-  std::string_view parent;
-  char delimiter;
-  std::string_view::const_iterator start;
-
- public:
-  SplitView(std::string_view str, char delimiter)
-      : parent(str), delimiter(delimiter), start(parent.begin()) {}
-
-  std::optional<std::string_view> next() {
-    if (start == parent.end()) {
-      return std::nullopt;
-    }
-
-    auto end = std::find(start, parent.end(), delimiter);
-    std::string_view token = parent.substr(start - parent.begin(), end - start);
-
-    if (end != parent.end()) {
-      start = end + 1;
-    } else {
-      start = end;
-    }
-
-    return token;
+  if (!choice.ok) {
+    return false;
   }
-
-  // This allows plugging the SplitView into std algorithms and range-for loops.
-  auto begin() { return iterator(this); }
-  auto end() { return iterator::sentinel(this); }
-
-  class iterator {
-   private:
-    SplitView* splitView;
-    std::optional<std::string_view> current;
-
-    iterator(SplitView* splitView, const std::optional<std::string_view>& current)
-        : splitView(splitView), current(current) {}
-
-   public:
-    // Creates a new iterator pointing to the next value of the SplitView, i.e. the
-    // begin-iterator.
-    iterator(SplitView* splitView) : splitView{splitView}, current{splitView->next()} {}
-    // Creates a new sentinel iterator for the provided SplitView, i.e. the end-iterator.
-    static iterator sentinel(SplitView* splitView) { return iterator{splitView, std::nullopt}; }
-
-    // boiler-plate to define a standard-compliant iterator interface.
-    using value_type = std::string_view;
-    using difference_type = std::ptrdiff_t;
-    using pointer = const std::string_view*;
-    using reference = const std::string_view&;
-    using iterator_category = std::input_iterator_tag;
-
-    reference operator*() const { return *current; }
-    pointer operator->() const { return &(*current); }
-
-    iterator& operator++() {
-      current = splitView->next();
-      return *this;
-    }
-
-    iterator operator++(int) {
-      iterator temp = *this;
-      ++(*this);
-      return temp;
-    }
-
-    friend bool operator==(const iterator& a, const iterator& b) {
-      return a.splitView == b.splitView && a.current == b.current;
-    }
-
-    friend bool operator!=(const iterator& a, const iterator& b) { return !(a == b); }
-  };
-};
-
-// Parses a string modelling a line of passwd into a UserEntry object.
-// We only care about login name, UID and the login shell, although the lines should have 7 fields:
-// ^NAME:ENCRYPTION:UID:...3 fields...:SHELL\n$
-// Returns std::nullopt on parse failure, the exact error for ill-formed lines is not needed.
-std::optional<UserEntry> userEntryFromString(std::string_view line);
-
-// Assuming UnaryOperation returns a std::optional, applies it to each element of the range
-// [first,last[ and stores the results that actually hold a value into the output range.
-// It's like std::transform, but skips the results of UnaryOperation that returns std::nullopt,
-// thus the output range size is going to be smaller than or equal to the input range size.
-template <typename InputIt, typename OutputIt, typename UnaryOperation>
-OutputIt transform_maybe(InputIt first, InputIt last, OutputIt d_first, UnaryOperation unary_op) {
-  while (first != last) {
-    auto&& in = *first;
-    std::optional maybe = unary_op(in);
-    if (maybe) {
-      *d_first++ = *maybe;
-    }
-    ++first;
+  if (!choice.uid.has_value()) {
+    return true;
   }
-  return d_first;
+  return setDefaultUserViaWslApi(wsl, choice.uid.value());
 }
 
-std::vector<UserEntry> getAllUsers(WslApiLoader& api) {
-  WslProcess getent{L"getent passwd"};
-  auto [error, exitCode, output] = getent.run(api, 10'000);
-  if (!error.empty()) {
-    _putws(L"failed to read passwd database: ");
-    _putws(error.c_str());
-    if (exitCode != 0) {
-      wprintf(L"%lld", exitCode);
-    }
-    return {};
+bool enforceDefaultUser(WslBackend& wsl, UserDirectory& users) try {
+  Trace::Span span{"enforceDefaultUser"};
+  auto resolution = ResolveDefaultUser(wsl);
+  wsl.Print(Utf8ToWide(FormatResolutionTimes(resolution)));
+  // WSL already defaults to someone else than root, nothing was looked up.
+  if (resolution.source == DefaultUserSource::Registry) {
+    return true;
   }
-
-  if (output.empty()) {
-    return {};
+  if (const auto& candidate = resolution.search.Candidate(); candidate) {
+    users.Populate({candidate.value()});
   }
-
-  std::vector<UserEntry> users;
-  // Where the boilerplate pays-off: splits the getent output by lines
-  SplitView lines{output, '\n'};
-  // and store the parsed results in the users vector.
-  // NOTE about ill-formed lines in passwd: this algorithm just skips them.
-  // Broken lines in /etc/passwd won't prevent the effects of the good lines.
-  // getent itself reports errors for broken lines but still output the good ones.
-  // The system behaves as if they don't exist. So we can ignore them as well.
-  transform_maybe(lines.begin(), lines.end(), std::back_inserter(users), userEntryFromString);
-  // Finally sort that vector by UID.
-  std::sort(users.begin(), users.end(),
-            [](const UserEntry& a, const UserEntry& b) { return a.uid < b.uid; });
-  return users;
+  if (!resolution.choice.ok) {
+    wsl.Print(L"NSS queries performed:");
+    wsl.Print(Utf8ToWide(FormatNssQueryRecords(resolution.records)));
+  }
+  return applyDefaultUserChoice(wsl, resolution.search, resolution.choice);
+} catch (const std::exception& err) {
+  wsl.Print(L"ERROR: Unexpected failure when enforcing the default user: ");
+  wsl.Print(Utf8ToWide(err.what()));
+  return false;
 }
 
-std::optional<UserEntry> userEntryFromString(std::string_view line) {
-  SplitView fields{line, ':'};
-  // Field 0: name
-  auto name = fields.next();
-  if (!name || name->empty()) {
-    return std::nullopt;
-  }
-  // Field 1: encryption flag, unused.
-  auto unused = fields.next();
-  if (!unused) {
-    return std::nullopt;
-  }
-  // Field 2: UID
-  auto u = fields.next();
-  if (!u) {
-    return std::nullopt;
-  }
-  ULONG uid = -1;
-  auto ud = std::from_chars(u->data(), u->data() + u->length(), uid);
-  if (ud.ec != std::errc{}) {
-    // cannot convert UID to an integer
-    return std::nullopt;
-  }
-  // Fields 3, 4 and 5: unused in this context, but still must be checked, otherwise the line is
-  // ill-formed.
-  for (int i = 0; i < 3; ++i) {
-    if (unused = fields.next(); !unused) {
-      return std::nullopt;
+bool enforceDefaultUser(WslBackend& wsl, UserDirectory& users,
+                        const ProvisioningSnapshot& snapshot) try {
+  Trace::Span span{"enforceDefaultUser"};
+  // Spares launching processes to look them up again later in this run.
+  users.Populate(snapshot.users);
+  DefaultUserSearch search{std::string{snapshot.wslConf.DefaultUser()}};
+  for (const auto& user : snapshot.users) {
+    if (!search.Add(user)) {
+      break;
     }
   }
-  // Field 6: the login shell.
-  auto shell = fields.next();
-  if (!shell || shell->empty()) {
-    return std::nullopt;
-  }
-
-  // For this particular case it seems that an exclusion list is easier than a
-  // positive list of what shells are valid as there are more valid shell choices (sh, bash, csh,
-  // dash, ksh, tcsh, zsh, fish, ...).
-  bool hasLogin =
-      (shell->find("/sync") == std::string::npos && shell->find("/nologin") == std::string::npos &&
-       shell->find("/false") == std::string::npos);
-
-  return UserEntry{std::string{name->begin(), name->end()}, uid, hasLogin};
+  auto choice = ChooseDefaultUser(search, [&snapshot] { return snapshot.defaultUid; });
+  return applyDefaultUserChoice(wsl, search, choice);
+} catch (const std::exception& err) {
+  wsl.Print(L"ERROR: Unexpected failure when enforcing the default user: ");
+  wsl.Print(Utf8ToWide(err.what()));
+  return false;
 }
 
-WslProcess::Result WslProcess::run(WslApiLoader& api, DWORD timeout) {
-  // Create a pipe to read the output of the launched process.
-  HANDLE read, write, process;
-  SECURITY_ATTRIBUTES sa{sizeof(sa), nullptr, true};
-  ULONG uid = -1;
-  if (CreatePipe(&read, &write, &sa, 0) == FALSE) {
-    return {L"failed to create the stdio pipe"};
+std::optional<ProvisioningSnapshot> provision(WslBackend& wsl, ProvisioningOptions options) {
+  Trace::Span span{"provision"};
+  // getent over a slow directory can take long, thus no timeout.
+  std::wstring command;
+  if (options.skipUsers) {
+    command += L"skip_users=1\n";
   }
-  // We have to remember to close the pipe handles.
-  readPipe_ = read;
-  writePipe_ = write;
-
-  DWORD exitCode = -1;
-  auto hr = api.WslLaunch(command_.c_str(), FALSE, GetStdHandle(STD_INPUT_HANDLE), writePipe_,
-                          GetStdHandle(STD_ERROR_HANDLE), &process);
-  if (FAILED(hr)) {
-    return {L"failed to launch process"};
+  if (options.skipCloudInit) {
+    command += L"skip_cloud_init=1\n";
   }
-  // Also need to remember to close the process handle.
-  process_ = process;
-
-  if (auto wait = WaitForSingleObject(process_, timeout); wait == WAIT_TIMEOUT) {
-    return {L"terminated due timed out"};
-  }
-
-  exitCode = -1;
-  if ((GetExitCodeProcess(process_, &exitCode) == false) || (exitCode != 0)) {
-    return {L"exited with error", exitCode};
+  command += Provisioning::Script;
+  auto [error, exitCode, output, errors] = wsl.Run(command, WslBackend::NoTimeout);
+  if (!error.empty()) {
+    wsl.Print(L"failed to run the provisioning script: ");
+    wsl.Print(error);
+    if (!errors.empty()) {
+      wsl.Print(Utf8ToWide(errors));
+    }
+    return std::nullopt;
   }
 
-  // Check how many bytes we need to allocate to pump all contents out the pipe.
-  DWORD unreadBytes;
-  if (FALSE == PeekNamedPipe(readPipe_, 0, 0, 0, &unreadBytes, 0) || unreadBytes == 0) {
-    return {L"could not read the process output", 0};
-  }
-  std::size_t size = 1ULL + unreadBytes;
-  if (size > MaxOutputSize) {
-    return {L"process output is too big", 0};
+  auto records = Provisioning::ParseReply(output);
+  if (!records) {
+    wsl.Print(L"ERROR: unexpected reply from the provisioning script");
+    return std::nullopt;
   }
-  std::string contents(size, '\0');
 
-  // Finally we do the read.
-  DWORD readCount = 0, avail = 0;
-  if (FALSE == ReadFile(readPipe_, contents.data(), unreadBytes, &readCount, nullptr) ||
-      read == 0) {
-    return {L"could not read the process output", 0};
+  ProvisioningSnapshot snapshot;
+  for (const auto& [type, payload] : *records) {
+    switch (type) {
+      case Provisioning::RecordType::Step: {
+        auto space = payload.rfind(' ');
+        int stepExitCode = -1;
+        if (space != std::string_view::npos) {
+          std::from_chars(payload.data() + space + 1, payload.data() + payload.size(),
+                          stepExitCode);
+        }
+        snapshot.steps.emplace_back(payload.substr(0, space), stepExitCode);
+        break;
+      }
+      case Provisioning::RecordType::User:
+        // Ill-formed lines are skipped, as in ParsePasswd.
+        if (auto user = UserEntryFromString(payload); user) {
+          snapshot.users.push_back(std::move(user.value()));
+        }
+        break;
+      case Provisioning::RecordType::Conf:
+        snapshot.wslConf = WslConf::Parse(std::string{payload});
+        break;
+      case Provisioning::RecordType::Uid:
+        if (unsigned long uid;
+            std::from_chars(payload.data(), payload.data() + payload.size(), uid).ec ==
+            std::errc{}) {
+          snapshot.defaultUid = uid;
+        }
+        break;
+      case Provisioning::RecordType::Systemd:
+        snapshot.systemdState = payload;
+        break;
+      case Provisioning::RecordType::CloudInit:
+        snapshot.cloudInit = payload == "enabled";
+        break;
+      default:
+        break;
+    }
   }
 
-  return {{}, 0, contents};
+  std::sort(snapshot.users.begin(), snapshot.users.end(),
+            [](const UserEntry& a, const UserEntry& b) { return a.uid < b.uid; });
+  return snapshot;
 }
 
 }  // namespace
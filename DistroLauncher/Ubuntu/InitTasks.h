@@ -1,8 +1,31 @@
 #pragma once
+
+#include "CloudInit.h"
+#include "TarIndex.h"
+#include "UserDirectory.h"
+#include "WslBackend.h"
+
+#include <memory>
+
+// The first-boot tasks of a freshly registered distro. It doesn't depend on any Windows API, the
+// distro being reached through a WslBackend.
 namespace Ubuntu
 {
+	// What the install image tells about the default user, worked out before the distro is even
+	// registered. Opaque outside of InitTasks.cpp.
+	struct InstallPlan;
+
+	// Plans the default user decision out of the files captured while indexing the install image.
+	std::shared_ptr<const InstallPlan> PlanFromImage(const Tar::Index& image);
+
+	// Performs the first-boot tasks of a freshly registered distro, such as letting WSL generate
+	// /etc/resolv.conf and waiting for cloud-init.
 	// Returns true if system initialization tasks are complete.
-	// If [checkDefaultUser] is true, we consider creating the default user part of such tasks.
-	bool CheckInitTasks(WslApiLoader& api, bool checkDefaultUser);
+	// If [checkDefaultUser] is true, we consider creating the default user part of such tasks, adding
+	// whoever is found along the way to [users].
+	// An optional [plan] spares querying the distro for what the install image already told.
+	// cloud-init is waited for as told by [cloudInit].
+	bool CheckInitTasks(WslBackend& wsl, UserDirectory& users, bool checkDefaultUser,
+	                    const InstallPlan* plan = nullptr,
+	                    const CloudInit::WaitOptions& cloudInit = {});
 };
-
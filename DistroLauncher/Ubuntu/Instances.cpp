@@ -0,0 +1,151 @@
+#include "Instances.h"
+#include "NssQuery.h"
+#include "Passwd.h"
+#include "Trace.h"
+#include "UserDirectory.h"
+#include "Utf8.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace Ubuntu::Instances {
+namespace {
+// Forwards everything to the backend of an instance, but for what it shows: lines are prefixed by
+// the name of the instance and progress blocks dropped, as they would overwrite each other.
+class Labelled : public WslBackend {
+ public:
+  Labelled(WslBackend& wsl, const std::wstring& name) : wsl_{wsl}, prefix_{name + L": "} {}
+
+  std::optional<Configuration> GetConfiguration() override { return wsl_.GetConfiguration(); }
+  bool SetDefaultUid(unsigned long uid) override { return wsl_.SetDefaultUid(uid); }
+  std::optional<unsigned long> LaunchInteractive(std::wstring_view command,
+                                                 bool useCurrentWorkingDirectory) override {
+    return wsl_.LaunchInteractive(command, useCurrentWorkingDirectory);
+  }
+  ProcessResult Run(std::wstring_view command, std::chrono::milliseconds timeout,
+                    const ConsumeFunction* consume = nullptr) override {
+    return wsl_.Run(command, timeout, consume);
+  }
+  std::unique_ptr<Session> Spawn(std::wstring_view command, ConsumeFunction consume) override {
+    return wsl_.Spawn(command, std::move(consume));
+  }
+  std::optional<std::string> ReadFile(std::string_view path) override {
+    return wsl_.ReadFile(path);
+  }
+  void Print(std::wstring_view line) override { wsl_.Print(prefix_ + std::wstring{line}); }
+  void ShowProgress(std::wstring_view) override {}
+
+ private:
+  WslBackend& wsl_;
+  std::wstring prefix_;
+};
+
+// Registers and provisions the instance [name].
+Instance install(const std::wstring& name, const RegisterFunction& registration,
+                 const Options& options);
+}  // namespace
+
+bool ValidName(std::wstring_view name) {
+  return !name.empty() && std::all_of(name.begin(), name.end(), [](wchar_t c) {
+    return (c >= L'a' && c <= L'z') || (c >= L'A' && c <= L'Z') || (c >= L'0' && c <= L'9') ||
+           c == L'.' || c == L'_' || c == L'-';
+  });
+}
+
+std::vector<std::wstring> Names(std::wstring_view prefix, std::size_t count) {
+  std::vector<std::wstring> names;
+  names.reserve(count);
+  for (std::size_t i = 1; i <= count; ++i) {
+    names.push_back(std::wstring{prefix} + L'-' + std::to_wstring(i));
+  }
+  return names;
+}
+
+std::size_t Summary::Succeeded() const {
+  return std::count_if(instances.begin(), instances.end(),
+                       [](const Instance& instance) { return instance.Succeeded(); });
+}
+
+double Summary::PerMinute() const {
+  std::chrono::duration<double, std::ratio<60>> minutes = elapsed;
+  return minutes.count() > 0 ? static_cast<double>(Succeeded()) / minutes.count() : 0;
+}
+
+Summary InstallAll(const std::vector<std::wstring>& names, const RegisterFunction& registration,
+                   const Options& options, const FinishedFunction& finished) {
+  Summary summary;
+  if (names.empty()) {
+    return summary;
+  }
+
+  Trace::Span span{"Instances::InstallAll"};
+  auto start = std::chrono::steady_clock::now();
+  summary.instances.resize(names.size());
+  std::mutex mutex;
+  std::atomic<std::size_t> next{0};
+  auto work = [&] {
+    for (auto index = next++; index < names.size(); index = next++) {
+      auto instance = install(names[index], registration, options);
+      std::scoped_lock lock{mutex};
+      summary.instances[index] = instance;
+      if (finished) {
+        finished(instance);
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  const auto count = std::min(std::max<std::size_t>(options.parallelism, 1), names.size());
+  for (std::size_t i = 1; i < count; ++i) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  summary.elapsed = std::chrono::steady_clock::now() - start;
+  span.SetDetail(std::to_string(summary.Succeeded()) + " of " + std::to_string(names.size()) +
+                 " instance(s), " + std::to_string(count) + " at once");
+  return summary;
+}
+
+namespace {
+Instance install(const std::wstring& name, const RegisterFunction& registration,
+                 const Options& options) {
+  Trace::Span span{"Instances::install", name};
+  Instance instance;
+  instance.name = name;
+  if (!ValidName(name)) {
+    instance.error = L"invalid distribution name";
+    return instance;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  auto backend = registration(name, instance.error);
+  auto registered = std::chrono::steady_clock::now();
+  instance.registration = registered - start;
+  if (!backend) {
+    if (instance.error.empty()) {
+      instance.error = L"registration failed";
+    }
+    return instance;
+  }
+
+  // As DistributionInfo::Users, but for this instance.
+  Labelled wsl{*backend, name};
+  UserDirectory users{[&wsl](const NssQuery& query) -> std::optional<std::vector<UserEntry>> {
+    auto result = wsl.Run(Utf8ToWide(query.Command()), std::chrono::seconds{10});
+    if (result.error.empty() || (query.kind != NssQuery::Kind::Enumeration &&
+                                 result.exitCode == NssQuery::NotFoundExitCode)) {
+      return ParsePasswd(result.stdOut);
+    }
+    return std::nullopt;
+  }};
+  instance.defaultUserSet = CheckInitTasks(wsl, users, true, options.plan, options.cloudInit);
+  instance.provisioning = std::chrono::steady_clock::now() - registered;
+  return instance;
+}
+}  // namespace
+}  // namespace Ubuntu::Instances
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "CloudInit.h"
+#include "InitTasks.h"
+#include "WslBackend.h"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Installing several instances of the distro from the same image at once, as
+// `install --instances` does for test farms, each registered under a name of its own and
+// provisioned as a single install would be. It doesn't depend on any Windows API, the registration
+// being provided by the caller and the instances reached through WslBackends.
+namespace Ubuntu::Instances {
+// Whether WSL accepts [name] for a distro: ^[a-zA-Z0-9._-]+$.
+bool ValidName(std::wstring_view name);
+
+// The names of [count] instances: [prefix]-1, [prefix]-2...
+std::vector<std::wstring> Names(std::wstring_view prefix, std::size_t count);
+
+struct Instance {
+  std::wstring name;
+  // Why it couldn't be installed, empty if it was.
+  std::wstring error;
+  // Whether the provisioning set the default user, root being left otherwise.
+  bool defaultUserSet = false;
+  std::chrono::nanoseconds registration{0};
+  std::chrono::nanoseconds provisioning{0};
+
+  bool Succeeded() const { return error.empty(); }
+};
+
+struct Options {
+  // How many instances are installed at once, at least one.
+  std::size_t parallelism = 4;
+  // What the install image tells of the default user, if it was indexed.
+  const InstallPlan* plan = nullptr;
+  CloudInit::WaitOptions cloudInit;
+};
+
+struct Summary {
+  // In the order of the names.
+  std::vector<Instance> instances;
+  std::chrono::nanoseconds elapsed{0};
+
+  std::size_t Succeeded() const;
+  // Instances installed per minute, all of them counted once done.
+  double PerMinute() const;
+};
+
+// Registers the instance [name] from the image, returning the backend reaching it, or nullptr
+// after setting [error].
+using RegisterFunction =
+    std::function<std::shared_ptr<WslBackend>(const std::wstring& name, std::wstring& error)>;
+using FinishedFunction = std::function<void(const Instance& instance)>;
+
+// Registers and provisions the instances named [names] as told by [options], handing each outcome
+// to [finished] as soon as it is known, never two at once. Instances don't ask for a default user,
+// the console being shared: those whose image and cloud-init set none are left with root. What
+// they print is prefixed by their name, their progress isn't shown.
+Summary InstallAll(const std::vector<std::wstring>& names, const RegisterFunction& registration,
+                   const Options& options, const FinishedFunction& finished);
+}  // namespace Ubuntu::Instances
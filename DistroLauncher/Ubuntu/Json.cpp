@@ -0,0 +1,284 @@
+#include "Json.h"
+#include "Utf8.h"
+
+#include <charconv>
+#include <cstdint>
+#include <system_error>
+
+namespace Ubuntu::Json {
+namespace {
+// Deeper documents are refused rather than risking the stack.
+constexpr int MaxDepth = 64;
+
+class Parser {
+ public:
+  explicit Parser(std::string_view text) : text_{text} {}
+
+  std::optional<Value> Document() {
+    auto value = parseValue(0);
+    skipWhitespace();
+    if (!value || pos_ != text_.size()) {
+      return std::nullopt;
+    }
+    return value;
+  }
+
+ private:
+  std::optional<Value> parseValue(int depth);
+  std::optional<Value> parseArray(int depth);
+  std::optional<Value> parseObject(int depth);
+  std::optional<std::string> parseString();
+  std::optional<Value> parseNumber();
+  // Reads the 4 hex digits of a \u escape.
+  std::optional<std::uint32_t> parseHex4();
+
+  bool literal(std::string_view word) {
+    if (text_.substr(pos_, word.size()) != word) {
+      return false;
+    }
+    pos_ += word.size();
+    return true;
+  }
+
+  bool consume(char c) {
+    skipWhitespace();
+    if (pos_ < text_.size() && text_[pos_] == c) {
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+
+  void skipWhitespace() {
+    while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t' ||
+                                   text_[pos_] == '\n' || text_[pos_] == '\r')) {
+      ++pos_;
+    }
+  }
+
+  std::string_view text_;
+  std::size_t pos_ = 0;
+};
+
+std::optional<Value> Parser::parseValue(int depth) {
+  if (depth > MaxDepth) {
+    return std::nullopt;
+  }
+  skipWhitespace();
+  if (pos_ == text_.size()) {
+    return std::nullopt;
+  }
+  switch (text_[pos_]) {
+    case '{':
+      return parseObject(depth + 1);
+    case '[':
+      return parseArray(depth + 1);
+    case '"':
+      if (auto str = parseString(); str) {
+        return Value{std::move(str.value())};
+      }
+      return std::nullopt;
+    case 't':
+      return literal("true") ? std::optional{Value{true}} : std::nullopt;
+    case 'f':
+      return literal("false") ? std::optional{Value{false}} : std::nullopt;
+    case 'n':
+      return literal("null") ? std::optional{Value{}} : std::nullopt;
+    default:
+      return parseNumber();
+  }
+}
+
+std::optional<Value> Parser::parseArray(int depth) {
+  ++pos_;
+  Value::Array array;
+  if (consume(']')) {
+    return Value{std::move(array)};
+  }
+  do {
+    auto element = parseValue(depth);
+    if (!element) {
+      return std::nullopt;
+    }
+    array.push_back(std::move(element.value()));
+  } while (consume(','));
+  if (!consume(']')) {
+    return std::nullopt;
+  }
+  return Value{std::move(array)};
+}
+
+std::optional<Value> Parser::parseObject(int depth) {
+  ++pos_;
+  Value::Object object;
+  if (consume('}')) {
+    return Value{std::move(object)};
+  }
+  do {
+    skipWhitespace();
+    if (pos_ == text_.size() || text_[pos_] != '"') {
+      return std::nullopt;
+    }
+    auto key = parseString();
+    if (!key || !consume(':')) {
+      return std::nullopt;
+    }
+    auto member = parseValue(depth);
+    if (!member) {
+      return std::nullopt;
+    }
+    object.emplace_back(std::move(key.value()), std::move(member.value()));
+  } while (consume(','));
+  if (!consume('}')) {
+    return std::nullopt;
+  }
+  return Value{std::move(object)};
+}
+
+std::optional<std::string> Parser::parseString() {
+  ++pos_;
+  std::string str;
+  while (pos_ < text_.size()) {
+    char c = text_[pos_++];
+    if (c == '"') {
+      return str;
+    }
+    if (static_cast<unsigned char>(c) < 0x20) {
+      return std::nullopt;
+    }
+    if (c != '\\') {
+      str += c;
+      continue;
+    }
+    if (pos_ == text_.size()) {
+      return std::nullopt;
+    }
+    switch (char escaped = text_[pos_++]; escaped) {
+      case '"':
+      case '\\':
+      case '/':
+        str += escaped;
+        break;
+      case 'b':
+        str += '\b';
+        break;
+      case 'f':
+        str += '\f';
+        break;
+      case 'n':
+        str += '\n';
+        break;
+      case 'r':
+        str += '\r';
+        break;
+      case 't':
+        str += '\t';
+        break;
+      case 'u': {
+        auto codePoint = parseHex4();
+        if (!codePoint) {
+          return std::nullopt;
+        }
+        // A high surrogate must be followed by a low one.
+        if (*codePoint >= 0xD800 && *codePoint < 0xDC00) {
+          if (!literal("\\u")) {
+            return std::nullopt;
+          }
+          auto low = parseHex4();
+          if (!low || *low < 0xDC00 || *low >= 0xE000) {
+            return std::nullopt;
+          }
+          codePoint = 0x10000 + ((*codePoint - 0xD800) << 10) + (*low - 0xDC00);
+        } else if (*codePoint >= 0xDC00 && *codePoint < 0xE000) {
+          return std::nullopt;
+        }
+        AppendUtf8(str, *codePoint);
+        break;
+      }
+      default:
+        return std::nullopt;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<std::uint32_t> Parser::parseHex4() {
+  if (text_.size() - pos_ < 4) {
+    return std::nullopt;
+  }
+  std::uint32_t value = 0;
+  auto [ptr, ec] = std::from_chars(text_.data() + pos_, text_.data() + pos_ + 4, value, 16);
+  if (ec != std::errc{} || ptr != text_.data() + pos_ + 4) {
+    return std::nullopt;
+  }
+  pos_ += 4;
+  return value;
+}
+
+std::optional<Value> Parser::parseNumber() {
+  // from_chars is laxer than JSON about leading characters, which are checked first.
+  auto start = pos_;
+  if (pos_ < text_.size() && text_[pos_] == '-') {
+    ++pos_;
+  }
+  if (pos_ == text_.size() || text_[pos_] < '0' || text_[pos_] > '9') {
+    return std::nullopt;
+  }
+  double number = 0;
+  auto [ptr, ec] = std::from_chars(text_.data() + start, text_.data() + text_.size(), number);
+  if (ec != std::errc{}) {
+    return std::nullopt;
+  }
+  pos_ = ptr - text_.data();
+  return Value{number};
+}
+}  // namespace
+
+const Value* Value::Find(std::string_view key) const {
+  const auto* object = AsObject();
+  if (object == nullptr) {
+    return nullptr;
+  }
+  for (auto member = object->rbegin(); member != object->rend(); ++member) {
+    if (member->first == key) {
+      return &member->second;
+    }
+  }
+  return nullptr;
+}
+
+std::optional<Value> Parse(std::string_view text) { return Parser{text}.Document(); }
+
+void AppendString(std::string& out, std::string_view text) {
+  constexpr char hex[] = "0123456789abcdef";
+  out += '"';
+  for (char c : text) {
+    switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          out += "\\u00";
+          out += hex[(c >> 4) & 0xF];
+          out += hex[c & 0xF];
+        } else {
+          out += c;
+        }
+    }
+  }
+  out += '"';
+}
+}  // namespace Ubuntu::Json
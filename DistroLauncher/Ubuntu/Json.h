@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Just enough JSON for the structured output of the tools the launcher runs in the distro, such as
+// `cloud-init status --format json`. It doesn't depend on any Windows API.
+namespace Ubuntu::Json {
+class Value {
+ public:
+  using Array = std::vector<Value>;
+  // Members in document order. As with most parsers, the last of duplicate keys wins on lookup.
+  using Object = std::vector<std::pair<std::string, Value>>;
+
+  // null
+  Value() = default;
+  explicit Value(bool value) : value_{value} {}
+  explicit Value(double value) : value_{value} {}
+  explicit Value(std::string value) : value_{std::move(value)} {}
+  explicit Value(Array value) : value_{std::move(value)} {}
+  explicit Value(Object value) : value_{std::move(value)} {}
+
+  bool IsNull() const { return std::holds_alternative<std::nullptr_t>(value_); }
+
+  // The value if of the given type, nullptr otherwise.
+  const bool* AsBool() const { return std::get_if<bool>(&value_); }
+  const double* AsNumber() const { return std::get_if<double>(&value_); }
+  const std::string* AsString() const { return std::get_if<std::string>(&value_); }
+  const Array* AsArray() const { return std::get_if<Array>(&value_); }
+  const Object* AsObject() const { return std::get_if<Object>(&value_); }
+
+  // The member [key] of an object. Returns nullptr if this isn't an object or has no such member.
+  const Value* Find(std::string_view key) const;
+
+ private:
+  std::variant<std::nullptr_t, bool, double, std::string, Array, Object> value_;
+};
+
+// Parses a single JSON document, surrounded by whitespace at most. Returns std::nullopt if [text]
+// is ill-formed or nested too deeply.
+std::optional<Value> Parse(std::string_view text);
+
+// Appends [text] to [out] as a JSON string, quotes included.
+void AppendString(std::string& out, std::string_view text);
+}  // namespace Ubuntu::Json
@@ -0,0 +1,422 @@
+#include "LaunchStats.h"
+#include "SplitView.h"
+#include "Trace.h"
+
+#include <charconv>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <system_error>
+
+namespace Ubuntu::LaunchStats {
+namespace fs = std::filesystem;
+
+namespace {
+// Durations up to twice as many microseconds as sub-buckets are counted exactly.
+constexpr std::uint64_t exactBuckets = 2 * Histogram::SubBuckets;
+
+// The Prometheus metric the histograms are exported as.
+constexpr char metric[] = "ubuntu_launcher_phase_duration_seconds";
+
+// Spans lasting as long as the launcher or a session.
+constexpr std::string_view sessionSpans[] = {"wmain", "WslLaunchInteractive", "Broker::Serve",
+                                             "BrokerPipe::Serve"};
+
+// Writes [contents] to [path] through a temporary file renamed over it.
+bool writeAtomically(const fs::path& path, const std::string& contents);
+
+// Parses the decimal number in [text], all of it.
+std::optional<std::uint64_t> parseNumber(std::string_view text);
+
+// [text] as a single word.
+std::string word(std::string_view text);
+
+// [microseconds] in seconds, as Prometheus has it.
+std::string seconds(std::uint64_t microseconds);
+
+// [text] as a Prometheus label value.
+std::string labelValue(std::string_view text);
+
+// What the current session records, if any.
+struct Recorder {
+  std::mutex mutex;
+  bool active = false;
+  std::string version;
+  Store store;
+};
+
+Recorder& recorder();
+
+void record(const char* name, std::chrono::nanoseconds duration);
+}  // namespace
+
+std::size_t Histogram::BucketOf(std::uint64_t microseconds) {
+  if (microseconds < exactBuckets) {
+    return static_cast<std::size_t>(microseconds);
+  }
+  unsigned exponent = 0;
+  for (auto v = microseconds; v > 1; v >>= 1) {
+    ++exponent;
+  }
+  // The 16 sub-buckets of 2^exponent follow those of the smaller powers of two.
+  return static_cast<std::size_t>(SubBuckets * (exponent - 3) + (microseconds >> (exponent - 4)) -
+                                  SubBuckets);
+}
+
+std::uint64_t Histogram::LowerBound(std::size_t index) {
+  if (index < exactBuckets) {
+    return index;
+  }
+  const auto group = index / SubBuckets;
+  const auto sub = index % SubBuckets;
+  return static_cast<std::uint64_t>(SubBuckets + sub) << (group - 1);
+}
+
+void Histogram::Record(std::chrono::microseconds duration) {
+  const auto microseconds =
+      duration.count() < 0 ? std::uint64_t{0} : static_cast<std::uint64_t>(duration.count());
+  const auto index = BucketOf(microseconds);
+  if (buckets_.size() <= index) {
+    buckets_.resize(index + 1);
+  }
+  ++buckets_[index];
+  if (count_ == 0 || microseconds < min_) {
+    min_ = microseconds;
+  }
+  if (count_ == 0 || microseconds > max_) {
+    max_ = microseconds;
+  }
+  ++count_;
+  sum_ += microseconds;
+}
+
+void Histogram::Merge(const Histogram& other) {
+  if (other.count_ == 0) {
+    return;
+  }
+  if (buckets_.size() < other.buckets_.size()) {
+    buckets_.resize(other.buckets_.size());
+  }
+  for (std::size_t i = 0; i < other.buckets_.size(); ++i) {
+    buckets_[i] += other.buckets_[i];
+  }
+  if (count_ == 0 || other.min_ < min_) {
+    min_ = other.min_;
+  }
+  if (count_ == 0 || other.max_ > max_) {
+    max_ = other.max_;
+  }
+  count_ += other.count_;
+  sum_ += other.sum_;
+}
+
+std::chrono::microseconds Histogram::Percentile(double quantile) const {
+  if (count_ == 0) {
+    return std::chrono::microseconds{0};
+  }
+  quantile = quantile < 0 ? 0 : quantile > 1 ? 1 : quantile;
+  // The rank of the duration wanted, from 1 to count_.
+  auto rank = static_cast<std::uint64_t>(quantile * static_cast<double>(count_) + 0.5);
+  rank = rank == 0 ? 1 : rank;
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < buckets_.size(); ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      auto upper = LowerBound(i + 1) - 1;
+      upper = upper > max_ ? max_ : upper < min_ ? min_ : upper;
+      return std::chrono::microseconds(upper);
+    }
+  }
+  return std::chrono::microseconds(max_);
+}
+
+void Histogram::SetBucket(std::size_t index, std::uint64_t count) {
+  if (buckets_.size() <= index) {
+    buckets_.resize(index + 1);
+  }
+  buckets_[index] = count;
+}
+
+void Store::Record(std::string_view version, std::string_view phase,
+                   std::chrono::microseconds duration) {
+  histograms_[{word(version), word(phase)}].Record(duration);
+}
+
+void Store::Merge(const Store& other) {
+  for (const auto& [key, histogram] : other.histograms_) {
+    histograms_[key].Merge(histogram);
+  }
+}
+
+std::string Store::Format() const {
+  std::string contents =
+      "# Launch phase durations in microseconds, see Ubuntu/LaunchStats.h:\n"
+      "# version phase count sum min max bucket:count...\n";
+  for (const auto& [key, histogram] : histograms_) {
+    contents += key.first + " " + key.second + " " + std::to_string(histogram.count_) + " " +
+                std::to_string(histogram.sum_) + " " + std::to_string(histogram.min_) + " " +
+                std::to_string(histogram.max_);
+    for (std::size_t i = 0; i < histogram.buckets_.size(); ++i) {
+      if (histogram.buckets_[i] != 0) {
+        contents += " " + std::to_string(i) + ":" + std::to_string(histogram.buckets_[i]);
+      }
+    }
+    contents += "\n";
+  }
+  return contents;
+}
+
+std::optional<Store> Store::Parse(std::string_view contents) {
+  Store store;
+  for (auto line : SplitView{contents, '\n'}) {
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+    if (line.empty() || line.front() == '#') {
+      continue;
+    }
+    std::vector<std::string_view> fields;
+    for (auto field : SplitView{line, ' '}) {
+      if (!field.empty()) {
+        fields.push_back(field);
+      }
+    }
+    if (fields.size() < 6) {
+      return std::nullopt;
+    }
+    Histogram histogram;
+    auto count = parseNumber(fields[2]);
+    auto sum = parseNumber(fields[3]);
+    auto min = parseNumber(fields[4]);
+    auto max = parseNumber(fields[5]);
+    if (!count || !sum || !min || !max) {
+      return std::nullopt;
+    }
+    std::uint64_t counted = 0;
+    for (std::size_t i = 6; i < fields.size(); ++i) {
+      auto colon = fields[i].find(':');
+      if (colon == std::string_view::npos) {
+        return std::nullopt;
+      }
+      auto index = parseNumber(fields[i].substr(0, colon));
+      auto bucket = parseNumber(fields[i].substr(colon + 1));
+      // Bounds the buckets to durations a 64-bit count of microseconds can tell.
+      if (!index || !bucket || *index >= 64 * Histogram::SubBuckets) {
+        return std::nullopt;
+      }
+      histogram.SetBucket(static_cast<std::size_t>(*index), *bucket);
+      counted += *bucket;
+    }
+    if (counted != *count) {
+      return std::nullopt;
+    }
+    histogram.count_ = *count;
+    histogram.sum_ = *sum;
+    histogram.min_ = *min;
+    histogram.max_ = *max;
+    store.histograms_[{std::string{fields[0]}, std::string{fields[1]}}].Merge(histogram);
+  }
+  return store;
+}
+
+std::optional<Store> Load(const fs::path& path) {
+  std::error_code error;
+  if (!fs::exists(path, error)) {
+    return error ? std::nullopt : std::optional<Store>{Store{}};
+  }
+  std::ifstream file{path, std::ios::binary};
+  if (!file) {
+    return std::nullopt;
+  }
+  std::string contents{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+  return Store::Parse(contents);
+}
+
+bool Append(const fs::path& path, const Store& store) {
+  Trace::Span span{"LaunchStats::Append"};
+  auto merged = Load(path).value_or(Store{});
+  merged.Merge(store);
+  return writeAtomically(path, merged.Format());
+}
+
+std::string Report(const Store& store) {
+  std::string report;
+  std::string version;
+  char line[160];
+  for (const auto& [key, histogram] : store.Histograms()) {
+    if (report.empty() || key.first != version) {
+      version = key.first;
+      std::snprintf(line, sizeof(line), "%s%s\n  %-32s %8s %10s %10s %10s %10s\n",
+                    report.empty() ? "" : "\n", version.c_str(), "phase (ms)", "count", "p50",
+                    "p90", "p99", "max");
+      report += line;
+    }
+    auto ms = [](std::chrono::microseconds duration) { return duration.count() / 1000.0; };
+    std::snprintf(line, sizeof(line), "  %-32s %8llu %10.1f %10.1f %10.1f %10.1f\n",
+                  key.second.c_str(), static_cast<unsigned long long>(histogram.Count()),
+                  ms(histogram.Percentile(0.5)), ms(histogram.Percentile(0.9)),
+                  ms(histogram.Percentile(0.99)), ms(histogram.Max()));
+    report += line;
+  }
+  return report;
+}
+
+std::string ToPrometheus(const Store& store) {
+  std::string out = std::string{"# HELP "} + metric +
+                    " Duration of the phases of the Ubuntu launcher's runs.\n"
+                    "# TYPE " +
+                    metric + " histogram\n";
+  for (const auto& [key, histogram] : store.Histograms()) {
+    const auto labels =
+        "version=\"" + labelValue(key.first) + "\",phase=\"" + labelValue(key.second) + "\"";
+    std::uint64_t cumulative = 0;
+    const auto& buckets = histogram.Buckets();
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+      if (buckets[i] == 0) {
+        continue;
+      }
+      cumulative += buckets[i];
+      // Bucket i counts durations strictly below the lower bound of the next, in whole
+      // microseconds: at most one less.
+      out += std::string{metric} + "_bucket{" + labels + ",le=\"" +
+             seconds(Histogram::LowerBound(i + 1) - 1) + "\"} " + std::to_string(cumulative) +
+             "\n";
+    }
+    out += std::string{metric} + "_bucket{" + labels + ",le=\"+Inf\"} " +
+           std::to_string(histogram.Count()) + "\n";
+    out += std::string{metric} + "_sum{" + labels + "} " +
+           seconds(static_cast<std::uint64_t>(histogram.Sum().count())) + "\n";
+    out += std::string{metric} + "_count{" + labels + "} " + std::to_string(histogram.Count()) +
+           "\n";
+  }
+  return out;
+}
+
+bool WritePrometheus(const fs::path& path, const Store& store) {
+  return writeAtomically(path, ToPrometheus(store));
+}
+
+void Record(const char* phase, std::chrono::nanoseconds duration) { record(phase, duration); }
+
+Session::Session(fs::path path, std::string version) : path_{std::move(path)} {
+  if (path_.empty()) {
+    return;
+  }
+  auto& r = recorder();
+  {
+    std::lock_guard lock{r.mutex};
+    r.active = true;
+    r.version = std::move(version);
+    r.store = Store{};
+  }
+  Trace::Observe(record);
+}
+
+Session::~Session() {
+  if (path_.empty()) {
+    return;
+  }
+  Trace::Observe(nullptr);
+  auto& r = recorder();
+  Store store;
+  {
+    std::lock_guard lock{r.mutex};
+    r.active = false;
+    store = std::move(r.store);
+    r.store = Store{};
+  }
+  if (!store.Empty()) {
+    Append(path_, store);
+  }
+}
+
+namespace {
+bool writeAtomically(const fs::path& path, const std::string& contents) {
+  std::error_code error;
+  if (path.has_parent_path()) {
+    fs::create_directories(path.parent_path(), error);
+  }
+  auto temporary = path;
+  temporary += ".new";
+  {
+    std::ofstream file{temporary, std::ios::binary | std::ios::trunc};
+    file << contents;
+    if (!file.flush()) {
+      return false;
+    }
+  }
+  fs::rename(temporary, path, error);
+  return !error;
+}
+
+std::optional<std::uint64_t> parseNumber(std::string_view text) {
+  std::uint64_t value{};
+  const char* end = text.data() + text.size();
+  auto [ptr, ec] = std::from_chars(text.data(), end, value);
+  if (text.empty() || ec != std::errc{} || ptr != end) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+std::string word(std::string_view text) {
+  std::string out{text.empty() ? std::string_view{"-"} : text};
+  for (auto& c : out) {
+    if (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '#') {
+      c = '_';
+    }
+  }
+  return out;
+}
+
+std::string seconds(std::uint64_t microseconds) {
+  char text[32];
+  std::snprintf(text, sizeof(text), "%llu.%06llu",
+                static_cast<unsigned long long>(microseconds / 1000000),
+                static_cast<unsigned long long>(microseconds % 1000000));
+  return text;
+}
+
+std::string labelValue(std::string_view text) {
+  std::string out;
+  for (char c : text) {
+    switch (c) {
+      case '\\':
+        out += "\\\\";
+        break;
+      case '"':
+        out += "\\\"";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      default:
+        out += c;
+    }
+  }
+  return out;
+}
+
+Recorder& recorder() {
+  // Never destroyed, spans may end on other threads as the launcher exits.
+  static auto* r = new Recorder{};
+  return *r;
+}
+
+void record(const char* name, std::chrono::nanoseconds duration) {
+  for (auto span : sessionSpans) {
+    if (span == name) {
+      return;
+    }
+  }
+  auto& r = recorder();
+  std::lock_guard lock{r.mutex};
+  if (!r.active) {
+    return;
+  }
+  r.store.Record(r.version, name,
+                 std::chrono::duration_cast<std::chrono::microseconds>(duration));
+}
+}  // namespace
+}  // namespace Ubuntu::LaunchStats
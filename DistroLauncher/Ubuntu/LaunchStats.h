@@ -0,0 +1,112 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Latency statistics kept across runs, telling whether launches get slower over time and releases.
+// The duration of each phase of a run, as timed by its trace spans (see Trace.h), is added to a
+// histogram per launcher version and phase, kept in a small text file merged into at the end of
+// every run. It doesn't depend on any Windows API.
+namespace Ubuntu::LaunchStats {
+// Counts durations in microseconds, exactly up to 32 us and within 1/16th above, HDR histograms
+// style: each power of two is split into 16 linear buckets.
+class Histogram {
+ public:
+  static constexpr std::size_t SubBuckets = 16;
+
+  void Record(std::chrono::microseconds duration);
+  void Merge(const Histogram& other);
+
+  std::uint64_t Count() const { return count_; }
+  std::chrono::microseconds Sum() const { return std::chrono::microseconds(sum_); }
+  std::chrono::microseconds Min() const { return std::chrono::microseconds(min_); }
+  std::chrono::microseconds Max() const { return std::chrono::microseconds(max_); }
+
+  // A duration at least as long as the [quantile], from 0 to 1, of those recorded, and within the
+  // precision of the buckets. Zero if none was.
+  std::chrono::microseconds Percentile(double quantile) const;
+
+  // The count of each bucket, those of the longest durations left out while empty.
+  const std::vector<std::uint64_t>& Buckets() const { return buckets_; }
+  void SetBucket(std::size_t index, std::uint64_t count);
+
+  // The bucket counting [microseconds], and the smallest duration counted by bucket [index].
+  static std::size_t BucketOf(std::uint64_t microseconds);
+  static std::uint64_t LowerBound(std::size_t index);
+
+ private:
+  friend class Store;
+
+  std::vector<std::uint64_t> buckets_;
+  std::uint64_t count_ = 0;
+  std::uint64_t sum_ = 0;
+  std::uint64_t min_ = 0;
+  std::uint64_t max_ = 0;
+};
+
+// Histograms by launcher version, then phase.
+class Store {
+ public:
+  using Key = std::pair<std::string, std::string>;
+
+  // Versions and phases are single words, other whitespace is replaced.
+  void Record(std::string_view version, std::string_view phase,
+              std::chrono::microseconds duration);
+  void Merge(const Store& other);
+
+  const std::map<Key, Histogram>& Histograms() const { return histograms_; }
+  bool Empty() const { return histograms_.empty(); }
+
+  // One line per histogram: version, phase, count, sum, min and max, then index:count for each
+  // non-empty bucket.
+  std::string Format() const;
+  // Returns std::nullopt if [contents] is ill-formed.
+  static std::optional<Store> Parse(std::string_view contents);
+
+ private:
+  std::map<Key, Histogram> histograms_;
+};
+
+// The store at [path], empty if there is none yet, or std::nullopt if it can't be read.
+std::optional<Store> Load(const std::filesystem::path& path);
+
+// Merges [store] into the one at [path], replacing it at once. A store which can't be read is
+// started anew. Runs ending at the same time may lose each other's durations.
+bool Append(const std::filesystem::path& path, const Store& store);
+
+// The 50th, 90th and 99th percentiles and maximum of each phase in milliseconds, by version.
+std::string Report(const Store& store);
+
+// The histograms in the Prometheus text format, for node_exporter's textfile collector.
+std::string ToPrometheus(const Store& store);
+
+// Writes ToPrometheus(store) to [path], replacing it at once so that it is never scraped half
+// written.
+bool WritePrometheus(const std::filesystem::path& path, const Store& store);
+
+// Records [duration] under [phase] in the current session, if any, for phases no span can time.
+void Record(const char* phase, std::chrono::nanoseconds duration);
+
+// Records the duration of the spans of this run under [version], to be appended to the store at
+// [path] once destroyed, if given a path. Spans lasting as long as a session, such as wmain or
+// WslLaunchInteractive, tell nothing of latency and are left out.
+class Session {
+ public:
+  Session(std::filesystem::path path, std::string version);
+  ~Session();
+
+  Session(const Session&) = delete;
+  Session& operator=(const Session&) = delete;
+
+ private:
+  std::filesystem::path path_;
+};
+}  // namespace Ubuntu::LaunchStats
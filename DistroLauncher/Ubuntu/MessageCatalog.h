@@ -0,0 +1,355 @@
+#pragma once
+
+// Generated from messages.mc by CompileMessages (see tests/CMakeLists.txt), don't edit.
+
+#include "Messages.h"
+
+namespace Ubuntu::Messages::Catalog {
+namespace Pieces {
+inline constexpr Piece MSG_WSL_REGISTER_DISTRIBUTION_FAILED[] = {
+    {L"WslRegisterDistribution failed with error: 0x", 1, Piece::Kind::Hex},
+    {L"\n"},
+};
+inline constexpr Piece MSG_WSL_CONFIGURE_DISTRIBUTION_FAILED[] = {
+    {L"WslGetDistributionConfiguration failed with error: 0x", 1, Piece::Kind::Hex},
+    {L"\n"},
+};
+inline constexpr Piece MSG_WSL_LAUNCH_INTERACTIVE_FAILED[] = {
+    {L"WslLaunchInteractive ", 1, Piece::Kind::Text},
+    {L" failed with error: 0x", 2, Piece::Kind::Hex},
+    {L"\n"},
+};
+inline constexpr Piece MSG_WSL_LAUNCH_FAILED[] = {
+    {L"WslLaunch ", 1, Piece::Kind::Text},
+    {L" failed with error: 0x", 2, Piece::Kind::Hex},
+    {L"\n"},
+};
+inline constexpr Piece MSG_USAGE[] = {
+    {L"Launches or configures a Linux distribution.\n"
+     L"\n"
+     L"Usage: \n"
+     L"    <no args> \n"
+     L"        Launches the user's default shell in the user's home directory.\n"
+     L"\n"
+     L"    install [--root]\n"
+     L"        Install the distribuiton and do not launch the shell when complete.\n"
+     L"          --root\n"
+     L"              Do not create a user account and leave the default user set to root.\n"
+     L"        The decompressed installation image is kept under %LOCALAPPDATA%, so\n"
+     L"        that installing again registers from it instead, once checked. Setting\n"
+     L"        the UBUNTU_LAUNCHER_IMAGE_CACHE environment variable to 0 disables it.\n"
+     L"\n"
+     L"    install --instances <count> --name-prefix <prefix> [--parallel <count>]\n"
+     L"        Register <count> instances of the distribution named <prefix>-1,\n"
+     L"        <prefix>-2... from the same installation image, up to 4 at once unless\n"
+     L"        --parallel tells otherwise. Each is imported with wsl --import into a\n"
+     L"        directory of its own, %LOCALAPPDATA%\\<distribution>\\Instances\\<name>,\n"
+     L"        and is removed with wsl --unregister <name>. Each is provisioned as an\n"
+     L"        install, except that no user account is asked for: those whose image or\n"
+     L"        cloud-init configure no default user are left with root.\n"
+     L"        Setting the UBUNTU_CLOUD_INIT_TIMEOUT environment variable to a number of\n"
+     L"        seconds bounds how long installing waits for cloud-init, 600 by default.\n"
+     L"\n"
+     L"    run <command line> \n"
+     L"        Run the provided command line in the current working directory. If no\n"
+     L"        command line is provided, the default shell is launched.\n"
+     L"\n"
+     L"    run --batch [--stop-on-failure] <file>\n"
+     L"        Run the commands listed in <file>, or read from stdin if <file> is -, one\n"
+     L"        per line, in a single session. Blank lines and lines starting with # are\n"
+     L"        skipped. Each command runs in its own subshell in the current working\n"
+     L"        directory, without stdin and with stderr merged into stdout. Its exit code\n"
+     L"        and duration are printed once it finishes. The exit code is that of the\n"
+     L"        first command which failed, 0 if none did.\n"
+     L"          --stop-on-failure\n"
+     L"              Skip the remaining commands once one fails.\n"
+     L"\n"
+     L"    run --parallel <jobs> <file>\n"
+     L"        Run the commands listed in <file>, or read from stdin if <file> is -, as\n"
+     L"        with --batch, but up to <jobs> of them at once, each in a session of its\n"
+     L"        own. Every line of output is prefixed with the number of the command it\n"
+     L"        came from, and the exit code and duration of each command are printed\n"
+     L"        once it finishes. The exit code is that of the first command in <file>\n"
+     L"        which failed, 0 if none did.\n"
+     L"\n"
+     L"    run --warm <command line>\n"
+     L"        Run the provided command line through the session broker, if one is\n"
+     L"        running and stdin is NUL, without a terminal and with stderr merged into\n"
+     L"        stdout. Otherwise it is run as with run <command line>.\n"
+     L"\n"
+     L"    broker\n"
+     L"        Keep shells running in the distribution and serve the later invocations\n"
+     L"        of run --warm <command line> from them, sparing each a launch. The\n"
+     L"        broker exits after 15 minutes without requests.\n"
+     L"\n"
+     L"    config [setting [value]] \n"
+     L"        Configure settings for this distribution.\n"
+     L"        Settings:\n"
+     L"          --default-user <username>\n"
+     L"              Sets the default user to <username>. This must be an existing user.\n"
+     L"\n"
+     L"    status\n"
+     L"        Print the configuration WSL keeps for the distribution without starting\n"
+     L"        it, or exit with an error if the distribution is not installed.\n"
+     L"\n"
+     L"    snapshot\n"
+     L"        Save the root filesystem of the distribution under %LOCALAPPDATA%,\n"
+     L"        replacing the previous snapshot once complete. The distribution is\n"
+     L"        entered as root while it runs, by other launches too, the default user\n"
+     L"        being restored once done or interrupted with Ctrl-C.\n"
+     L"\n"
+     L"    reset\n"
+     L"        Register the distribution again from its snapshot, unregistering it\n"
+     L"        first if needed. The installation and its first boot are skipped, the\n"
+     L"        default user and settings being those of the snapshot. Everything\n"
+     L"        changed since the snapshot was taken is lost.\n"
+     L"\n"
+     L"    stats [--prometheus <file>]\n"
+     L"        Print the 50th, 90th and 99th percentiles of the time spent in each phase\n"
+     L"        of the launcher, by version, as recorded by every run under\n"
+     L"        %LOCALAPPDATA%. Setting the UBUNTU_LAUNCHER_STATS environment variable\n"
+     L"        to 0 stops recording.\n"
+     L"          --prometheus <file>\n"
+     L"              Also write the histograms to <file> in the Prometheus text format,\n"
+     L"              e.g. for the textfile collector of node_exporter.\n"
+     L"\n"
+     L"    --trace <file> <arguments>\n"
+     L"        Record the time spent in each phase of the launcher invoked with\n"
+     L"        <arguments> to <file>, in the Chrome trace format. Setting the\n"
+     L"        UBUNTU_LAUNCHER_TRACE environment variable to <file> does the same.\n"
+     L"\n"
+     L"    help \n"
+     L"        Print usage information and exit.\n"},
+};
+inline constexpr Piece MSG_STATUS_INSTALLING[] = {
+    {L"Installing, this may take a few minutes...\n"},
+};
+inline constexpr Piece MSG_INSTALL_SUCCESS[] = {
+    {L"Installation successful!\n"},
+};
+inline constexpr Piece MSG_ERROR_CODE[] = {
+    {L"Error: 0x", 1, Piece::Kind::Hex},
+    {L" ", 2, Piece::Kind::Text},
+    {L"\n"},
+};
+inline constexpr Piece MSG_ENTER_USERNAME[] = {
+    {L"Enter new UNIX username: "},
+};
+inline constexpr Piece MSG_CREATE_USER_PROMPT[] = {
+    {L"Please create a default UNIX user account. The username does not need to match your Windows username.\n"
+     L"For more information visit: https://aka.ms/wslusers\n"},
+};
+inline constexpr Piece MSG_PRESS_A_KEY[] = {
+    {L"Press any key to continue...\n"},
+};
+inline constexpr Piece MSG_INSTALL_ALREADY_EXISTS[] = {
+    {L"The distribution installation has become corrupted.\n"
+     L"Please select Reset from App Settings or uninstall and reinstall the app.\n"},
+};
+inline constexpr Piece MSG_ENABLE_VIRTUALIZATION[] = {
+    {L"Please enable the Virtual Machine Platform Windows feature and ensure virtualization is enabled in the BIOS.\n"
+     L"For information please visit https://aka.ms/enablevirtualization\n"},
+};
+inline constexpr Piece MSG_INSTALL_IMAGE_CORRUPTED[] = {
+    {L"The installation image is damaged: ", 1, Piece::Kind::Text},
+    {L"\n"
+     L"Please select Reset from App Settings or uninstall and reinstall the app.\n"},
+};
+inline constexpr Piece MSG_INSTALL_IMAGE_VERIFIED[] = {
+    {L"Verified the installation image: ", 1, Piece::Kind::Unsigned},
+    {L" MB in ", 2, Piece::Kind::Unsigned},
+    {L" ms (", 3, Piece::Kind::Unsigned},
+    {L" MB/s).\n"},
+};
+inline constexpr Piece MSG_WSL_GET_DISTRIBUTION_CONFIGURATION_FAILED[] = {
+    {L"WslGetDistributionConfiguration failed with error: 0x", 1, Piece::Kind::Hex},
+    {L"\n"},
+};
+inline constexpr Piece MSG_STATUS[] = {
+    {L"WSL version: ", 1, Piece::Kind::Unsigned},
+    {L"\n"
+     L"Default UID: ", 2, Piece::Kind::Unsigned},
+    {L"\n"
+     L"Flags: 0x", 3, Piece::Kind::Hex},
+    {L"\n"
+     L"Default environment:\n"},
+};
+inline constexpr Piece MSG_STATUS_ENVIRONMENT_VARIABLE[] = {
+    {L"    ", 1, Piece::Kind::NarrowText},
+    {L"\n"},
+};
+inline constexpr Piece MSG_STATUS_NOT_INSTALLED[] = {
+    {L"The distribution is not installed.\n"},
+};
+inline constexpr Piece MSG_INVALID_USERNAME[] = {
+    {L"Invalid username: ", 1, Piece::Kind::Text},
+    {L"\n"},
+};
+inline constexpr Piece MSG_USERNAME_ALREADY_EXISTS[] = {
+    {L"A user of this name already exists.\n"},
+};
+inline constexpr Piece MSG_BATCH_COMMAND_FINISHED[] = {
+    {L"[", 1, Piece::Kind::Unsigned},
+    {L"/", 2, Piece::Kind::Unsigned},
+    {L"] exit code ", 3, Piece::Kind::Unsigned},
+    {L" in ", 4, Piece::Kind::Unsigned},
+    {L" ms: ", 5, Piece::Kind::Text},
+    {L"\n"},
+};
+inline constexpr Piece MSG_BATCH_SUMMARY[] = {
+    {L"", 1, Piece::Kind::Unsigned},
+    {L" of ", 2, Piece::Kind::Unsigned},
+    {L" commands succeeded.\n"},
+};
+inline constexpr Piece MSG_BATCH_READ_FAILED[] = {
+    {L"Could not read the batch file ", 1, Piece::Kind::Text},
+    {L".\n"},
+};
+inline constexpr Piece MSG_BATCH_SESSION_FAILED[] = {
+    {L"The batch session failed: ", 1, Piece::Kind::Text},
+    {L"\n"},
+};
+inline constexpr Piece MSG_BROKER_LISTENING[] = {
+    {L"The session broker is running with ", 1, Piece::Kind::Unsigned},
+    {L" warm shell(s). It exits after ", 2, Piece::Kind::Unsigned},
+    {L" minutes without requests.\n"},
+};
+inline constexpr Piece MSG_BROKER_ALREADY_RUNNING[] = {
+    {L"A session broker is already running.\n"},
+};
+inline constexpr Piece MSG_BROKER_REQUEST_FAILED[] = {
+    {L"The session broker failed to run the command: ", 1, Piece::Kind::Text},
+    {L"\n"},
+};
+inline constexpr Piece MSG_PARALLEL_JOB_FAILED[] = {
+    {L"[", 1, Piece::Kind::Unsigned},
+    {L"/", 2, Piece::Kind::Unsigned},
+    {L"] failed: ", 3, Piece::Kind::Text},
+    {L": ", 4, Piece::Kind::Text},
+    {L"\n"},
+};
+inline constexpr Piece MSG_PARALLEL_SUMMARY[] = {
+    {L"", 1, Piece::Kind::Unsigned},
+    {L" of ", 2, Piece::Kind::Unsigned},
+    {L" commands succeeded in ", 3, Piece::Kind::Unsigned},
+    {L" ms, running ", 4, Piece::Kind::Unsigned},
+    {L" at once.\n"},
+};
+inline constexpr Piece MSG_INSTANCE_INSTALLED[] = {
+    {L"Installed ", 1, Piece::Kind::Text},
+    {L" in ", 2, Piece::Kind::Unsigned},
+    {L" ms: ", 3, Piece::Kind::Unsigned},
+    {L" ms registering, ", 4, Piece::Kind::Unsigned},
+    {L" ms provisioning.\n"},
+};
+inline constexpr Piece MSG_INSTANCE_FAILED[] = {
+    {L"Could not install ", 1, Piece::Kind::Text},
+    {L": ", 2, Piece::Kind::Text},
+    {L"\n"},
+};
+inline constexpr Piece MSG_INSTANCES_SUMMARY[] = {
+    {L"Installed ", 1, Piece::Kind::Unsigned},
+    {L" of ", 2, Piece::Kind::Unsigned},
+    {L" instances in ", 3, Piece::Kind::Unsigned},
+    {L" ms, ", 4, Piece::Kind::Unsigned},
+    {L" at once: ", 5, Piece::Kind::Unsigned},
+    {L" instances per minute, ", 6, Piece::Kind::Unsigned},
+    {L" MB/s of installation image.\n"},
+};
+inline constexpr Piece MSG_INSTALL_FROM_IMAGE_CACHE[] = {
+    {L"Registered from the image cache in ", 1, Piece::Kind::Unsigned},
+    {L" ms.\n"},
+};
+inline constexpr Piece MSG_INSTALL_FROM_IMAGE_CACHE_SAVED[] = {
+    {L"Registered from the image cache in ", 1, Piece::Kind::Unsigned},
+    {L" ms, ", 2, Piece::Kind::Unsigned},
+    {L" ms less than from the compressed image.\n"},
+};
+inline constexpr Piece MSG_WSL_UNREGISTER_DISTRIBUTION_FAILED[] = {
+    {L"WslUnregisterDistribution failed with error: 0x", 1, Piece::Kind::Hex},
+    {L"\n"},
+};
+inline constexpr Piece MSG_SNAPSHOT_TAKEN[] = {
+    {L"Took a snapshot of the distribution: ", 1, Piece::Kind::Unsigned},
+    {L" MB in ", 2, Piece::Kind::Unsigned},
+    {L" ms (", 3, Piece::Kind::Unsigned},
+    {L" MB/s).\n"},
+};
+inline constexpr Piece MSG_SNAPSHOT_FAILED[] = {
+    {L"Could not take a snapshot of the distribution: ", 1, Piece::Kind::Text},
+    {L"\n"},
+};
+inline constexpr Piece MSG_SNAPSHOT_MISSING[] = {
+    {L"There is no snapshot to reset the distribution to, or it is damaged. Take one with snapshot first.\n"},
+};
+inline constexpr Piece MSG_RESET_SUCCESS[] = {
+    {L"Reset the distribution to its snapshot in ", 1, Piece::Kind::Unsigned},
+    {L" ms.\n"},
+};
+inline constexpr Piece MSG_STATS[] = {
+    {L"", 1, Piece::Kind::NarrowText},
+};
+inline constexpr Piece MSG_STATS_EMPTY[] = {
+    {L"No launch statistics have been recorded in ", 1, Piece::Kind::Text},
+    {L" yet.\n"},
+};
+inline constexpr Piece MSG_STATS_UNREADABLE[] = {
+    {L"The launch statistics in ", 1, Piece::Kind::Text},
+    {L" cannot be read. They are started anew on the next launch.\n"},
+};
+inline constexpr Piece MSG_STATS_PROMETHEUS_FAILED[] = {
+    {L"Could not write the Prometheus metrics to ", 1, Piece::Kind::Text},
+    {L".\n"},
+};
+inline constexpr Piece MSG_RESET_UNREGISTERED[] = {
+    {L"The distribution was unregistered, but registering it again from its snapshot failed: it is no longer installed.\n"
+     L"Launch the app again or run it with install to install it anew from its installation image.\n"},
+};
+}  // namespace Pieces
+
+inline constexpr Message<Hex> MSG_WSL_REGISTER_DISTRIBUTION_FAILED{1001, Pieces::MSG_WSL_REGISTER_DISTRIBUTION_FAILED};
+inline constexpr Message<Hex> MSG_WSL_CONFIGURE_DISTRIBUTION_FAILED{1002, Pieces::MSG_WSL_CONFIGURE_DISTRIBUTION_FAILED};
+inline constexpr Message<Text, Hex> MSG_WSL_LAUNCH_INTERACTIVE_FAILED{1003, Pieces::MSG_WSL_LAUNCH_INTERACTIVE_FAILED};
+inline constexpr Message<Text, Hex> MSG_WSL_LAUNCH_FAILED{1004, Pieces::MSG_WSL_LAUNCH_FAILED};
+inline constexpr Message<> MSG_USAGE{1005, Pieces::MSG_USAGE};
+inline constexpr Message<> MSG_STATUS_INSTALLING{1006, Pieces::MSG_STATUS_INSTALLING};
+inline constexpr Message<> MSG_INSTALL_SUCCESS{1007, Pieces::MSG_INSTALL_SUCCESS};
+inline constexpr Message<Hex, Text> MSG_ERROR_CODE{1008, Pieces::MSG_ERROR_CODE};
+inline constexpr Message<> MSG_ENTER_USERNAME{1009, Pieces::MSG_ENTER_USERNAME};
+inline constexpr Message<> MSG_CREATE_USER_PROMPT{1010, Pieces::MSG_CREATE_USER_PROMPT};
+inline constexpr Message<> MSG_PRESS_A_KEY{1011, Pieces::MSG_PRESS_A_KEY};
+inline constexpr Message<> MSG_INSTALL_ALREADY_EXISTS{1013, Pieces::MSG_INSTALL_ALREADY_EXISTS};
+inline constexpr Message<> MSG_ENABLE_VIRTUALIZATION{1014, Pieces::MSG_ENABLE_VIRTUALIZATION};
+inline constexpr Message<Text> MSG_INSTALL_IMAGE_CORRUPTED{1015, Pieces::MSG_INSTALL_IMAGE_CORRUPTED};
+inline constexpr Message<Unsigned, Unsigned, Unsigned> MSG_INSTALL_IMAGE_VERIFIED{1016, Pieces::MSG_INSTALL_IMAGE_VERIFIED};
+inline constexpr Message<Hex> MSG_WSL_GET_DISTRIBUTION_CONFIGURATION_FAILED{1017, Pieces::MSG_WSL_GET_DISTRIBUTION_CONFIGURATION_FAILED};
+inline constexpr Message<Unsigned, Unsigned, Hex> MSG_STATUS{1018, Pieces::MSG_STATUS};
+inline constexpr Message<NarrowText> MSG_STATUS_ENVIRONMENT_VARIABLE{1019, Pieces::MSG_STATUS_ENVIRONMENT_VARIABLE};
+inline constexpr Message<> MSG_STATUS_NOT_INSTALLED{1020, Pieces::MSG_STATUS_NOT_INSTALLED};
+inline constexpr Message<Text> MSG_INVALID_USERNAME{1021, Pieces::MSG_INVALID_USERNAME};
+inline constexpr Message<> MSG_USERNAME_ALREADY_EXISTS{1022, Pieces::MSG_USERNAME_ALREADY_EXISTS};
+inline constexpr Message<Unsigned, Unsigned, Unsigned, Unsigned, Text> MSG_BATCH_COMMAND_FINISHED{1023, Pieces::MSG_BATCH_COMMAND_FINISHED};
+inline constexpr Message<Unsigned, Unsigned> MSG_BATCH_SUMMARY{1024, Pieces::MSG_BATCH_SUMMARY};
+inline constexpr Message<Text> MSG_BATCH_READ_FAILED{1025, Pieces::MSG_BATCH_READ_FAILED};
+inline constexpr Message<Text> MSG_BATCH_SESSION_FAILED{1026, Pieces::MSG_BATCH_SESSION_FAILED};
+inline constexpr Message<Unsigned, Unsigned> MSG_BROKER_LISTENING{1027, Pieces::MSG_BROKER_LISTENING};
+inline constexpr Message<> MSG_BROKER_ALREADY_RUNNING{1028, Pieces::MSG_BROKER_ALREADY_RUNNING};
+inline constexpr Message<Text> MSG_BROKER_REQUEST_FAILED{1029, Pieces::MSG_BROKER_REQUEST_FAILED};
+inline constexpr Message<Unsigned, Unsigned, Text, Text> MSG_PARALLEL_JOB_FAILED{1030, Pieces::MSG_PARALLEL_JOB_FAILED};
+inline constexpr Message<Unsigned, Unsigned, Unsigned, Unsigned> MSG_PARALLEL_SUMMARY{1031, Pieces::MSG_PARALLEL_SUMMARY};
+inline constexpr Message<Text, Unsigned, Unsigned, Unsigned> MSG_INSTANCE_INSTALLED{1032, Pieces::MSG_INSTANCE_INSTALLED};
+inline constexpr Message<Text, Text> MSG_INSTANCE_FAILED{1033, Pieces::MSG_INSTANCE_FAILED};
+inline constexpr Message<Unsigned, Unsigned, Unsigned, Unsigned, Unsigned, Unsigned> MSG_INSTANCES_SUMMARY{1034, Pieces::MSG_INSTANCES_SUMMARY};
+inline constexpr Message<Unsigned> MSG_INSTALL_FROM_IMAGE_CACHE{1035, Pieces::MSG_INSTALL_FROM_IMAGE_CACHE};
+inline constexpr Message<Unsigned, Unsigned> MSG_INSTALL_FROM_IMAGE_CACHE_SAVED{1036, Pieces::MSG_INSTALL_FROM_IMAGE_CACHE_SAVED};
+inline constexpr Message<Hex> MSG_WSL_UNREGISTER_DISTRIBUTION_FAILED{1037, Pieces::MSG_WSL_UNREGISTER_DISTRIBUTION_FAILED};
+inline constexpr Message<Unsigned, Unsigned, Unsigned> MSG_SNAPSHOT_TAKEN{1038, Pieces::MSG_SNAPSHOT_TAKEN};
+inline constexpr Message<Text> MSG_SNAPSHOT_FAILED{1039, Pieces::MSG_SNAPSHOT_FAILED};
+inline constexpr Message<> MSG_SNAPSHOT_MISSING{1040, Pieces::MSG_SNAPSHOT_MISSING};
+inline constexpr Message<Unsigned> MSG_RESET_SUCCESS{1041, Pieces::MSG_RESET_SUCCESS};
+inline constexpr Message<NarrowText> MSG_STATS{1042, Pieces::MSG_STATS};
+inline constexpr Message<Text> MSG_STATS_EMPTY{1043, Pieces::MSG_STATS_EMPTY};
+inline constexpr Message<Text> MSG_STATS_UNREADABLE{1044, Pieces::MSG_STATS_UNREADABLE};
+inline constexpr Message<Text> MSG_STATS_PROMETHEUS_FAILED{1045, Pieces::MSG_STATS_PROMETHEUS_FAILED};
+inline constexpr Message<> MSG_RESET_UNREGISTERED{1046, Pieces::MSG_RESET_UNREGISTERED};
+}  // namespace Ubuntu::Messages::Catalog
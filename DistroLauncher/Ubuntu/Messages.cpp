@@ -0,0 +1,93 @@
+#include "Messages.h"
+#include "Utf8.h"
+
+namespace Ubuntu::Messages {
+namespace {
+// Appends [number] in [base], without leading zeros.
+void appendNumber(Output& out, std::uint32_t number, std::uint32_t base);
+
+// Appends [text], decoded from UTF-8.
+void appendNarrow(Output& out, std::string_view text);
+}  // namespace
+
+void Output::Append(std::wstring_view text) {
+  while (!text.empty()) {
+    if (size_ == Capacity) {
+      Flush();
+    }
+    auto count = text.size() < Capacity - size_ ? text.size() : Capacity - size_;
+    text.copy(buffer_ + size_, count);
+    size_ += count;
+    text.remove_prefix(count);
+  }
+}
+
+void Output::Append(wchar_t c) {
+  if (size_ == Capacity) {
+    Flush();
+  }
+  buffer_[size_++] = c;
+}
+
+void Output::Flush() {
+  if (size_ > 0) {
+    flush_(context_, {buffer_, size_});
+    size_ = 0;
+  }
+}
+
+void Format(const Piece* pieces, std::size_t count, const Argument* arguments, Output& out) {
+  for (std::size_t i = 0; i < count; ++i) {
+    const auto& piece = pieces[i];
+    out.Append(piece.literal);
+    if (piece.insert == 0) {
+      continue;
+    }
+    const auto& argument = arguments[piece.insert - 1];
+    switch (piece.kind) {
+      case Piece::Kind::Text:
+        out.Append(argument.text);
+        break;
+      case Piece::Kind::NarrowText:
+        appendNarrow(out, argument.narrowText);
+        break;
+      case Piece::Kind::Unsigned:
+        appendNumber(out, argument.number, 10);
+        break;
+      case Piece::Kind::Hex:
+        appendNumber(out, argument.number, 16);
+        break;
+      case Piece::Kind::None:
+        break;
+    }
+  }
+}
+
+namespace {
+void appendNumber(Output& out, std::uint32_t number, std::uint32_t base) {
+  static constexpr wchar_t digits[] = L"0123456789abcdef";
+  wchar_t reversed[32];
+  std::size_t size = 0;
+  do {
+    reversed[size++] = digits[number % base];
+    number /= base;
+  } while (number != 0);
+  while (size > 0) {
+    out.Append(reversed[--size]);
+  }
+}
+
+void appendNarrow(Output& out, std::string_view text) {
+  for (std::size_t i = 0; i < text.size();) {
+    auto c = DecodeUtf8(text, i);
+    if (sizeof(wchar_t) == 2 && c >= 0x10000) {
+      c -= 0x10000;
+      out.Append(static_cast<wchar_t>(0xD800 + (c >> 10)));
+      out.Append(static_cast<wchar_t>(0xDC00 + (c & 0x3FF)));
+    } else {
+      out.Append(static_cast<wchar_t>(c));
+    }
+  }
+}
+}  // namespace
+}  // namespace Ubuntu::Messages
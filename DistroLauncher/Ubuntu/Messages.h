@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// The launcher's messages, compiled out of messages.mc into MessageCatalog.h by CompileMessages
+// (see tests/CMakeLists.txt), and their formatting. The inserts a message is given are checked
+// against those messages.mc declares at compile time, and formatting allocates nothing, the text
+// being already split around the inserts. It doesn't depend on any Windows API.
+namespace Ubuntu::Messages {
+// What the inserts of a message take, as written in messages.mc.
+// %n: a string.
+struct Text {
+  using Type = std::wstring_view;
+};
+// %n!S!: a narrow string, in UTF-8.
+struct NarrowText {
+  using Type = std::string_view;
+};
+// %n!u!: an unsigned number.
+struct Unsigned {
+  using Type = std::uint32_t;
+};
+// %n!x!: an unsigned number, in lowercase hex.
+struct Hex {
+  using Type = std::uint32_t;
+};
+
+// Text up to an insert, if any.
+struct Piece {
+  enum class Kind : std::uint8_t { None, Text, NarrowText, Unsigned, Hex };
+
+  std::wstring_view literal;
+  // Which insert follows, from 1.
+  std::uint8_t insert = 0;
+  Kind kind = Kind::None;
+};
+
+// A message whose inserts, %1 first, take [Inserts].
+template <typename... Inserts>
+struct Message {
+  template <std::size_t Count>
+  constexpr Message(std::uint32_t id, const Piece (&pieces)[Count])
+      : id{id}, pieces{pieces}, count{Count} {}
+
+  std::uint32_t id;
+  const Piece* pieces;
+  std::size_t count;
+};
+
+// The value of an insert.
+struct Argument {
+  Argument() = default;
+  Argument(std::wstring_view text) : text{text} {}
+  Argument(std::string_view narrowText) : narrowText{narrowText} {}
+  Argument(std::uint32_t number) : number{number} {}
+
+  std::wstring_view text;
+  std::string_view narrowText;
+  std::uint32_t number = 0;
+};
+
+// A fixed buffer messages are formatted into, handed to [flush] whenever full and once done, so
+// that a message is usually written out at once.
+class Output {
+ public:
+  static constexpr std::size_t Capacity = 8192;
+  using FlushFunction = void (*)(void* context, std::wstring_view text);
+
+  Output(FlushFunction flush, void* context) : flush_{flush}, context_{context} {}
+  ~Output() { Flush(); }
+
+  Output(const Output&) = delete;
+  Output& operator=(const Output&) = delete;
+
+  void Append(std::wstring_view text);
+  void Append(wchar_t c);
+  void Flush();
+
+ private:
+  FlushFunction flush_;
+  void* context_;
+  std::size_t size_ = 0;
+  wchar_t buffer_[Capacity];
+};
+
+// Formats the [count] [pieces] of a message with [arguments], one per insert, into [out].
+void Format(const Piece* pieces, std::size_t count, const Argument* arguments, Output& out);
+
+template <typename... Inserts>
+void Format(const Message<Inserts...>& message, Output& out,
+            typename Inserts::Type... arguments) {
+  // One more, as there can't be arrays of none.
+  const Argument values[] = {Argument{arguments}..., Argument{}};
+  Format(message.pieces, message.count, values, out);
+}
+}  // namespace Ubuntu::Messages
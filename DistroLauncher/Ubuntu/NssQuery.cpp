@@ -0,0 +1,91 @@
+#include "NssQuery.h"
+
+namespace Ubuntu {
+namespace {
+const char* describe(NssQuery::Kind kind);
+}  // namespace
+
+std::string NssQuery::Command() const {
+  std::string command = "getent passwd";
+  switch (kind) {
+    case Kind::PointLookup:
+      command += ' ';
+      command += ShellQuote(name);
+      break;
+    case Kind::UidRangeProbe:
+      for (auto uid = firstUid; uid <= lastUid; ++uid) {
+        command += ' ';
+        command += std::to_string(uid);
+      }
+      break;
+    default:
+      break;
+  }
+  return command;
+}
+
+bool NssQuery::IsConclusive(const DefaultUserSearch& search) const {
+  switch (kind) {
+    case Kind::PointLookup:
+      return search.Candidate().has_value();
+    case Kind::UidRangeProbe:
+      // Anyone not probed has a higher UID than anyone found, as long as the probe started at the
+      // lowest regular UID.
+      return firstUid <= DefaultUserSearch::FirstRegularUid && search.Candidate().has_value();
+    default:
+      return true;
+  }
+}
+
+std::vector<NssQuery> PlanNssQueries(std::string_view name, const std::string* nsswitch) {
+  std::vector<NssQuery> plan;
+  if (!name.empty()) {
+    // If the user doesn't exist, only the enumeration can tell the database isn't empty.
+    plan.push_back({NssQuery::Kind::PointLookup, std::string{name}});
+  } else if (nsswitch != nullptr && !PasswdIsLocal(*nsswitch)) {
+    // Enumerating a directory can take long, or be disabled altogether as with sssd by default,
+    // while local users are cheap to list anyway.
+    plan.push_back({NssQuery::Kind::UidRangeProbe, {}, DefaultUserSearch::FirstRegularUid,
+                    DefaultUserSearch::FirstRegularUid + UidProbeSize - 1});
+  }
+  plan.push_back({NssQuery::Kind::Enumeration});
+  return plan;
+}
+
+std::string FormatNssQueryRecords(const std::vector<NssQueryRecord>& records) {
+  std::string text;
+  for (const auto& record : records) {
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(record.elapsed).count();
+    text += describe(record.kind);
+    text += ": " + std::to_string(ms) + " ms, " + std::to_string(record.usersSeen) + " user(s), ";
+    text += record.conclusive ? "conclusive\n" : "inconclusive\n";
+  }
+  return text;
+}
+
+std::string ShellQuote(std::string_view word) {
+  std::string quoted = "'";
+  for (char c : word) {
+    if (c == '\'') {
+      quoted += "'\\''";
+    } else {
+      quoted += c;
+    }
+  }
+  quoted += '\'';
+  return quoted;
+}
+
+namespace {
+const char* describe(NssQuery::Kind kind) {
+  switch (kind) {
+    case NssQuery::Kind::PointLookup:
+      return "point lookup";
+    case NssQuery::Kind::UidRangeProbe:
+      return "UID range probe";
+    default:
+      return "enumeration";
+  }
+}
+}  // namespace
+}  // namespace Ubuntu
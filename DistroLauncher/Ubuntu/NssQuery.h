@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Passwd.h"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Planning how to ask the NSS passwd database for the default user candidate without enumerating
+// it whenever a cheaper query can settle the answer. It doesn't depend on any Windows API.
+namespace Ubuntu {
+// One getent invocation looking for the default user candidate.
+struct NssQuery {
+  enum class Kind {
+    // `getent passwd <name>`: a single indexed lookup.
+    PointLookup,
+    // `getent passwd <uid>...` over the lowest regular UIDs: a bounded number of lookups.
+    UidRangeProbe,
+    // `getent passwd`: the whole database, possibly over the network.
+    Enumeration,
+  };
+
+  Kind kind = Kind::Enumeration;
+  // The user looked up by a PointLookup.
+  std::string name;
+  // The UIDs looked up by a UidRangeProbe, both included.
+  unsigned long firstUid = 0;
+  unsigned long lastUid = 0;
+
+  // The command line running this query, ready for the shell.
+  std::string Command() const;
+
+  // Whether the candidate found by [search] fed with the output of this query is the final answer,
+  // i.e. no other query could change it.
+  bool IsConclusive(const DefaultUserSearch& search) const;
+
+  // Exit code of getent when some of the keys looked up don't exist, which isn't an error here.
+  static constexpr int NotFoundExitCode = 2;
+};
+
+// The number of UIDs a UidRangeProbe looks up.
+constexpr unsigned long UidProbeSize = 64;
+
+// Returns the queries to try in order until one is conclusive, based on what is known upfront: the
+// default user [name] set in /etc/wsl.conf, if any, and the contents of /etc/nsswitch.conf, if
+// known. The last one is always a full enumeration, which is always conclusive.
+std::vector<NssQuery> PlanNssQueries(std::string_view name, const std::string* nsswitch);
+
+// What came out of running a query, for the record.
+struct NssQueryRecord {
+  NssQuery::Kind kind;
+  std::chrono::steady_clock::duration elapsed;
+  std::size_t usersSeen;
+  bool conclusive;
+};
+
+// Quotes [word] for a POSIX shell.
+std::string ShellQuote(std::string_view word);
+
+// One line per query, such as "point lookup: 12 ms, 1 user(s), conclusive".
+std::string FormatNssQueryRecords(const std::vector<NssQueryRecord>& records);
+}  // namespace Ubuntu
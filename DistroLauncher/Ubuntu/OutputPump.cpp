@@ -0,0 +1,76 @@
+#include "OutputPump.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Ubuntu {
+bool ChunkedBuffer::Append(std::string_view data) {
+  if (overflowed_) {
+    return false;
+  }
+  if (data.size() > ceiling_ - size_) {
+    data = data.substr(0, ceiling_ - size_);
+    overflowed_ = true;
+  }
+
+  while (!data.empty()) {
+    std::size_t used = size_ % ChunkSize;
+    if (used == 0 && size_ / ChunkSize == chunks_.size()) {
+      chunks_.push_back(std::make_unique<char[]>(ChunkSize));
+    }
+    std::size_t n = std::min(ChunkSize - used, data.size());
+    std::memcpy(chunks_.back().get() + used, data.data(), n);
+    size_ += n;
+    data.remove_prefix(n);
+  }
+  return !overflowed_;
+}
+
+std::string ChunkedBuffer::str() const {
+  std::string result;
+  result.reserve(size_);
+  std::size_t remaining = size_;
+  for (const auto& chunk : chunks_) {
+    std::size_t n = std::min(ChunkSize, remaining);
+    result.append(chunk.get(), n);
+    remaining -= n;
+  }
+  return result;
+}
+
+OutputPump::OutputPump(ReadFunction read, std::size_t ceiling)
+    : read_{std::move(read)}, output_{ceiling} {
+  start([this](std::string_view data) {
+    output_.Append(data);
+    return true;
+  });
+}
+
+OutputPump::OutputPump(ReadFunction read, ConsumeFunction consume)
+    : read_{std::move(read)}, output_{0} {
+  start(std::move(consume));
+}
+
+void OutputPump::start(ConsumeFunction consume) {
+  thread_ = std::thread{[this, consume = std::move(consume)] {
+    // Big enough to empty a pipe buffer in one go.
+    auto buffer = std::make_unique<char[]>(ChunkedBuffer::ChunkSize);
+    while (std::size_t count = read_(buffer.get(), ChunkedBuffer::ChunkSize)) {
+      if (!consume({buffer.get(), count})) {
+        stopped_ = true;
+        return;
+      }
+    }
+  }};
+}
+
+OutputPump::~OutputPump() {
+  Join();
+}
+
+void OutputPump::Join() {
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+}  // namespace Ubuntu
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Draining the output of child processes while they run. It doesn't depend on any Windows API, the
+// actual reads being provided by the caller.
+namespace Ubuntu {
+// Growable storage made of fixed-size chunks, so growing never moves what was already stored.
+class ChunkedBuffer {
+ public:
+  static constexpr std::size_t ChunkSize = 64 * 1024;
+
+  // Stores at most [ceiling] bytes.
+  explicit ChunkedBuffer(std::size_t ceiling = std::numeric_limits<std::size_t>::max())
+      : ceiling_{ceiling} {}
+
+  // Appends [data]. Returns false if the ceiling prevented storing all of it, in which case nothing
+  // else is ever stored.
+  bool Append(std::string_view data);
+
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  // Whether some data was dropped because of the ceiling.
+  bool Overflowed() const { return overflowed_; }
+
+  // Copies the contents into a contiguous string.
+  std::string str() const;
+
+ private:
+  std::vector<std::unique_ptr<char[]>> chunks_;
+  std::size_t size_ = 0;
+  std::size_t ceiling_;
+  bool overflowed_ = false;
+};
+
+// Reads up to [size] bytes into [buffer], blocking until something is available. Returns the number
+// of bytes read, 0 meaning the end of the stream or an error.
+using ReadFunction = std::function<std::size_t(char* buffer, std::size_t size)>;
+
+// Receives the [data] read so far, in order. Returns false once it had enough.
+using ConsumeFunction = std::function<bool(std::string_view data)>;
+
+// Drains a stream into a ChunkedBuffer on a background thread until the end of the stream. Once the
+// ceiling is reached the stream is still drained, so the writer never blocks, but the data dropped.
+class OutputPump {
+ public:
+  OutputPump(ReadFunction read, std::size_t ceiling);
+
+  // Hands the stream to [consume] as it arrives instead of storing it, stopping as soon as
+  // [consume] returns false. Output() stays empty.
+  OutputPump(ReadFunction read, ConsumeFunction consume);
+
+  // Waits for the end of the stream.
+  ~OutputPump();
+
+  OutputPump(const OutputPump&) = delete;
+  OutputPump& operator=(const OutputPump&) = delete;
+
+  // Waits for the end of the stream. The output must not be accessed before.
+  void Join();
+
+  // The pumping thread, e.g. to cancel a blocking read.
+  std::thread::native_handle_type NativeHandle() { return thread_.native_handle(); }
+
+  const ChunkedBuffer& Output() const { return output_; }
+
+  // Whether the consumer stopped the pump before the end of the stream.
+  bool Stopped() const { return stopped_; }
+
+ private:
+  void start(ConsumeFunction consume);
+
+  ReadFunction read_;
+  ChunkedBuffer output_;
+  bool stopped_ = false;
+  std::thread thread_;
+};
+}  // namespace Ubuntu
@@ -0,0 +1,119 @@
+#include "Parallel.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace Ubuntu::Parallel {
+namespace {
+// Runs the command at [index], as Run does.
+JobResult runJob(WslBackend& wsl, std::size_t index, const std::string& command,
+                 const Options& options, const LineFunction& line, std::mutex& callbacks);
+}  // namespace
+
+void LineSplitter::Feed(std::string_view chunk) {
+  for (auto eol = chunk.find('\n'); eol != std::string_view::npos; eol = chunk.find('\n')) {
+    if (pending_.empty()) {
+      line_(chunk.substr(0, eol));
+    } else {
+      pending_ += chunk.substr(0, eol);
+      line_(pending_);
+      pending_.clear();
+    }
+    chunk.remove_prefix(eol + 1);
+  }
+  pending_ += chunk;
+  while (pending_.size() >= MaxLineSize) {
+    line_(std::string_view{pending_}.substr(0, MaxLineSize));
+    pending_.erase(0, MaxLineSize);
+  }
+}
+
+void LineSplitter::Finish() {
+  if (!pending_.empty()) {
+    line_(pending_);
+    pending_.clear();
+  }
+}
+
+unsigned long Result::ExitCode() const {
+  for (const auto& job : jobs) {
+    if (!job.exitCode) {
+      return 1;
+    }
+    if (*job.exitCode != 0) {
+      return *job.exitCode;
+    }
+  }
+  return 0;
+}
+
+Result Run(WslBackend& wsl, const std::vector<std::string>& commands, const Options& options,
+           const LineFunction& line, const FinishedFunction& finished) {
+  Result result;
+  if (commands.empty()) {
+    return result;
+  }
+
+  Trace::Span span{"Parallel::Run"};
+  result.jobs.resize(commands.size());
+  std::mutex callbacks;
+  std::atomic<std::size_t> next{0};
+  auto work = [&] {
+    for (auto index = next++; index < commands.size(); index = next++) {
+      auto job = runJob(wsl, index, commands[index], options, line, callbacks);
+      std::scoped_lock lock{callbacks};
+      result.jobs[index] = job;
+      if (finished) {
+        finished(job);
+      }
+    }
+  };
+
+  // Each worker keeps a launch going until the list is exhausted.
+  std::vector<std::thread> workers;
+  const auto count = std::min(std::max<std::size_t>(options.jobs, 1), commands.size());
+  for (std::size_t i = 1; i < count; ++i) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  span.SetDetail(std::to_string(commands.size()) + " command(s), " + std::to_string(count) +
+                 " at once");
+  return result;
+}
+
+namespace {
+JobResult runJob(WslBackend& wsl, std::size_t index, const std::string& command,
+                 const Options& options, const LineFunction& line, std::mutex& callbacks) {
+  JobResult job;
+  job.index = index;
+  LineSplitter splitter{[&](std::string_view text) {
+    std::scoped_lock lock{callbacks};
+    line(index, text);
+  }};
+  Batch::Options batchOptions;
+  batchOptions.windowsDirectory = options.windowsDirectory;
+
+  // A batch of one, for the exit code to be told apart from that of the session.
+  auto start = std::chrono::steady_clock::now();
+  auto batch = Batch::Run(
+      wsl, {command}, batchOptions, [&](std::string_view data) { splitter.Feed(data); }, {});
+  splitter.Finish();
+  job.elapsed = std::chrono::steady_clock::now() - start;
+
+  if (!batch.error.empty()) {
+    job.error = std::move(batch.error);
+  } else if (batch.commands.empty()) {
+    job.error = L"the session ended before the command did";
+  } else {
+    job.exitCode = batch.commands.front().exitCode;
+  }
+  return job;
+}
+}  // namespace
+}  // namespace Ubuntu::Parallel
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Batch.h"
+#include "WslBackend.h"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Running a list of commands concurrently, as `run --parallel` does, each through a launch of its
+// own so that none waits for another, be it slow or failing. Their output is split into lines, so
+// that those of different commands can be told apart once interleaved. It doesn't depend on any
+// Windows API, the distro being reached through a WslBackend.
+namespace Ubuntu::Parallel {
+// Splits output fed in chunks into lines, without their line feed.
+class LineSplitter {
+ public:
+  using LineFunction = std::function<void(std::string_view line)>;
+
+  // Lines longer than this are handed out in pieces, so that a command outputting no line feed
+  // can't exhaust the memory.
+  static constexpr std::size_t MaxLineSize = 64 * 1024;
+
+  explicit LineSplitter(LineFunction line) : line_{std::move(line)} {}
+
+  void Feed(std::string_view chunk);
+
+  // Hands out the last line, if it didn't end with a line feed.
+  void Finish();
+
+ private:
+  LineFunction line_;
+  std::string pending_;
+};
+
+struct Options {
+  // How many commands run at once, at least one.
+  std::size_t jobs = 1;
+  // The Windows directory the commands run in, translated by wslpath. The home directory if empty.
+  std::string windowsDirectory;
+};
+
+struct JobResult {
+  // The position of the command in the list.
+  std::size_t index = 0;
+  // std::nullopt if the command couldn't run to its end.
+  std::optional<unsigned long> exitCode;
+  // Why, if it couldn't.
+  std::wstring error;
+  // From the launch to the end of the output.
+  std::chrono::nanoseconds elapsed{0};
+
+  bool Succeeded() const { return exitCode == 0UL; }
+};
+
+struct Result {
+  // In the order of the list, whatever the order they finished in.
+  std::vector<JobResult> jobs;
+
+  // The exit code of the first command in the list which failed, 1 if it couldn't run to its end,
+  // 0 if none failed.
+  unsigned long ExitCode() const;
+};
+
+using LineFunction = std::function<void(std::size_t index, std::string_view line)>;
+using FinishedFunction = std::function<void(const JobResult& result)>;
+
+// Runs [commands] as told by [options], each in its own session with stdin redirected from
+// /dev/null and stderr merged into stdout. Hands each line they output to [line] as soon as it is
+// complete, and each result to [finished] as soon as the command exits, but never two calls at
+// once, so that the callers needn't synchronize.
+Result Run(WslBackend& wsl, const std::vector<std::string>& commands, const Options& options,
+           const LineFunction& line, const FinishedFunction& finished);
+}  // namespace Ubuntu::Parallel
@@ -0,0 +1,296 @@
+#include "Passwd.h"
+#include "DelimiterScanner.h"
+#include "SplitView.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <system_error>
+
+namespace Ubuntu {
+namespace {
+// Builds the entry out of the fields we care about, already split.
+std::optional<UserEntry> makeUserEntry(std::string_view name, std::string_view uidField,
+                                       std::string_view shell);
+
+// Parses the lines of [block], passing the well-formed entries to [onEntry] until it returns false,
+// using [positions] as scratch space. Returns false if [onEntry] stopped the parsing.
+template <typename OnEntry>
+bool parseBlock(std::string_view block, std::vector<std::uint32_t>& positions, OnEntry&& onEntry);
+
+// Trims blanks (and the carriage return of CRLF files) from both ends of [str].
+std::string_view trim(std::string_view str);
+
+// Lines longer than that are too broken to be worth keeping while waiting for their end.
+constexpr std::size_t maxLineSize = 64 * 1024;
+
+// How much of the contents is scanned at once: keeps the positions found in the cache and bounded
+// in memory no matter the size of the database.
+constexpr std::size_t blockSize = 1024 * 1024;
+}  // namespace
+
+std::optional<UserEntry> UserEntryFromString(std::string_view line) {
+  SplitView fields{line, ':'};
+  // Field 0: name
+  auto name = fields.next();
+  if (!name || name->empty()) {
+    return std::nullopt;
+  }
+  // Field 1: encryption flag, unused.
+  auto unused = fields.next();
+  if (!unused) {
+    return std::nullopt;
+  }
+  // Field 2: UID
+  auto u = fields.next();
+  if (!u) {
+    return std::nullopt;
+  }
+  // Fields 3, 4 and 5: unused in this context, but still must be checked, otherwise the line is
+  // ill-formed.
+  for (int i = 0; i < 3; ++i) {
+    if (unused = fields.next(); !unused) {
+      return std::nullopt;
+    }
+  }
+  // Field 6: the login shell.
+  auto shell = fields.next();
+  if (!shell || shell->empty()) {
+    return std::nullopt;
+  }
+  return makeUserEntry(*name, *u, *shell);
+}
+
+std::vector<UserEntry> ParsePasswd(std::string_view contents) {
+  std::vector<UserEntry> users;
+  std::vector<std::uint32_t> positions;
+  // NOTE about ill-formed lines in passwd: this algorithm just skips them.
+  // Broken lines in /etc/passwd won't prevent the effects of the good lines.
+  // getent itself reports errors for broken lines but still output the good ones.
+  // The system behaves as if they don't exist. So we can ignore them as well.
+  for (bool first = true; !contents.empty(); first = false) {
+    // Blocks end with a whole line, unless a single line is longer than a block.
+    std::size_t end = contents.size();
+    if (end > blockSize) {
+      end = contents.rfind('\n', blockSize - 1);
+      if (end == std::string_view::npos) {
+        end = contents.find('\n', blockSize);
+      }
+      end = end == std::string_view::npos ? contents.size() : end + 1;
+    }
+    parseBlock(contents.substr(0, end), positions, [&users](UserEntry&& user) {
+      users.push_back(std::move(user));
+      return true;
+    });
+    if (first && end < contents.size()) {
+      // Assumes the rest of the contents look like the first block, sparing the reallocations.
+      users.reserve(users.size() * (contents.size() / end + 1));
+    }
+    contents.remove_prefix(end);
+  }
+  // Finally sort that vector by UID, unless the database already was.
+  auto byUid = [](const UserEntry& a, const UserEntry& b) { return a.uid < b.uid; };
+  if (!std::is_sorted(users.begin(), users.end(), byUid)) {
+    std::stable_sort(users.begin(), users.end(), byUid);
+  }
+  return users;
+}
+
+bool DefaultUserSearch::Feed(std::string_view chunk) {
+  auto add = [this](UserEntry&& user) { return Add(std::move(user)); };
+  while (!done_ && !chunk.empty()) {
+    if (partialLine_.empty() && !skippingLine_) {
+      // Whole lines are parsed straight from the chunk.
+      auto whole = chunk.rfind('\n');
+      if (whole != std::string_view::npos) {
+        parseBlock(chunk.substr(0, whole + 1), positions_, add);
+        chunk.remove_prefix(whole + 1);
+        continue;
+      }
+    }
+    // Completes the line started in a previous chunk.
+    auto newline = chunk.find('\n');
+    auto piece = chunk.substr(0, newline == std::string_view::npos ? chunk.size() : newline + 1);
+    chunk.remove_prefix(piece.size());
+    if (!skippingLine_) {
+      if (partialLine_.size() + piece.size() > maxLineSize) {
+        skippingLine_ = true;
+        partialLine_.clear();
+      } else {
+        partialLine_.append(piece);
+      }
+    }
+    if (newline != std::string_view::npos) {
+      if (!skippingLine_) {
+        parseBlock(partialLine_, positions_, add);
+      }
+      partialLine_.clear();
+      skippingLine_ = false;
+    }
+  }
+  return !done_;
+}
+
+void DefaultUserSearch::Finish() {
+  if (!done_ && !skippingLine_ && !partialLine_.empty()) {
+    parseBlock(partialLine_, positions_, [this](UserEntry&& user) { return Add(std::move(user)); });
+  }
+  partialLine_.clear();
+  skippingLine_ = false;
+}
+
+bool DefaultUserSearch::Add(UserEntry user) {
+  if (done_) {
+    return false;
+  }
+  ++usersSeen_;
+  if (!name_.empty()) {
+    if (user.name == name_) {
+      candidate_ = std::move(user);
+      done_ = true;
+    }
+    return !done_;
+  }
+  if (user.uid >= FirstRegularUid && user.hasLogin &&
+      (!candidate_ || user.uid < candidate_->uid)) {
+    candidate_ = std::move(user);
+    // Nobody can have a lower UID than the lowest possible one.
+    done_ = candidate_->uid == FirstRegularUid;
+  }
+  return !done_;
+}
+
+DefaultUserChoice ChooseDefaultUser(const DefaultUserSearch& search,
+                                    const std::function<unsigned long()>& currentUid) {
+  if (search.UsersSeen() == 0) {
+    // unexpectedly nothing to do
+    return {false};
+  }
+  const auto& found = search.Candidate();
+  // 1. We read the default user name from /etc/wsl.conf
+  if (!search.Name().empty()) {
+    // We still need the UID to be able to call the WSL API.
+    if (!found) {
+      // no UID, nothing to do, the system is in a bad state where the user requested in wsl.conf
+      // doesn't exist. We won't fix that.
+      return {};
+    }
+    return {true, found->uid};
+  }
+  // 2. Check for the Windows registry
+  // This returns the UID of the current default user, most likely root, unless someone set a
+  // different UID via the registry editor or WSL API, for which case we are done.
+  if (currentUid() != 0) {
+    return {};
+  }
+
+  // 3. Finally, the first non-system user.
+  if (found) {
+    return {true, found->uid};
+  }
+
+  return {false};
+}
+
+bool PasswdIsLocal(std::string_view contents) {
+  for (auto line : SplitView{contents, '\n'}) {
+    line = trim(line);
+    static constexpr std::string_view database = "passwd:";
+    if (line.substr(0, database.size()) != database) {
+      continue;
+    }
+    auto sources = line.substr(database.size());
+    sources = sources.substr(0, sources.find('#'));
+    while (!(sources = trim(sources)).empty()) {
+      auto source = sources.substr(0, sources.find_first_of(" \t"));
+      sources.remove_prefix(source.size());
+      // [...] are actions on the outcome of the previous source.
+      // systemd only adds dynamic service users, which cannot log in.
+      if (source.front() == '[' || source == "files" || source == "compat" || source == "systemd") {
+        continue;
+      }
+      return false;
+    }
+    return true;
+  }
+  return true;
+}
+
+namespace {
+std::optional<UserEntry> makeUserEntry(std::string_view name, std::string_view uidField,
+                                       std::string_view shell) {
+  unsigned long uid = -1;
+  auto ud = std::from_chars(uidField.data(), uidField.data() + uidField.size(), uid);
+  if (ud.ec != std::errc{}) {
+    // cannot convert UID to an integer
+    return std::nullopt;
+  }
+
+  // For this particular case it seems that an exclusion list is easier than a
+  // positive list of what shells are valid as there are more valid shell choices (sh, bash, csh,
+  // dash, ksh, tcsh, zsh, fish, ...).
+  bool hasLogin =
+      (shell.find("/sync") == std::string::npos && shell.find("/nologin") == std::string::npos &&
+       shell.find("/false") == std::string::npos);
+
+  return UserEntry{std::string{name}, uid, hasLogin};
+}
+
+template <typename OnEntry>
+bool parseBlock(std::string_view block, std::vector<std::uint32_t>& positions, OnEntry&& onEntry) {
+  positions.clear();
+  ScanDelimiters(block, positions);
+
+  // Only the first 7 colons of a line matter: the 7th, if any, ends the shell field.
+  std::array<std::uint32_t, 7> colons;
+  std::size_t colonCount = 0;
+  std::size_t lineStart = 0;
+  auto parseLine = [&](std::size_t lineEnd) {
+    bool more = true;
+    // Lines with less than 7 fields are ill-formed.
+    if (colonCount >= 6) {
+      std::size_t shellEnd = colonCount > 6 ? colons[6] : lineEnd;
+      auto name = block.substr(lineStart, colons[0] - lineStart);
+      auto uid = block.substr(colons[1] + 1, colons[2] - colons[1] - 1);
+      auto shell = block.substr(colons[5] + 1, shellEnd - colons[5] - 1);
+      if (!name.empty() && !shell.empty()) {
+        if (auto user = makeUserEntry(name, uid, shell); user) {
+          more = onEntry(std::move(user.value()));
+        }
+      }
+    }
+    colonCount = 0;
+    return more;
+  };
+
+  for (auto position : positions) {
+    if (block[position] == ':') {
+      if (colonCount < colons.size()) {
+        colons[colonCount] = position;
+      }
+      ++colonCount;
+      continue;
+    }
+    if (!parseLine(position)) {
+      return false;
+    }
+    lineStart = position + 1;
+  }
+  // The last line may not be terminated.
+  if (lineStart < block.size()) {
+    return parseLine(block.size());
+  }
+  return true;
+}
+
+std::string_view trim(std::string_view str) {
+  static constexpr std::string_view blanks = " \t\r";
+  auto first = str.find_first_not_of(blanks);
+  if (first == std::string_view::npos) {
+    return {};
+  }
+  return str.substr(first, str.find_last_not_of(blanks) - first + 1);
+}
+}  // namespace
+}  // namespace Ubuntu
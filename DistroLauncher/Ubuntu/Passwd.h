@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Parsing the passwd database, as found in /etc/passwd or output by `getent passwd`, and the bits
+// of nsswitch.conf telling where it comes from. It doesn't depend on any Windows API.
+namespace Ubuntu {
+// Groups the pieces of information from a single user entry in the passwd database we care about.
+struct UserEntry {
+  std::string name;
+  unsigned long uid = -1;
+  bool hasLogin = false;
+};
+
+// Parses a string modelling a line of passwd into a UserEntry object.
+// We only care about login name, UID and the login shell, although the lines should have 7 fields:
+// ^NAME:ENCRYPTION:UID:...3 fields...:SHELL\n$
+// Returns std::nullopt on parse failure, the exact error for ill-formed lines is not needed.
+std::optional<UserEntry> UserEntryFromString(std::string_view line);
+
+// Parses passwd-formatted [contents] into user entries sorted by UID, skipping ill-formed lines.
+// Entries sharing a UID keep the order they had in [contents].
+//
+// Accepts exactly the lines UserEntryFromString does, but finds all separators with a single
+// vectorized pass over the buffer instead of splitting it line by line, which matters for the
+// directories with hundreds of thousands of users getent can return.
+std::vector<UserEntry> ParsePasswd(std::string_view contents);
+
+// Looks for the default user candidate in a passwd database read in chunks as it arrives, e.g. from
+// a running `getent passwd`, keeping nothing but the best candidate so far. The candidate is either
+// the user with the name given upfront or, without a name, the entry with the lowest UID in the
+// regular user range having a login shell, the first one seen winning ties.
+class DefaultUserSearch {
+ public:
+  // The lowest UID of a regular user.
+  static constexpr unsigned long FirstRegularUid = 1000;
+
+  // Looks for [name] or, if empty, for the first regular user.
+  explicit DefaultUserSearch(std::string name = {}) : name_{std::move(name)} {}
+
+  // Parses the next [chunk] of the database. Lines may span chunks. Returns false once the
+  // candidate can no longer change, meaning the rest of the database needn't be read.
+  bool Feed(std::string_view chunk);
+
+  // Parses what's left of an unterminated last line, once the database has been read to its end.
+  void Finish();
+
+  // Considers a single [user]. Returns false once the candidate can no longer change.
+  bool Add(UserEntry user);
+
+  // Whether the candidate can no longer change.
+  bool Done() const { return done_; }
+
+  // The number of well-formed entries seen.
+  std::size_t UsersSeen() const { return usersSeen_; }
+
+  const std::string& Name() const { return name_; }
+
+  // The best candidate found so far, if any.
+  const std::optional<UserEntry>& Candidate() const { return candidate_; }
+
+ private:
+  std::string name_;
+  std::optional<UserEntry> candidate_;
+  std::size_t usersSeen_ = 0;
+  bool done_ = false;
+  // The beginning of a line whose end is yet to come.
+  std::string partialLine_;
+  // Whether the line in progress is too long to be kept, thus dropped.
+  bool skippingLine_ = false;
+  std::vector<std::uint32_t> positions_;
+};
+
+// Outcome of the default user policy.
+struct DefaultUserChoice {
+  // False if no default user could be found.
+  bool ok = true;
+  // The UID to set as default, if any change is required.
+  std::optional<unsigned long> uid;
+};
+
+// Decides the default user out of a [search] for the user named in /etc/wsl.conf, if any: that user
+// if named and existing, otherwise the first regular user unless WSL already defaults to someone
+// other than root. The [currentUid] callback is only invoked if its result is needed.
+DefaultUserChoice ChooseDefaultUser(const DefaultUserSearch& search,
+                                    const std::function<unsigned long()>& currentUid);
+
+// Whether the passwd line of the nsswitch.conf [contents] lists nothing but local sources.
+bool PasswdIsLocal(std::string_view contents);
+}  // namespace Ubuntu
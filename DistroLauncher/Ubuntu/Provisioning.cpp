@@ -0,0 +1,181 @@
+#include "Provisioning.h"
+
+#include <charconv>
+#include <string>
+#include <utility>
+#include <string_view>
+#include <system_error>
+
+namespace Ubuntu::Provisioning {
+// Runs as the default user, which is still root right after registration.
+// Each step reports its exit code, so the launcher can tell "nothing found" from "failed to look".
+// The user records come last, once everything else is known. If cloud-init is enabled, the script
+// stops right after telling so: the launcher waits for cloud-init itself, and what it does may
+// change everything else.
+const wchar_t Script[] = LR"(
+export LC_ALL=C
+emit() { printf '%s %d\n%s\n' "$1" "${#2}" "$2"; }
+step() { emit step "$1 $2"; }
+
+# Allow WSL to generate a version based on Windows networking information.
+rm /etc/resolv.conf 2>/dev/null
+step resolv.conf $?
+
+# cloud-init is to be waited for if systemd and its service is enabled, unless the launcher already
+# knows there's nothing to wait for.
+cloudinit=disabled
+if [ -n "${skip_cloud_init}" ]; then
+  status=skipped
+elif status=$(systemctl is-system-running 2>/dev/null) || [ "${status}" != "offline" ] && systemctl is-enabled --quiet cloud-init.service 2>/dev/null; then
+  cloudinit=enabled
+fi
+emit systemd "${status}"
+emit cloud-init "${cloudinit}"
+if [ "${cloudinit}" = enabled ]; then
+  printf 'end 0\n\n'
+  exit 0
+fi
+
+if [ -f /etc/wsl.conf ]; then
+  conf=$(cat /etc/wsl.conf)
+  step wsl.conf $?
+  emit conf "${conf}"
+fi
+
+uid=$(id -u)
+step id $?
+emit uid "${uid}"
+
+# The launcher may already know the users from the install image.
+if [ -z "${skip_users}" ]; then
+  users=$(getent passwd)
+  step getent $?
+  printf '%s\n' "${users}" | awk 'length($0) > 0 { printf "user %d\n%s\n", length($0), $0 }'
+fi
+
+printf 'end 0\n\n'
+)";
+
+namespace {
+RecordType recordTypeFromTag(std::string_view tag) {
+  if (tag == "step") {
+    return RecordType::Step;
+  }
+  if (tag == "user") {
+    return RecordType::User;
+  }
+  if (tag == "conf") {
+    return RecordType::Conf;
+  }
+  if (tag == "uid") {
+    return RecordType::Uid;
+  }
+  if (tag == "systemd") {
+    return RecordType::Systemd;
+  }
+  if (tag == "cloud-init") {
+    return RecordType::CloudInit;
+  }
+  if (tag == "status") {
+    return RecordType::Status;
+  }
+  if (tag == "log") {
+    return RecordType::Log;
+  }
+  return RecordType::Unknown;
+}
+
+// Parses a record header, "<tag> <length>" without the newline.
+std::optional<std::pair<std::string_view, std::size_t>> parseHeader(std::string_view header) {
+  auto space = header.find(' ');
+  if (space == std::string_view::npos || space == 0) {
+    return std::nullopt;
+  }
+  std::size_t length = 0;
+  const char* last = header.data() + header.size();
+  auto [ptr, ec] = std::from_chars(header.data() + space + 1, last, length);
+  if (ec != std::errc{} || ptr != last) {
+    return std::nullopt;
+  }
+  return std::pair{header.substr(0, space), length};
+}
+}  // namespace
+
+std::optional<std::vector<Record>> ParseReply(std::string_view reply) {
+  std::vector<Record> records;
+  while (!reply.empty()) {
+    // Header: "<tag> <length>\n"
+    auto eol = reply.find('\n');
+    if (eol == std::string_view::npos) {
+      return std::nullopt;
+    }
+    auto header = parseHeader(reply.substr(0, eol));
+    if (!header) {
+      return std::nullopt;
+    }
+    auto [tag, length] = *header;
+    reply.remove_prefix(eol + 1);
+
+    // Payload, followed by a newline that is not accounted for in the length.
+    if (reply.size() <= length || reply[length] != '\n') {
+      return std::nullopt;
+    }
+    auto payload = reply.substr(0, length);
+    reply.remove_prefix(length + 1);
+
+    if (tag == "end") {
+      return records;
+    }
+    records.push_back(Record{recordTypeFromTag(tag), payload});
+  }
+
+  // Never saw the end record.
+  return std::nullopt;
+}
+
+void AppendRecord(std::string& out, std::string_view tag, std::string_view payload) {
+  out += tag;
+  out += ' ';
+  out += std::to_string(payload.size());
+  out += '\n';
+  out += payload;
+  out += '\n';
+}
+
+bool RecordReader::Feed(std::string_view chunk, const RecordFunction& record) {
+  if (failed_) {
+    return false;
+  }
+  pending_ += chunk;
+  std::string_view rest = pending_;
+  while (!rest.empty()) {
+    auto eol = rest.find('\n');
+    if (eol == std::string_view::npos) {
+      // Headers are short, a long line without one is garbage.
+      failed_ = rest.size() > MaxHeaderSize;
+      break;
+    }
+    auto header = parseHeader(rest.substr(0, eol));
+    if (!header || header->second > maxPayloadSize_) {
+      failed_ = true;
+      break;
+    }
+    auto [tag, length] = *header;
+    if (rest.size() < eol + 1 + length + 1) {
+      break;
+    }
+    auto payload = rest.substr(eol + 1, length);
+    if (rest[eol + 1 + length] != '\n') {
+      failed_ = true;
+      break;
+    }
+    rest.remove_prefix(eol + 1 + length + 1);
+    if (!record(tag, payload)) {
+      failed_ = true;
+      break;
+    }
+  }
+  pending_.erase(0, pending_.size() - rest.size());
+  return !failed_;
+}
+}  // namespace Ubuntu::Provisioning
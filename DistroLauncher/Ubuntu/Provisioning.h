@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The post-registration provisioning protocol.
+//
+// A single guest-side script performs every first-boot step the launcher needs and replies on its
+// stdout with a sequence of typed, length-prefixed records:
+//
+//   <tag> <payload length in bytes>\n<payload>\n
+//
+// The reply is always terminated by an `end` record, so a truncated reply can be told apart from a
+// complete one. This file only deals with the wire format; it doesn't depend on any Windows API.
+namespace Ubuntu::Provisioning {
+// The shell script run via WslLaunch right after the distro is registered.
+extern const wchar_t Script[];
+
+enum class RecordType {
+  Unknown,
+  // "<step name> <exit code>" of each step performed by the script.
+  Step,
+  // One line of the NSS passwd database.
+  User,
+  // The contents of /etc/wsl.conf, parsed by the launcher.
+  Conf,
+  // UID of the current default user.
+  Uid,
+  // Output of `systemctl is-system-running`, or "skipped" if not checked.
+  Systemd,
+  // "enabled" if cloud-init is to be waited for, which the launcher does itself, "disabled"
+  // otherwise.
+  CloudInit,
+  // Output of `cloud-init status`, see CloudInit.h.
+  Status,
+  // What a log followed by the launcher gained since it was last read.
+  Log,
+};
+
+struct Record {
+  RecordType type;
+  std::string_view payload;
+};
+
+// Splits a reply of the provisioning script into its records, which view into the [reply] buffer.
+// Unknown tags are preserved as RecordType::Unknown so older launchers can cope with newer scripts.
+// Returns std::nullopt if the reply is ill-formed or truncated.
+std::optional<std::vector<Record>> ParseReply(std::string_view reply);
+
+// Appends a record to [out], as the scripts do.
+void AppendRecord(std::string& out, std::string_view tag, std::string_view payload);
+
+// Parses records as they arrive in chunks, e.g. over a pipe, rather than a whole reply at once.
+class RecordReader {
+ public:
+  // Receives each record completed, viewing into a buffer only valid during the call. Returns false
+  // to stop reading.
+  using RecordFunction = std::function<bool(std::string_view tag, std::string_view payload)>;
+
+  // Refuses records longer than [maxPayloadSize] bytes, as the peer may not be trusted.
+  explicit RecordReader(std::size_t maxPayloadSize = 16 * 1024 * 1024)
+      : maxPayloadSize_{maxPayloadSize} {}
+
+  // Parses the next [chunk], handing each record completed to [record]. Returns false once the
+  // stream turned out ill-formed or [record] returned false, ignoring anything fed afterwards.
+  bool Feed(std::string_view chunk, const RecordFunction& record);
+
+ private:
+  static constexpr std::size_t MaxHeaderSize = 64;
+
+  std::size_t maxPayloadSize_;
+  std::string pending_;
+  bool failed_ = false;
+};
+}  // namespace Ubuntu::Provisioning
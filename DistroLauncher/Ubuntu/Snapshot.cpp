@@ -0,0 +1,97 @@
+#include "Snapshot.h"
+#include "ImageCache.h"
+#include "Trace.h"
+#include "Utf8.h"
+
+namespace Ubuntu::Snapshot {
+namespace fs = std::filesystem;
+
+namespace {
+// What the manifest of a snapshot tells as its source, an image cache copy telling a digest.
+constexpr char source[] = "snapshot";
+
+// Streams the root filesystem into [directory], the distro being entered as root already.
+Result stream(WslBackend& wsl, const fs::path& directory,
+              const WslBackend::Configuration& configuration);
+}  // namespace
+
+double Result::MegabytesPerSecond() const {
+  auto seconds = std::chrono::duration<double>(elapsed).count();
+  return seconds > 0 ? static_cast<double>(bytes) / (1024 * 1024) / seconds : 0;
+}
+
+Result Take(WslBackend& wsl, const fs::path& directory) {
+  Trace::Span span{"Snapshot::Take"};
+  auto start = std::chrono::steady_clock::now();
+  auto configuration = wsl.GetConfiguration();
+  if (!configuration) {
+    return {L"couldn't read the configuration of the distribution"};
+  }
+
+  // WSL launches as the default user, who can't read everything.
+  const auto defaultUid = configuration->defaultUid;
+  if (defaultUid != 0 && !wsl.SetDefaultUid(0)) {
+    return {L"couldn't enter the distribution as root"};
+  }
+  auto result = stream(wsl, directory, *configuration);
+  if (defaultUid != 0 && !wsl.SetDefaultUid(defaultUid)) {
+    result.error = L"couldn't restore the default user";
+  }
+  result.elapsed = std::chrono::steady_clock::now() - start;
+  return result;
+}
+
+std::optional<Stored> Check(const fs::path& directory, const std::atomic<bool>& cancelled) {
+  Trace::Span span{"Snapshot::Check"};
+  auto manifest = ImageCache::Load(directory);
+  if (!manifest || manifest->source != source || !manifest->defaultUid ||
+      !ImageCache::Validate(directory, *manifest, cancelled)) {
+    return std::nullopt;
+  }
+  return Stored{ImageCache::ImagePath(directory), *manifest->defaultUid,
+                manifest->flags.value_or(WslBackend::Configuration::DefaultFlags)};
+}
+
+namespace {
+Result stream(WslBackend& wsl, const fs::path& directory,
+              const WslBackend::Configuration& configuration) {
+  Result result;
+  ImageCache::Writer writer{directory};
+  bool written = true;
+  ConsumeFunction consume = [&writer, &written, &result](std::string_view chunk) {
+    written = writer.Append(chunk);
+    result.bytes += chunk.size();
+    return written;
+  };
+  auto process = wsl.Run(Command, WslBackend::NoTimeout, &consume);
+  if (!written) {
+    result.error = L"couldn't write the snapshot";
+    return result;
+  }
+  if (!process.error.empty()) {
+    result.error = process.error;
+    if (!process.stdErr.empty()) {
+      result.error += L": " + Utf8ToWide(process.stdErr);
+    }
+    return result;
+  }
+
+  // The default user and flags go along, as registering leaves root and the default flags.
+  if (!writer.Commit(source)) {
+    result.error = L"couldn't write the snapshot";
+    return result;
+  }
+  auto manifest = ImageCache::Load(directory);
+  if (!manifest) {
+    result.error = L"couldn't write the snapshot";
+    return result;
+  }
+  manifest->defaultUid = configuration.defaultUid;
+  manifest->flags = configuration.flags;
+  if (!ImageCache::Save(directory, *manifest)) {
+    result.error = L"couldn't write the snapshot";
+  }
+  return result;
+}
+}  // namespace
+}  // namespace Ubuntu::Snapshot
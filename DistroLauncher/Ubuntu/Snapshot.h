@@ -0,0 +1,54 @@
+#pragma once
+
+#include "WslBackend.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Snapshots of the provisioned distro, for `reset` to register it again as it was once set up,
+// skipping the extraction of the install image, cloud-init and the user creation. The root
+// filesystem is streamed out of the distro as a tar archive and stored decompressed, as the image
+// cache stores its copy (see ImageCache.h), so that WSL registers from it without inflating
+// anything. It doesn't depend on any Windows API.
+namespace Ubuntu::Snapshot {
+// Writes the root filesystem to stdout, leaving out the other mounts such as /proc and the Windows
+// drives. Files changing while read don't fail it.
+inline constexpr std::wstring_view Command =
+    L"tar --create --file=- --directory=/ --one-file-system --numeric-owner --xattrs --sparse "
+    L"--warning=no-file-changed . || [ $? -eq 1 ]";
+
+struct Result {
+  // Why the snapshot couldn't be taken, empty if it was.
+  std::wstring error;
+  std::uint64_t bytes = 0;
+  std::chrono::nanoseconds elapsed{0};
+
+  bool Succeeded() const { return error.empty(); }
+  double MegabytesPerSecond() const;
+};
+
+// Streams the root filesystem of the distro reached through [wsl] into [directory], replacing the
+// previous snapshot there once complete only. The archive is made as root, the default user being
+// restored right after and recorded with it, along with the flags. Other launches meanwhile enter
+// the distro as root too, as would the later ones if the launcher were killed before restoring it.
+Result Take(WslBackend& wsl, const std::filesystem::path& directory);
+
+// A snapshot which checked out.
+struct Stored {
+  // The tar archive to register the distro from.
+  std::filesystem::path image;
+  unsigned long defaultUid = 0;
+  // The WSL_DISTRIBUTION_FLAGS, the default ones for snapshots which didn't record them.
+  unsigned long flags = WslBackend::Configuration::DefaultFlags;
+};
+
+// The snapshot in [directory], if there is one and its blocks still match their checksums, read in
+// parallel. Gives up early once [cancelled].
+std::optional<Stored> Check(const std::filesystem::path& directory,
+                            const std::atomic<bool>& cancelled);
+}  // namespace Ubuntu::Snapshot
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <string_view>
+
+namespace Ubuntu {
+// Views a string as a collection of (most likely non-null terminated) substring slices split by the
+// provided delimiter, visited unidirectionally. The backing string is required to outlive this for
+// safe usage. Useful for lazy iteration.
+class SplitView {
+ private:
+  std::string_view parent;
+  char delimiter;
+  std::string_view::const_iterator start;
+
+ public:
+  SplitView(std::string_view str, char delimiter)
+      : parent(str), delimiter(delimiter), start(parent.begin()) {}
+
+  std::optional<std::string_view> next() {
+    if (start == parent.end()) {
+      return std::nullopt;
+    }
+
+    auto end = std::find(start, parent.end(), delimiter);
+    std::string_view token = parent.substr(start - parent.begin(), end - start);
+
+    if (end != parent.end()) {
+      start = end + 1;
+    } else {
+      start = end;
+    }
+
+    return token;
+  }
+
+  // This allows plugging the SplitView into std algorithms and range-for loops.
+  auto begin() { return iterator(this); }
+  auto end() { return iterator::sentinel(this); }
+
+  class iterator {
+   private:
+    SplitView* splitView;
+    std::optional<std::string_view> current;
+
+    iterator(SplitView* splitView, const std::optional<std::string_view>& current)
+        : splitView(splitView), current(current) {}
+
+   public:
+    // Creates a new iterator pointing to the next value of the SplitView, i.e. the
+    // begin-iterator.
+    iterator(SplitView* splitView) : splitView{splitView}, current{splitView->next()} {}
+    // Creates a new sentinel iterator for the provided SplitView, i.e. the end-iterator.
+    static iterator sentinel(SplitView* splitView) { return iterator{splitView, std::nullopt}; }
+
+    // boiler-plate to define a standard-compliant iterator interface.
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::string_view*;
+    using reference = const std::string_view&;
+    using iterator_category = std::input_iterator_tag;
+
+    reference operator*() const { return *current; }
+    pointer operator->() const { return &(*current); }
+
+    iterator& operator++() {
+      current = splitView->next();
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator temp = *this;
+      ++(*this);
+      return temp;
+    }
+
+    friend bool operator==(const iterator& a, const iterator& b) {
+      return a.splitView == b.splitView && a.current == b.current;
+    }
+
+    friend bool operator!=(const iterator& a, const iterator& b) { return !(a == b); }
+  };
+};
+}  // namespace Ubuntu
@@ -0,0 +1,274 @@
+#include "TarIndex.h"
+
+#include <algorithm>
+#include <charconv>
+#include <system_error>
+
+namespace Ubuntu::Tar {
+namespace {
+constexpr std::size_t blockSize = 512;
+// Metadata entries (long names and pax headers) are tiny in practice.
+constexpr std::uint64_t maxMetadataSize = 1024 * 1024;
+
+// Returns the NUL-terminated string stored in a fixed-size header field.
+std::string_view field(std::string_view header, std::size_t offset, std::size_t size) {
+  auto value = header.substr(offset, size);
+  return value.substr(0, value.find('\0'));
+}
+
+// Parses a numeric header field, either octal text or GNU base-256 binary.
+bool parseNumber(std::string_view header, std::size_t offset, std::size_t size,
+                 std::uint64_t& result) {
+  auto value = header.substr(offset, size);
+  result = 0;
+  if (static_cast<unsigned char>(value[0]) & 0x80) {
+    result = static_cast<unsigned char>(value[0]) & 0x7F;
+    for (std::size_t i = 1; i < value.size(); ++i) {
+      if (result >> 56) {
+        return false;
+      }
+      result = (result << 8) | static_cast<unsigned char>(value[i]);
+    }
+    return true;
+  }
+
+  auto begin = value.find_first_not_of(' ');
+  if (begin == std::string_view::npos) {
+    return true;
+  }
+  value.remove_prefix(begin);
+  value = value.substr(0, value.find_first_of(std::string_view{" \0", 2}));
+  if (value.empty()) {
+    return true;
+  }
+  auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), result, 8);
+  return ec == std::errc{} && ptr == value.data() + value.size();
+}
+
+std::string normalize(std::string_view name) {
+  for (;;) {
+    if (name.substr(0, 2) == "./") {
+      name.remove_prefix(2);
+    } else if (name.substr(0, 1) == "/") {
+      name.remove_prefix(1);
+    } else {
+      break;
+    }
+  }
+  while (!name.empty() && name.back() == '/') {
+    name.remove_suffix(1);
+  }
+  if (name == ".") {
+    return {};
+  }
+  return std::string{name};
+}
+
+std::string_view trimNul(std::string_view value) {
+  return value.substr(0, value.find('\0'));
+}
+}  // namespace
+
+const Entry* Index::Find(std::string_view name) const {
+  auto found = std::find_if(entries.rbegin(), entries.rend(),
+                            [name](const Entry& e) { return e.name == name; });
+  return found == entries.rend() ? nullptr : &*found;
+}
+
+const std::string* Index::Contents(std::string_view name) const {
+  auto found = files.find(name);
+  return found == files.end() ? nullptr : &found->second;
+}
+
+bool IsUnder(std::string_view name, std::string_view directory) {
+  return name.substr(0, directory.size()) == directory &&
+         (name.size() == directory.size() || name[directory.size()] == '/');
+}
+
+Indexer::Indexer(CapturePredicate capture, std::uint64_t maxCaptureSize)
+    : capture_{std::move(capture)}, maxCaptureSize_{maxCaptureSize} {
+  header_.reserve(blockSize);
+}
+
+bool Indexer::Feed(std::string_view chunk) {
+  auto consume = [this, &chunk](std::uint64_t max) {
+    auto n = static_cast<std::size_t>(std::min<std::uint64_t>(max, chunk.size()));
+    auto consumed = chunk.substr(0, n);
+    chunk.remove_prefix(n);
+    position_ += n;
+    return consumed;
+  };
+
+  while (!chunk.empty()) {
+    switch (state_) {
+      case State::Header:
+        header_.append(consume(blockSize - header_.size()));
+        if (header_.size() < blockSize) {
+          return true;
+        }
+        if (!parseHeader()) {
+          state_ = State::Error;
+          return false;
+        }
+        header_.clear();
+        break;
+
+      case State::Data: {
+        auto data = consume(remaining_);
+        if (capturing_) {
+          data_.append(data);
+        }
+        remaining_ -= data.size();
+        if (remaining_ == 0) {
+          finishEntry();
+          state_ = padding_ == 0 ? State::Header : State::Padding;
+        }
+        break;
+      }
+
+      case State::Padding:
+        padding_ -= consume(padding_).size();
+        if (padding_ == 0) {
+          state_ = State::Header;
+        }
+        break;
+
+      case State::End:
+        // Whatever follows the end-of-archive marker is just padding up to the record size.
+        return true;
+
+      case State::Error:
+        return false;
+    }
+  }
+  return state_ != State::Error;
+}
+
+bool Indexer::parseHeader() {
+  std::string_view header{header_};
+  if (std::all_of(header.begin(), header.end(), [](char c) { return c == '\0'; })) {
+    if (++zeroBlocks_ == 2) {
+      state_ = State::End;
+    }
+    return true;
+  }
+  zeroBlocks_ = 0;
+
+  // The checksum is computed as if its own field were filled with spaces.
+  std::uint64_t expected = 0;
+  if (!parseNumber(header, 148, 8, expected)) {
+    return false;
+  }
+  std::uint64_t sum = 0;
+  for (std::size_t i = 0; i < blockSize; ++i) {
+    sum += (i >= 148 && i < 156) ? ' ' : static_cast<unsigned char>(header[i]);
+  }
+  if (sum != expected) {
+    return false;
+  }
+
+  std::uint64_t size = 0;
+  if (!parseNumber(header, 124, 12, size)) {
+    return false;
+  }
+
+  Entry entry;
+  entry.type = header[156];
+  std::string name{field(header, 0, 100)};
+  if (header.substr(257, 5) == "ustar") {
+    if (auto prefix = field(header, 345, 155); !prefix.empty()) {
+      name = std::string{prefix} + "/" + name;
+    }
+  }
+  entry.name = std::move(name);
+  entry.linkName = field(header, 157, 100);
+
+  const bool isMetadata =
+      entry.type == 'L' || entry.type == 'K' || entry.type == 'x' || entry.type == 'g';
+  if (!isMetadata) {
+    if (!nextName_.empty()) {
+      entry.name = std::move(nextName_);
+    }
+    if (!nextLinkName_.empty()) {
+      entry.linkName = std::move(nextLinkName_);
+    }
+    if (hasNextSize_) {
+      size = nextSize_;
+    }
+    nextName_.clear();
+    nextLinkName_.clear();
+    hasNextSize_ = false;
+    entry.name = normalize(entry.name);
+  } else if (size > maxMetadataSize) {
+    return false;
+  }
+
+  entry.offset = position_;
+  entry.size = size;
+  current_ = std::move(entry);
+  remaining_ = size;
+  padding_ = (blockSize - size % blockSize) % blockSize;
+  capturing_ = isMetadata || (current_.isRegularFile() && size <= maxCaptureSize_ && capture_ &&
+                              capture_(current_));
+  data_.clear();
+
+  if (remaining_ == 0) {
+    finishEntry();
+  } else {
+    state_ = State::Data;
+  }
+  return true;
+}
+
+void Indexer::finishEntry() {
+  switch (current_.type) {
+    case 'L':
+      nextName_ = trimNul(data_);
+      return;
+    case 'K':
+      nextLinkName_ = trimNul(data_);
+      return;
+    case 'x': {
+      // Records look like "<length> <key>=<value>\n", the length accounting for the whole record.
+      std::string_view records{data_};
+      while (!records.empty()) {
+        std::size_t length = 0;
+        auto [ptr, ec] = std::from_chars(records.data(), records.data() + records.size(), length);
+        if (ec != std::errc{} || length == 0 || length > records.size()) {
+          break;
+        }
+        auto record = records.substr(0, length);
+        records.remove_prefix(length);
+        record.remove_prefix(ptr - record.data());
+        auto eq = record.find('=');
+        if (record.empty() || record.front() != ' ' || eq == std::string_view::npos ||
+            record.back() != '\n') {
+          continue;
+        }
+        auto key = record.substr(1, eq - 1);
+        auto value = record.substr(eq + 1, record.size() - eq - 2);
+        if (key == "path") {
+          nextName_ = value;
+        } else if (key == "linkpath") {
+          nextLinkName_ = value;
+        } else if (key == "size") {
+          auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), nextSize_);
+          hasNextSize_ = error == std::errc{} && end == value.data() + value.size();
+        }
+      }
+      return;
+    }
+    case 'g':
+      // Global pax headers carry nothing we care about.
+      return;
+    default:
+      break;
+  }
+
+  if (capturing_) {
+    index_.files.insert_or_assign(current_.name, std::move(data_));
+    data_.clear();
+  }
+  index_.entries.push_back(std::move(current_));
+}
+}  // namespace Ubuntu::Tar
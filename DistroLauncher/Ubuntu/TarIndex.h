@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A one-pass index of a tar stream (ustar, GNU and pax flavours), built from the decompressed
+// install image so the launcher knows what is inside the root filesystem before WSL extracts it.
+// It doesn't depend on any Windows API.
+namespace Ubuntu::Tar {
+struct Entry {
+  // Path relative to the root of the archive, without leading "./" or "/", e.g. "etc/wsl.conf".
+  std::string name;
+  // The tar typeflag: '0' for regular files, '5' for directories, '2' for symlinks...
+  char type = '0';
+  // Offset of the entry data in the uncompressed stream.
+  std::uint64_t offset = 0;
+  std::uint64_t size = 0;
+  // Target of links.
+  std::string linkName;
+
+  bool isRegularFile() const { return type == '0' || type == '\0' || type == '7'; }
+};
+
+struct Index {
+  std::vector<Entry> entries;
+  // Contents of the entries captured while indexing, by name.
+  std::map<std::string, std::string, std::less<>> files;
+
+  // Returns the last entry with such [name] (later entries override earlier ones), if any.
+  const Entry* Find(std::string_view name) const;
+  // Returns the captured contents of the file [name], if any.
+  const std::string* Contents(std::string_view name) const;
+};
+
+// Decides whether the contents of an entry should be kept in memory.
+using CapturePredicate = std::function<bool(const Entry&)>;
+
+// Builds an Index out of a tar stream fed in chunks of any size.
+class Indexer {
+ public:
+  // Entries larger than [maxCaptureSize] are never captured.
+  explicit Indexer(CapturePredicate capture, std::uint64_t maxCaptureSize = 1024 * 1024);
+
+  // Consumes the next chunk of the stream. Returns false once the stream is found ill-formed.
+  bool Feed(std::string_view chunk);
+
+  // True once the end-of-archive marker was seen.
+  bool Finished() const { return state_ == State::End; }
+
+  const Index& Result() const { return index_; }
+  Index Take() { return std::move(index_); }
+
+ private:
+  enum class State { Header, Data, Padding, End, Error };
+
+  bool parseHeader();
+  void finishEntry();
+
+  CapturePredicate capture_;
+  std::uint64_t maxCaptureSize_;
+  Index index_;
+
+  State state_ = State::Header;
+  std::uint64_t position_ = 0;
+  std::string header_;
+  unsigned zeroBlocks_ = 0;
+
+  // The entry whose data is being consumed.
+  Entry current_;
+  std::uint64_t remaining_ = 0;
+  std::uint64_t padding_ = 0;
+  bool capturing_ = false;
+  std::string data_;
+
+  // Overrides for the next entry, from GNU long names or pax extended headers.
+  std::string nextName_;
+  std::string nextLinkName_;
+  std::uint64_t nextSize_ = 0;
+  bool hasNextSize_ = false;
+};
+
+// Whether [name] is [directory] itself or lies somewhere inside it, e.g.
+// IsUnder("etc/cloud/cloud.cfg", "etc/cloud").
+bool IsUnder(std::string_view name, std::string_view directory);
+}  // namespace Ubuntu::Tar
@@ -0,0 +1,202 @@
+#include "Trace.h"
+#include "Json.h"
+#include "Utf8.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+namespace Ubuntu::Trace {
+namespace {
+// A completed span, as a Chrome trace "complete" event.
+struct Event {
+  const char* name;
+  std::string detail;
+  std::int64_t start;
+  std::int64_t duration;
+  std::uint32_t thread;
+};
+
+struct State {
+  std::mutex mutex;
+  std::filesystem::path path;
+  std::chrono::steady_clock::time_point origin;
+  std::vector<Event> events;
+};
+
+std::atomic<bool> enabled{false};
+std::atomic<Observer> observer{nullptr};
+
+State& state();
+
+// Nanoseconds elapsed since tracing was enabled.
+std::int64_t now();
+
+// A small number identifying the calling thread, stable for its lifetime.
+std::uint32_t threadNumber();
+
+// Appends [ns] as fractional microseconds, the unit of the trace event format.
+void appendMicroseconds(std::string& out, std::int64_t ns);
+}  // namespace
+
+void Enable(std::filesystem::path path) {
+  auto& s = state();
+  std::scoped_lock lock{s.mutex};
+  s.path = std::move(path);
+  s.origin = std::chrono::steady_clock::now();
+  s.events.clear();
+  enabled.store(true, std::memory_order_release);
+}
+
+bool Enabled() { return enabled.load(std::memory_order_relaxed); }
+
+bool Flush() {
+  if (!Enabled()) {
+    return false;
+  }
+  auto json = ToJson();
+  std::filesystem::path path;
+  {
+    auto& s = state();
+    std::scoped_lock lock{s.mutex};
+    path = s.path;
+  }
+  std::ofstream file{path, std::ios::binary | std::ios::trunc};
+  file << json;
+  return file.good();
+}
+
+std::string ToJson() {
+  auto& s = state();
+  std::scoped_lock lock{s.mutex};
+  std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  for (const auto& event : s.events) {
+    json += first ? "\n" : ",\n";
+    first = false;
+    json += "{\"name\":";
+    Json::AppendString(json, event.name);
+    json += ",\"cat\":\"launcher\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+    json += std::to_string(event.thread);
+    json += ",\"ts\":";
+    appendMicroseconds(json, event.start);
+    json += ",\"dur\":";
+    appendMicroseconds(json, event.duration);
+    if (!event.detail.empty()) {
+      json += ",\"args\":{\"detail\":";
+      Json::AppendString(json, event.detail);
+      json += '}';
+    }
+    json += '}';
+  }
+  json += "\n]}\n";
+  return json;
+}
+
+void Reset() {
+  auto& s = state();
+  std::scoped_lock lock{s.mutex};
+  enabled.store(false, std::memory_order_release);
+  s.path.clear();
+  s.events.clear();
+}
+
+void Observe(Observer newObserver) { observer.store(newObserver, std::memory_order_release); }
+
+Span::Span(const char* name) : name_{name} {
+  if (Enabled()) {
+    start_ = now();
+  }
+  observe();
+}
+
+Span::Span(const char* name, std::string_view detail) : name_{name} {
+  if (Enabled()) {
+    detail_ = detail;
+    start_ = now();
+  }
+  observe();
+}
+
+Span::Span(const char* name, std::wstring_view detail) : name_{name} {
+  if (Enabled()) {
+    detail_ = WideToUtf8(detail);
+    start_ = now();
+  }
+  observe();
+}
+
+void Span::observe() {
+  if (observer.load(std::memory_order_acquire) != nullptr) {
+    observed_ = true;
+    observedStart_ = std::chrono::steady_clock::now();
+  }
+}
+
+void Span::SetDetail(std::string_view detail) {
+  if (start_ >= 0) {
+    detail_ = detail;
+  }
+}
+
+Span::~Span() {
+  if (observed_) {
+    if (auto observe = observer.load(std::memory_order_acquire)) {
+      observe(name_, std::chrono::steady_clock::now() - observedStart_);
+    }
+  }
+
+  // A span started before tracing was reset would land in the wrong session.
+  if (start_ < 0 || !Enabled()) {
+    return;
+  }
+  auto end = now();
+  auto thread = threadNumber();
+  auto& s = state();
+  std::scoped_lock lock{s.mutex};
+  s.events.push_back({name_, std::move(detail_), start_, end - start_, thread});
+}
+
+Session::Session(std::filesystem::path path) {
+  if (!path.empty()) {
+    Enable(std::move(path));
+    enabled_ = true;
+  }
+}
+
+Session::~Session() {
+  if (enabled_ && !Flush()) {
+    std::fputs("Failed to write the trace file.\n", stderr);
+  }
+}
+
+namespace {
+State& state() {
+  static State s;
+  return s;
+}
+
+std::int64_t now() {
+  auto elapsed = std::chrono::steady_clock::now() - state().origin;
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+
+std::uint32_t threadNumber() {
+  static std::atomic<std::uint32_t> threads{0};
+  thread_local std::uint32_t number = ++threads;
+  return number;
+}
+
+void appendMicroseconds(std::string& out, std::int64_t ns) {
+  out += std::to_string(ns / 1000);
+  auto fraction = ns % 1000;
+  out += '.';
+  out += static_cast<char>('0' + fraction / 100);
+  out += static_cast<char>('0' + fraction / 10 % 10);
+  out += static_cast<char>('0' + fraction % 10);
+}
+}  // namespace
+}  // namespace Ubuntu::Trace
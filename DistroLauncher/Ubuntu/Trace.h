@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+// Recording where the launcher spends its time as spans, written out in the Chrome trace event
+// format, viewable in chrome://tracing or https://ui.perfetto.dev. Their durations can also be
+// observed, whether tracing or not, e.g. to keep statistics. While neither, spans cost two atomic
+// loads. It doesn't depend on any Windows API.
+namespace Ubuntu::Trace {
+// Starts recording spans, to be written to [path].
+void Enable(std::filesystem::path path);
+
+// Whether spans are being recorded.
+bool Enabled();
+
+// Writes the spans recorded so far to the path given to Enable. Returns false if not enabled or the
+// file couldn't be written.
+bool Flush();
+
+// The spans recorded so far, as a Chrome trace JSON document.
+std::string ToJson();
+
+// Stops recording and forgets the spans recorded so far.
+void Reset();
+
+// Receives the [name] and [duration] of each span as it ends, from the thread it ran on.
+using Observer = void (*)(const char* name, std::chrono::nanoseconds duration);
+
+// Hands the spans starting from now on to [observer], none if nullptr.
+void Observe(Observer observer);
+
+// Records the time spent between its construction and destruction, nested spans showing as such.
+class Span {
+ public:
+  // [name] must outlive the tracing session, e.g. a string literal.
+  explicit Span(const char* name);
+
+  // Same as above, with a [detail] such as a command line attached.
+  Span(const char* name, std::string_view detail);
+  Span(const char* name, std::wstring_view detail);
+
+  ~Span();
+
+  // Replaces the detail attached, e.g. with an outcome only known at the end.
+  void SetDetail(std::string_view detail);
+
+  Span(const Span&) = delete;
+  Span& operator=(const Span&) = delete;
+
+ private:
+  // Takes the time if observed.
+  void observe();
+
+  const char* name_;
+  std::string detail_;
+  // Nanoseconds since tracing was enabled, negative if it wasn't.
+  std::int64_t start_ = -1;
+  bool observed_ = false;
+  std::chrono::steady_clock::time_point observedStart_;
+};
+
+// Enables tracing for its lifetime if given a path, writing the spans out when destroyed.
+class Session {
+ public:
+  explicit Session(std::filesystem::path path);
+  ~Session();
+
+  Session(const Session&) = delete;
+  Session& operator=(const Session&) = delete;
+
+ private:
+  bool enabled_ = false;
+};
+}  // namespace Ubuntu::Trace
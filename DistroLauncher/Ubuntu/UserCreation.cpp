@@ -0,0 +1,160 @@
+#include "UserCreation.h"
+#include "NssQuery.h"
+#include "SplitView.h"
+#include "Trace.h"
+#include "Utf8.h"
+
+#include <algorithm>
+#include <regex>
+
+namespace Ubuntu::UserCreation {
+// Runs as root, the default user of a fresh distro. The groups are those of the users created by the
+// Ubuntu installer.
+const wchar_t Script[] = LR"(
+exists() { id -u "${name}" >/dev/null 2>&1; }
+
+# Leaves no half-created user behind.
+rollback() {
+  if exists && ! deluser --quiet --remove-home "${name}" >/dev/null 2>&1; then
+    echo "Failed to remove the user ${name} after a failure." >&2
+    exit 3
+  fi
+}
+trap 'rollback; exit 1' HUP INT TERM
+
+if exists; then
+  exit 4
+fi
+
+if ! adduser --quiet --gecos '' "${name}"; then
+  rollback
+  exit 1
+fi
+
+# usermod fails on any group missing, thus only those the distro has.
+joined=
+for group in adm dialout cdrom floppy sudo audio dip video plugdev netdev; do
+  if grep -q "^${group}:" /etc/group; then
+    joined="${joined:+${joined},}${group}"
+  fi
+done
+if [ -n "${joined}" ] && ! usermod -aG "${joined}" "${name}"; then
+  rollback
+  echo "Failed to add the user ${name} to the groups ${joined}, thus removed it." >&2
+  exit 2
+fi
+exit 0
+)";
+
+namespace {
+std::string_view trim(std::string_view text);
+
+// The entry of [name] in the passwd [contents], if any.
+std::optional<UserEntry> findUser(std::string_view contents, std::string_view name);
+}  // namespace
+
+std::string NameRegex(std::string_view contents) {
+  static constexpr std::string_view key = "NAME_REGEX";
+  // As adduser reads its configuration, the last setting wins.
+  std::string regex = DefaultNameRegex;
+  for (auto line : SplitView{contents, '\n'}) {
+    line = trim(line);
+    if (line.substr(0, key.size()) != key) {
+      continue;
+    }
+    auto value = trim(line.substr(key.size()));
+    if (value.empty() || value.front() != '=') {
+      continue;
+    }
+    value = trim(value.substr(1));
+    if (value.size() >= 2 && (value.front() == '"' || value.front() == '\'') &&
+        value.back() == value.front()) {
+      value = value.substr(1, value.size() - 2);
+    }
+    if (!value.empty()) {
+      regex = value;
+    }
+  }
+  return regex;
+}
+
+std::optional<std::string> CheckName(std::string_view name, const std::string& nameRegex) {
+  if (name.empty()) {
+    return "the name is empty";
+  }
+  if (name.size() > MaxNameLength) {
+    return "the name is longer than " + std::to_string(MaxNameLength) + " characters";
+  }
+  // adduser matches with Perl, whose basic syntax ECMAScript shares.
+  std::regex regex;
+  try {
+    regex.assign(nameRegex, std::regex::ECMAScript);
+  } catch (const std::regex_error&) {
+    return std::nullopt;
+  }
+  if (!std::regex_search(name.begin(), name.end(), regex)) {
+    return "the name must match the regular expression " + nameRegex;
+  }
+  return std::nullopt;
+}
+
+Result Create(WslBackend& wsl, std::string_view name, const std::string& nameRegex) {
+  Trace::Span span{"UserCreation::Create"};
+  Result result;
+  if (auto reason = CheckName(name, nameRegex); reason) {
+    result.outcome = Result::Outcome::InvalidName;
+    result.reason = std::move(reason.value());
+    return result;
+  }
+  // Local users are the only ones adduser could clash with, and reading their file launches nothing.
+  if (auto passwd = wsl.ReadFile("etc/passwd"); passwd && findUser(*passwd, name)) {
+    result.outcome = Result::Outcome::AlreadyExists;
+    return result;
+  }
+
+  std::wstring command = L"name=" + Utf8ToWide(ShellQuote(name)) + L"\n";
+  command += Script;
+  auto exitCode = wsl.LaunchInteractive(command, true);
+  ++result.launches;
+  if (!exitCode) {
+    result.outcome = Result::Outcome::LaunchFailed;
+    return result;
+  }
+  // Whatever else adduser exits with, the script rolled back.
+  result.outcome = *exitCode <= static_cast<unsigned long>(Result::Outcome::AlreadyExists)
+                       ? static_cast<Result::Outcome>(*exitCode)
+                       : Result::Outcome::AddFailed;
+  if (result.outcome == Result::Outcome::Created) {
+    if (auto passwd = wsl.ReadFile("etc/passwd"); passwd) {
+      result.user = findUser(*passwd, name);
+    }
+  }
+  return result;
+}
+
+std::string ReadNameRegex(WslBackend& wsl) {
+  auto conf = wsl.ReadFile("etc/adduser.conf");
+  return NameRegex(conf ? std::string_view{*conf} : std::string_view{});
+}
+
+namespace {
+std::string_view trim(std::string_view text) {
+  auto first = text.find_first_not_of(" \t\r");
+  if (first == std::string_view::npos) {
+    return {};
+  }
+  auto last = text.find_last_not_of(" \t\r");
+  return text.substr(first, last - first + 1);
+}
+
+std::optional<UserEntry> findUser(std::string_view contents, std::string_view name) {
+  auto users = ParsePasswd(contents);
+  auto found = std::find_if(users.begin(), users.end(),
+                            [name](const UserEntry& user) { return user.name == name; });
+  if (found == users.end()) {
+    return std::nullopt;
+  }
+  return *found;
+}
+}  // namespace
+}  // namespace Ubuntu::UserCreation
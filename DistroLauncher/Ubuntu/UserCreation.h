@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Passwd.h"
+#include "WslBackend.h"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// Creating the default user account. The name is checked on the host first, so that a typo costs no
+// launch, then a single guest script adds the user, makes it join the usual groups and removes it
+// again if anything failed. It doesn't depend on any Windows API, the distro being reached through a
+// WslBackend.
+namespace Ubuntu::UserCreation {
+// The shell script creating the user named in ${name}, run attached to the console so that adduser
+// can prompt for the password. Its exit code is one of those of Result::Outcome below.
+extern const wchar_t Script[];
+
+// What adduser accepts when /etc/adduser.conf doesn't set NAME_REGEX.
+constexpr char DefaultNameRegex[] = R"(^[a-z][-a-z0-9_]*\$?$)";
+
+// The longest name useradd accepts.
+constexpr std::size_t MaxNameLength = 32;
+
+// The NAME_REGEX set in the adduser.conf [contents], DefaultNameRegex if none.
+std::string NameRegex(std::string_view contents);
+
+// Why adduser would refuse [name] given its [nameRegex], or std::nullopt if it wouldn't. A regex
+// the host can't make sense of is left for adduser to apply.
+std::optional<std::string> CheckName(std::string_view name, const std::string& nameRegex);
+
+struct Result {
+  // The exit codes of the script are those up to RollbackFailed.
+  enum class Outcome {
+    Created = 0,
+    // adduser failed, e.g. the password was mistyped thrice. Anything it created was removed.
+    AddFailed = 1,
+    // Joining the groups failed, thus the user was removed.
+    RolledBack = 2,
+    // Removing the user after a failure failed too.
+    RollbackFailed = 3,
+    // Someone already has that name, who was left alone.
+    AlreadyExists = 4,
+    // Refused on the host, nothing was launched.
+    InvalidName,
+    // The script couldn't be launched, which is already reported.
+    LaunchFailed,
+  };
+
+  Outcome outcome = Outcome::LaunchFailed;
+  // Why the name was refused, if it was.
+  std::string reason;
+  // The entry of the new user in /etc/passwd, if created.
+  std::optional<UserEntry> user;
+  // The distro processes launched.
+  std::size_t launches = 0;
+};
+
+// Creates the user [name] as adduser allows it by [nameRegex], see NameRegex.
+Result Create(WslBackend& wsl, std::string_view name, const std::string& nameRegex);
+
+// Reads the NAME_REGEX of the distro, without launching anything.
+std::string ReadNameRegex(WslBackend& wsl);
+}  // namespace Ubuntu::UserCreation
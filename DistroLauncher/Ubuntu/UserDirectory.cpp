@@ -0,0 +1,69 @@
+#include "UserDirectory.h"
+
+namespace Ubuntu {
+void UserDirectory::Populate(const std::vector<UserEntry>& users) {
+  for (const auto& user : users) {
+    add(user);
+  }
+}
+
+void UserDirectory::Invalidate() {
+  users_.clear();
+  byName_.clear();
+  byUid_.clear();
+  missingNames_.clear();
+  missingUids_.clear();
+}
+
+std::optional<UserEntry> UserDirectory::FindByName(std::string_view name) {
+  std::string key{name};
+  if (auto found = byName_.find(key); found != byName_.end()) {
+    return users_[found->second];
+  }
+  if (name.empty() || missingNames_.count(key) != 0) {
+    return std::nullopt;
+  }
+  // getent takes a numeric name for a UID, returning someone else, thus the check for the name.
+  if (lookup({NssQuery::Kind::PointLookup, key})) {
+    if (auto found = byName_.find(key); found != byName_.end()) {
+      return users_[found->second];
+    }
+    missingNames_.insert(std::move(key));
+  }
+  return std::nullopt;
+}
+
+std::optional<UserEntry> UserDirectory::FindByUid(unsigned long uid) {
+  if (auto found = byUid_.find(uid); found != byUid_.end()) {
+    return users_[found->second];
+  }
+  if (missingUids_.count(uid) != 0) {
+    return std::nullopt;
+  }
+  if (lookup({NssQuery::Kind::UidRangeProbe, {}, uid, uid})) {
+    if (auto found = byUid_.find(uid); found != byUid_.end()) {
+      return users_[found->second];
+    }
+    missingUids_.insert(uid);
+  }
+  return std::nullopt;
+}
+
+void UserDirectory::add(const UserEntry& user) {
+  auto [byName, newName] = byName_.try_emplace(user.name, users_.size());
+  auto [byUid, newUid] = byUid_.try_emplace(user.uid, users_.size());
+  if (newName || newUid) {
+    users_.push_back(user);
+  }
+}
+
+bool UserDirectory::lookup(const NssQuery& query) {
+  ++queriesRun_;
+  auto users = query_(query);
+  if (!users) {
+    return false;
+  }
+  Populate(*users);
+  return true;
+}
+}  // namespace Ubuntu
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "NssQuery.h"
+#include "Passwd.h"
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// A per-run cache of the NSS passwd database. It doesn't depend on any Windows API, the actual
+// queries being provided by the caller.
+namespace Ubuntu {
+// Answers user lookups from what is already known of the passwd database, falling back to a point
+// lookup in the distro, whose outcome is remembered, found or not, until invalidated. Not meant to
+// be shared between threads.
+class UserDirectory {
+ public:
+  // Runs [query] against the distro's NSS passwd database. Returns the entries found, or
+  // std::nullopt if the database couldn't be read.
+  using QueryFunction = std::function<std::optional<std::vector<UserEntry>>(const NssQuery& query)>;
+
+  explicit UserDirectory(QueryFunction query) : query_{std::move(query)} {}
+
+  // Adds [users] read elsewhere, e.g. by the provisioning script, to what is known. As in NSS,
+  // the first entry of a given name or UID wins.
+  void Populate(const std::vector<UserEntry>& users);
+
+  // Forgets everything, e.g. after creating a user.
+  void Invalidate();
+
+  // The entry of the user named [name], if any.
+  std::optional<UserEntry> FindByName(std::string_view name);
+
+  // The entry of the user with the UID [uid], if any.
+  std::optional<UserEntry> FindByUid(unsigned long uid);
+
+  // The number of queries run in the distro so far.
+  std::size_t QueriesRun() const { return queriesRun_; }
+
+ private:
+  void add(const UserEntry& user);
+
+  // Runs [query], adding its results. Returns false if the database couldn't be read.
+  bool lookup(const NssQuery& query);
+
+  QueryFunction query_;
+  std::vector<UserEntry> users_;
+  std::unordered_map<std::string, std::size_t> byName_;
+  std::unordered_map<unsigned long, std::size_t> byUid_;
+  std::unordered_set<std::string> missingNames_;
+  std::unordered_set<unsigned long> missingUids_;
+  std::size_t queriesRun_ = 0;
+};
+}  // namespace Ubuntu
@@ -0,0 +1,115 @@
+#include "Utf8.h"
+
+namespace Ubuntu {
+namespace {
+constexpr char32_t replacement = 0xFFFD;
+
+bool isSurrogate(char32_t c) { return c >= 0xD800 && c <= 0xDFFF; }
+
+void appendWide(std::wstring& out, char32_t c);
+
+}  // namespace
+
+std::wstring Utf8ToWide(std::string_view text) {
+  std::wstring out;
+  out.reserve(text.size());
+  for (std::size_t i = 0; i < text.size();) {
+    auto byte = static_cast<unsigned char>(text[i]);
+    if (byte < 0x80) {
+      // The common case, one character at a time.
+      out += static_cast<wchar_t>(byte);
+      ++i;
+      continue;
+    }
+    appendWide(out, DecodeUtf8(text, i));
+  }
+  return out;
+}
+
+std::string WideToUtf8(std::wstring_view text) {
+  std::string out;
+  out.reserve(text.size());
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    auto c = static_cast<char32_t>(text[i]);
+    if constexpr (sizeof(wchar_t) == 2) {
+      if (c >= 0xD800 && c <= 0xDBFF && i + 1 < text.size() && text[i + 1] >= 0xDC00 &&
+          text[i + 1] <= 0xDFFF) {
+        c = 0x10000 + ((c - 0xD800) << 10) + (static_cast<char32_t>(text[i + 1]) - 0xDC00);
+        ++i;
+      }
+    }
+    if (c > 0x10FFFF || isSurrogate(c)) {
+      c = replacement;
+    }
+    AppendUtf8(out, c);
+  }
+  return out;
+}
+
+void AppendUtf8(std::string& out, char32_t c) {
+  if (c < 0x80) {
+    out += static_cast<char>(c);
+  } else if (c < 0x800) {
+    out += static_cast<char>(0xC0 | (c >> 6));
+    out += static_cast<char>(0x80 | (c & 0x3F));
+  } else if (c < 0x10000) {
+    out += static_cast<char>(0xE0 | (c >> 12));
+    out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (c & 0x3F));
+  } else {
+    out += static_cast<char>(0xF0 | (c >> 18));
+    out += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (c & 0x3F));
+  }
+}
+
+char32_t DecodeUtf8(std::string_view text, std::size_t& i) {
+  auto lead = static_cast<unsigned char>(text[i++]);
+  if (lead < 0x80) {
+    return lead;
+  }
+  // The number of continuation bytes, and the smallest code point needing as many.
+  std::size_t length = 0;
+  char32_t minimum = 0;
+  char32_t c = 0;
+  if (lead >= 0xC2 && lead <= 0xDF) {
+    length = 1;
+    minimum = 0x80;
+    c = lead & 0x1F;
+  } else if (lead >= 0xE0 && lead <= 0xEF) {
+    length = 2;
+    minimum = 0x800;
+    c = lead & 0x0F;
+  } else if (lead >= 0xF0 && lead <= 0xF4) {
+    length = 3;
+    minimum = 0x10000;
+    c = lead & 0x07;
+  } else {
+    return replacement;
+  }
+  for (std::size_t k = 0; k < length; ++k) {
+    if (i >= text.size() || (static_cast<unsigned char>(text[i]) & 0xC0) != 0x80) {
+      // Truncated: the byte at i starts the next sequence.
+      return replacement;
+    }
+    c = (c << 6) | (static_cast<unsigned char>(text[i++]) & 0x3F);
+  }
+  if (c < minimum || c > 0x10FFFF || isSurrogate(c)) {
+    return replacement;
+  }
+  return c;
+}
+
+namespace {
+void appendWide(std::wstring& out, char32_t c) {
+  if (sizeof(wchar_t) == 2 && c >= 0x10000) {
+    c -= 0x10000;
+    out += static_cast<wchar_t>(0xD800 + (c >> 10));
+    out += static_cast<wchar_t>(0xDC00 + (c & 0x3FF));
+  } else {
+    out += static_cast<wchar_t>(c);
+  }
+}
+}  // namespace
+}  // namespace Ubuntu
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Conversions between UTF-8, spoken by the distro, and wide strings, spoken by the Windows API:
+// UTF-16 where wchar_t is 16 bits wide, UTF-32 elsewhere. Invalid sequences become U+FFFD. It
+// doesn't depend on any Windows API.
+namespace Ubuntu {
+std::wstring Utf8ToWide(std::string_view text);
+
+std::string WideToUtf8(std::wstring_view text);
+
+// Appends the UTF-8 encoding of the code point [c] to [out].
+void AppendUtf8(std::string& out, char32_t c);
+
+// Decodes the code point starting at text[i], advancing i past it.
+char32_t DecodeUtf8(std::string_view text, std::size_t& i);
+}  // namespace Ubuntu
@@ -0,0 +1,230 @@
+#include <stdafx.h>
+#include "WslApiBackend.h"
+#include "OutputPump.h"
+#include "Utf8.h"
+#include "WslProcess.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace Ubuntu {
+namespace {
+namespace fs = std::filesystem;
+// The root of the distro [name], as shared over 9P.
+fs::path distroRoot(const std::wstring& name) {
+  return fs::path{L"\\\\wsl.localhost"} / name;
+}
+
+// Converts a string in the ANSI code page, such as an exception message, into a wide string.
+std::wstring fromAnsi(std::string_view str) {
+  if (str.empty() || str.size() >= INT_MAX) return {};
+
+  int inputSize = static_cast<int>(str.size());
+  int required = ::MultiByteToWideChar(CP_THREAD_ACP, 0, str.data(), inputSize, NULL, 0);
+  if (0 == required) return {};
+
+  std::wstring wide(required, L'\0');
+  if (0 == ::MultiByteToWideChar(CP_THREAD_ACP, 0, str.data(), inputSize, &wide[0], required)) {
+    return {};
+  }
+  return wide;
+}
+
+// A process started by Spawn, its output pumped on a background thread.
+class WslSession : public WslBackend::Session {
+ public:
+  // Takes ownership of the handles.
+  WslSession(HANDLE process, HANDLE stdIn, HANDLE stdOut, ConsumeFunction consume)
+      : process_{process},
+        stdIn_{stdIn},
+        stdOut_{stdOut},
+        pump_{[this, consume](char* buffer, std::size_t size) -> std::size_t {
+                DWORD readCount = 0;
+                if (stopping_ ||
+                    ::ReadFile(stdOut_, buffer, static_cast<DWORD>(size), &readCount, nullptr) ==
+                        FALSE ||
+                    readCount == 0) {
+                  consume({});
+                  return 0;
+                }
+                return readCount;
+              },
+              consume} {}
+
+  ~WslSession() override {
+    // A shell reading its stdin exits once it is closed, anything else is terminated.
+    CloseHandle(stdIn_);
+    if (WaitForSingleObject(process_, 1'000) == WAIT_TIMEOUT) {
+      TerminateProcess(process_, ERROR_CANCELLED);
+    }
+    // Background processes left behind may still hold the write end of the pipe.
+    if (WaitForSingleObject(pump_.NativeHandle(), 1'000) == WAIT_TIMEOUT) {
+      stopping_ = true;
+      while (WaitForSingleObject(pump_.NativeHandle(), 100) == WAIT_TIMEOUT) {
+        CancelSynchronousIo(pump_.NativeHandle());
+      }
+    }
+    pump_.Join();
+    CloseHandle(stdOut_);
+    CloseHandle(process_);
+  }
+
+  bool Write(std::string_view data) override {
+    std::scoped_lock lock{writeMutex_};
+    while (!data.empty()) {
+      DWORD written = 0;
+      if (::WriteFile(stdIn_, data.data(), static_cast<DWORD>(data.size()), &written, nullptr) ==
+          FALSE) {
+        return false;
+      }
+      data.remove_prefix(written);
+    }
+    return true;
+  }
+
+ private:
+  HANDLE process_;
+  HANDLE stdIn_;
+  HANDLE stdOut_;
+  std::mutex writeMutex_;
+  std::atomic<bool> stopping_{false};
+  // Last, so that it is started once everything else is ready.
+  OutputPump pump_;
+};
+}  // namespace
+
+std::optional<WslBackend::Configuration> WslApiBackend::GetConfiguration() {
+  WslDistributionConfiguration configuration;
+  if (FAILED(api_.WslGetDistributionConfiguration(configuration))) {
+    return std::nullopt;
+  }
+  return Configuration{configuration.version, configuration.defaultUid,
+                       static_cast<unsigned long>(configuration.flags)};
+}
+
+bool WslApiBackend::SetDefaultUid(unsigned long uid) {
+  // WslConfigureDistribution sets both, so the flags are read back first.
+  WslDistributionConfiguration configuration;
+  if (FAILED(api_.WslGetDistributionConfiguration(configuration))) {
+    return false;
+  }
+  if (auto hr = api_.WslConfigureDistribution(uid, configuration.flags); FAILED(hr)) {
+    Helpers::PrintErrorMessage(hr);
+    return false;
+  }
+  return true;
+}
+
+std::optional<unsigned long> WslApiBackend::LaunchInteractive(std::wstring_view command,
+                                                              bool useCurrentWorkingDirectory) {
+  DWORD exitCode = -1;
+  std::wstring nullTerminated{command};
+  if (auto hr = api_.WslLaunchInteractive(nullTerminated.c_str(), useCurrentWorkingDirectory,
+                                          &exitCode);
+      FAILED(hr)) {
+    Helpers::PrintErrorMessage(hr);
+    return std::nullopt;
+  }
+  return exitCode;
+}
+
+ProcessResult WslApiBackend::Run(std::wstring_view command, std::chrono::milliseconds timeout,
+                                 const ConsumeFunction* consume) {
+  DWORD milliseconds = timeout == NoTimeout ? INFINITE : static_cast<DWORD>(timeout.count());
+  WslProcess process{std::wstring{command}};
+  if (consume) {
+    return process.run(api_, milliseconds, *consume);
+  }
+  return process.run(api_, milliseconds);
+}
+
+std::unique_ptr<WslBackend::Session> WslApiBackend::Spawn(std::wstring_view command,
+                                                          ConsumeFunction consume) {
+  // Only the child's ends of the pipes are inheritable.
+  SECURITY_ATTRIBUTES sa{sizeof(sa), nullptr, TRUE};
+  HANDLE stdInRead = nullptr;
+  HANDLE stdInWrite = nullptr;
+  if (CreatePipe(&stdInRead, &stdInWrite, &sa, 0) == FALSE) {
+    Helpers::PrintErrorMessage(HRESULT_FROM_WIN32(GetLastError()));
+    return nullptr;
+  }
+  SetHandleInformation(stdInWrite, HANDLE_FLAG_INHERIT, 0);
+  HANDLE stdOutRead = nullptr;
+  HANDLE stdOutWrite = nullptr;
+  if (CreatePipe(&stdOutRead, &stdOutWrite, &sa, 0) == FALSE) {
+    Helpers::PrintErrorMessage(HRESULT_FROM_WIN32(GetLastError()));
+    CloseHandle(stdInRead);
+    CloseHandle(stdInWrite);
+    return nullptr;
+  }
+  SetHandleInformation(stdOutRead, HANDLE_FLAG_INHERIT, 0);
+
+  HANDLE process = nullptr;
+  std::wstring nullTerminated{command};
+  auto hr = api_.WslLaunch(nullTerminated.c_str(), FALSE, stdInRead, stdOutWrite, stdOutWrite,
+                           &process);
+  // The child has its own copies by now, ours would keep the pipes open once it is gone.
+  CloseHandle(stdInRead);
+  CloseHandle(stdOutWrite);
+  if (FAILED(hr)) {
+    Helpers::PrintErrorMessage(hr);
+    CloseHandle(stdInWrite);
+    CloseHandle(stdOutRead);
+    return nullptr;
+  }
+  return std::make_unique<WslSession>(process, stdInWrite, stdOutRead, std::move(consume));
+}
+
+std::optional<std::string> WslApiBackend::ReadFile(std::string_view path) try {
+  auto fullPath = (distroRoot(api_.DistributionName()) / Utf8ToWide(path)).make_preferred();
+  if (!fs::exists(fullPath)) {
+    return std::nullopt;
+  }
+  // A single read over the 9P share.
+  std::ifstream file{fullPath, std::ios::binary};
+  std::string contents{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+  if (file.bad()) {
+    throw std::system_error{errno, std::generic_category(), "couldn't read " + fullPath.string()};
+  }
+  return contents;
+
+} catch (std::system_error const& err) {
+  // std::filesystem_error is child of std::system_error
+  std::wcout << L"ERROR: failed to read " << Utf8ToWide(path) << L": " << err.code() << ": "
+             << fromAnsi(err.what());
+  return std::nullopt;
+}
+
+void WslApiBackend::Print(std::wstring_view line) { _putws(std::wstring{line}.c_str()); }
+
+void WslApiBackend::ShowProgress(std::wstring_view block) {
+  // Only a console understanding VT sequences can have lines replaced.
+  static const bool virtualTerminal = [] {
+    HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    return GetConsoleMode(console, &mode) &&
+           SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+  }();
+  if (!virtualTerminal) {
+    return;
+  }
+
+  std::scoped_lock lock{progressMutex_};
+  std::wstring out;
+  if (progressLines_ > 0) {
+    // Back to the first line shown, erasing everything below.
+    out += L"\x1b[" + std::to_wstring(progressLines_) + L"F";
+  }
+  out += L"\x1b[J";
+  out += block;
+  if (!block.empty() && block.back() != L'\n') {
+    out += L'\n';
+  }
+  progressLines_ = std::count(out.begin(), out.end(), L'\n');
+  fputws(out.c_str(), stdout);
+  fflush(stdout);
+}
+}  // namespace Ubuntu
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "WslBackend.h"
+
+#include <cstddef>
+#include <mutex>
+
+namespace Ubuntu {
+// The real WSL, reached through its API, and the console.
+class WslApiBackend : public WslBackend {
+ public:
+  explicit WslApiBackend(WslApiLoader& api) : api_{api} {}
+
+  std::optional<Configuration> GetConfiguration() override;
+  bool SetDefaultUid(unsigned long uid) override;
+  std::optional<unsigned long> LaunchInteractive(std::wstring_view command,
+                                                 bool useCurrentWorkingDirectory) override;
+  ProcessResult Run(std::wstring_view command, std::chrono::milliseconds timeout,
+                    const ConsumeFunction* consume = nullptr) override;
+  std::unique_ptr<Session> Spawn(std::wstring_view command, ConsumeFunction consume) override;
+  std::optional<std::string> ReadFile(std::string_view path) override;
+  void Print(std::wstring_view line) override;
+  void ShowProgress(std::wstring_view block) override;
+
+ private:
+  WslApiLoader& api_;
+  // Guards the lines shown by ShowProgress, to be erased by the next call.
+  std::mutex progressMutex_;
+  std::size_t progressLines_ = 0;
+};
+}  // namespace Ubuntu
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "OutputPump.h"
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// What the launcher's flows need from WSL and the console, so that they can run against something
+// else than the real thing, such as a simulated distro on Linux. It doesn't depend on any Windows
+// API, WslApiBackend providing the real implementation.
+//
+// Implementations must bear being called from several threads at once, as the WSL API does.
+namespace Ubuntu {
+// Outcome of a non-interactive process.
+struct ProcessResult {
+  // Empty on success.
+  std::wstring error;
+  std::size_t exitCode = static_cast<std::size_t>(-1);
+  std::string stdOut;
+  std::string stdErr;
+};
+
+class WslBackend {
+ public:
+  // A process left running in the background, fed through its stdin.
+  class Session {
+   public:
+    // Ends the process, if still running. Its output is no longer consumed once destroyed.
+    virtual ~Session() = default;
+
+    // Writes [data] to its stdin. Returns false if the process is gone.
+    virtual bool Write(std::string_view data) = 0;
+  };
+
+  // What WSL keeps about the distro.
+  struct Configuration {
+    // WSL_DISTRIBUTION_FLAGS_DEFAULT: interop, Windows paths appended to $PATH and drives mounted.
+    static constexpr unsigned long DefaultFlags = 0x7;
+
+    unsigned long version = 0;
+    unsigned long defaultUid = static_cast<unsigned long>(-1);
+    unsigned long flags = DefaultFlags;
+  };
+
+  static constexpr std::chrono::milliseconds NoTimeout = std::chrono::milliseconds::max();
+
+  virtual ~WslBackend() = default;
+
+  // Returns std::nullopt on failure, already reported.
+  virtual std::optional<Configuration> GetConfiguration() = 0;
+
+  // Makes [uid] the default user, leaving the flags as they are. Returns false on failure, already
+  // reported.
+  virtual bool SetDefaultUid(unsigned long uid) = 0;
+
+  // Runs [command] attached to the console, returning its exit code, or std::nullopt if it couldn't
+  // be launched, which is already reported.
+  virtual std::optional<unsigned long> LaunchInteractive(std::wstring_view command,
+                                                         bool useCurrentWorkingDirectory) = 0;
+
+  // Runs [command] in the background for at most [timeout], collecting its output. If given,
+  // [consume] is handed stdout as it arrives instead, as with WslProcess::run.
+  virtual ProcessResult Run(std::wstring_view command, std::chrono::milliseconds timeout,
+                            const ConsumeFunction* consume = nullptr) = 0;
+
+  // Starts [command] in the background with a pipe for stdin, handing its stdout and stderr, merged,
+  // to [consume] as they arrive, from another thread. [consume] is handed an empty chunk once the
+  // process is gone. Returns nullptr if it couldn't be started, which is already reported.
+  virtual std::unique_ptr<Session> Spawn(std::wstring_view command, ConsumeFunction consume) = 0;
+
+  // Reads the file at [path], relative to the root, straight from the distro's filesystem without
+  // launching anything. Returns std::nullopt if there is no such file or it couldn't be read.
+  virtual std::optional<std::string> ReadFile(std::string_view path) = 0;
+
+  // Shows a line of diagnostics to the user.
+  virtual void Print(std::wstring_view line) = 0;
+
+  // Replaces what the previous call showed with the few lines of [block], such as the tail of a
+  // log, where the console allows it. An empty [block] clears it.
+  virtual void ShowProgress(std::wstring_view block) = 0;
+};
+}  // namespace Ubuntu
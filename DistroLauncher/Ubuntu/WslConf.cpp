@@ -0,0 +1,166 @@
+#include "WslConf.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace Ubuntu {
+namespace {
+constexpr std::string_view blanks = " \t\r";
+
+std::string_view trim(std::string_view str) {
+  auto first = str.find_first_not_of(blanks);
+  if (first == std::string_view::npos) {
+    return {};
+  }
+  return str.substr(first, str.find_last_not_of(blanks) - first + 1);
+}
+
+char lower(char c) {
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Three-way comparison of ASCII strings ignoring case.
+int compareIgnoreCase(std::string_view a, std::string_view b) {
+  auto size = std::min(a.size(), b.size());
+  for (std::size_t i = 0; i < size; ++i) {
+    char x = lower(a[i]);
+    char y = lower(b[i]);
+    if (x != y) {
+      return x < y ? -1 : 1;
+    }
+  }
+  if (a.size() == b.size()) {
+    return 0;
+  }
+  return a.size() < b.size() ? -1 : 1;
+}
+
+// FNV-1a of the lowercase section and key, so the table is sorted and searched comparing integers.
+std::uint64_t hashName(std::string_view section, std::string_view key) {
+  std::uint64_t hash = 14695981039346656037ull;
+  auto feed = [&hash](std::string_view str) {
+    for (char c : str) {
+      hash = (hash ^ static_cast<unsigned char>(lower(c))) * 1099511628211ull;
+    }
+  };
+  feed(section);
+  // A character that cannot appear in names, so [ab].c and [a].bc hash differently.
+  hash = (hash ^ '\n') * 1099511628211ull;
+  feed(key);
+  return hash;
+}
+
+std::string_view unquote(std::string_view value) {
+  if (value.size() >= 2 && (value.front() == '"' || value.front() == '\'') &&
+      value.back() == value.front()) {
+    return value.substr(1, value.size() - 2);
+  }
+  return value;
+}
+}  // namespace
+
+WslConf WslConf::Parse(std::string contents) {
+  WslConf conf;
+  conf.buffer_ = std::move(contents);
+  // Offsets are 32 bits wide. Nobody writes a 4 GiB wsl.conf, but better safe than sorry.
+  std::string_view buffer{conf.buffer_};
+  if (buffer.size() > std::numeric_limits<std::uint32_t>::max()) {
+    buffer = buffer.substr(0, std::numeric_limits<std::uint32_t>::max());
+    conf.diagnostics_.push_back({0, "file too big, truncated"});
+  }
+  // Every entry has an equal sign, so this is an upper bound of the table size.
+  conf.entries_.reserve(static_cast<std::size_t>(std::count(buffer.begin(), buffer.end(), '=')));
+
+  auto span = [base = buffer.data()](std::string_view slice) {
+    return Span{static_cast<std::uint32_t>(slice.data() - base),
+                static_cast<std::uint32_t>(slice.size())};
+  };
+
+  // Editors on Windows like to prepend a byte order mark.
+  std::size_t position = buffer.substr(0, 3) == "\xEF\xBB\xBF" ? 3 : 0;
+  std::uint32_t lineNumber = 0;
+  std::optional<Span> section;
+  while (position < buffer.size()) {
+    ++lineNumber;
+    const char* begin = buffer.data() + position;
+    const void* newline = std::memchr(begin, '\n', buffer.size() - position);
+    std::size_t length =
+        newline ? static_cast<const char*>(newline) - begin : buffer.size() - position;
+    position += length + 1;
+
+    auto line = trim({begin, length});
+    if (line.empty() || line.front() == '#' || line.front() == ';') {
+      continue;
+    }
+
+    if (line.front() == '[') {
+      auto close = line.find(']');
+      if (close == std::string_view::npos) {
+        // Keys that follow don't belong anywhere sensible.
+        section.reset();
+        conf.diagnostics_.push_back({lineNumber, "unterminated section header"});
+        continue;
+      }
+      section = span(trim(line.substr(1, close - 1)));
+      continue;
+    }
+
+    auto eq = line.find('=');
+    if (eq == std::string_view::npos) {
+      conf.diagnostics_.push_back({lineNumber, "expected key=value"});
+      continue;
+    }
+    auto key = trim(line.substr(0, eq));
+    if (key.empty()) {
+      conf.diagnostics_.push_back({lineNumber, "empty key"});
+      continue;
+    }
+    if (!section) {
+      conf.diagnostics_.push_back({lineNumber, "key outside of any section"});
+      continue;
+    }
+    auto sectionName = conf.view(*section);
+    conf.entries_.push_back({hashName(sectionName, key), *section, span(key),
+                             span(unquote(trim(line.substr(eq + 1))))});
+  }
+
+  // Keys are unique offsets, thus breaking ties with them keeps duplicates in file order.
+  std::sort(conf.entries_.begin(), conf.entries_.end(), [](const Entry& a, const Entry& b) {
+    return a.hash != b.hash ? a.hash < b.hash : a.key.offset < b.key.offset;
+  });
+  return conf;
+}
+
+std::optional<std::string_view> WslConf::Get(std::string_view section, std::string_view key) const {
+  auto hash = hashName(section, key);
+  auto found = std::lower_bound(entries_.begin(), entries_.end(), hash,
+                                [](const Entry& e, std::uint64_t h) { return e.hash < h; });
+  // Entries sharing the hash are most likely duplicates of the same name, but might collide.
+  for (; found != entries_.end() && found->hash == hash; ++found) {
+    if (compareIgnoreCase(view(found->section), section) == 0 &&
+        compareIgnoreCase(view(found->key), key) == 0) {
+      return view(found->value);
+    }
+  }
+  return std::nullopt;
+}
+
+bool WslConf::GetBool(std::string_view section, std::string_view key, bool fallback) const {
+  auto value = Get(section, key);
+  if (!value) {
+    return fallback;
+  }
+  for (std::string_view yes : {"true", "yes", "1"}) {
+    if (compareIgnoreCase(*value, yes) == 0) {
+      return true;
+    }
+  }
+  for (std::string_view no : {"false", "no", "0"}) {
+    if (compareIgnoreCase(*value, no) == 0) {
+      return false;
+    }
+  }
+  return fallback;
+}
+}  // namespace Ubuntu
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// An in-memory parser for /etc/wsl.conf.
+//
+// The whole file is parsed in a single pass into a table of section/key/value triples, stored as
+// offsets into the one buffer holding the file contents, so parsing allocates nothing but the table
+// itself. It doesn't depend on any Windows API.
+namespace Ubuntu {
+class WslConf {
+ public:
+  // Something ignored while parsing, reported so it can be logged.
+  struct Diagnostic {
+    // 1-based line number.
+    std::uint32_t line;
+    const char* message;
+  };
+
+  // Takes ownership of the file [contents] and parses them. Never fails: ill-formed lines are
+  // skipped and reported as diagnostics, as WSL itself does.
+  static WslConf Parse(std::string contents);
+
+  // Returns the value of [section].[key] if set. Names are case insensitive and, as with
+  // GetPrivateProfileString, the first occurrence wins. Values surrounded by matching quotes are
+  // returned without them.
+  std::optional<std::string_view> Get(std::string_view section, std::string_view key) const;
+
+  // Interprets [section].[key] as a boolean ("true"/"false", "yes"/"no", "1"/"0"), returning
+  // [fallback] if unset or not a boolean.
+  bool GetBool(std::string_view section, std::string_view key, bool fallback) const;
+
+  // The number of section/key pairs found, duplicates included.
+  std::size_t size() const { return entries_.size(); }
+  const std::vector<Diagnostic>& Diagnostics() const { return diagnostics_; }
+
+  // [user]
+  std::string_view DefaultUser() const { return Get("user", "default").value_or(""); }
+
+  // [boot]
+  bool Systemd() const { return GetBool("boot", "systemd", false); }
+  std::string_view BootCommand() const { return Get("boot", "command").value_or(""); }
+
+  // [automount]
+  bool AutomountEnabled() const { return GetBool("automount", "enabled", true); }
+  std::string_view AutomountRoot() const { return Get("automount", "root").value_or("/mnt/"); }
+  std::string_view AutomountOptions() const { return Get("automount", "options").value_or(""); }
+
+  // [interop]
+  bool InteropEnabled() const { return GetBool("interop", "enabled", true); }
+  bool AppendWindowsPath() const { return GetBool("interop", "appendWindowsPath", true); }
+
+ private:
+  // A slice of buffer_. Offsets survive moves of the buffer, unlike string_views.
+  struct Span {
+    std::uint32_t offset = 0;
+    std::uint32_t size = 0;
+  };
+
+  struct Entry {
+    // Hash of the lowercase section and key names.
+    std::uint64_t hash;
+    Span section;
+    Span key;
+    Span value;
+  };
+
+  std::string_view view(Span span) const { return {buffer_.data() + span.offset, span.size}; }
+
+  std::string buffer_;
+  // Sorted by name hash, keeping the file order among duplicates.
+  std::vector<Entry> entries_;
+  std::vector<Diagnostic> diagnostics_;
+};
+}  // namespace Ubuntu
@@ -0,0 +1,153 @@
+#include <stdafx.h>
+#include "WslProcess.h"
+#include "OutputPump.h"
+#include "Trace.h"
+
+#include <atomic>
+
+namespace Ubuntu {
+namespace {
+// Creates a pipe whose write end only is inheritable by the child.
+bool createOutputPipe(HANDLE& read, HANDLE& write) {
+  SECURITY_ATTRIBUTES sa{sizeof(sa), nullptr, true};
+  if (CreatePipe(&read, &write, &sa, 0) == FALSE) {
+    return false;
+  }
+  SetHandleInformation(read, HANDLE_FLAG_INHERIT, 0);
+  return true;
+}
+
+ReadFunction readFrom(HANDLE pipe, const std::atomic<bool>& stopping) {
+  return [pipe, &stopping](char* buffer, std::size_t size) -> std::size_t {
+    DWORD readCount = 0;
+    if (stopping ||
+        ReadFile(pipe, buffer, static_cast<DWORD>(size), &readCount, nullptr) == FALSE) {
+      return 0;
+    }
+    return readCount;
+  };
+}
+
+// How long the output may keep flowing once the process is gone.
+constexpr DWORD drainTimeout = 5'000;
+
+// Waits for [pump] to reach the end of its stream, unblocking it if stuck in ReadFile because
+// something else holds the write end, e.g. the relay of a process we just terminated or a
+// background process it left behind. The cancellation only affects a read in progress, thus the
+// retries.
+void finish(OutputPump& pump, std::atomic<bool>& stopping) {
+  if (WaitForSingleObject(pump.NativeHandle(), stopping ? 0 : drainTimeout) == WAIT_TIMEOUT) {
+    stopping = true;
+    while (WaitForSingleObject(pump.NativeHandle(), 100) == WAIT_TIMEOUT) {
+      CancelSynchronousIo(pump.NativeHandle());
+    }
+  }
+  pump.Join();
+}
+}  // namespace
+
+WslProcess::~WslProcess() {
+  for (HANDLE handle :
+       {process_, enough_, stdOutRead_, stdOutWrite_, stdErrRead_, stdErrWrite_}) {
+    if (handle) {
+      CloseHandle(handle);
+    }
+  }
+}
+
+WslProcess::Result WslProcess::run(WslApiLoader& api, DWORD timeout) {
+  return execute(api, timeout, nullptr);
+}
+
+WslProcess::Result WslProcess::run(WslApiLoader& api, DWORD timeout,
+                                   const ConsumeFunction& consume) {
+  return execute(api, timeout, &consume);
+}
+
+WslProcess::Result WslProcess::execute(WslApiLoader& api, DWORD timeout,
+                                       const ConsumeFunction* consume) {
+  Trace::Span span{"WslProcess::run", command_};
+  if (consume) {
+    enough_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (enough_ == nullptr) {
+      return {L"failed to create the stop event"};
+    }
+  }
+
+  // Create pipes to read the output of the launched process. The handles are closed by the
+  // destructor.
+  if (!createOutputPipe(stdOutRead_, stdOutWrite_) ||
+      !createOutputPipe(stdErrRead_, stdErrWrite_)) {
+    return {L"failed to create the stdio pipes"};
+  }
+
+  HANDLE process = nullptr;
+  auto hr = api.WslLaunch(command_.c_str(), FALSE, GetStdHandle(STD_INPUT_HANDLE), stdOutWrite_,
+                          stdErrWrite_, &process);
+  if (FAILED(hr)) {
+    return {L"failed to launch process"};
+  }
+  // Also need to remember to close the process handle.
+  process_ = process;
+
+  // The child has its own copies of the write ends by now. Closing ours is what makes ReadFile fail
+  // with ERROR_BROKEN_PIPE once the child is gone.
+  CloseHandle(stdOutWrite_);
+  stdOutWrite_ = nullptr;
+  CloseHandle(stdErrWrite_);
+  stdErrWrite_ = nullptr;
+
+  // Drain both pipes while the child runs. Waiting for it to exit before reading, or reading them
+  // one after the other, would deadlock as soon as some output doesn't fit in a pipe buffer.
+  std::atomic<bool> stopping{false};
+  ChunkedBuffer stdOut{maxOutputSize_};
+  std::size_t stdOutSize = 0;
+  OutputPump out{readFrom(stdOutRead_, stopping), [&](std::string_view data) {
+                   stdOutSize += data.size();
+                   if (consume == nullptr) {
+                     stdOut.Append(data);
+                     return true;
+                   }
+                   if ((*consume)(data)) {
+                     return true;
+                   }
+                   SetEvent(enough_);
+                   return false;
+                 }};
+  OutputPump err{readFrom(stdErrRead_, stopping), maxOutputSize_};
+
+  HANDLE waitables[] = {process_, enough_};
+  auto wait = WaitForMultipleObjects(enough_ ? 2 : 1, waitables, FALSE, timeout);
+  if (wait != WAIT_OBJECT_0) {
+    // Either timed out or nothing else is wanted from it.
+    TerminateProcess(process_, wait == WAIT_TIMEOUT ? ERROR_TIMEOUT : ERROR_CANCELLED);
+    stopping = true;
+  }
+  finish(out, stopping);
+  finish(err, stopping);
+
+  // The consumer may have had enough just as the process exited by itself.
+  if (out.Stopped()) {
+    return {{}, 0, {}, err.Output().str()};
+  }
+
+  if (wait == WAIT_TIMEOUT) {
+    return {L"terminated due timed out"};
+  }
+
+  DWORD exitCode = -1;
+  if ((GetExitCodeProcess(process_, &exitCode) == false) || (exitCode != 0)) {
+    return {L"exited with error", exitCode, stdOut.str(), err.Output().str()};
+  }
+
+  if (stdOut.Overflowed() || err.Output().Overflowed()) {
+    return {L"process output is too big", 0};
+  }
+
+  if (stdOutSize == 0) {
+    return {L"could not read the process output", 0, {}, err.Output().str()};
+  }
+
+  return {{}, 0, stdOut.str(), err.Output().str()};
+}
+}  // namespace Ubuntu
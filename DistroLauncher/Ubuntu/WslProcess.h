@@ -0,0 +1,51 @@
+#pragma once
+
+#include "OutputPump.h"
+#include "WslBackend.h"
+
+#include <cstddef>
+#include <string>
+
+namespace Ubuntu {
+// A non-interactive WSL process, turned into a class so we don't have to worry about closing
+// the process and pipe's handles.
+//
+// Both stdout and stderr are drained while the process runs, so it never blocks writing to a full
+// pipe no matter how much it outputs.
+class WslProcess {
+ public:
+  // Bounds the memory used to store each of the output streams by default.
+  static constexpr std::size_t DefaultMaxOutputSize = 64 * 1024 * 1024;
+
+  using Result = ProcessResult;
+
+  explicit WslProcess(std::wstring command, std::size_t maxOutputSize = DefaultMaxOutputSize)
+      : command_{std::move(command)}, maxOutputSize_{maxOutputSize} {}
+
+  ~WslProcess();
+
+  WslProcess(const WslProcess&) = delete;
+  WslProcess& operator=(const WslProcess&) = delete;
+
+  // Runs the process via WSL api and wait for timeout milliseconds.
+  Result run(WslApiLoader& api, DWORD timeout);
+
+  // Same as above, except that stdout is handed to [consume] as it arrives instead of being stored.
+  // The process is terminated as soon as [consume] returns false, which counts as a success
+  // whatever it would have output next.
+  Result run(WslApiLoader& api, DWORD timeout, const ConsumeFunction& consume);
+
+ private:
+  Result execute(WslApiLoader& api, DWORD timeout, const ConsumeFunction* consume);
+
+  HANDLE process_ = nullptr;
+  // Signaled when the consumer had enough.
+  HANDLE enough_ = nullptr;
+  HANDLE stdOutRead_ = nullptr;
+  HANDLE stdOutWrite_ = nullptr;
+  HANDLE stdErrRead_ = nullptr;
+  HANDLE stdErrWrite_ = nullptr;
+  std::wstring command_;
+  std::size_t maxOutputSize_;
+};
+}  // namespace Ubuntu
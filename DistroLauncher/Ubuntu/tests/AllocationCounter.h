@@ -0,0 +1,19 @@
+#pragma once
+
+// Counting the heap allocations made by the code under benchmark, by replacing the global operator
+// new in any executable linking AllocationCounter.cpp.
+
+#include <cstddef>
+
+namespace Ubuntu::Testing {
+// The number of calls to operator new since the program started.
+std::size_t Allocations();
+
+// The number of allocations [f] makes.
+template <typename F>
+std::size_t AllocationsOf(F&& f) {
+  auto before = Allocations();
+  f();
+  return Allocations() - before;
+}
+}  // namespace Ubuntu::Testing
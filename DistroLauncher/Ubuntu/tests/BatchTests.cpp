@@ -0,0 +1,162 @@
+#include "Check.h"
+#include "Host.h"
+#include "SimulatedWsl.h"
+#include "../Batch.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace Batch = Ubuntu::Batch;
+using Ubuntu::ProcessResult;
+using Ubuntu::Testing::HostSession;
+using Ubuntu::Testing::SimulatedWsl;
+
+namespace {
+// Collects what a Demuxer hands out.
+struct Collected {
+  std::string output;
+  std::vector<Batch::CommandResult> results;
+
+  Batch::Demuxer demuxer(std::string marker) {
+    return Batch::Demuxer{
+        std::move(marker), [this](std::string_view data) { output += data; },
+        [this](const Batch::CommandResult& result) { results.push_back(result); }};
+  }
+};
+
+void parsesScripts() {
+  auto commands = Batch::ParseScript("make\r\n\n  # a comment\n\tmake test  \nmake install");
+  CHECK(commands.size() == 3);
+  CHECK(commands[0] == "make");
+  CHECK(commands[1] == "make test  ");
+  CHECK(commands[2] == "make install");
+  CHECK(Batch::ParseScript("").empty());
+}
+
+void demuxesRecords() {
+  const std::string session = "hello\n\nM 0 0 1500\nno newline\nM 1 2 20\n\nM 2 0 3\n";
+  // However it is chunked.
+  for (std::size_t chunkSize : {std::size_t{1}, std::size_t{3}, session.size()}) {
+    Collected collected;
+    auto demuxer = collected.demuxer("M");
+    for (std::size_t offset = 0; offset < session.size(); offset += chunkSize) {
+      demuxer.Feed(std::string_view{session}.substr(offset, chunkSize));
+    }
+    demuxer.Finish();
+    CHECK(collected.output == "hello\nno newline");
+    CHECK(collected.results.size() == 3);
+    CHECK(demuxer.Results() == 3);
+    CHECK(collected.results[0].elapsed.count() == 1500);
+    CHECK(collected.results[1].index == 1 && collected.results[1].exitCode == 2);
+  }
+}
+
+void holdsBackOnlyWhatMayBeARecord() {
+  Collected collected;
+  auto demuxer = collected.demuxer("marker");
+  demuxer.Feed("progress 10%\n");
+  CHECK(collected.output == "progress 10%");
+  demuxer.Feed("progress 20%\n\nmar");
+  CHECK(collected.output == "progress 10%\nprogress 20%\n");
+  demuxer.Feed("ch\n");
+  CHECK(collected.output == "progress 10%\nprogress 20%\n\nmarch");
+  // Ill-formed records are output too.
+  demuxer.Feed("\nmarker x\n");
+  CHECK(collected.output == "progress 10%\nprogress 20%\n\nmarch\n\nmarker x\n");
+  demuxer.Feed("\n");
+  demuxer.Finish();
+  CHECK(collected.output == "progress 10%\nprogress 20%\n\nmarch\n\nmarker x\n\n");
+  CHECK(collected.results.empty());
+}
+
+void runsCommandsInOneSession() {
+  SimulatedWsl wsl{{}};
+  wsl.SetSessionFixture(HostSession::Start);
+  std::string output;
+  std::vector<std::size_t> finished;
+  auto result = Batch::Run(
+      wsl, {"echo one", "printf 'two'; exit 3", "cd /; pwd", "pwd | grep -vx /", "cat"}, {},
+      [&](std::string_view data) { output += data; },
+      [&](const Batch::CommandResult& command) { finished.push_back(command.index); });
+  CHECK(result.error.empty());
+  CHECK(wsl.Commands().size() == 1);
+  CHECK(output.find("one\ntwo/\n") == 0);
+  CHECK(result.commands.size() == 5);
+  CHECK(finished == (std::vector<std::size_t>{0, 1, 2, 3, 4}));
+  CHECK(result.commands[1].exitCode == 3);
+  // Each in its own subshell, reading nothing.
+  CHECK(result.commands[3].exitCode == 0);
+  CHECK(result.commands[4].exitCode == 0);
+  CHECK(result.ExitCode() == 3);
+}
+
+void stopsOnFailureIfTold() {
+  SimulatedWsl wsl{{}};
+  wsl.SetSessionFixture(HostSession::Start);
+  std::string output;
+  Batch::Options options;
+  options.stopOnFailure = true;
+  auto result = Batch::Run(
+      wsl, {"echo 'it''s fine'", "sleep 0.01; false", "echo skipped"}, options,
+      [&](std::string_view data) { output += data; }, {});
+  CHECK(result.error.empty());
+  CHECK(output == "its fine\n");
+  CHECK(result.commands.size() == 2);
+  CHECK(result.commands[1].exitCode == 1);
+  CHECK(result.commands[1].elapsed >= std::chrono::milliseconds{10});
+  CHECK(result.ExitCode() == 1);
+}
+
+void runsBatchesLongerThanACommandLine() {
+  SimulatedWsl wsl{{}};
+  wsl.SetSessionFixture(HostSession::Start);
+  // Well past the 128 KiB a single argument of a command line can hold on Linux.
+  std::vector<std::string> commands(500, "echo " + std::string(300, 'x'));
+  std::size_t lines = 0;
+  auto result = Batch::Run(
+      wsl, commands, {},
+      [&](std::string_view data) { lines += std::count(data.begin(), data.end(), '\n'); }, {});
+  CHECK(result.error.empty());
+  CHECK(result.commands.size() == commands.size());
+  CHECK(lines == commands.size());
+}
+
+void reportsADeadSession() {
+  SimulatedWsl wsl{{}};
+  wsl.SetFixture([](std::string_view command) -> std::optional<ProcessResult> {
+    // As if killed while running the second command.
+    if (command == "echo second") {
+      return ProcessResult{L"the session was killed"};
+    }
+    return ProcessResult{{}, 0, "first\n"};
+  });
+  std::string output;
+  auto result =
+      Batch::Run(wsl, {"echo first", "echo second"}, {},
+                 [&](std::string_view data) { output += data; }, {});
+  CHECK(output == "first\n");
+  CHECK(result.commands.size() == 1);
+  CHECK(!result.error.empty());
+
+  SimulatedWsl unstartable{{}};
+  unstartable.SetSessionFixture(
+      [](std::string_view, Ubuntu::ConsumeFunction) { return nullptr; });
+  CHECK(!Batch::Run(unstartable, {"true"}, {}, {}, {}).error.empty());
+
+  SimulatedWsl empty{{}};
+  CHECK(Batch::Run(empty, {}, {}, {}, {}).commands.empty());
+  CHECK(empty.Commands().empty());
+}
+}  // namespace
+
+int main() {
+  RUN(parsesScripts);
+  RUN(demuxesRecords);
+  RUN(holdsBackOnlyWhatMayBeARecord);
+  RUN(runsCommandsInOneSession);
+  RUN(stopsOnFailureIfTold);
+  RUN(runsBatchesLongerThanACommandLine);
+  RUN(reportsADeadSession);
+  return TEST_EXIT_CODE();
+}
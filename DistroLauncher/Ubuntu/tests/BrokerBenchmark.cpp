@@ -0,0 +1,113 @@
+#include "SimulatedWsl.h"
+#include "../Broker.h"
+#include "../Utf8.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using Ubuntu::ProcessResult;
+using Ubuntu::Testing::Latency;
+using Ubuntu::Testing::SimulatedWsl;
+
+namespace {
+struct Profile {
+  const char* name;
+  Latency latency;
+};
+
+// Orders of magnitude seen on a WSL 2 VM already running. The boot of a VM shut down while idle,
+// which the broker also spares by keeping it busy, isn't modelled.
+const Profile profiles[] = {
+    {"none", {}},
+    {"wsl2", {std::chrono::microseconds{300}, std::chrono::milliseconds{20},
+              std::chrono::microseconds{50}, std::chrono::milliseconds{1}}},
+};
+
+std::optional<ProcessResult> answer(std::string_view command) {
+  return ProcessResult{{}, 0, std::string{command} + "\n"};
+}
+
+using Clock = std::chrono::steady_clock;
+
+// Invocations of `run` launching the command themselves.
+std::vector<Clock::duration> cold(const Profile& profile, int runs) {
+  SimulatedWsl wsl{{}, profile.latency};
+  wsl.SetFixture(answer);
+  std::vector<Clock::duration> latencies;
+  for (int i = 0; i < runs; ++i) {
+    auto start = Clock::now();
+    std::size_t received = 0;
+    Ubuntu::ConsumeFunction consume = [&](std::string_view data) {
+      received += data.size();
+      return true;
+    };
+    wsl.Run(L"echo hello", Ubuntu::WslBackend::NoTimeout, &consume);
+    latencies.push_back(Clock::now() - start);
+  }
+  return latencies;
+}
+
+// Invocations of `run` handing the command to a broker over a pipe, as they would a named pipe.
+std::vector<Clock::duration> warm(const Profile& profile, int runs) {
+  SimulatedWsl wsl{{}, profile.latency};
+  wsl.SetFixture(answer);
+  Ubuntu::Broker::Pool pool{wsl};
+  pool.Prewarm();
+  auto reader = [](int fd) {
+    return [fd](char* buffer, std::size_t size) -> std::size_t {
+      auto count = ::read(fd, buffer, size);
+      return count > 0 ? static_cast<std::size_t>(count) : 0;
+    };
+  };
+  auto writer = [](int fd) {
+    return [fd](std::string_view data) {
+      return ::write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size());
+    };
+  };
+  std::vector<Clock::duration> latencies;
+  for (int i = 0; i < runs; ++i) {
+    int toBroker[2];
+    int toClient[2];
+    if (pipe(toBroker) != 0 || pipe(toClient) != 0) {
+      std::perror("pipe");
+      std::exit(1);
+    }
+    std::thread broker{
+        [&] { Ubuntu::Broker::Serve(pool, reader(toBroker[0]), writer(toClient[1])); }};
+    auto start = Clock::now();
+    std::size_t received = 0;
+    Ubuntu::Broker::Request(reader(toClient[0]), writer(toBroker[1]), "echo hello", {},
+                            [&](std::string_view data) { received += data.size(); });
+    latencies.push_back(Clock::now() - start);
+    broker.join();
+    for (int fd : {toBroker[0], toBroker[1], toClient[0], toClient[1]}) {
+      close(fd);
+    }
+  }
+  return latencies;
+}
+
+double percentile(std::vector<Clock::duration> latencies, double p) {
+  std::sort(latencies.begin(), latencies.end());
+  auto index = static_cast<std::size_t>(p * (latencies.size() - 1));
+  return std::chrono::duration<double, std::milli>(latencies[index]).count();
+}
+}  // namespace
+
+int main() {
+  std::printf("%-8s %-6s %10s %10s\n", "latency", "mode", "p50 ms", "p99 ms");
+  for (const auto& profile : profiles) {
+    int runs = profile.latency.launch.count() == 0 ? 2000 : 100;
+    for (auto [mode, latencies] : {std::pair{"cold", cold(profile, runs)},
+                                   std::pair{"warm", warm(profile, runs)}}) {
+      std::printf("%-8s %-6s %10.3f %10.3f\n", profile.name, mode, percentile(latencies, 0.5),
+                  percentile(latencies, 0.99));
+    }
+  }
+  return 0;
+}
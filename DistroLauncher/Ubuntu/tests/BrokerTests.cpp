@@ -0,0 +1,211 @@
+#include "Check.h"
+#include "SimulatedWsl.h"
+#include "../Broker.h"
+#include "../Provisioning.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unistd.h>
+#include <vector>
+
+namespace Broker = Ubuntu::Broker;
+using Ubuntu::ProcessResult;
+using Ubuntu::Testing::Latency;
+using Ubuntu::Testing::SimulatedWsl;
+using namespace std::chrono_literals;
+
+namespace {
+// Answers "echo <text>" and "exit <code>", anything else succeeding silently.
+std::optional<ProcessResult> shellLike(std::string_view command) {
+  if (command.substr(0, 5) == "echo ") {
+    return ProcessResult{{}, 0, std::string{command.substr(5)} + "\n"};
+  }
+  if (command.substr(0, 5) == "exit ") {
+    return ProcessResult{{}, std::stoul(std::string{command.substr(5)})};
+  }
+  if (command == "die") {
+    return ProcessResult{L"killed"};
+  }
+  return std::nullopt;
+}
+
+// Both ends of a connection made of two pipes, as a named pipe would be.
+struct Connection {
+  int toBroker[2];
+  int toClient[2];
+
+  Connection() {
+    CHECK(pipe(toBroker) == 0);
+    CHECK(pipe(toClient) == 0);
+  }
+
+  ~Connection() {
+    for (int fd : {toBroker[0], toBroker[1], toClient[0], toClient[1]}) {
+      close(fd);
+    }
+  }
+
+  static Ubuntu::ReadFunction reader(int fd) {
+    return [fd](char* buffer, std::size_t size) -> std::size_t {
+      auto count = ::read(fd, buffer, size);
+      return count > 0 ? static_cast<std::size_t>(count) : 0;
+    };
+  }
+
+  static Broker::WriteFunction writer(int fd) {
+    return [fd](std::string_view data) {
+      while (!data.empty()) {
+        auto count = ::write(fd, data.data(), data.size());
+        if (count <= 0) {
+          return false;
+        }
+        data.remove_prefix(static_cast<std::size_t>(count));
+      }
+      return true;
+    };
+  }
+};
+
+void readsRecordsAsTheyArrive() {
+  std::string stream;
+  Ubuntu::Provisioning::AppendRecord(stream, "output", "a\nb");
+  Ubuntu::Provisioning::AppendRecord(stream, "exit", "0");
+  std::vector<std::string> records;
+  Ubuntu::Provisioning::RecordReader reader;
+  for (char c : stream) {
+    CHECK(reader.Feed({&c, 1}, [&](std::string_view tag, std::string_view payload) {
+      records.push_back(std::string{tag} + "=" + std::string{payload});
+      return true;
+    }));
+  }
+  CHECK(records == (std::vector<std::string>{"output=a\nb", "exit=0"}));
+
+  Ubuntu::Provisioning::RecordReader small{4};
+  CHECK(!small.Feed("output 5\nhello\n", [](auto, auto) { return true; }));
+  Ubuntu::Provisioning::RecordReader garbage;
+  CHECK(!garbage.Feed(std::string(100, 'x'), [](auto, auto) { return true; }));
+  CHECK(!garbage.Feed("exit 1\n0\n", [](auto, auto) { return true; }));
+}
+
+void runsCommandsInOneShell() {
+  SimulatedWsl wsl{{}};
+  wsl.SetFixture(shellLike);
+  auto shell = Broker::WarmShell::Start(wsl);
+  CHECK(shell != nullptr);
+  for (int i = 0; i < 3; ++i) {
+    std::string output;
+    auto result = shell->Run("echo hi", "C:\\Users", [&](std::string_view data) { output += data; });
+    CHECK(result && result->exitCode == 0 && result->index == static_cast<std::size_t>(i));
+    CHECK(output == "hi\n");
+  }
+  auto failed = shell->Run("exit 7", {}, [](std::string_view) {});
+  CHECK(failed && failed->exitCode == 7);
+  CHECK(wsl.Commands().size() == 1);
+  CHECK(wsl.StepsRun() == 4);
+
+  CHECK(!shell->Run("die", {}, [](std::string_view) {}));
+  CHECK(!shell->Alive());
+  CHECK(!shell->Run("echo too late", {}, [](std::string_view) {}));
+}
+
+void poolReusesAndReplacesShells() {
+  SimulatedWsl wsl{{}};
+  wsl.SetFixture(shellLike);
+  Broker::Pool pool{wsl, {1, 2}};
+  CHECK(pool.Prewarm() == 1);
+  for (int i = 0; i < 5; ++i) {
+    CHECK(pool.Run("echo x", {}, [](std::string_view) {}));
+  }
+  CHECK(pool.ShellsStarted() == 1);
+
+  CHECK(!pool.Run("die", {}, [](std::string_view) {}));
+  auto result = pool.Run("exit 3", {}, [](std::string_view) {});
+  CHECK(result && result->exitCode == 3);
+  CHECK(pool.ShellsStarted() == 2);
+  CHECK(wsl.Commands().size() == 2);
+}
+
+void poolBoundsTheShells() {
+  Latency latency;
+  latency.perChunk = 20ms;
+  SimulatedWsl wsl{{}, latency};
+  wsl.SetFixture(shellLike);
+  Broker::Pool pool{wsl, {0, 2}};
+  std::vector<std::thread> clients;
+  std::atomic<int> succeeded{0};
+  for (int i = 0; i < 6; ++i) {
+    clients.emplace_back([&] {
+      if (pool.Run("echo x", {}, [](std::string_view) {})) {
+        ++succeeded;
+      }
+    });
+  }
+  for (auto& client : clients) {
+    client.join();
+  }
+  CHECK(succeeded == 6);
+  CHECK(pool.ShellsStarted() == 2);
+}
+
+void servesRequests() {
+  SimulatedWsl wsl{{}};
+  wsl.SetFixture(shellLike);
+  Broker::Pool pool{wsl};
+  for (auto [command, exitCode, output] :
+       {std::tuple{"echo served", 0ul, "served\n"}, std::tuple{"exit 42", 42ul, ""}}) {
+    Connection connection;
+    std::thread broker{[&] {
+      Broker::Serve(pool, Connection::reader(connection.toBroker[0]),
+                    Connection::writer(connection.toClient[1]));
+    }};
+    std::string received;
+    auto reply = Broker::Request(Connection::reader(connection.toClient[0]),
+                                 Connection::writer(connection.toBroker[1]), command, "C:\\",
+                                 [&](std::string_view data) { received += data; });
+    broker.join();
+    CHECK(reply.error.empty());
+    CHECK(reply.exitCode == exitCode);
+    CHECK(received == output);
+  }
+  CHECK(pool.ShellsStarted() == 1);
+
+  // The broker couldn't run it.
+  Connection connection;
+  std::thread broker{[&] {
+    Broker::Serve(pool, Connection::reader(connection.toBroker[0]),
+                  Connection::writer(connection.toClient[1]));
+  }};
+  auto reply = Broker::Request(Connection::reader(connection.toClient[0]),
+                               Connection::writer(connection.toBroker[1]), "die", {},
+                               [](std::string_view) {});
+  broker.join();
+  CHECK(!reply.exitCode && !reply.error.empty());
+}
+
+void refusesIllFormedRequests() {
+  SimulatedWsl wsl{{}};
+  Broker::Pool pool{wsl};
+  Connection connection;
+  std::string garbage = "run x\n";
+  CHECK(Connection::writer(connection.toBroker[1])(garbage));
+  Broker::Serve(pool, Connection::reader(connection.toBroker[0]),
+                Connection::writer(connection.toClient[1]));
+  char buffer[64];
+  auto count = ::read(connection.toClient[0], buffer, sizeof(buffer));
+  CHECK(std::string_view(buffer, count).substr(0, 6) == "error ");
+  CHECK(pool.ShellsStarted() == 0);
+}
+}  // namespace
+
+int main() {
+  RUN(readsRecordsAsTheyArrive);
+  RUN(runsCommandsInOneShell);
+  RUN(poolReusesAndReplacesShells);
+  RUN(poolBoundsTheShells);
+  RUN(servesRequests);
+  RUN(refusesIllFormedRequests);
+  return TEST_EXIT_CODE();
+}
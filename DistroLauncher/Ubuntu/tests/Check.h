@@ -0,0 +1,26 @@
+#pragma once
+
+// Just enough of a test harness for the portable parts of the launcher, so they can be exercised on
+// any Linux box without pulling a test framework.
+
+#include <cstdio>
+
+namespace Ubuntu::Testing {
+inline int failures = 0;
+}  // namespace Ubuntu::Testing
+
+#define CHECK(condition)                                                              \
+  do {                                                                                \
+    if (!(condition)) {                                                               \
+      std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+      ++Ubuntu::Testing::failures;                                                    \
+    }                                                                                 \
+  } while (false)
+
+#define RUN(test)                           \
+  do {                                      \
+    std::fprintf(stderr, "=== %s\n", #test); \
+    test();                                 \
+  } while (false)
+
+#define TEST_EXIT_CODE() (Ubuntu::Testing::failures == 0 ? 0 : 1)
@@ -0,0 +1,169 @@
+#include "Check.h"
+#include "SimulatedWsl.h"
+#include "../CloudInit.h"
+
+#include <chrono>
+#include <string>
+
+namespace CloudInit = Ubuntu::CloudInit;
+using CloudInit::LogTail;
+using CloudInit::Status;
+using Outcome = CloudInit::WaitResult::Outcome;
+using Ubuntu::Testing::SimulatedWsl;
+using namespace std::chrono_literals;
+
+namespace {
+// As cloud-init 23.4 outputs it while running modules-config.
+const char* runningJson = R"({
+  "boot_status_code": "enabled-by-generator",
+  "datasource": "wsl",
+  "detail": "DataSourceWSL",
+  "errors": [],
+  "extended_status": "running",
+  "init": {"errors": [], "finished": 1700000012.5, "recoverable_errors": {}, "start": 1700000010.0},
+  "init-local": {"errors": [], "finished": 1700000009.5, "recoverable_errors": {}, "start": 1700000009.0},
+  "last_update": "Tue, 14 Nov 2023 22:13:32 +0000",
+  "modules-config": {"errors": [], "finished": null, "recoverable_errors": {}, "start": 1700000013.0},
+  "modules-final": {"errors": [], "finished": null, "recoverable_errors": {}, "start": null},
+  "recoverable_errors": {},
+  "stage": "modules-config",
+  "status": "running"
+})";
+
+const char* doneJson = R"({"extended_status": "done", "status": "done", "stage": null, "errors": [],
+  "modules-final": {"start": 1700000014.0, "finished": 1700000020.5}})";
+
+const char* degradedJson =
+    R"({"extended_status": "degraded done", "status": "done", "errors": ["oops"]})";
+
+// Polls as fast as possible.
+CloudInit::WaitOptions quickly() {
+  CloudInit::WaitOptions options;
+  options.initialBackoff = 1ms;
+  options.maxBackoff = 2ms;
+  options.deadline = 5s;
+  return options;
+}
+
+void parsesTheJsonStatus() {
+  auto status = CloudInit::ParseStatus(runningJson);
+  CHECK(status && status->state == Status::State::Running);
+  CHECK(status->stage == "modules-config");
+  CHECK(!status->Finished());
+  CHECK(status->stages.size() == 4);
+  CHECK(status->stages[0].name == "init-local");
+  CHECK(status->stages[1].Seconds() == 2.5);
+  CHECK(!status->stages[2].Seconds().has_value());
+  CHECK(!status->stages[3].start.has_value());
+  CHECK(CloudInit::FormatStageTimings(*status) ==
+        "init-local: 0.5 s\ninit: 2.5 s\nmodules-config: running\n");
+
+  auto degraded = CloudInit::ParseStatus(degradedJson);
+  CHECK(degraded && degraded->state == Status::State::Degraded && degraded->Finished());
+  CHECK(degraded->errors.size() == 1 && degraded->errors[0] == "oops");
+}
+
+void parsesThePlainStatus() {
+  auto status = CloudInit::ParseStatus("\nstatus: done\nboot_status_code: enabled\n");
+  CHECK(status && status->state == Status::State::Done);
+  CHECK(CloudInit::ParseStatus("status: not run\n")->state == Status::State::NotStarted);
+  CHECK(!CloudInit::ParseStatus("status: confused\n"));
+  CHECK(!CloudInit::ParseStatus("usage: cloud-init\n"));
+  CHECK(!CloudInit::ParseStatus(""));
+  CHECK(!CloudInit::ParseStatus("{\"status\": 1}"));
+}
+
+void keepsTheLastLines() {
+  LogTail tail{2, 8};
+  tail.Feed("one\ntwo\nthr");
+  CHECK(tail.Text() == "two\nthr\n");
+  tail.Feed("ee\nfour is long\n");
+  CHECK(tail.Text() == "three\nfour is \n");
+  tail.Feed("10%\r99%\r\n");
+  CHECK(tail.Text() == "four is \n99%\n");
+  CHECK(tail.BytesSeen() == 36);
+
+  LogTail none{0};
+  none.Feed("a\nb");
+  CHECK(none.Text().empty());
+  CHECK(none.BytesSeen() == 3);
+}
+
+void waitsUntilDone() {
+  SimulatedWsl::Distro distro;
+  distro.cloudInitStatuses = {runningJson, runningJson, doneJson};
+  distro.cloudInitLogs = {"a\n", "a\nb\n", "a\nb\nc\n"};
+  SimulatedWsl wsl{distro};
+  auto result = CloudInit::Wait(wsl, quickly());
+  CHECK(result.outcome == Outcome::Done);
+  CHECK(result.polls == 3);
+  CHECK(wsl.CloudInitPolls() == 3);
+  // Each poll only brings what the log gained.
+  CHECK(wsl.Progress().size() == 4);
+  CHECK(wsl.Progress()[2] == L"a\nb\nc\n");
+  CHECK(wsl.Progress().back().empty());
+  CHECK(result.status.stages.size() == 1);
+  CHECK(result.status.stages[0].Seconds() == 6.5);
+}
+
+void givesUpOnceTheDeadlineExpires() {
+  SimulatedWsl::Distro distro;
+  distro.cloudInitStatuses = {runningJson};
+  SimulatedWsl wsl{distro};
+  auto options = quickly();
+  options.deadline = 50ms;
+  auto start = std::chrono::steady_clock::now();
+  auto result = CloudInit::Wait(wsl, options);
+  CHECK(result.outcome == Outcome::TimedOut);
+  CHECK(result.polls > 2);
+  CHECK(std::chrono::steady_clock::now() - start < 1s);
+  CHECK(result.status.stage == "modules-config");
+}
+
+void backsOff() {
+  SimulatedWsl::Distro distro;
+  distro.cloudInitStatuses = {runningJson};
+  SimulatedWsl wsl{distro};
+  CloudInit::WaitOptions options;
+  options.initialBackoff = 10ms;
+  options.maxBackoff = 40ms;
+  options.deadline = 200ms;
+  auto result = CloudInit::Wait(wsl, options);
+  // 10 + 15 + 22 + 33 + 40 + 40 + 40 > 200 ms: about 7 polls, rather than 20 without backoff.
+  CHECK(result.polls >= 5 && result.polls <= 9);
+}
+
+void skipsDisabledCloudInit() {
+  SimulatedWsl wsl{{}};
+  auto result = CloudInit::Wait(wsl, quickly());
+  CHECK(result.outcome == Outcome::Disabled);
+  CHECK(result.polls == 1);
+  CHECK(wsl.Progress().empty());
+}
+
+void reportsErrors() {
+  SimulatedWsl::Distro distro;
+  distro.cloudInitStatuses = {degradedJson};
+  SimulatedWsl wsl{distro};
+  auto result = CloudInit::Wait(wsl, quickly());
+  CHECK(result.outcome == Outcome::Degraded);
+  CHECK(result.status.errors.size() == 1);
+
+  distro.cloudInitStatuses = {"Traceback (most recent call last):"};
+  SimulatedWsl broken{distro};
+  CHECK(CloudInit::Wait(broken, quickly()).outcome == Outcome::Unavailable);
+  CHECK(!broken.Printed().empty());
+}
+}  // namespace
+
+int main() {
+  RUN(parsesTheJsonStatus);
+  RUN(parsesThePlainStatus);
+  RUN(keepsTheLastLines);
+  RUN(waitsUntilDone);
+  RUN(givesUpOnceTheDeadlineExpires);
+  RUN(backsOff);
+  RUN(skipsDisabledCloudInit);
+  RUN(reportsErrors);
+  return TEST_EXIT_CODE();
+}
@@ -0,0 +1,337 @@
+// Compiles messages.mc into MessageCatalog.h, the tables Ubuntu::Messages formats the launcher's
+// messages from (see Messages.h):
+//   CompileMessages <messages.mc> <MessageCatalog.h>
+//   CompileMessages --check <messages.mc> <MessageCatalog.h>
+// The latter fails if the catalog is out of date instead of writing it.
+//
+// Only what messages.mc uses of the message compiler's syntax is understood: MessageId and
+// SymbolicName, a single language, the escapes %%, %n, %t, %b, %r, %., %! and %0, and inserts as
+// %n, %n!s!, %n!S!, %n!u! and %n!x!.
+
+#include "../Utf8.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+struct Piece {
+  std::string literal;
+  unsigned insert = 0;
+  std::string kind;
+};
+
+struct Message {
+  unsigned long id = 0;
+  std::string name;
+  std::vector<Piece> pieces;
+  // The kind of each insert, %1 first.
+  std::vector<std::string> inserts;
+};
+
+// Thrown on anything not understood, with the line it was found on.
+struct Error {
+  std::size_t line;
+  std::string what;
+};
+
+std::string readFile(const char* path) {
+  std::ifstream file{path, std::ios::binary};
+  if (!file) {
+    throw Error{0, std::string{"couldn't read "} + path};
+  }
+  return {std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+}
+
+// The value of [key]=value among the space separated assignments of [line], if there.
+std::optional<std::string> valueOf(std::string_view line, std::string_view key) {
+  std::string prefix{key};
+  prefix += '=';
+  for (std::size_t start = 0; start < line.size();) {
+    auto end = line.find(' ', start);
+    auto field = line.substr(start, end == std::string_view::npos ? end : end - start);
+    if (field.substr(0, prefix.size()) == prefix) {
+      return std::string{field.substr(prefix.size())};
+    }
+    if (end == std::string_view::npos) {
+      break;
+    }
+    start = end + 1;
+  }
+  return std::nullopt;
+}
+
+// Splits the text of [message] around its inserts. Returns false once %0 ends it.
+bool compileLine(std::string_view text, std::size_t lineNumber, Message& message) {
+  auto& pieces = message.pieces;
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    if (text[i] != '%') {
+      pieces.back().literal += text[i];
+      continue;
+    }
+    if (++i == text.size()) {
+      throw Error{lineNumber, "% ending a line"};
+    }
+    char c = text[i];
+    if (c >= '1' && c <= '9') {
+      unsigned insert = c - '0';
+      if (i + 1 < text.size() && text[i + 1] >= '0' && text[i + 1] <= '9') {
+        insert = insert * 10 + (text[++i] - '0');
+      }
+      std::string kind = "Text";
+      if (i + 1 < text.size() && text[i + 1] == '!') {
+        auto end = text.find('!', i + 2);
+        if (end == std::string_view::npos) {
+          throw Error{lineNumber, "unterminated insert format"};
+        }
+        auto format = text.substr(i + 2, end - i - 2);
+        if (format == "s") {
+          kind = "Text";
+        } else if (format == "S") {
+          kind = "NarrowText";
+        } else if (format == "u") {
+          kind = "Unsigned";
+        } else if (format == "x") {
+          kind = "Hex";
+        } else {
+          throw Error{lineNumber, "unsupported insert format !" + std::string{format} + "!"};
+        }
+        i = end;
+      }
+      if (message.inserts.size() < insert) {
+        message.inserts.resize(insert);
+      }
+      if (!message.inserts[insert - 1].empty() && message.inserts[insert - 1] != kind) {
+        throw Error{lineNumber, "insert %" + std::to_string(insert) + " used with two formats"};
+      }
+      message.inserts[insert - 1] = kind;
+      pieces.back().insert = insert;
+      pieces.back().kind = kind;
+      pieces.emplace_back();
+      continue;
+    }
+    switch (c) {
+      case '0':
+        return false;
+      case 'n':
+        pieces.back().literal += '\n';
+        break;
+      case 'r':
+        pieces.back().literal += '\r';
+        break;
+      case 't':
+        pieces.back().literal += '\t';
+        break;
+      case 'b':
+        pieces.back().literal += ' ';
+        break;
+      case '%':
+      case '.':
+      case '!':
+        pieces.back().literal += c;
+        break;
+      default:
+        throw Error{lineNumber, std::string{"unsupported escape %"} + c};
+    }
+  }
+  pieces.back().literal += '\n';
+  return true;
+}
+
+std::vector<Message> parse(std::string_view contents) {
+  std::vector<Message> messages;
+  std::optional<Message> current;
+  bool inText = false;
+  bool ended = false;
+  std::size_t lineNumber = 0;
+  for (std::size_t start = 0; start <= contents.size();) {
+    auto end = contents.find('\n', start);
+    if (end == std::string_view::npos) {
+      end = contents.size();
+    }
+    auto line = contents.substr(start, end - start);
+    start = end + 1;
+    ++lineNumber;
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+
+    if (inText) {
+      if (line == ".") {
+        if (current->pieces.back().literal.empty() && current->pieces.size() > 1) {
+          current->pieces.pop_back();
+        }
+        messages.push_back(std::move(*current));
+        current.reset();
+        inText = false;
+      } else if (!ended) {
+        ended = !compileLine(line, lineNumber, *current);
+      }
+      continue;
+    }
+
+    if (line.substr(0, 10) == "MessageId=") {
+      current.emplace();
+      auto id = valueOf(line, "MessageId");
+      if (id->empty()) {
+        current->id = messages.empty() ? 0 : messages.back().id + 1;
+      } else {
+        current->id = std::stoul(*id, nullptr, 0);
+      }
+      auto name = valueOf(line, "SymbolicName");
+      if (!name || name->empty()) {
+        throw Error{lineNumber, "message without SymbolicName"};
+      }
+      current->name = *name;
+    } else if (line.substr(0, 9) == "Language=") {
+      if (!current) {
+        throw Error{lineNumber, "text outside of a message"};
+      }
+      inText = true;
+      ended = false;
+      current->pieces.emplace_back();
+    }
+    // Anything else, e.g. LanguageNames, doesn't change the text.
+  }
+  if (current) {
+    throw Error{lineNumber, "unterminated message " + current->name};
+  }
+  for (const auto& message : messages) {
+    for (std::size_t i = 0; i < message.inserts.size(); ++i) {
+      if (message.inserts[i].empty()) {
+        throw Error{0, message.name + " skips insert %" + std::to_string(i + 1)};
+      }
+    }
+  }
+  return messages;
+}
+
+// [text] as the contents of a wide string literal.
+std::string escape(std::string_view text) {
+  std::string out;
+  for (std::size_t i = 0; i < text.size();) {
+    char32_t c = Ubuntu::DecodeUtf8(text, i);
+    switch (c) {
+      case '\\':
+        out += "\\\\";
+        break;
+      case '"':
+        out += "\\\"";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        if (c >= 0x20 && c < 0x7F) {
+          out += static_cast<char>(c);
+        } else {
+          char code[16];
+          std::snprintf(code, sizeof(code), c < 0x10000 ? "\\u%04x" : "\\U%08x",
+                        static_cast<unsigned>(c));
+          out += code;
+        }
+    }
+  }
+  return out;
+}
+
+// The literal of [piece], one source line per line of text.
+std::string literal(std::string_view text) {
+  if (text.empty()) {
+    return "L\"\"";
+  }
+  std::string out;
+  for (std::size_t start = 0; start < text.size();) {
+    auto end = text.find('\n', start);
+    end = end == std::string_view::npos ? text.size() : end + 1;
+    if (!out.empty()) {
+      out += "\n     ";
+    }
+    out += "L\"" + escape(text.substr(start, end - start)) + "\"";
+    start = end;
+  }
+  return out;
+}
+
+std::string generate(const std::vector<Message>& messages) {
+  std::ostringstream out;
+  out << "#pragma once\n\n"
+         "// Generated from messages.mc by CompileMessages (see tests/CMakeLists.txt), don't edit.\n"
+         "\n"
+         "#include \"Messages.h\"\n"
+         "\n"
+         "namespace Ubuntu::Messages::Catalog {\n"
+         "namespace Pieces {\n";
+  for (const auto& message : messages) {
+    out << "inline constexpr Piece " << message.name << "[] = {\n";
+    for (const auto& piece : message.pieces) {
+      out << "    {" << literal(piece.literal);
+      if (piece.insert != 0) {
+        out << ", " << piece.insert << ", Piece::Kind::" << piece.kind;
+      }
+      out << "},\n";
+    }
+    out << "};\n";
+  }
+  out << "}  // namespace Pieces\n\n";
+  for (const auto& message : messages) {
+    out << "inline constexpr Message<";
+    for (std::size_t i = 0; i < message.inserts.size(); ++i) {
+      out << (i == 0 ? "" : ", ") << message.inserts[i];
+    }
+    out << "> " << message.name << "{" << message.id << ", Pieces::" << message.name << "};\n";
+  }
+  out << "}  // namespace Ubuntu::Messages::Catalog\n";
+  return out.str();
+}
+}  // namespace
+
+int main(int argc, char* argv[]) try {
+  std::vector<std::string_view> arguments{argv + 1, argv + argc};
+  const bool check = !arguments.empty() && arguments.front() == "--check";
+  if (check) {
+    arguments.erase(arguments.begin());
+  }
+  if (arguments.size() != 2) {
+    std::cerr << "usage: CompileMessages [--check] <messages.mc> <MessageCatalog.h>\n";
+    return 2;
+  }
+  const std::string source{arguments[0]};
+  const std::string target{arguments[1]};
+
+  auto catalog = generate(parse(readFile(source.c_str())));
+  std::string current;
+  try {
+    current = readFile(target.c_str());
+  } catch (const Error&) {
+    // Not generated yet.
+  }
+  if (current == catalog) {
+    return 0;
+  }
+  if (check) {
+    std::cerr << target << " is out of date with " << source
+              << ", build the MessageCatalog target to regenerate it.\n";
+    return 1;
+  }
+  std::ofstream file{target, std::ios::binary | std::ios::trunc};
+  file << catalog;
+  return file.flush() ? 0 : 1;
+} catch (const Error& error) {
+  std::cerr << argv[argc - 2] << ":" << error.line << ": " << error.what << "\n";
+  return 1;
+} catch (const std::exception& error) {
+  std::cerr << error.what() << "\n";
+  return 1;
+}
@@ -0,0 +1,115 @@
+#include "Check.h"
+#include "SimulatedWsl.h"
+#include "../DefaultUserSources.h"
+#include "../Trace.h"
+
+#include <chrono>
+#include <string>
+
+using Ubuntu::DefaultUserSource;
+using Ubuntu::ResolveDefaultUser;
+using Ubuntu::Testing::Latency;
+using Ubuntu::Testing::SimulatedWsl;
+using namespace std::chrono_literals;
+
+namespace Trace = Ubuntu::Trace;
+
+namespace {
+// A local database of [entries] users, many more than a chunk of output, the first regular one
+// coming last.
+std::string largePasswd(std::size_t entries = 20'000) {
+  std::string contents = "root:x:0:0:root:/root:/bin/bash\n";
+  for (std::size_t i = 1; i < entries; ++i) {
+    auto uid = std::to_string(i < entries - 1 ? 100'000 + i : 1000);
+    contents += "user" + uid + ":x:" + uid + ":" + uid + "::/home/user" + uid + ":/bin/bash\n";
+  }
+  return contents;
+}
+
+// Slow enough chunks for the enumeration to still be running once the other sources answered.
+Latency slowEnumeration() {
+  Latency latency;
+  latency.perChunk = 5ms;
+  latency.fileRead = 1ms;
+  return latency;
+}
+
+void picksTheFirstRegularUserWhenWslDefaultsToRoot() {
+  SimulatedWsl wsl{{"root:x:0:0:root:/root:/bin/bash\nu:x:1000:1000::/home/u:/bin/bash\n"}};
+  auto resolution = ResolveDefaultUser(wsl);
+  CHECK(resolution.source == DefaultUserSource::FirstRegularUser);
+  CHECK(resolution.choice.ok);
+  CHECK(resolution.choice.uid == 1000ul);
+  CHECK(resolution.records.size() == 1);
+}
+
+void cancelsTheEnumerationOnceWslConfNamesTheUser() {
+  auto passwd = largePasswd() + "named:x:2000:2000::/home/named:/bin/bash\n";
+  SimulatedWsl wsl{{passwd, {{"etc/wsl.conf", "[user]\ndefault=named\n"}}}, slowEnumeration()};
+  auto resolution = ResolveDefaultUser(wsl);
+  CHECK(resolution.source == DefaultUserSource::WslConf);
+  CHECK(resolution.choice.uid == 2000ul);
+  CHECK(resolution.search.Candidate()->name == "named");
+  CHECK(wsl.BytesStreamed() < passwd.size() / 2);
+}
+
+void cancelsTheEnumerationOnceTheRegistryAnswers() {
+  auto passwd = largePasswd();
+  SimulatedWsl::Distro distro{passwd};
+  distro.defaultUid = 1001;
+  SimulatedWsl wsl{distro, slowEnumeration()};
+  auto resolution = ResolveDefaultUser(wsl);
+  CHECK(resolution.source == DefaultUserSource::Registry);
+  CHECK(resolution.choice.ok);
+  CHECK(!resolution.choice.uid.has_value());
+  CHECK(wsl.BytesStreamed() < passwd.size() / 2);
+  CHECK(wsl.Printed().empty());
+}
+
+void leavesAMissingNamedUserAlone() {
+  SimulatedWsl wsl{{"root:x:0:0:root:/root:/bin/bash\nu:x:1000:1000::/home/u:/bin/bash\n",
+                    {{"etc/wsl.conf", "[user]\ndefault=nobody\n"}}}};
+  auto resolution = ResolveDefaultUser(wsl);
+  CHECK(resolution.source == DefaultUserSource::WslConf);
+  CHECK(resolution.choice.ok);
+  CHECK(!resolution.choice.uid.has_value());
+}
+
+void reportsTheTimeSaved() {
+  Latency latency;
+  latency.apiCall = 30ms;
+  latency.fileRead = 30ms;
+  latency.launch = 30ms;
+  SimulatedWsl wsl{{"root:x:0:0:root:/root:/bin/bash\nu:x:1000:1000::/home/u:/bin/bash\n"},
+                   latency};
+  Trace::Reset();
+  Trace::Enable("unused.json");
+  auto resolution = ResolveDefaultUser(wsl);
+  // One after the other: wsl.conf, the registry, nsswitch.conf then getent, i.e. 120 ms, while the
+  // longest of them alone takes 60 ms.
+  CHECK(resolution.choice.uid == 1000ul);
+  CHECK(resolution.serial >= 120ms);
+  CHECK(resolution.wall < resolution.serial);
+  CHECK(resolution.Saved() >= 30ms);
+  CHECK(Trace::ToJson().find("overlap saved ") != std::string::npos);
+  Trace::Reset();
+
+  auto line = Ubuntu::FormatResolutionTimes(resolution);
+  CHECK(line.find("Default user found among the regular users in ") == 0);
+  CHECK(line.find(" ms less than one source at a time.\n") != std::string::npos);
+  resolution.source = DefaultUserSource::WslConf;
+  resolution.wall = 40ms;
+  resolution.serial = 65ms;
+  CHECK(Ubuntu::FormatResolutionTimes(resolution) ==
+        "Default user found in wsl.conf in 40 ms, 25 ms less than one source at a time.\n");
+}
+}  // namespace
+
+int main() {
+  RUN(picksTheFirstRegularUserWhenWslDefaultsToRoot);
+  RUN(cancelsTheEnumerationOnceWslConfNamesTheUser);
+  RUN(cancelsTheEnumerationOnceTheRegistryAnswers);
+  RUN(leavesAMissingNamedUserAlone);
+  RUN(reportsTheTimeSaved);
+  return TEST_EXIT_CODE();
+}
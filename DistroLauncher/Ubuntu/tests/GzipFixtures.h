@@ -0,0 +1,268 @@
+#pragma once
+
+// Generated by MakeGzipFixtures.py with zlib 1.2.13, don't edit.
+
+namespace Ubuntu::Testing::GzipFixtures {
+inline constexpr unsigned long ContentsSize = 3640;
+inline constexpr unsigned long ContentsCrc32 = 0xdec99194;
+
+inline constexpr unsigned char Fixed[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x33, 0x30, 0x00, 0x02, 0x85, 0xd2,
+    0xa4, 0xd2, 0xbc, 0x92, 0x52, 0x85, 0x92, 0xc4, 0x22, 0x85, 0xcb, 0xcb, 0xb9, 0x40, 0x42, 0x86,
+    0x0a, 0xa5, 0xc5, 0xa9, 0x45, 0x0a, 0x45, 0xf9, 0xf9, 0x25, 0x0a, 0xd7, 0x78, 0xc1, 0x42, 0x46,
+    0x0a, 0x29, 0x99, 0xc5, 0x25, 0x45, 0x99, 0x49, 0xa5, 0x25, 0x99, 0xf9, 0x79, 0x10, 0xf9, 0x43,
+    0x76, 0x60, 0x29, 0x63, 0x85, 0xe4, 0x9c, 0xfc, 0xd2, 0x14, 0xdd, 0xcc, 0xbc, 0xcc, 0x12, 0x85,
+    0xf2, 0xe2, 0x1c, 0x85, 0xb3, 0xeb, 0xc1, 0xe2, 0x26, 0x0a, 0x99, 0xb9, 0x89, 0xe9, 0xa9, 0xc8,
+    0xb2, 0x0a, 0x10, 0x19, 0x53, 0x85, 0x8c, 0xd2, 0xb4, 0xb4, 0xdc, 0xc4, 0x3c, 0x85, 0x94, 0xd4,
+    0xb4, 0x9c, 0xc4, 0x92, 0x54, 0x85, 0xcc, 0x69, 0x60, 0x09, 0x33, 0x88, 0x9d, 0x30, 0x59, 0xb5,
+    0x20, 0xb0, 0xa8, 0xb9, 0x42, 0x4e, 0x62, 0x69, 0x5e, 0x72, 0x06, 0xd0, 0x4a, 0xa8, 0x5b, 0x53,
+    0xeb, 0xc0, 0x12, 0x16, 0x60, 0xeb, 0xe0, 0x92, 0xcf, 0x76, 0x83, 0x45, 0x2d, 0x15, 0x32, 0xf3,
+    0x8a, 0x4b, 0x12, 0x73, 0x72, 0x50, 0x9d, 0xec, 0x72, 0x01, 0x24, 0x6b, 0x68, 0x80, 0xb0, 0x13,
+    0xaa, 0x6a, 0x7e, 0x14, 0x58, 0xc2, 0x10, 0x1c, 0x02, 0x10, 0x27, 0x47, 0xd7, 0x82, 0x85, 0x8c,
+    0x90, 0xc3, 0x66, 0xd5, 0x4e, 0xb0, 0x98, 0x31, 0x52, 0xd8, 0xdc, 0x8a, 0x03, 0x0b, 0x99, 0x60,
+    0x09, 0x9b, 0x69, 0x4c, 0x60, 0x29, 0x53, 0xf4, 0xb0, 0x49, 0x61, 0x05, 0x8b, 0x9b, 0x61, 0x86,
+    0xcd, 0x19, 0x79, 0xb0, 0x8c, 0x39, 0x46, 0xd8, 0xb8, 0x1f, 0x04, 0x4b, 0x58, 0xa0, 0x86, 0xcd,
+    0xa6, 0xe9, 0x60, 0x51, 0x4b, 0x8c, 0xb0, 0x09, 0x8a, 0x06, 0x49, 0x18, 0x19, 0xa0, 0x86, 0x8d,
+    0xfa, 0x1f, 0xb0, 0xa8, 0x21, 0xf6, 0xb0, 0x79, 0xb5, 0x11, 0x2c, 0x6b, 0x84, 0x11, 0x36, 0xb7,
+    0x26, 0x80, 0x25, 0x8c, 0x91, 0xc2, 0xe6, 0xac, 0x1b, 0x58, 0xc8, 0x04, 0x39, 0x6c, 0x6e, 0x16,
+    0x83, 0xc5, 0x4c, 0x91, 0xc2, 0x66, 0x53, 0x16, 0x58, 0xc8, 0x0c, 0x4b, 0xd8, 0xf8, 0x37, 0x81,
+    0xa5, 0xcc, 0xd1, 0xc3, 0x66, 0x7d, 0x1f, 0x58, 0xdc, 0x02, 0x33, 0x6c, 0xdc, 0xc1, 0xe9, 0xc6,
+    0xc8, 0x12, 0x23, 0x6c, 0x84, 0x9f, 0x81, 0x24, 0x8c, 0x0d, 0x50, 0xc3, 0x86, 0xb3, 0x0b, 0x2c,
+    0x6a, 0x88, 0x11, 0x36, 0x92, 0x45, 0x60, 0x09, 0x23, 0xd4, 0xb0, 0x71, 0x03, 0xa7, 0x63, 0x63,
+    0x63, 0xec, 0x61, 0xb3, 0x81, 0x07, 0x2c, 0x6b, 0x82, 0x11, 0x36, 0x56, 0xea, 0x60, 0x09, 0x53,
+    0xa4, 0xb0, 0x31, 0xe0, 0x07, 0x0b, 0x99, 0x21, 0x87, 0x4d, 0xe5, 0x53, 0xb0, 0x98, 0x39, 0x52,
+    0xd8, 0x6c, 0x3f, 0x01, 0x16, 0xb2, 0xc0, 0x12, 0x36, 0x4c, 0x55, 0x60, 0x29, 0x4b, 0xf4, 0xb0,
+    0x99, 0xb2, 0x06, 0x24, 0x6e, 0x62, 0x80, 0x19, 0x36, 0xf7, 0xef, 0x80, 0x65, 0x0c, 0x31, 0xc2,
+    0xe6, 0x95, 0x38, 0x58, 0xc2, 0x08, 0x35, 0x6c, 0x22, 0xd9, 0xc0, 0xa2, 0xc6, 0x18, 0x61, 0x53,
+    0xc7, 0x0c, 0x96, 0x30, 0x41, 0x0d, 0x9b, 0x29, 0xf5, 0x60, 0x51, 0x53, 0xec, 0x61, 0x13, 0x06,
+    0x4e, 0xcd, 0x26, 0x66, 0x18, 0x61, 0x23, 0x77, 0x11, 0x2c, 0x61, 0x8e, 0x14, 0x36, 0x53, 0x4a,
+    0xc0, 0x42, 0x16, 0xc8, 0x61, 0xb3, 0x23, 0x0f, 0x2c, 0x66, 0x89, 0x14, 0x36, 0xfb, 0xa7, 0x80,
+    0x84, 0x4c, 0x0d, 0xb0, 0x84, 0x4d, 0x32, 0x03, 0x58, 0xca, 0x10, 0x3d, 0x6c, 0x52, 0x55, 0xc1,
+    0xe2, 0x46, 0x98, 0x61, 0x33, 0x41, 0x1a, 0x2c, 0x63, 0x8c, 0x11, 0x36, 0x3b, 0xe7, 0x83, 0x25,
+    0x4c, 0x50, 0xc3, 0xe6, 0xde, 0x6d, 0xb0, 0xa8, 0x29, 0x46, 0xd8, 0x2c, 0x91, 0x02, 0x4b, 0x98,
+    0xa1, 0x86, 0xcd, 0xb5, 0x33, 0x60, 0x51, 0x73, 0xec, 0x61, 0x53, 0x30, 0x1b, 0x2c, 0x6b, 0x81,
+    0x11, 0x36, 0x13, 0xdd, 0xc1, 0x12, 0x96, 0x48, 0x61, 0xf3, 0xcf, 0x1c, 0x24, 0x64, 0x86, 0x52,
+    0x16, 0x1b, 0xb0, 0x83, 0xc5, 0x90, 0xcb, 0x62, 0x95, 0x18, 0xb0, 0x10, 0xb6, 0xb2, 0x78, 0xce,
+    0x5a, 0xb0, 0x14, 0x46, 0x59, 0xbc, 0xcd, 0x00, 0x2c, 0x8e, 0xa5, 0x2c, 0x7e, 0x02, 0x8e, 0x0f,
+    0x33, 0xcc, 0xb2, 0x38, 0x60, 0x2f, 0x58, 0x02, 0xad, 0x2c, 0xf6, 0xf0, 0x07, 0x8b, 0x62, 0x96,
+    0xc5, 0xf7, 0xc1, 0x79, 0xdf, 0x0c, 0xad, 0x2c, 0xde, 0xac, 0x03, 0x16, 0xc5, 0x51, 0x16, 0xb7,
+    0x81, 0xfd, 0x6b, 0x8e, 0x59, 0x16, 0x5b, 0x89, 0x82, 0x25, 0x90, 0xcb, 0xe2, 0xe0, 0xaf, 0x60,
+    0x21, 0x94, 0xb2, 0xf8, 0x69, 0x25, 0x58, 0x0c, 0xb9, 0x2c, 0xfe, 0x5a, 0x0e, 0x16, 0xc2, 0x56,
+    0x16, 0x5f, 0xd9, 0x0f, 0x96, 0xc2, 0x28, 0x8b, 0x03, 0xc0, 0x65, 0xa2, 0x39, 0x96, 0xb2, 0xb8,
+    0x1d, 0x9c, 0x17, 0xcc, 0x31, 0xcb, 0xe2, 0x15, 0xe7, 0xc0, 0x12, 0x68, 0x65, 0xf1, 0xe5, 0x7e,
+    0xb0, 0x28, 0x66, 0x59, 0x7c, 0xe6, 0x14, 0x48, 0xc2, 0x02, 0xad, 0x2c, 0xbe, 0x0d, 0x0e, 0x31,
+    0x0b, 0x1c, 0x65, 0x71, 0xe6, 0x62, 0xb0, 0x2c, 0x66, 0x59, 0xcc, 0x0b, 0xae, 0x6d, 0x2c, 0x90,
+    0xcb, 0xe2, 0x32, 0x6f, 0xb0, 0x10, 0x4a, 0x59, 0xfc, 0xa5, 0x11, 0x2c, 0x86, 0x5c, 0x16, 0xc7,
+    0x83, 0xab, 0x3e, 0x0b, 0x6c, 0x65, 0x71, 0xb6, 0x36, 0x58, 0x0a, 0xa3, 0x2c, 0x4e, 0x03, 0x67,
+    0x10, 0x0b, 0x2c, 0x65, 0x71, 0x23, 0xb8, 0x0c, 0xb5, 0xc0, 0x2c, 0x8b, 0xc3, 0x9e, 0x83, 0x24,
+    0x2c, 0xd1, 0xca, 0x62, 0x3e, 0x70, 0x32, 0xb6, 0xc4, 0x2c, 0x8b, 0x9b, 0xc1, 0xfe, 0xb4, 0x44,
+    0x2b, 0x8b, 0x2f, 0x70, 0x81, 0x45, 0x71, 0x94, 0xc5, 0xbb, 0xc0, 0x69, 0xd6, 0x12, 0xb3, 0x2c,
+    0x5e, 0xd0, 0x06, 0x96, 0x40, 0x2e, 0x8b, 0xfb, 0x93, 0xc0, 0x42, 0x28, 0x65, 0xf1, 0xb7, 0x97,
+    0x60, 0x31, 0xe4, 0xb2, 0xd8, 0x46, 0x05, 0x2c, 0x84, 0xad, 0x2c, 0x7e, 0x38, 0x19, 0x2c, 0x85,
+    0x51, 0x16, 0xbf, 0xa9, 0xe1, 0x02, 0x35, 0x24, 0xb0, 0x94, 0xc5, 0xfa, 0x71, 0x60, 0x19, 0xcc,
+    0xb2, 0xd8, 0xe8, 0x11, 0x58, 0x02, 0xad, 0x2c, 0x0e, 0xdf, 0x0e, 0x16, 0xc5, 0x2c, 0x8b, 0x79,
+    0x4a, 0xc0, 0x12, 0x68, 0x65, 0x71, 0xee, 0x62, 0xb0, 0x28, 0x8e, 0xb2, 0x78, 0xce, 0x53, 0xb0,
+    0x2c, 0x66, 0x59, 0x6c, 0x72, 0x01, 0x2c, 0x81, 0x5c, 0x16, 0x4f, 0xfc, 0x01, 0x16, 0x42, 0x29,
+    0x8b, 0x05, 0x7a, 0xc1, 0x62, 0xc8, 0x65, 0xf1, 0x5d, 0x50, 0x73, 0xd0, 0xd0, 0x10, 0x5b, 0x59,
+    0x9c, 0x6b, 0x0b, 0x96, 0xc2, 0x28, 0x8b, 0x55, 0x85, 0xc0, 0xe2, 0x58, 0xca, 0xe2, 0xbb, 0xeb,
+    0xc1, 0x32, 0x98, 0x65, 0xb1, 0xe6, 0x15, 0xb0, 0x04, 0x5a, 0x59, 0xcc, 0x94, 0x07, 0x16, 0xc5,
+    0x2c, 0x8b, 0x3f, 0xfb, 0x83, 0x25, 0xd0, 0xca, 0x62, 0x81, 0x27, 0x60, 0x51, 0x1c, 0x65, 0xf1,
+    0x4c, 0x65, 0xb0, 0x2c, 0x66, 0x59, 0x9c, 0xfd, 0x09, 0x2c, 0x81, 0x5c, 0x16, 0xdf, 0x3b, 0x0b,
+    0x6e, 0x45, 0x8e, 0xb6, 0x8b, 0x47, 0xdb, 0xc5, 0xa3, 0xed, 0x62, 0xec, 0xed, 0x62, 0x00, 0x94,
+    0x91, 0xc9, 0xde, 0x38, 0x0e, 0x00, 0x00,
+};
+
+inline constexpr unsigned char Level1[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xed, 0x97, 0xdd, 0x4b, 0x14, 0x51,
+    0x1c, 0x86, 0xc3, 0xa8, 0x48, 0xb4, 0xa4, 0x88, 0xa8, 0xa0, 0x0e, 0xa4, 0x49, 0x54, 0x34, 0xb3,
+    0x5f, 0x33, 0x23, 0xd5, 0x55, 0x68, 0xd0, 0x85, 0x62, 0x60, 0x94, 0x61, 0xac, 0xba, 0x9b, 0x93,
+    0xfb, 0x11, 0xbb, 0xb3, 0x89, 0x51, 0x86, 0x05, 0x06, 0x41, 0xa9, 0x24, 0x46, 0x24, 0x18, 0x14,
+    0x18, 0x51, 0x58, 0x06, 0x99, 0x45, 0x48, 0x5d, 0x45, 0x68, 0x18, 0x8a, 0x90, 0xa6, 0x52, 0xa8,
+    0x91, 0x74, 0xd5, 0x17, 0x5d, 0x48, 0x34, 0xe7, 0x5d, 0xb7, 0xce, 0xcc, 0x6f, 0xf6, 0x3f, 0x70,
+    0x2f, 0x9f, 0x77, 0xce, 0xce, 0xcc, 0x7b, 0xce, 0x3c, 0x73, 0x46, 0x92, 0xcc, 0x1f, 0x4b, 0x54,
+    0x26, 0x22, 0x46, 0x82, 0x19, 0xfe, 0x18, 0x1b, 0xee, 0xca, 0xe4, 0x48, 0x66, 0x89, 0x78, 0x20,
+    0xc6, 0x62, 0xd1, 0xa8, 0xc1, 0x46, 0xb3, 0x81, 0x5c, 0xac, 0x5a, 0x8f, 0x1b, 0x31, 0xbd, 0x32,
+    0x61, 0xe8, 0xd1, 0x48, 0x32, 0x7f, 0xb5, 0x0f, 0x91, 0x9b, 0x55, 0x85, 0xa2, 0x89, 0xea, 0x5d,
+    0x7a, 0x44, 0x37, 0x58, 0x5d, 0x3c, 0xc4, 0x06, 0xbb, 0xc1, 0x3d, 0x4c, 0x0f, 0xfb, 0x4f, 0x04,
+    0xc4, 0x94, 0x25, 0x13, 0x2f, 0xab, 0x49, 0x04, 0x83, 0x61, 0x7f, 0x84, 0x55, 0x07, 0x82, 0x21,
+    0xbf, 0x11, 0x60, 0x7a, 0x3b, 0x86, 0xf8, 0x92, 0xe7, 0x4c, 0xa5, 0xdb, 0x4a, 0x41, 0x15, 0x16,
+    0xf2, 0x27, 0x22, 0x55, 0x35, 0xe6, 0x25, 0x2d, 0x5c, 0x6b, 0xa0, 0x01, 0x81, 0x8a, 0xd3, 0xfd,
+    0x0b, 0x67, 0x9f, 0x83, 0x6a, 0x4c, 0x8f, 0xc4, 0x0d, 0x7f, 0x28, 0x64, 0xbd, 0xe4, 0xfd, 0x43,
+    0x3c, 0x95, 0xa5, 0xff, 0xe7, 0x5c, 0x38, 0xaa, 0xf3, 0x28, 0x02, 0x19, 0x0d, 0x24, 0x2f, 0xb9,
+    0xfc, 0x1c, 0x90, 0x2b, 0x75, 0x3e, 0xde, 0xcd, 0xbd, 0x3e, 0x30, 0xb7, 0xd0, 0xcd, 0x58, 0x05,
+    0x90, 0xc7, 0x7a, 0x22, 0x74, 0xd7, 0x9e, 0x81, 0xc8, 0x2b, 0xde, 0x3d, 0xef, 0xa6, 0x7a, 0x19,
+    0xb8, 0x8f, 0x76, 0x33, 0xb0, 0x05, 0x89, 0x42, 0xba, 0x29, 0x7a, 0x89, 0x40, 0xb5, 0x76, 0xd3,
+    0x73, 0x1d, 0x54, 0x23, 0xdd, 0x94, 0x96, 0xf3, 0xc0, 0x25, 0x59, 0xbb, 0xc9, 0x9f, 0x07, 0x95,
+    0x9d, 0xbb, 0x99, 0x7b, 0x84, 0xd4, 0x9c, 0xe4, 0xd4, 0x7c, 0x2c, 0x74, 0x33, 0xd6, 0x82, 0xc0,
+    0x2d, 0x74, 0x33, 0x58, 0x08, 0xe4, 0x11, 0xbb, 0x79, 0x1f, 0x07, 0xf3, 0x0a, 0xdd, 0xf4, 0x9c,
+    0x04, 0xf2, 0x39, 0x74, 0x53, 0x7c, 0x01, 0x91, 0x62, 0xef, 0xa6, 0xfb, 0x2a, 0xb8, 0x4a, 0xbb,
+    0x29, 0xc2, 0xba, 0x71, 0x69, 0xa4, 0x9b, 0xb5, 0xb3, 0x7c, 0x88, 0x5b, 0xb2, 0x76, 0xb3, 0xf2,
+    0x32, 0xa8, 0x4c, 0xba, 0xd9, 0x10, 0x43, 0xe0, 0xb2, 0x76, 0x53, 0x88, 0x75, 0xec, 0x76, 0x3b,
+    0x77, 0xf3, 0x30, 0x0b, 0x63, 0xcc, 0x49, 0xb6, 0x75, 0x53, 0x90, 0x8f, 0xc0, 0x2b, 0x74, 0x23,
+    0xad, 0x06, 0xf2, 0x89, 0xdd, 0xd4, 0xcf, 0x80, 0x29, 0x42, 0x37, 0xbd, 0xaf, 0x81, 0x54, 0x87,
+    0x6e, 0x32, 0xce, 0x20, 0xd2, 0xec, 0xdd, 0xb4, 0xdd, 0xe7, 0xdc, 0x23, 0xd1, 0x6e, 0xa6, 0x3e,
+    0x20, 0x91, 0x49, 0x37, 0x73, 0xeb, 0x11, 0xb8, 0xac, 0xdd, 0x1c, 0x59, 0x0e, 0xea, 0x26, 0xdd,
+    0x34, 0x2c, 0x45, 0xe0, 0xb1, 0x76, 0xd3, 0x76, 0x1e, 0xd4, 0xeb, 0xdc, 0x4d, 0x19, 0x56, 0xb3,
+    0xc7, 0x9c, 0x64, 0x5b, 0x37, 0x9b, 0xdf, 0x61, 0x98, 0x22, 0x74, 0xd3, 0x66, 0x00, 0xa9, 0x62,
+    0x37, 0x4f, 0x23, 0x60, 0x9a, 0xd0, 0x4d, 0x7f, 0x1b, 0x47, 0x5e, 0xf3, 0x31, 0x25, 0xbe, 0xa9,
+    0x5a, 0x82, 0x48, 0xb6, 0x77, 0x13, 0xc8, 0x03, 0x77, 0xd1, 0x6e, 0x5a, 0x36, 0x21, 0x71, 0x93,
+    0x6e, 0xfa, 0x3a, 0x11, 0x78, 0xac, 0xdd, 0x4c, 0x8e, 0x83, 0x7a, 0x49, 0x37, 0x77, 0x36, 0x22,
+    0xf0, 0x59, 0xbb, 0x19, 0x1d, 0x00, 0x55, 0x9c, 0xbb, 0x39, 0x75, 0x13, 0xa9, 0x39, 0xc9, 0xb6,
+    0x6e, 0x5a, 0x8b, 0x10, 0x68, 0x42, 0x37, 0x7f, 0x14, 0x8e, 0x7c, 0x16, 0x17, 0x4b, 0x2b, 0xc0,
+    0x44, 0x17, 0xe7, 0x1e, 0x03, 0x72, 0x72, 0x71, 0xc7, 0x03, 0x44, 0xc4, 0xc5, 0x4f, 0x24, 0x70,
+    0x07, 0x17, 0x4f, 0x63, 0x3e, 0x7c, 0xd4, 0xc5, 0x25, 0x2f, 0x30, 0xc4, 0xe6, 0xe2, 0x03, 0xc5,
+    0xa0, 0xd4, 0xc5, 0x53, 0x78, 0xf6, 0x7d, 0x36, 0x17, 0x3f, 0xde, 0x89, 0xc3, 0xd3, 0xb8, 0xb8,
+    0x09, 0xf7, 0xab, 0x50, 0x17, 0x17, 0xac, 0xe3, 0xc3, 0x14, 0xd1, 0xc5, 0x87, 0x7e, 0x02, 0x59,
+    0x5c, 0x3c, 0x53, 0x0f, 0x26, 0xba, 0xf8, 0x67, 0x1d, 0x90, 0x93, 0x8b, 0x47, 0xfa, 0x11, 0x11,
+    0x17, 0x97, 0xcc, 0x83, 0x3b, 0xb8, 0xf8, 0x12, 0x9e, 0x05, 0x85, 0xba, 0xf8, 0xee, 0x5b, 0x0c,
+    0xb1, 0xb9, 0x78, 0xb8, 0x19, 0x94, 0xba, 0x78, 0xe0, 0x0d, 0x0f, 0x54, 0x9b, 0x8b, 0xc7, 0xd1,
+    0x98, 0x9a, 0xc6, 0xc5, 0xfa, 0x6d, 0x8c, 0xa1, 0x2e, 0xce, 0xae, 0x40, 0x20, 0xba, 0xf8, 0xf4,
+    0x41, 0x20, 0x8b, 0x8b, 0x7f, 0x34, 0x82, 0x89, 0x2e, 0x3e, 0x8e, 0x57, 0x9f, 0xea, 0xe4, 0xe2,
+    0xda, 0x1d, 0x38, 0x9a, 0xb8, 0x38, 0x88, 0x07, 0x44, 0x75, 0x70, 0x71, 0x23, 0x1c, 0xaa, 0x52,
+    0x17, 0x97, 0x7d, 0xe6, 0x7f, 0xa5, 0xd9, 0x5c, 0xbc, 0x0a, 0xcb, 0x58, 0xa3, 0x2e, 0xbe, 0x88,
+    0xfb, 0xd4, 0x6c, 0x2e, 0x1e, 0xca, 0xc4, 0x9f, 0xa4, 0x71, 0xf1, 0x33, 0xac, 0x59, 0x8d, 0xba,
+    0xf8, 0x56, 0x13, 0x86, 0x89, 0x2e, 0x6e, 0xae, 0x04, 0xb2, 0xb8, 0xf8, 0xd7, 0x17, 0x30, 0xd1,
+    0xc5, 0x7b, 0x72, 0x81, 0x9c, 0x5c, 0xfc, 0xf1, 0x1a, 0x22, 0xe2, 0xe2, 0xaf, 0x67, 0x4d, 0x2e,
+    0x9b, 0x3b, 0x27, 0xb2, 0xbf, 0xd9, 0xcd, 0xa7, 0x48, 0x36, 0xf7, 0x4f, 0xa9, 0x1d, 0x4c, 0xea,
+    0xd9, 0x77, 0x7d, 0x42, 0x60, 0x73, 0xf1, 0xe1, 0x5e, 0x50, 0xea, 0xe2, 0x2c, 0x7e, 0x9f, 0xb2,
+    0x64, 0x73, 0x71, 0x98, 0x37, 0x26, 0x4b, 0x69, 0x5c, 0xdc, 0x31, 0x83, 0x94, 0xba, 0xd8, 0xc3,
+    0x67, 0x5f, 0x96, 0x44, 0x17, 0xb7, 0xfe, 0x06, 0xb2, 0xb8, 0x38, 0xe7, 0x0a, 0x98, 0xe8, 0xe2,
+    0x89, 0x2e, 0x8e, 0xf8, 0x96, 0x89, 0xb8, 0x38, 0xbc, 0x17, 0x11, 0x71, 0x71, 0xde, 0x1a, 0x70,
+    0x07, 0x17, 0x4f, 0x74, 0x23, 0xa1, 0x2e, 0xde, 0x3e, 0x82, 0xc0, 0xe6, 0xe2, 0x0c, 0xfe, 0x6a,
+    0x90, 0x65, 0xea, 0xe2, 0xef, 0xc5, 0x08, 0x6c, 0x2e, 0xce, 0x99, 0x06, 0x4d, 0xe3, 0xe2, 0x1b,
+    0x5b, 0x91, 0x52, 0x17, 0xd7, 0x7e, 0x43, 0x20, 0xba, 0x78, 0x72, 0xd0, 0x44, 0xe6, 0x4f, 0x7c,
+    0x4f, 0x2d, 0xee, 0x8b, 0x17, 0xf7, 0xc5, 0xc9, 0xef, 0x94, 0xc5, 0x7d, 0xb1, 0xf9, 0x09, 0xf8,
+    0x17, 0x94, 0x91, 0xc9, 0xde, 0x38, 0x0e, 0x00, 0x00,
+};
+
+inline constexpr unsigned char Level6[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xed, 0x96, 0xdf, 0x4b, 0x14, 0x51,
+    0x18, 0x86, 0xc3, 0xa8, 0x48, 0xb4, 0xa4, 0x88, 0xa8, 0xa0, 0x0e, 0xa4, 0x49, 0x54, 0x34, 0x33,
+    0x3b, 0x3b, 0x3f, 0xa4, 0xba, 0x0a, 0x0d, 0xba, 0x50, 0x0c, 0x8c, 0x32, 0x8a, 0xd5, 0xdd, 0xcd,
+    0xc9, 0xdd, 0x35, 0x76, 0x67, 0x13, 0xa3, 0x0c, 0x0b, 0x0c, 0x82, 0x52, 0x49, 0x8c, 0x48, 0x30,
+    0x30, 0x28, 0xa2, 0xb0, 0x0c, 0x32, 0x8b, 0x90, 0xba, 0x8a, 0xd0, 0x30, 0x14, 0x21, 0x4d, 0xa5,
+    0x50, 0x23, 0xe9, 0xaa, 0x32, 0xba, 0x88, 0xc8, 0x79, 0xb5, 0x3a, 0x33, 0xdf, 0xd9, 0xff, 0x40,
+    0x2f, 0x9f, 0x47, 0x98, 0xd9, 0x77, 0x67, 0x9e, 0x3d, 0x92, 0x34, 0xfb, 0xc7, 0x92, 0x65, 0xc9,
+    0x98, 0x9d, 0x64, 0x76, 0x20, 0xce, 0x06, 0x6e, 0xa7, 0x3b, 0x48, 0x66, 0xc9, 0x44, 0x28, 0xce,
+    0xe2, 0x55, 0x55, 0x36, 0x1b, 0xca, 0x04, 0x52, 0x58, 0xd0, 0x4a, 0xd8, 0x71, 0xab, 0x2c, 0x69,
+    0x5b, 0x55, 0xb1, 0x39, 0xff, 0x72, 0x0f, 0x94, 0x8f, 0x95, 0x47, 0xaa, 0x92, 0xc1, 0x1d, 0x56,
+    0xcc, 0xb2, 0x59, 0x75, 0x22, 0xc2, 0xfa, 0x3a, 0xc0, 0x55, 0x66, 0x45, 0x03, 0xc7, 0x43, 0xbc,
+    0x65, 0x73, 0xc6, 0xcf, 0x2a, 0x92, 0xe1, 0x70, 0x34, 0x10, 0x63, 0xc1, 0x50, 0x38, 0x12, 0xb0,
+    0x43, 0xcc, 0x6a, 0x81, 0xd0, 0xe6, 0xae, 0xf9, 0xd7, 0x6e, 0x29, 0x06, 0xd5, 0x59, 0x24, 0x90,
+    0x8c, 0x95, 0x57, 0xcc, 0x5e, 0x72, 0xfe, 0x5e, 0x43, 0xb5, 0x10, 0x06, 0x2e, 0xf7, 0x4f, 0x4e,
+    0x3d, 0x03, 0x35, 0x99, 0x15, 0x4b, 0xd8, 0x81, 0x48, 0xc4, 0x7d, 0xcb, 0x7b, 0xfb, 0x1d, 0x2b,
+    0x4b, 0xff, 0xaf, 0x39, 0xff, 0x5f, 0x6d, 0x87, 0x21, 0x64, 0x2c, 0x30, 0x77, 0xcb, 0xa5, 0x67,
+    0x81, 0x14, 0x7e, 0x9b, 0xbb, 0xdd, 0x60, 0x3e, 0x6e, 0x9b, 0xe1, 0xa3, 0x40, 0xaa, 0x60, 0x9b,
+    0x96, 0x34, 0x28, 0xbf, 0x77, 0x9b, 0xe0, 0x12, 0x70, 0x8d, 0x6e, 0xd3, 0xbb, 0x09, 0x46, 0x27,
+    0xdb, 0x14, 0xbc, 0x80, 0x30, 0xdc, 0xdb, 0x74, 0x5e, 0x03, 0x35, 0xc9, 0x36, 0xc5, 0xa5, 0x8e,
+    0x50, 0x24, 0xf7, 0x36, 0xb9, 0xbf, 0x40, 0x65, 0xf1, 0x36, 0xd3, 0x0f, 0x61, 0x15, 0xb2, 0xcd,
+    0x70, 0x23, 0x84, 0x8f, 0xdb, 0xa6, 0x2f, 0x1f, 0x48, 0xe5, 0xb7, 0x79, 0x97, 0x00, 0xf3, 0x73,
+    0xdb, 0x74, 0x9e, 0x00, 0xd2, 0x04, 0xdb, 0x14, 0x9e, 0x87, 0xd2, 0xbd, 0xdb, 0x74, 0x5c, 0x01,
+    0x37, 0xe8, 0x36, 0x05, 0x78, 0x6e, 0x14, 0x93, 0x6c, 0xb3, 0x7a, 0xca, 0x11, 0x3e, 0xc9, 0xbd,
+    0xcd, 0xf2, 0x4b, 0xa0, 0x32, 0xd9, 0x66, 0x5d, 0x1c, 0x42, 0x71, 0x6f, 0x93, 0x8f, 0xe7, 0xd8,
+    0xe7, 0x13, 0x6f, 0xf3, 0x20, 0x03, 0x56, 0x25, 0xdb, 0xe4, 0xe5, 0x42, 0xf8, 0xb9, 0x6d, 0xa4,
+    0x95, 0x40, 0x1a, 0xbf, 0x4d, 0xcd, 0x24, 0x98, 0xce, 0x6d, 0xd3, 0xf5, 0x0a, 0xc8, 0x10, 0x6c,
+    0x93, 0x76, 0x1a, 0xca, 0xf4, 0x6e, 0xd3, 0x7c, 0xcf, 0xe1, 0xaa, 0x44, 0xb7, 0x19, 0x7f, 0x0f,
+    0x23, 0x93, 0x6d, 0xa6, 0xd7, 0x42, 0x28, 0xee, 0x6d, 0x0e, 0x2d, 0x05, 0xf5, 0x91, 0x6d, 0x6a,
+    0x17, 0x43, 0xa8, 0xee, 0x6d, 0x9a, 0xcf, 0x81, 0xfa, 0xc5, 0xdb, 0x94, 0xe0, 0x69, 0x56, 0x35,
+    0xb2, 0xcd, 0xc6, 0xb7, 0x10, 0x3a, 0xb7, 0x4d, 0xb3, 0x0d, 0x64, 0xf0, 0xdb, 0x3c, 0x89, 0x81,
+    0x99, 0xdc, 0x36, 0x3d, 0xcd, 0x0e, 0xf2, 0x4b, 0x82, 0x6d, 0xca, 0x17, 0x41, 0xc9, 0xde, 0x6d,
+    0x42, 0x39, 0xe0, 0x0a, 0xdd, 0xa6, 0x71, 0x03, 0x8c, 0x8f, 0x6c, 0xd3, 0xdd, 0x06, 0xa1, 0xba,
+    0xb7, 0x19, 0x1b, 0x01, 0xf5, 0x93, 0x6d, 0x6e, 0xad, 0x87, 0xd0, 0xdc, 0xdb, 0x0c, 0xf5, 0x82,
+    0xea, 0xe2, 0x6d, 0x4e, 0xde, 0x80, 0x35, 0xc8, 0x36, 0x4d, 0x05, 0x10, 0x26, 0xb7, 0xcd, 0x6f,
+    0xdd, 0x41, 0x9a, 0xab, 0xc5, 0xd2, 0x32, 0x30, 0xbe, 0xc5, 0xd9, 0x47, 0x80, 0x44, 0x2d, 0x6e,
+    0xbd, 0x0f, 0x45, 0x5a, 0xfc, 0x58, 0x02, 0x17, 0xb4, 0x78, 0x02, 0xdf, 0x87, 0x46, 0x5b, 0x5c,
+    0xf4, 0x1c, 0xc2, 0xd3, 0xe2, 0x7d, 0x85, 0xa0, 0xb4, 0xc5, 0xe3, 0x78, 0xf7, 0x35, 0x4f, 0x8b,
+    0x1f, 0x6d, 0x07, 0x4d, 0xd1, 0xe2, 0x7a, 0x7c, 0x5e, 0x9d, 0xb6, 0x38, 0x6f, 0x0d, 0x04, 0xdf,
+    0xe2, 0x03, 0x33, 0x40, 0xae, 0x16, 0x4f, 0xd6, 0x80, 0xf1, 0x2d, 0x9e, 0xa9, 0x06, 0x12, 0xb5,
+    0x78, 0xb0, 0x07, 0x8a, 0xb4, 0xb8, 0x08, 0x4d, 0xd4, 0x05, 0x2d, 0xbe, 0x88, 0x77, 0x41, 0xa7,
+    0x2d, 0xbe, 0xf3, 0x06, 0xc2, 0xd3, 0xe2, 0x81, 0x06, 0x50, 0xda, 0xe2, 0xde, 0xd7, 0x8e, 0x30,
+    0x3c, 0x2d, 0x1e, 0xc1, 0x62, 0x46, 0x8a, 0x16, 0x5b, 0xed, 0xb0, 0xb4, 0xc5, 0x99, 0xf8, 0xb5,
+    0x31, 0xf8, 0x16, 0x9f, 0xda, 0x0f, 0xe4, 0x6a, 0xf1, 0xf7, 0x3a, 0x30, 0xbe, 0xc5, 0xc7, 0xf0,
+    0xd3, 0x67, 0x88, 0x5a, 0x5c, 0xb9, 0x0d, 0x8a, 0xb4, 0x38, 0x8c, 0x17, 0xc4, 0x10, 0xb4, 0xb8,
+    0x0e, 0x0d, 0x35, 0x68, 0x8b, 0x4b, 0x3e, 0x39, 0xc2, 0xf4, 0xb4, 0x78, 0x05, 0x1e, 0x63, 0x93,
+    0xb6, 0xf8, 0x02, 0x3e, 0xa7, 0xe9, 0x69, 0x71, 0x7f, 0x3a, 0x68, 0x8a, 0x16, 0x3f, 0xc5, 0x33,
+    0x6b, 0xd2, 0x16, 0xdf, 0xac, 0x87, 0xe0, 0x5b, 0xdc, 0x50, 0x06, 0xe4, 0x6a, 0xf1, 0x8f, 0xcf,
+    0x60, 0x7c, 0x8b, 0x77, 0x65, 0x03, 0x89, 0x5a, 0xfc, 0xe1, 0x2a, 0x14, 0x69, 0xf1, 0x97, 0x33,
+    0xe9, 0xce, 0x41, 0x42, 0xd0, 0xe2, 0x9d, 0x47, 0x61, 0x68, 0x8b, 0x95, 0x8f, 0x10, 0x9e, 0x16,
+    0x1f, 0xec, 0x02, 0xa5, 0x2d, 0xce, 0xb0, 0x21, 0x3c, 0x2d, 0x8e, 0xb6, 0x83, 0xa6, 0x68, 0x71,
+    0xeb, 0x24, 0x2c, 0x6d, 0xb1, 0xda, 0x0f, 0xc1, 0xb7, 0xb8, 0xe9, 0x27, 0x90, 0xab, 0xc5, 0x59,
+    0x97, 0xc1, 0xf8, 0x16, 0x8f, 0x3a, 0xc7, 0x41, 0x59, 0x16, 0xb5, 0x38, 0xba, 0x1b, 0x8a, 0xb4,
+    0x38, 0x67, 0x15, 0xb8, 0xa0, 0xc5, 0xa3, 0x1d, 0x30, 0xb4, 0xc5, 0x5b, 0x07, 0x21, 0x3c, 0x2d,
+    0x4e, 0x8b, 0x81, 0xd2, 0x16, 0x7f, 0x2b, 0x84, 0xf0, 0xb4, 0x38, 0x6b, 0x02, 0x34, 0x45, 0x8b,
+    0xaf, 0x6f, 0x86, 0xa5, 0x2d, 0xae, 0xfc, 0x0a, 0xc1, 0xb7, 0x78, 0xac, 0x0f, 0xa7, 0xc8, 0x85,
+    0x73, 0xf1, 0xc2, 0xb9, 0x78, 0xe1, 0x5c, 0x2c, 0x3e, 0x17, 0xff, 0x01, 0x94, 0x91, 0xc9, 0xde,
+    0x38, 0x0e, 0x00, 0x00,
+};
+
+inline constexpr unsigned char Level9[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xed, 0x96, 0xdf, 0x4b, 0x14, 0x51,
+    0x18, 0x86, 0xc3, 0xa8, 0x48, 0xb4, 0xa4, 0x88, 0xa8, 0xa0, 0x0e, 0xa4, 0x49, 0x54, 0x34, 0x33,
+    0x3b, 0x3b, 0x3f, 0xa4, 0xba, 0x0a, 0x0d, 0xba, 0x50, 0x0c, 0x8c, 0x32, 0x8a, 0xd5, 0xdd, 0xcd,
+    0xc9, 0xdd, 0x35, 0x76, 0x67, 0x13, 0xa3, 0x0c, 0x0b, 0x0c, 0x82, 0x52, 0x49, 0x8c, 0x48, 0x30,
+    0x30, 0x28, 0xa2, 0xb0, 0x0c, 0x32, 0x8b, 0x90, 0xba, 0x8a, 0xd0, 0x30, 0x14, 0x21, 0x4d, 0xa5,
+    0x50, 0x23, 0xe9, 0xaa, 0x32, 0xba, 0x88, 0xc8, 0x79, 0xb5, 0x3a, 0x33, 0xdf, 0xd9, 0xff, 0x40,
+    0x2f, 0x9f, 0x47, 0x98, 0xd9, 0x77, 0x67, 0x9e, 0x3d, 0x92, 0x34, 0xfb, 0xc7, 0x92, 0x65, 0xc9,
+    0x98, 0x9d, 0x64, 0x76, 0x20, 0xce, 0x06, 0x6e, 0xa7, 0x3b, 0x48, 0x66, 0xc9, 0x44, 0x28, 0xce,
+    0xe2, 0x55, 0x55, 0x36, 0x1b, 0xca, 0x04, 0x52, 0x58, 0xd0, 0x4a, 0xd8, 0x71, 0xab, 0x2c, 0x69,
+    0x5b, 0x55, 0xb1, 0x39, 0xff, 0x72, 0x0f, 0x94, 0x8f, 0x95, 0x47, 0xaa, 0x92, 0xc1, 0x1d, 0x56,
+    0xcc, 0xb2, 0x59, 0x75, 0x22, 0xc2, 0xfa, 0x3a, 0xc0, 0x55, 0x66, 0x45, 0x03, 0xc7, 0x43, 0xbc,
+    0x65, 0x73, 0xc6, 0xcf, 0x2a, 0x92, 0xe1, 0x70, 0x34, 0x10, 0x63, 0xc1, 0x50, 0x38, 0x12, 0xb0,
+    0x43, 0xcc, 0x6a, 0x81, 0xd0, 0xe6, 0xae, 0xf9, 0xd7, 0x6e, 0x29, 0x06, 0xd5, 0x59, 0x24, 0x90,
+    0x8c, 0x95, 0x57, 0xcc, 0x5e, 0x72, 0xfe, 0x5e, 0x43, 0xb5, 0x10, 0x06, 0x2e, 0xf7, 0x4f, 0x4e,
+    0x3d, 0x03, 0x35, 0x99, 0x15, 0x4b, 0xd8, 0x81, 0x48, 0xc4, 0x7d, 0xcb, 0x7b, 0xfb, 0x1d, 0x2b,
+    0x4b, 0xff, 0xaf, 0x39, 0xff, 0x5f, 0x6d, 0x87, 0x21, 0x64, 0x2c, 0x30, 0x77, 0xcb, 0xa5, 0x67,
+    0x81, 0x14, 0x7e, 0x9b, 0xbb, 0xdd, 0x60, 0x3e, 0x6e, 0x9b, 0xe1, 0xa3, 0x40, 0xaa, 0x60, 0x9b,
+    0x96, 0x34, 0x28, 0xbf, 0x77, 0x9b, 0xe0, 0x12, 0x70, 0x8d, 0x6e, 0xd3, 0xbb, 0x09, 0x46, 0x27,
+    0xdb, 0x14, 0xbc, 0x80, 0x30, 0xdc, 0xdb, 0x74, 0x5e, 0x03, 0x35, 0xc9, 0x36, 0xc5, 0xa5, 0x8e,
+    0x50, 0x24, 0xf7, 0x36, 0xb9, 0xbf, 0x40, 0x65, 0xf1, 0x36, 0xd3, 0x0f, 0x61, 0x15, 0xb2, 0xcd,
+    0x70, 0x23, 0x84, 0x8f, 0xdb, 0xa6, 0x2f, 0x1f, 0x48, 0xe5, 0xb7, 0x79, 0x97, 0x00, 0xf3, 0x73,
+    0xdb, 0x74, 0x9e, 0x00, 0xd2, 0x04, 0xdb, 0x14, 0x9e, 0x87, 0xd2, 0xbd, 0xdb, 0x74, 0x5c, 0x01,
+    0x37, 0xe8, 0x36, 0x05, 0x78, 0x6e, 0x14, 0x93, 0x6c, 0xb3, 0x7a, 0xca, 0x11, 0x3e, 0xc9, 0xbd,
+    0xcd, 0xf2, 0x4b, 0xa0, 0x32, 0xd9, 0x66, 0x5d, 0x1c, 0x42, 0x71, 0x6f, 0x93, 0x8f, 0xe7, 0xd8,
+    0xe7, 0x13, 0x6f, 0xf3, 0x20, 0x03, 0x56, 0x25, 0xdb, 0xe4, 0xe5, 0x42, 0xf8, 0xb9, 0x6d, 0xa4,
+    0x95, 0x40, 0x1a, 0xbf, 0x4d, 0xcd, 0x24, 0x98, 0xce, 0x6d, 0xd3, 0xf5, 0x0a, 0xc8, 0x10, 0x6c,
+    0x93, 0x76, 0x1a, 0xca, 0xf4, 0x6e, 0xd3, 0x7c, 0xcf, 0xe1, 0xaa, 0x44, 0xb7, 0x19, 0x7f, 0x0f,
+    0x23, 0x93, 0x6d, 0xa6, 0xd7, 0x42, 0x28, 0xee, 0x6d, 0x0e, 0x2d, 0x05, 0xf5, 0x91, 0x6d, 0x6a,
+    0x17, 0x43, 0xa8, 0xee, 0x6d, 0x9a, 0xcf, 0x81, 0xfa, 0xc5, 0xdb, 0x94, 0xe0, 0x69, 0x56, 0x35,
+    0xb2, 0xcd, 0xc6, 0xb7, 0x10, 0x3a, 0xb7, 0x4d, 0xb3, 0x0d, 0x64, 0xf0, 0xdb, 0x3c, 0x89, 0x81,
+    0x99, 0xdc, 0x36, 0x3d, 0xcd, 0x0e, 0xf2, 0x4b, 0x82, 0x6d, 0xca, 0x17, 0x41, 0xc9, 0xde, 0x6d,
+    0x42, 0x39, 0xe0, 0x0a, 0xdd, 0xa6, 0x71, 0x03, 0x8c, 0x8f, 0x6c, 0xd3, 0xdd, 0x06, 0xa1, 0xba,
+    0xb7, 0x19, 0x1b, 0x01, 0xf5, 0x93, 0x6d, 0x6e, 0xad, 0x87, 0xd0, 0xdc, 0xdb, 0x0c, 0xf5, 0x82,
+    0xea, 0xe2, 0x6d, 0x4e, 0xde, 0x80, 0x35, 0xc8, 0x36, 0x4d, 0x05, 0x10, 0x26, 0xb7, 0xcd, 0x6f,
+    0xdd, 0x41, 0x9a, 0xab, 0xc5, 0xd2, 0x32, 0x30, 0xbe, 0xc5, 0xd9, 0x47, 0x80, 0x44, 0x2d, 0x6e,
+    0xbd, 0x0f, 0x45, 0x5a, 0xfc, 0x58, 0x02, 0x17, 0xb4, 0x78, 0x02, 0xdf, 0x87, 0x46, 0x5b, 0x5c,
+    0xf4, 0x1c, 0xc2, 0xd3, 0xe2, 0x7d, 0x85, 0xa0, 0xb4, 0xc5, 0xe3, 0x78, 0xf7, 0x35, 0x4f, 0x8b,
+    0x1f, 0x6d, 0x07, 0x4d, 0xd1, 0xe2, 0x7a, 0x7c, 0x5e, 0x9d, 0xb6, 0x38, 0x6f, 0x0d, 0x04, 0xdf,
+    0xe2, 0x03, 0x33, 0x40, 0xae, 0x16, 0x4f, 0xd6, 0x80, 0xf1, 0x2d, 0x9e, 0xa9, 0x06, 0x12, 0xb5,
+    0x78, 0xb0, 0x07, 0x8a, 0xb4, 0xb8, 0x08, 0x4d, 0xd4, 0x05, 0x2d, 0xbe, 0x88, 0x77, 0x41, 0xa7,
+    0x2d, 0xbe, 0xf3, 0x06, 0xc2, 0xd3, 0xe2, 0x81, 0x06, 0x50, 0xda, 0xe2, 0xde, 0xd7, 0x8e, 0x30,
+    0x3c, 0x2d, 0x1e, 0xc1, 0x62, 0x46, 0x8a, 0x16, 0x5b, 0xed, 0xb0, 0xb4, 0xc5, 0x99, 0xf8, 0xb5,
+    0x31, 0xf8, 0x16, 0x9f, 0xda, 0x0f, 0xe4, 0x6a, 0xf1, 0xf7, 0x3a, 0x30, 0xbe, 0xc5, 0xc7, 0xf0,
+    0xd3, 0x67, 0x88, 0x5a, 0x5c, 0xb9, 0x0d, 0x8a, 0xb4, 0x38, 0x8c, 0x17, 0xc4, 0x10, 0xb4, 0xb8,
+    0x0e, 0x0d, 0x35, 0x68, 0x8b, 0x4b, 0x3e, 0x39, 0xc2, 0xf4, 0xb4, 0x78, 0x05, 0x1e, 0x63, 0x93,
+    0xb6, 0xf8, 0x02, 0x3e, 0xa7, 0xe9, 0x69, 0x71, 0x7f, 0x3a, 0x68, 0x8a, 0x16, 0x3f, 0xc5, 0x33,
+    0x6b, 0xd2, 0x16, 0xdf, 0xac, 0x87, 0xe0, 0x5b, 0xdc, 0x50, 0x06, 0xe4, 0x6a, 0xf1, 0x8f, 0xcf,
+    0x60, 0x7c, 0x8b, 0x77, 0x65, 0x03, 0x89, 0x5a, 0xfc, 0xe1, 0x2a, 0x14, 0x69, 0xf1, 0x97, 0x33,
+    0xe9, 0xce, 0x41, 0x42, 0xd0, 0xe2, 0x9d, 0x47, 0x61, 0x68, 0x8b, 0x95, 0x8f, 0x10, 0x9e, 0x16,
+    0x1f, 0xec, 0x02, 0xa5, 0x2d, 0xce, 0xb0, 0x21, 0x3c, 0x2d, 0x8e, 0xb6, 0x83, 0xa6, 0x68, 0x71,
+    0xeb, 0x24, 0x2c, 0x6d, 0xb1, 0xda, 0x0f, 0xc1, 0xb7, 0xb8, 0xe9, 0x27, 0x90, 0xab, 0xc5, 0x59,
+    0x97, 0xc1, 0xf8, 0x16, 0x8f, 0x3a, 0xc7, 0x41, 0x59, 0x16, 0xb5, 0x38, 0xba, 0x1b, 0x8a, 0xb4,
+    0x38, 0x67, 0x15, 0xb8, 0xa0, 0xc5, 0xa3, 0x1d, 0x30, 0xb4, 0xc5, 0x5b, 0x07, 0x21, 0x3c, 0x2d,
+    0x4e, 0x8b, 0x81, 0xd2, 0x16, 0x7f, 0x2b, 0x84, 0xf0, 0xb4, 0x38, 0x6b, 0x02, 0x34, 0x45, 0x8b,
+    0xaf, 0x6f, 0x86, 0xa5, 0x2d, 0xae, 0xfc, 0x0a, 0xc1, 0xb7, 0x78, 0xac, 0x0f, 0xa7, 0xc8, 0x85,
+    0x73, 0xf1, 0xc2, 0xb9, 0x78, 0xe1, 0x5c, 0x2c, 0x3e, 0x17, 0xff, 0x01, 0x94, 0x91, 0xc9, 0xde,
+    0x38, 0x0e, 0x00, 0x00,
+};
+
+inline constexpr unsigned char Named[] = {
+    0x1f, 0x8b, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x02, 0xff, 0x69, 0x6e, 0x73, 0x74, 0x61, 0x6c,
+    0x6c, 0x2e, 0x74, 0x61, 0x72, 0x00, 0x33, 0x30, 0x00, 0x02, 0x85, 0xd2, 0xa4, 0xd2, 0xbc, 0x92,
+    0x52, 0x85, 0x92, 0xc4, 0x22, 0x85, 0xcb, 0xcb, 0xb9, 0x40, 0x42, 0x86, 0x0a, 0xa5, 0xc5, 0xa9,
+    0x45, 0x0a, 0x45, 0xf9, 0xf9, 0x25, 0x0a, 0xd7, 0x78, 0xc1, 0x42, 0x46, 0x0a, 0x29, 0x99, 0xc5,
+    0x25, 0x45, 0x99, 0x49, 0xa5, 0x25, 0x99, 0xf9, 0x79, 0x10, 0xf9, 0x43, 0x76, 0x60, 0x29, 0x63,
+    0x85, 0xe4, 0x9c, 0xfc, 0xd2, 0x14, 0xdd, 0xcc, 0xbc, 0xcc, 0x12, 0x85, 0xf2, 0xe2, 0x1c, 0x85,
+    0xb3, 0xeb, 0xc1, 0xe2, 0x26, 0x0a, 0x99, 0xb9, 0x89, 0xe9, 0x00, 0xa7, 0x08, 0xdc, 0x57, 0x64,
+    0x00, 0x00, 0x00,
+};
+}  // namespace Ubuntu::Testing::GzipFixtures
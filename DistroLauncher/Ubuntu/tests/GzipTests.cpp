@@ -0,0 +1,230 @@
+#include "Check.h"
+#include "GzipFixtures.h"
+#include "../Gzip.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+namespace Gzip = Ubuntu::Gzip;
+namespace GzipFixtures = Ubuntu::Testing::GzipFixtures;
+
+namespace {
+// What MakeGzipFixtures.py compressed.
+std::string fixtureContents() {
+  static const char* words[] = {"ubuntu", "launcher", "distribution", "install",
+                                "image", "tar", "root", "user", "wsl", "cloud-init",
+                                "deflate", "huffman"};
+  constexpr std::size_t wordCount = sizeof(words) / sizeof(words[0]);
+  std::string out;
+  std::uint32_t state = 12345;
+  for (std::size_t i = 0; i < 120; ++i) {
+    char number[8];
+    std::snprintf(number, sizeof(number), "%05zu ", i);
+    out += number;
+    out += words[(i * 7) % wordCount];
+    out += ' ';
+    out += words[(i * 13 + 5) % wordCount];
+    out += ' ';
+    for (int j = 0; j < 2; ++j) {
+      state = state * 1103515245u + 12345u;
+      out += static_cast<char>(state >> 24);
+    }
+    out += '\n';
+  }
+  return out + out.substr(0, 800);
+}
+
+template <std::size_t N>
+std::string_view view(const unsigned char (&fixture)[N]) {
+  return {reinterpret_cast<const char*>(fixture), N};
+}
+
+struct Inflated {
+  Gzip::Status status;
+  std::string output;
+  Gzip::Stats stats;
+};
+
+Inflated inflate(std::string_view input) {
+  Inflated result;
+  result.status = Gzip::Inflate(
+      input,
+      [&result](std::string_view chunk) {
+        result.output += chunk;
+        return true;
+      },
+      &result.stats);
+  return result;
+}
+
+void appendLE32(std::string& out, std::uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    out += static_cast<char>((value >> (8 * i)) & 0xFF);
+  }
+}
+
+// The header storedMember() writes.
+constexpr std::size_t storedHeaderSize = 10 + 5 + 12 + 8 + 2;
+
+// A member of [contents] split into stored blocks of [blockSize], an empty one first, behind a
+// header with every optional field.
+std::string storedMember(std::string_view contents, std::size_t blockSize) {
+  std::string out{"\x1f\x8b\x08\x1e", 4};
+  out += std::string(6, '\0');
+  out += std::string{"\x03\x00" "ab\x01", 5};  // FEXTRA
+  out += std::string{"install.tar", 12};        // FNAME
+  out += std::string{"comment", 8};             // FCOMMENT
+  out += std::string{"\x12\x34", 2};            // FHCRC, not checked
+  auto block = [&out](std::string_view data, bool final) {
+    out += static_cast<char>(final ? 1 : 0);
+    const auto length = static_cast<std::uint16_t>(data.size());
+    out += static_cast<char>(length & 0xFF);
+    out += static_cast<char>(length >> 8);
+    out += static_cast<char>(~length & 0xFF);
+    out += static_cast<char>((~length >> 8) & 0xFF);
+    out += data;
+  };
+  block({}, false);
+  for (std::size_t offset = 0; offset < contents.size(); offset += blockSize) {
+    block(contents.substr(offset, blockSize), offset + blockSize >= contents.size());
+  }
+  appendLE32(out, Gzip::Crc32(0, contents));
+  appendLE32(out, static_cast<std::uint32_t>(contents.size()));
+  return out;
+}
+
+void computesCrc32() {
+  // The check value of the CRC-32 gzip uses.
+  CHECK(Gzip::Crc32(0, "123456789") == 0xCBF43926);
+  CHECK(Gzip::Crc32(0, "") == 0);
+  auto contents = fixtureContents();
+  CHECK(contents.size() == GzipFixtures::ContentsSize);
+  CHECK(Gzip::Crc32(0, contents) == GzipFixtures::ContentsCrc32);
+  // Running, in pieces.
+  auto half = contents.size() / 2;
+  CHECK(Gzip::Crc32(Gzip::Crc32(0, contents.substr(0, half)), contents.substr(half)) ==
+        GzipFixtures::ContentsCrc32);
+}
+
+void inflatesStoredBlocks() {
+  const auto contents = fixtureContents();
+  const auto member = storedMember(contents, 1000);
+  auto inflated = inflate(member);
+  CHECK(inflated.status == Gzip::Status::Ok);
+  CHECK(inflated.output == contents);
+  CHECK(inflated.stats.members == 1 && inflated.stats.uncompressedBytes == contents.size());
+  CHECK(inflated.stats.compressedBytes == member.size());
+
+  // The length complement of the first block past the empty one.
+  auto corrupted = member;
+  corrupted[storedHeaderSize + 5 + 3] ^= 1;
+  CHECK(inflate(corrupted).status == Gzip::Status::BadData);
+}
+
+void inflatesFixedBlocks() {
+  auto inflated = inflate(view(GzipFixtures::Fixed));
+  CHECK(inflated.status == Gzip::Status::Ok);
+  CHECK(inflated.output == fixtureContents());
+}
+
+void inflatesDynamicBlocksOfEveryLevel() {
+  const auto contents = fixtureContents();
+  for (auto fixture : {view(GzipFixtures::Level1), view(GzipFixtures::Level6),
+                       view(GzipFixtures::Level9)}) {
+    auto inflated = inflate(fixture);
+    CHECK(inflated.status == Gzip::Status::Ok);
+    CHECK(inflated.output == contents);
+    CHECK(inflated.stats.compressedBytes == fixture.size());
+  }
+
+  // With a file name in the header, as gzip(1) writes it.
+  auto named = inflate(view(GzipFixtures::Named));
+  CHECK(named.status == Gzip::Status::Ok && named.output == contents.substr(0, 100));
+}
+
+void inflatesMultipleMembers() {
+  const auto contents = fixtureContents();
+  std::string stream{view(GzipFixtures::Level6)};
+  stream += view(GzipFixtures::Fixed);
+  stream += storedMember(contents, 4096);
+  auto inflated = inflate(stream);
+  CHECK(inflated.status == Gzip::Status::Ok);
+  CHECK(inflated.output == contents + contents + contents);
+  CHECK(inflated.stats.members == 3);
+
+  // Zeros padding the stream are ignored, anything else must be a member.
+  CHECK(inflate(stream + std::string(512, '\0')).status == Gzip::Status::Ok);
+  CHECK(inflate(stream + "not another member").status == Gzip::Status::BadHeader);
+}
+
+void reportsTruncatedInput() {
+  const auto fixture = view(GzipFixtures::Level9);
+  // Within the header, the deflate data and the trailer.
+  for (std::size_t size : {std::size_t{0}, std::size_t{5}, std::size_t{10}, fixture.size() / 2,
+                           fixture.size() - 8, fixture.size() - 1}) {
+    CHECK(inflate(fixture.substr(0, size)).status == Gzip::Status::Truncated);
+  }
+  // Every other cut fails too, even if not all are told apart from bad data.
+  for (std::size_t size = 0; size < fixture.size(); ++size) {
+    CHECK(inflate(fixture.substr(0, size)).status != Gzip::Status::Ok);
+  }
+
+  const auto stored = storedMember(fixtureContents(), 1000);
+  CHECK(inflate(std::string_view{stored}.substr(0, stored.size() / 2)).status ==
+        Gzip::Status::Truncated);
+  // A second member cut short.
+  std::string stream{view(GzipFixtures::Level1)};
+  stream += view(GzipFixtures::Level1).substr(0, 30);
+  CHECK(inflate(stream).status == Gzip::Status::Truncated);
+}
+
+void reportsBadTrailers() {
+  const std::string fixture{view(GzipFixtures::Level6)};
+  for (std::size_t fromEnd : {8, 5, 4, 1}) {
+    auto corrupted = fixture;
+    corrupted[corrupted.size() - fromEnd] ^= 0x40;
+    // The first four bytes are the CRC32, the last four the size.
+    CHECK(inflate(corrupted).status == Gzip::Status::BadChecksum);
+  }
+  // Corrupted data, whether or not it still decodes.
+  auto corrupted = fixture;
+  corrupted[fixture.size() / 2] ^= 0x10;
+  auto status = inflate(corrupted).status;
+  CHECK(status == Gzip::Status::BadChecksum || status == Gzip::Status::BadData);
+}
+
+void rejectsOtherFormats() {
+  CHECK(inflate("not a gzip stream").status == Gzip::Status::BadHeader);
+  std::string deflate64{view(GzipFixtures::Level6)};
+  deflate64[2] = 9;
+  CHECK(inflate(deflate64).status == Gzip::Status::BadHeader);
+  // Block type 3 is reserved.
+  std::string reserved{"\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\xff\x07\x00", 12};
+  CHECK(inflate(reserved).status == Gzip::Status::BadData);
+}
+
+void stopsWhenTheSinkAsks() {
+  std::size_t received = 0;
+  auto status = Gzip::Inflate(view(GzipFixtures::Level6), [&received](std::string_view chunk) {
+    received += chunk.size();
+    return false;
+  });
+  CHECK(status == Gzip::Status::Aborted);
+  CHECK(received > 0 && received <= GzipFixtures::ContentsSize);
+}
+}  // namespace
+
+int main() {
+  RUN(computesCrc32);
+  RUN(inflatesStoredBlocks);
+  RUN(inflatesFixedBlocks);
+  RUN(inflatesDynamicBlocksOfEveryLevel);
+  RUN(inflatesMultipleMembers);
+  RUN(reportsTruncatedInput);
+  RUN(reportsBadTrailers);
+  RUN(rejectsOtherFormats);
+  RUN(stopsWhenTheSinkAsks);
+  return TEST_EXIT_CODE();
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+// What the tests borrow from the Linux host they run on: temporary files, and its shell to run the
+// scripts the launcher would have the distro run.
+
+#include "../WslBackend.h"
+
+#include <atomic>
+#include <csignal>
+#include <fcntl.h>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+namespace Ubuntu::Testing {
+// A fresh directory under the temporary one, removed when done.
+struct TemporaryDirectory {
+  std::filesystem::path path;
+
+  TemporaryDirectory() {
+    std::random_device random;
+    path = std::filesystem::temp_directory_path() / ("launcher-test-" + std::to_string(random()));
+    std::filesystem::create_directories(path);
+  }
+
+  ~TemporaryDirectory() { std::filesystem::remove_all(path); }
+
+  TemporaryDirectory(const TemporaryDirectory&) = delete;
+  TemporaryDirectory& operator=(const TemporaryDirectory&) = delete;
+};
+
+// A process started by the shell of the host and fed through its stdin, its stdout and stderr
+// merged, as WslBackend::Spawn starts them in the distro. Suits SimulatedWsl session fixtures.
+class HostSession : public WslBackend::Session {
+ public:
+  // Starts [command], or returns nullptr if it can't be.
+  static std::unique_ptr<WslBackend::Session> Start(std::string_view command,
+                                                    ConsumeFunction consume) {
+    // Writing to a shell that exited mustn't kill the test.
+    std::signal(SIGPIPE, SIG_IGN);
+    // Not inherited by the sessions other threads start meanwhile, which would hold them open.
+    int in[2];
+    int out[2];
+    if (pipe2(in, O_CLOEXEC) != 0) {
+      return nullptr;
+    }
+    if (pipe2(out, O_CLOEXEC) != 0) {
+      close(in[0]);
+      close(in[1]);
+      return nullptr;
+    }
+    const std::string line{command};
+    pid_t pid = fork();
+    if (pid == 0) {
+      dup2(in[0], STDIN_FILENO);
+      dup2(out[1], STDOUT_FILENO);
+      dup2(out[1], STDERR_FILENO);
+      execl("/bin/sh", "sh", "-c", line.c_str(), static_cast<char*>(nullptr));
+      _exit(127);
+    }
+    close(in[0]);
+    close(out[1]);
+    if (pid < 0) {
+      close(in[1]);
+      close(out[0]);
+      return nullptr;
+    }
+    return std::unique_ptr<WslBackend::Session>{
+        new HostSession{pid, in[1], out[0], std::move(consume)}};
+  }
+
+  ~HostSession() override {
+    close(stdIn_);
+    if (!reaped_) {
+      kill(pid_, SIGKILL);
+    }
+    reader_.join();
+    close(stdOut_);
+  }
+
+  bool Write(std::string_view data) override {
+    while (!data.empty()) {
+      auto written = write(stdIn_, data.data(), data.size());
+      if (written < 0) {
+        return false;
+      }
+      data.remove_prefix(static_cast<std::size_t>(written));
+    }
+    return true;
+  }
+
+ private:
+  HostSession(pid_t pid, int stdIn, int stdOut, ConsumeFunction consume)
+      : pid_{pid}, stdIn_{stdIn}, stdOut_{stdOut}, consume_{std::move(consume)} {
+    reader_ = std::thread{[this] {
+      char buffer[4096];
+      for (ssize_t count; (count = read(stdOut_, buffer, sizeof(buffer))) > 0;) {
+        consume_({buffer, static_cast<std::size_t>(count)});
+      }
+      waitpid(pid_, nullptr, 0);
+      reaped_ = true;
+      consume_({});
+    }};
+  }
+
+  pid_t pid_;
+  int stdIn_;
+  int stdOut_;
+  ConsumeFunction consume_;
+  std::atomic<bool> reaped_{false};
+  std::thread reader_;
+};
+}  // namespace Ubuntu::Testing
@@ -0,0 +1,120 @@
+#include "Check.h"
+#include "Host.h"
+#include "../ImageCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+namespace ImageCache = Ubuntu::ImageCache;
+namespace fs = std::filesystem;
+using Ubuntu::Testing::TemporaryDirectory;
+
+namespace {
+// Spans a few blocks, the last one partial.
+std::string image() {
+  std::string contents(2 * ImageCache::BlockSize + 12345, '\0');
+  std::mt19937_64 random{42};
+  for (std::size_t i = 0; i + 8 <= contents.size(); i += 8) {
+    auto bits = random();
+    std::memcpy(&contents[i], &bits, 8);
+  }
+  return contents;
+}
+
+bool build(const fs::path& directory, std::string_view contents, std::string source) {
+  ImageCache::Writer writer{directory};
+  // In chunks straddling the block boundaries.
+  for (std::size_t offset = 0; offset < contents.size(); offset += 3'000'017) {
+    if (!writer.Append(contents.substr(offset, 3'000'017))) {
+      return false;
+    }
+  }
+  return writer.Commit(std::move(source));
+}
+
+void parsesManifests() {
+  ImageCache::Manifest manifest;
+  manifest.source = "abc123";
+  manifest.size = ImageCache::BlockSize + 1;
+  manifest.blocks = {0xdeadbeef, 0x1};
+  auto parsed = ImageCache::Manifest::Parse(manifest.Format());
+  CHECK(parsed && parsed->source == "abc123" && parsed->size == manifest.size);
+  CHECK(parsed->blocks == manifest.blocks);
+  CHECK(!parsed->gzipRegistrationMs);
+
+  manifest.gzipRegistrationMs = 4200;
+  manifest.defaultUid = 1000;
+  manifest.flags = 5;
+  parsed = ImageCache::Manifest::Parse(manifest.Format() + "from-the-future yes\n");
+  CHECK(parsed && parsed->gzipRegistrationMs == 4200u && parsed->defaultUid == 1000ul);
+  CHECK(parsed->flags == 5ul);
+
+  // The blocks don't account for the size.
+  CHECK(!ImageCache::Manifest::Parse("source abc\nsize 1\n"));
+  CHECK(!ImageCache::Manifest::Parse("source abc\nsize x\nblock 0\n"));
+  CHECK(!ImageCache::Manifest::Parse("size 0\n"));
+  CHECK(!ImageCache::Manifest::Parse("garbage"));
+}
+
+void buildsAndValidates() {
+  TemporaryDirectory directory;
+  auto contents = image();
+  CHECK(build(directory.path, contents, "digest"));
+  CHECK(fs::file_size(ImageCache::ImagePath(directory.path)) == contents.size());
+
+  auto manifest = ImageCache::Load(directory.path);
+  CHECK(manifest && manifest->source == "digest" && manifest->size == contents.size());
+  CHECK(manifest->blocks.size() == 3);
+  std::atomic<bool> cancelled{false};
+  for (unsigned threads : {1u, 8u}) {
+    CHECK(ImageCache::Validate(directory.path, *manifest, cancelled, threads));
+  }
+
+  manifest->gzipRegistrationMs = 1234;
+  CHECK(ImageCache::Save(directory.path, *manifest));
+  CHECK(ImageCache::Load(directory.path)->gzipRegistrationMs == 1234u);
+
+  // A flipped byte in the middle block.
+  {
+    std::fstream file{ImageCache::ImagePath(directory.path),
+                      std::ios::binary | std::ios::in | std::ios::out};
+    file.seekp(ImageCache::BlockSize + 7);
+    file.put(static_cast<char>(contents[ImageCache::BlockSize + 7] ^ 1));
+  }
+  CHECK(!ImageCache::Validate(directory.path, *manifest, cancelled));
+
+  // Truncated.
+  fs::resize_file(ImageCache::ImagePath(directory.path), 100);
+  CHECK(!ImageCache::Validate(directory.path, *manifest, cancelled));
+}
+
+void abandonsUncommittedCopies() {
+  TemporaryDirectory directory;
+  CHECK(build(directory.path, "first", "one"));
+  {
+    ImageCache::Writer writer{directory.path};
+    CHECK(writer.Append("second, never committed"));
+  }
+  auto manifest = ImageCache::Load(directory.path);
+  CHECK(manifest && manifest->source == "one" && manifest->size == 5);
+  std::atomic<bool> cancelled{false};
+  CHECK(ImageCache::Validate(directory.path, *manifest, cancelled));
+  CHECK(std::distance(fs::directory_iterator{directory.path}, fs::directory_iterator{}) == 2);
+
+  // Replaced on commit.
+  CHECK(build(directory.path, "third", "three"));
+  CHECK(ImageCache::Load(directory.path)->source == "three");
+
+  CHECK(!ImageCache::Load(directory.path / "missing"));
+}
+}  // namespace
+
+int main() {
+  RUN(parsesManifests);
+  RUN(buildsAndValidates);
+  RUN(abandonsUncommittedCopies);
+  return TEST_EXIT_CODE();
+}
@@ -0,0 +1,116 @@
+#include "AllocationCounter.h"
+#include "SimulatedWsl.h"
+#include "../InitTasks.h"
+#include "../Trace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+using Ubuntu::NssQuery;
+using Ubuntu::ProcessResult;
+using Ubuntu::UserDirectory;
+using Ubuntu::Testing::Latency;
+using Ubuntu::Testing::SimulatedWsl;
+
+namespace {
+// A local database of [entries] users, the first regular one coming last.
+std::string syntheticPasswd(std::size_t entries) {
+  std::string contents = "root:x:0:0:root:/root:/bin/bash\n";
+  for (std::size_t i = 1; i < entries; ++i) {
+    auto uid = std::to_string(i < entries - 1 ? 100'000 + i : 1000);
+    contents += "user" + uid + ":x:" + uid + ":" + uid + "::/home/user" + uid + ":/bin/bash\n";
+  }
+  return contents;
+}
+
+struct Scenario {
+  const char* name;
+  SimulatedWsl::Distro distro;
+  // Whether the provisioning script fails, forcing one launch per step.
+  bool fallback = false;
+};
+
+std::vector<Scenario> scenarios() {
+  auto small = syntheticPasswd(50);
+  auto large = syntheticPasswd(100'000);
+  std::map<std::string, std::string, std::less<>> directory{
+      {"etc/nsswitch.conf", "passwd: files sss\n"}};
+  std::map<std::string, std::string, std::less<>> named{{"etc/wsl.conf", "[user]\ndefault=u\n"}};
+  return {
+      {"local", {small}},
+      {"local fallback", {small}, true},
+      {"large", {large}},
+      {"large fallback", {large}, true},
+      {"sss fallback", {large, directory}, true},
+      {"named fallback", {large + "u:x:1001:1001::/home/u:/bin/sh\n", named}, true},
+  };
+}
+
+struct Profile {
+  const char* name;
+  Latency latency;
+};
+
+// Orders of magnitude seen on a WSL 2 VM already running.
+const Profile profiles[] = {
+    {"none", {}},
+    {"wsl2", {std::chrono::microseconds{300}, std::chrono::milliseconds{20},
+              std::chrono::microseconds{50}, std::chrono::milliseconds{1}}},
+};
+
+UserDirectory unusedDirectory() {
+  return UserDirectory{
+      [](const NssQuery&) -> std::optional<std::vector<Ubuntu::UserEntry>> { return {}; }};
+}
+
+void failProvisioning(SimulatedWsl& wsl) {
+  wsl.SetFixture([](std::string_view command) -> std::optional<ProcessResult> {
+    if (command.find("emit()") != std::string_view::npos) {
+      return ProcessResult{{}, 127};
+    }
+    return std::nullopt;
+  });
+}
+
+// Defeats the optimizer.
+volatile std::size_t sink = 0;
+}  // namespace
+
+int main() {
+  // Profile with UBUNTU_LAUNCHER_TRACE=<file>, as the launcher itself.
+  const char* tracePath = std::getenv("UBUNTU_LAUNCHER_TRACE");
+  Ubuntu::Trace::Session trace{tracePath ? tracePath : ""};
+
+  std::printf("%-8s %-16s %10s %10s %12s %14s\n", "latency", "scenario", "ms/run", "launches",
+              "KiB streamed", "allocs/run");
+  for (const auto& profile : profiles) {
+    int runs = profile.latency.launch.count() == 0 ? 20 : 3;
+    for (const auto& scenario : scenarios()) {
+      std::size_t launches = 0;
+      std::size_t streamed = 0;
+      std::size_t allocations = 0;
+      std::chrono::steady_clock::duration elapsed{};
+      for (int i = 0; i < runs; ++i) {
+        SimulatedWsl wsl{scenario.distro, profile.latency};
+        if (scenario.fallback) {
+          failProvisioning(wsl);
+        }
+        auto users = unusedDirectory();
+        auto start = std::chrono::steady_clock::now();
+        allocations += Ubuntu::Testing::AllocationsOf(
+            [&] { sink = sink + Ubuntu::CheckInitTasks(wsl, users, true); });
+        elapsed += std::chrono::steady_clock::now() - start;
+        launches += wsl.Commands().size();
+        streamed += wsl.BytesStreamed();
+      }
+      std::chrono::duration<double, std::milli> ms = elapsed / runs;
+      std::printf("%-8s %-16s %10.2f %10zu %12zu %14zu\n", profile.name, scenario.name, ms.count(),
+                  launches / runs, streamed / runs / 1024, allocations / runs);
+    }
+  }
+  return 0;
+}
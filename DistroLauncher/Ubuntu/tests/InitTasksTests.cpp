@@ -0,0 +1,195 @@
+#include "Check.h"
+#include "SimulatedWsl.h"
+#include "../InitTasks.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+using Ubuntu::CheckInitTasks;
+using Ubuntu::NssQuery;
+using Ubuntu::ProcessResult;
+using Ubuntu::UserDirectory;
+using Ubuntu::Testing::SimulatedWsl;
+
+namespace {
+const char* passwd =
+    "root:x:0:0:root:/root:/bin/bash\n"
+    "daemon:x:1:1:daemon:/usr/sbin:/usr/sbin/nologin\n"
+    "u:x:1000:1000::/home/u:/bin/bash\n"
+    "v:x:1001:1001::/home/v:/bin/bash\n";
+
+// Never expected to be asked anything, the flows telling it what they find.
+UserDirectory noQueries() {
+  return UserDirectory{[](const NssQuery&) -> std::optional<std::vector<Ubuntu::UserEntry>> {
+    CHECK(false);
+    return std::nullopt;
+  }};
+}
+
+std::size_t countCommands(const SimulatedWsl& wsl, std::string_view prefix) {
+  return std::count_if(wsl.Commands().begin(), wsl.Commands().end(), [prefix](const auto& c) {
+    return c.compare(0, prefix.size(), prefix) == 0;
+  });
+}
+
+// Fails the provisioning script, as an older distro without some tool would.
+void breakProvisioning(SimulatedWsl& wsl) {
+  wsl.SetFixture([](std::string_view command) -> std::optional<ProcessResult> {
+    if (command.find("emit()") != std::string_view::npos) {
+      return ProcessResult{{}, 127, {}, "sh: 1: emit: not found\n"};
+    }
+    return std::nullopt;
+  });
+}
+
+void setsTheFirstRegularUserInOneLaunch() {
+  SimulatedWsl wsl{{passwd, {{"etc/resolv.conf", "nameserver 1.1.1.1\n"}}}};
+  auto users = noQueries();
+  CHECK(CheckInitTasks(wsl, users, true));
+  CHECK(wsl.State().defaultUid == 1000);
+  CHECK(wsl.Commands().size() == 1);
+  CHECK(wsl.State().files.count("etc/resolv.conf") == 0);
+  CHECK(users.FindByName("v")->uid == 1001);
+}
+
+void honoursWslConf() {
+  SimulatedWsl wsl{{passwd, {{"etc/wsl.conf", "[user]\ndefault=v\n"}}}};
+  auto users = noQueries();
+  CHECK(CheckInitTasks(wsl, users, true));
+  CHECK(wsl.State().defaultUid == 1001);
+}
+
+void keepsADefaultUserAlreadySet() {
+  SimulatedWsl::Distro distro{passwd};
+  distro.defaultUid = 1001;
+  SimulatedWsl wsl{distro};
+  auto users = noQueries();
+  CHECK(CheckInitTasks(wsl, users, true));
+  CHECK(wsl.State().defaultUid == 1001);
+}
+
+void leavesTheUserAloneIfNotAsked() {
+  SimulatedWsl wsl{{passwd}};
+  auto users = noQueries();
+  CHECK(CheckInitTasks(wsl, users, false));
+  CHECK(wsl.State().defaultUid == 0);
+}
+
+void failsWithoutRegularUsers() {
+  SimulatedWsl wsl{{"root:x:0:0:root:/root:/bin/bash\n"}};
+  auto users = noQueries();
+  CHECK(!CheckInitTasks(wsl, users, true));
+  CHECK(wsl.State().defaultUid == 0);
+}
+
+void fallsBackToOneProcessPerStep() {
+  SimulatedWsl wsl{{passwd, {{"etc/resolv.conf", "nameserver 1.1.1.1\n"}}}};
+  breakProvisioning(wsl);
+  auto users = noQueries();
+  CHECK(CheckInitTasks(wsl, users, true));
+  CHECK(wsl.State().defaultUid == 1000);
+  CHECK(wsl.State().files.count("etc/resolv.conf") == 0);
+  CHECK(countCommands(wsl, "getent passwd") == 1);
+  CHECK(!wsl.Printed().empty());
+}
+
+void fallsBackOnAGarbledReply() {
+  SimulatedWsl wsl{{passwd}};
+  wsl.SetFixture([](std::string_view command) -> std::optional<ProcessResult> {
+    if (command.find("emit()") != std::string_view::npos) {
+      return ProcessResult{{}, 0, "garbled\n", {}};
+    }
+    return std::nullopt;
+  });
+  auto users = noQueries();
+  CHECK(CheckInitTasks(wsl, users, true));
+  CHECK(wsl.State().defaultUid == 1000);
+  // Print ends the line itself.
+  const std::wstring error = L"ERROR: unexpected reply from the provisioning script";
+  CHECK(std::count(wsl.Printed().begin(), wsl.Printed().end(), error) == 1);
+}
+
+void fallbackLooksTheNamedUserUp() {
+  SimulatedWsl wsl{{passwd, {{"etc/wsl.conf", "[user]\ndefault=v\n"}}}};
+  breakProvisioning(wsl);
+  auto users = noQueries();
+  CHECK(CheckInitTasks(wsl, users, true));
+  CHECK(wsl.State().defaultUid == 1001);
+  CHECK(countCommands(wsl, "getent passwd 'v'") == 1);
+  // The enumeration may have started before wsl.conf was read, only to be cancelled.
+  CHECK(countCommands(wsl, "getent passwd") <= 2);
+}
+
+void fallbackProbesADirectory() {
+  SimulatedWsl wsl{{passwd, {{"etc/nsswitch.conf", "passwd: files sss\n"}}}};
+  breakProvisioning(wsl);
+  auto users = noQueries();
+  CHECK(CheckInitTasks(wsl, users, true));
+  CHECK(wsl.State().defaultUid == 1000);
+  CHECK(countCommands(wsl, "getent passwd 1000 1001") == 1);
+  CHECK(countCommands(wsl, "getent passwd") == 1);
+}
+
+void planSparesEnumeratingUsers() {
+  Ubuntu::Tar::Index image;
+  image.entries.push_back({"etc/passwd"});
+  image.files["etc/passwd"] = passwd;
+  auto plan = Ubuntu::PlanFromImage(image);
+
+  SimulatedWsl wsl{{passwd}};
+  auto users = noQueries();
+  CHECK(CheckInitTasks(wsl, users, true, plan.get()));
+  CHECK(wsl.State().defaultUid == 1000);
+  CHECK(wsl.Commands().size() == 1);
+  CHECK(wsl.Commands().front().find("skip_users=1\n") != std::string::npos);
+  CHECK(wsl.Commands().front().find("skip_cloud_init=1\n") != std::string::npos);
+}
+
+void waitsForCloudInitBeforeLookingForUsers() {
+  SimulatedWsl::Distro distro{passwd, {{"etc/wsl.conf", "[boot]\nsystemd=true\n"}}};
+  distro.cloudInitStatuses = {R"({"status": "running"})", R"({"status": "done"})"};
+  SimulatedWsl wsl{distro};
+  Ubuntu::CloudInit::WaitOptions options;
+  options.initialBackoff = std::chrono::milliseconds{1};
+  auto users = noQueries();
+  CHECK(CheckInitTasks(wsl, users, true, nullptr, options));
+  CHECK(wsl.CloudInitPolls() == 2);
+  CHECK(wsl.State().defaultUid == 1000);
+  // The provisioning script stopped short of enumerating users, done once cloud-init finished.
+  CHECK(countCommands(wsl, "getent passwd") == 1);
+  // Only how the default user was found.
+  CHECK(wsl.Printed().size() == 1);
+  CHECK(wsl.Printed().front().find(L"Default user found among the regular users in ") == 0);
+}
+
+void warnsWhenCloudInitTakesTooLong() {
+  SimulatedWsl::Distro distro{passwd, {{"etc/wsl.conf", "[boot]\nsystemd=true\n"}}};
+  distro.cloudInitStatuses = {R"({"status": "running", "init": {"start": 1.0, "finished": null}})"};
+  SimulatedWsl wsl{distro};
+  Ubuntu::CloudInit::WaitOptions options;
+  options.initialBackoff = std::chrono::milliseconds{1};
+  options.deadline = std::chrono::milliseconds{20};
+  auto users = noQueries();
+  CHECK(CheckInitTasks(wsl, users, true, nullptr, options));
+  CHECK(wsl.State().defaultUid == 1000);
+  CHECK(wsl.Printed().size() == 3);
+  CHECK(wsl.Printed()[1] == L"init: running\n");
+}
+}  // namespace
+
+int main() {
+  RUN(setsTheFirstRegularUserInOneLaunch);
+  RUN(honoursWslConf);
+  RUN(keepsADefaultUserAlreadySet);
+  RUN(leavesTheUserAloneIfNotAsked);
+  RUN(failsWithoutRegularUsers);
+  RUN(fallsBackToOneProcessPerStep);
+  RUN(fallsBackOnAGarbledReply);
+  RUN(fallbackLooksTheNamedUserUp);
+  RUN(fallbackProbesADirectory);
+  RUN(planSparesEnumeratingUsers);
+  RUN(waitsForCloudInitBeforeLookingForUsers);
+  RUN(warnsWhenCloudInitTakesTooLong);
+  return TEST_EXIT_CODE();
+}
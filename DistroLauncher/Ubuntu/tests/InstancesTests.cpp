@@ -0,0 +1,121 @@
+#include "Check.h"
+#include "SimulatedWsl.h"
+#include "../Instances.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Instances = Ubuntu::Instances;
+using Ubuntu::Testing::SimulatedWsl;
+using namespace std::chrono_literals;
+
+namespace {
+const char* passwd =
+    "root:x:0:0:root:/root:/bin/bash\n"
+    "u:x:1000:1000::/home/u:/bin/bash\n";
+
+// Registers simulated instances, keeping an eye on them.
+struct Farm {
+  SimulatedWsl::Distro image{passwd, {{"etc/resolv.conf", "nameserver 1.1.1.1\n"}}};
+  std::chrono::milliseconds registrationTime{0};
+  std::mutex mutex;
+  std::map<std::wstring, std::shared_ptr<SimulatedWsl>> registered;
+  std::atomic<int> registering{0};
+  std::atomic<int> maxRegistering{0};
+
+  Instances::RegisterFunction registration() {
+    return [this](const std::wstring& name,
+                  std::wstring& error) -> std::shared_ptr<Ubuntu::WslBackend> {
+      auto now = ++registering;
+      for (auto max = maxRegistering.load();
+           now > max && !maxRegistering.compare_exchange_weak(max, now);) {
+      }
+      std::this_thread::sleep_for(registrationTime);
+      --registering;
+      std::scoped_lock lock{mutex};
+      if (registered.count(name) != 0 || name.find(L"taken") != std::wstring::npos) {
+        error = L"already registered";
+        return nullptr;
+      }
+      auto wsl = std::make_shared<SimulatedWsl>(image);
+      registered[name] = wsl;
+      return wsl;
+    };
+  }
+};
+
+void namesInstances() {
+  CHECK(Instances::Names(L"farm", 3) ==
+        (std::vector<std::wstring>{L"farm-1", L"farm-2", L"farm-3"}));
+  CHECK(Instances::Names(L"farm", 0).empty());
+  CHECK(Instances::ValidName(L"Ubuntu-22.04_test-1"));
+  CHECK(!Instances::ValidName(L""));
+  CHECK(!Instances::ValidName(L"farm 1"));
+  CHECK(!Instances::ValidName(L"farm/1"));
+}
+
+void installsEveryInstance() {
+  Farm farm;
+  std::vector<std::wstring> finished;
+  auto names = Instances::Names(L"farm", 5);
+  auto summary = Instances::InstallAll(names, farm.registration(), {2}, [&](const auto& instance) {
+    finished.push_back(instance.name);
+  });
+  CHECK(summary.Succeeded() == 5);
+  CHECK(finished.size() == 5);
+  CHECK(summary.PerMinute() > 0);
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    CHECK(summary.instances[i].name == names[i]);
+    CHECK(summary.instances[i].defaultUserSet);
+  }
+  // Each provisioned as a single install would be.
+  CHECK(farm.registered.size() == 5);
+  for (auto& [name, wsl] : farm.registered) {
+    CHECK(wsl->State().defaultUid == 1000);
+    CHECK(wsl->State().files.count("etc/resolv.conf") == 0);
+  }
+}
+
+void boundsTheRegistrations() {
+  Farm farm;
+  farm.registrationTime = 50ms;
+  auto start = std::chrono::steady_clock::now();
+  auto summary = Instances::InstallAll(Instances::Names(L"farm", 6), farm.registration(), {3}, {});
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  CHECK(summary.Succeeded() == 6);
+  CHECK(farm.maxRegistering <= 3);
+  // Six registrations one after the other would take 300ms.
+  CHECK(elapsed < 250ms);
+}
+
+void reportsFailures() {
+  Farm farm;
+  farm.image.passwd = "root:x:0:0:root:/root:/bin/bash\n";
+  auto summary = Instances::InstallAll({L"farm-1", L"taken", L"bad name"}, farm.registration(),
+                                       {4}, {});
+  CHECK(summary.Succeeded() == 1);
+  // No regular user to make the default, which isn't a failure.
+  CHECK(summary.instances[0].Succeeded() && !summary.instances[0].defaultUserSet);
+  CHECK(summary.instances[1].error == L"already registered");
+  CHECK(!summary.instances[2].Succeeded());
+  CHECK(farm.registered.size() == 1);
+
+  // What an instance prints tells which one it is.
+  auto& printed = farm.registered[L"farm-1"]->Printed();
+  CHECK(std::all_of(printed.begin(), printed.end(),
+                    [](const std::wstring& line) { return line.rfind(L"farm-1: ", 0) == 0; }));
+}
+}  // namespace
+
+int main() {
+  RUN(namesInstances);
+  RUN(installsEveryInstance);
+  RUN(boundsTheRegistrations);
+  RUN(reportsFailures);
+  return TEST_EXIT_CODE();
+}
@@ -0,0 +1,67 @@
+#include "Check.h"
+#include "../Json.h"
+
+#include <string>
+
+namespace Json = Ubuntu::Json;
+
+namespace {
+void parsesNestedDocuments() {
+  auto document = Json::Parse(R"( {"a": [1, -2.5e1, true, false, null], "b": {"c": "d"}} )");
+  CHECK(document.has_value());
+  const auto* a = document->Find("a");
+  CHECK(a && a->AsArray() && a->AsArray()->size() == 5);
+  const auto& array = *a->AsArray();
+  CHECK(*array[0].AsNumber() == 1);
+  CHECK(*array[1].AsNumber() == -25);
+  CHECK(*array[2].AsBool());
+  CHECK(!*array[3].AsBool());
+  CHECK(array[4].IsNull());
+  CHECK(*document->Find("b")->Find("c")->AsString() == "d");
+  CHECK(document->Find("missing") == nullptr);
+  CHECK(a->Find("a") == nullptr);
+}
+
+void decodesEscapes() {
+  auto document = Json::Parse(R"("\"\\\/\b\f\n\r\t\u00e9\ud83d\ude00")");
+  CHECK(document && *document->AsString() == "\"\\/\b\f\n\r\t\xC3\xA9\xF0\x9F\x98\x80");
+}
+
+void lastDuplicateKeyWins() {
+  auto document = Json::Parse(R"({"k": 1, "k": 2})");
+  CHECK(document && *document->Find("k")->AsNumber() == 2);
+}
+
+void rejectsIllFormedDocuments() {
+  for (const char* text : {"", "{", "[1,]", "{\"a\" 1}", "{\"a\": 1,}", "01x", "tru", "\"\\x\"",
+                           "\"\\ud800\"", "\"a\nb\"", "1 2", "+1", "{a: 1}"}) {
+    if (Json::Parse(text).has_value()) {
+      std::fprintf(stderr, "accepted: %s\n", text);
+      CHECK(false);
+    }
+  }
+}
+
+void refusesDeepNesting() {
+  CHECK(Json::Parse(std::string(50, '[') + std::string(50, ']')).has_value());
+  CHECK(!Json::Parse(std::string(100'000, '[') + std::string(100'000, ']')).has_value());
+}
+
+void roundTripsStrings() {
+  std::string text = "quote\" backslash\\ newline\n control\x01 é";
+  std::string json;
+  Json::AppendString(json, text);
+  CHECK(json == "\"quote\\\" backslash\\\\ newline\\n control\\u0001 é\"");
+  CHECK(*Json::Parse(json)->AsString() == text);
+}
+}  // namespace
+
+int main() {
+  RUN(parsesNestedDocuments);
+  RUN(decodesEscapes);
+  RUN(lastDuplicateKeyWins);
+  RUN(rejectsIllFormedDocuments);
+  RUN(refusesDeepNesting);
+  RUN(roundTripsStrings);
+  return TEST_EXIT_CODE();
+}
@@ -0,0 +1,192 @@
+#include "Check.h"
+#include "Host.h"
+#include "../LaunchStats.h"
+#include "../Trace.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+namespace LaunchStats = Ubuntu::LaunchStats;
+namespace Trace = Ubuntu::Trace;
+namespace fs = std::filesystem;
+using std::chrono::microseconds;
+using Histogram = LaunchStats::Histogram;
+using Ubuntu::Testing::TemporaryDirectory;
+
+namespace {
+void bucketsStayWithinASixteenth() {
+  for (std::uint64_t v = 0; v < 32; ++v) {
+    CHECK(Histogram::BucketOf(v) == v && Histogram::LowerBound(v) == v);
+  }
+  CHECK(Histogram::BucketOf(32) == 32 && Histogram::BucketOf(33) == 32);
+  CHECK(Histogram::BucketOf(63) == 47 && Histogram::BucketOf(64) == 48);
+  CHECK(Histogram::LowerBound(48) == 64);
+  // Every bucket starts where the previous one ended, past the exact ones at most a sixteenth
+  // further.
+  for (std::size_t i = 1; i < 60 * Histogram::SubBuckets; ++i) {
+    auto lower = Histogram::LowerBound(i);
+    CHECK(Histogram::BucketOf(lower) == i && Histogram::BucketOf(lower - 1) == i - 1);
+    CHECK(i <= 32 || (lower - Histogram::LowerBound(i - 1)) * 16 <= lower);
+  }
+  CHECK(Histogram::BucketOf(~std::uint64_t{0}) < 64 * Histogram::SubBuckets);
+}
+
+void computesPercentiles() {
+  Histogram histogram;
+  CHECK(histogram.Percentile(0.5) == microseconds{0});
+  for (int ms = 1; ms <= 100; ++ms) {
+    histogram.Record(microseconds{ms * 1000});
+  }
+  CHECK(histogram.Count() == 100);
+  CHECK(histogram.Min() == microseconds{1000} && histogram.Max() == microseconds{100000});
+  CHECK(histogram.Sum() == microseconds{5050 * 1000});
+  auto p50 = histogram.Percentile(0.5).count();
+  CHECK(p50 >= 50000 && p50 <= 50000 + 50000 / 16);
+  auto p99 = histogram.Percentile(0.99).count();
+  CHECK(p99 >= 99000 && p99 <= 100000);
+  CHECK(histogram.Percentile(1) == microseconds{100000});
+  auto p0 = histogram.Percentile(0).count();
+  CHECK(p0 >= 1000 && p0 <= 1000 + 1000 / 16);
+
+  Histogram single;
+  single.Record(microseconds{12345});
+  CHECK(single.Percentile(0.5) == microseconds{12345});
+}
+
+void mergesHistograms() {
+  Histogram a, b, both;
+  a.Record(microseconds{10});
+  b.Record(microseconds{5000});
+  b.Record(microseconds{7});
+  both.Record(microseconds{10});
+  both.Record(microseconds{5000});
+  both.Record(microseconds{7});
+  a.Merge(b);
+  CHECK(a.Count() == 3 && a.Min() == microseconds{7} && a.Max() == microseconds{5000});
+  CHECK(a.Buckets() == both.Buckets());
+
+  Histogram empty;
+  empty.Merge(Histogram{});
+  CHECK(empty.Count() == 0 && empty.Min() == microseconds{0});
+}
+
+void roundTripsTheStore() {
+  LaunchStats::Store store;
+  store.Record("1.2.3.0", "WslLaunch", microseconds{84000});
+  store.Record("1.2.3.0", "WslLaunch", microseconds{91000});
+  store.Record("1.2.3.0", "Install::Register", microseconds{3});
+  store.Record("unpackaged", "Broker request", microseconds{120});
+  auto parsed = LaunchStats::Store::Parse(store.Format());
+  CHECK(parsed && parsed->Format() == store.Format());
+  CHECK(parsed->Histograms().size() == 3);
+  CHECK(parsed->Histograms().count({"unpackaged", "Broker_request"}) == 1);
+  const auto& launch = parsed->Histograms().at({"1.2.3.0", "WslLaunch"});
+  CHECK(launch.Count() == 2 && launch.Max() == microseconds{91000});
+
+  CHECK(LaunchStats::Store::Parse("# nothing yet\n\n") && LaunchStats::Store::Parse("")->Empty());
+  CHECK(!LaunchStats::Store::Parse("1.0 phase 2 10 5 5 5:1\n"));
+  CHECK(!LaunchStats::Store::Parse("1.0 phase 1 5 5 5 5\n"));
+  CHECK(!LaunchStats::Store::Parse("1.0 phase x 5 5 5 5:1\n"));
+  CHECK(!LaunchStats::Store::Parse("1.0 phase 1 5 5 5 99999:1\n"));
+}
+
+void appendsAcrossRuns() {
+  TemporaryDirectory directory;
+  const auto path = directory.path / "stats" / "LaunchStats.txt";
+  CHECK(LaunchStats::Load(path) && LaunchStats::Load(path)->Empty());
+
+  LaunchStats::Store first;
+  first.Record("1.0", "WslLaunch", microseconds{1000});
+  CHECK(LaunchStats::Append(path, first));
+  LaunchStats::Store second;
+  second.Record("1.0", "WslLaunch", microseconds{2000});
+  second.Record("2.0", "WslLaunch", microseconds{500});
+  CHECK(LaunchStats::Append(path, second));
+
+  auto loaded = LaunchStats::Load(path);
+  CHECK(loaded && loaded->Histograms().size() == 2);
+  CHECK(loaded->Histograms().at({"1.0", "WslLaunch"}).Count() == 2);
+  CHECK(!fs::exists(path.string() + ".new"));
+
+  // A store which can't be read is started anew.
+  std::ofstream{path, std::ios::trunc} << "garbage\n";
+  CHECK(!LaunchStats::Load(path));
+  CHECK(LaunchStats::Append(path, first));
+  CHECK(LaunchStats::Load(path)->Histograms().at({"1.0", "WslLaunch"}).Count() == 1);
+}
+
+void reportsPercentiles() {
+  LaunchStats::Store store;
+  store.Record("1.0", "WslLaunch", microseconds{250000});
+  store.Record("2.0", "WslLaunch", microseconds{80000});
+  auto report = LaunchStats::Report(store);
+  CHECK(report.find("1.0\n") == 0);
+  CHECK(report.find("\n2.0\n") != std::string::npos);
+  CHECK(report.find("250.0") != std::string::npos && report.find("80.0") != std::string::npos);
+  CHECK(LaunchStats::Report({}).empty());
+}
+
+void exportsPrometheus() {
+  LaunchStats::Store store;
+  store.Record("1.0", "WslLaunch", microseconds{10});
+  store.Record("1.0", "WslLaunch", microseconds{1500000});
+  store.Record("1\"0", "x", microseconds{1});
+  auto text = LaunchStats::ToPrometheus(store);
+  CHECK(text.find("# TYPE ubuntu_launcher_phase_duration_seconds histogram\n") !=
+        std::string::npos);
+  const std::string labels = "{version=\"1.0\",phase=\"WslLaunch\"";
+  CHECK(text.find("ubuntu_launcher_phase_duration_seconds_bucket" + labels +
+                  ",le=\"0.000010\"} 1\n") != std::string::npos);
+  CHECK(text.find("ubuntu_launcher_phase_duration_seconds_bucket" + labels +
+                  ",le=\"+Inf\"} 2\n") != std::string::npos);
+  CHECK(text.find("ubuntu_launcher_phase_duration_seconds_sum" + labels + "} 1.500010\n") !=
+        std::string::npos);
+  CHECK(text.find("ubuntu_launcher_phase_duration_seconds_count" + labels + "} 2\n") !=
+        std::string::npos);
+  CHECK(text.find("version=\"1\\\"0\"") != std::string::npos);
+
+  TemporaryDirectory directory;
+  CHECK(LaunchStats::WritePrometheus(directory.path / "launcher.prom", store));
+  std::ifstream file{directory.path / "launcher.prom", std::ios::binary};
+  CHECK(std::string(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}) == text);
+}
+
+void sessionRecordsSpans() {
+  TemporaryDirectory directory;
+  const auto path = directory.path / "LaunchStats.txt";
+  {
+    LaunchStats::Session session{path, "1.0"};
+    Trace::Span whole{"wmain"};
+    { Trace::Span span{"WslLaunch"}; }
+    std::thread{[] { Trace::Span span{"WslLaunch"}; }}.join();
+    LaunchStats::Record("UntilSession", std::chrono::milliseconds{40});
+  }
+  { Trace::Span span{"WslLaunch"}; }
+  LaunchStats::Record("UntilSession", std::chrono::milliseconds{40});
+  auto loaded = LaunchStats::Load(path);
+  CHECK(loaded && loaded->Histograms().size() == 2);
+  CHECK(loaded->Histograms().at({"1.0", "WslLaunch"}).Count() == 2);
+  CHECK(loaded->Histograms().at({"1.0", "UntilSession"}).Max() == microseconds{40000});
+
+  { LaunchStats::Session session{{}, "1.0"}; }
+  TemporaryDirectory none;
+  { LaunchStats::Session session{none.path / "LaunchStats.txt", "1.0"}; }
+  CHECK(!fs::exists(none.path / "LaunchStats.txt"));
+}
+}  // namespace
+
+int main() {
+  RUN(bucketsStayWithinASixteenth);
+  RUN(computesPercentiles);
+  RUN(mergesHistograms);
+  RUN(roundTripsTheStore);
+  RUN(appendsAcrossRuns);
+  RUN(reportsPercentiles);
+  RUN(exportsPrometheus);
+  RUN(sessionRecordsSpans);
+  return TEST_EXIT_CODE();
+}
@@ -0,0 +1,74 @@
+# Writes GzipFixtures.h, the gzip streams GzipTests inflates, compressed by zlib through Python so
+# that the inflater is checked against another implementation:
+#   python3 MakeGzipFixtures.py > GzipFixtures.h
+# The contents are those of fixtureContents() in GzipTests.cpp, which must be kept in sync.
+
+import gzip
+import io
+import zlib
+
+WORDS = ["ubuntu", "launcher", "distribution", "install", "image", "tar", "root", "user",
+         "wsl", "cloud-init", "deflate", "huffman"]
+
+
+def contents():
+    out = bytearray()
+    state = 12345
+    for i in range(120):
+        out += b"%05d %s %s " % (i, WORDS[(i * 7) % len(WORDS)].encode(),
+                                 WORDS[(i * 13 + 5) % len(WORDS)].encode())
+        # A couple of bytes nothing repeats, so that literals of every value come up.
+        for _ in range(2):
+            state = (state * 1103515245 + 12345) & 0xFFFFFFFF
+            out.append(state >> 24)
+        out += b"\n"
+    # A match as far back as most of the window this spans.
+    return bytes(out + out[:800])
+
+
+def deflate(data, level, strategy=zlib.Z_DEFAULT_STRATEGY):
+    compressor = zlib.compressobj(level, zlib.DEFLATED, -15, 9, strategy)
+    return compressor.compress(data) + compressor.flush()
+
+
+def member(data, level, strategy=zlib.Z_DEFAULT_STRATEGY):
+    # No name nor time, so that the fixtures don't change from a run to the next.
+    header = bytes([0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 255])
+    trailer = zlib.crc32(data).to_bytes(4, "little") + (len(data) & 0xFFFFFFFF).to_bytes(4, "little")
+    return header + deflate(data, level, strategy) + trailer
+
+
+def named(data):
+    buffer = io.BytesIO()
+    with gzip.GzipFile(filename="install.tar", mode="wb", fileobj=buffer, mtime=0) as file:
+        file.write(data)
+    return buffer.getvalue()
+
+
+def array(name, data):
+    lines = ["inline constexpr unsigned char %s[] = {" % name]
+    for start in range(0, len(data), 16):
+        lines.append("    " + ", ".join("0x%02x" % b for b in data[start:start + 16]) + ",")
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def main():
+    data = contents()
+    fixtures = [
+        ("Fixed", member(data, 6, zlib.Z_FIXED)),
+        ("Level1", member(data, 1)),
+        ("Level6", member(data, 6)),
+        ("Level9", member(data, 9)),
+        ("Named", named(data[:100])),
+    ]
+    print("#pragma once\n")
+    print("// Generated by MakeGzipFixtures.py with zlib %s, don't edit.\n" % zlib.ZLIB_VERSION)
+    print("namespace Ubuntu::Testing::GzipFixtures {")
+    print("inline constexpr unsigned long ContentsSize = %d;" % len(data))
+    print("inline constexpr unsigned long ContentsCrc32 = 0x%08x;\n" % zlib.crc32(data))
+    print("\n\n".join(array(name, fixture) for name, fixture in fixtures))
+    print("}  // namespace Ubuntu::Testing::GzipFixtures")
+
+
+main()
@@ -0,0 +1,53 @@
+#include "AllocationCounter.h"
+#include "../MessageCatalog.h"
+#include "../Messages.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace Messages = Ubuntu::Messages;
+using namespace Ubuntu::Messages::Catalog;
+using Ubuntu::Testing::AllocationsOf;
+
+namespace {
+// Defeats the optimizer.
+volatile std::size_t sink = 0;
+
+void count(void*, std::wstring_view text) { sink = sink + text.size(); }
+
+// The way messages were printed before the catalog, FormatMessageW left aside as it isn't on
+// Linux: the message allocated, then copied into a string before being printed.
+void formatAllocating(std::uint32_t bytes, std::uint32_t milliseconds, std::uint32_t speed) {
+  std::wstring buffer = L"Verified the installation image: " + std::to_wstring(bytes) + L" MB in " +
+                        std::to_wstring(milliseconds) + L" ms (" + std::to_wstring(speed) +
+                        L" MB/s).\r\n";
+  std::wstring message = buffer.c_str();
+  count(nullptr, message);
+}
+
+template <typename F>
+void report(const char* step, F&& f) {
+  constexpr int runs = 1'000'000;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < runs; ++i) {
+    f();
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  std::printf("%-22s %12.1f %14zu\n", step, elapsed.count() / runs, AllocationsOf(f));
+}
+}  // namespace
+
+int main() {
+  std::printf("%-22s %12s %14s\n", "message", "ns/message", "allocs/message");
+  report("allocating", [] { formatAllocating(512, 1234, 415); });
+  report("catalog", [] {
+    Messages::Output out{count, nullptr};
+    Messages::Format(MSG_INSTALL_IMAGE_VERIFIED, out, 512, 1234, 415);
+  });
+  report("catalog usage", [] {
+    Messages::Output out{count, nullptr};
+    Messages::Format(MSG_USAGE, out);
+  });
+  return 0;
+}
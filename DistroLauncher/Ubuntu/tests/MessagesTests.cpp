@@ -0,0 +1,86 @@
+#include "Check.h"
+#include "../MessageCatalog.h"
+#include "../Messages.h"
+
+#include <string>
+#include <vector>
+
+namespace Messages = Ubuntu::Messages;
+using namespace Ubuntu::Messages::Catalog;
+
+namespace {
+// Collects what an Output flushes, one entry per flush.
+struct Console {
+  std::vector<std::wstring> writes;
+
+  static void write(void* context, std::wstring_view text) {
+    static_cast<Console*>(context)->writes.emplace_back(text);
+  }
+
+  std::wstring text() const {
+    std::wstring all;
+    for (const auto& write : writes) {
+      all += write;
+    }
+    return all;
+  }
+};
+
+template <typename... Inserts>
+Console print(const Messages::Message<Inserts...>& message,
+              typename Inserts::Type... arguments) {
+  Console console;
+  {
+    Messages::Output out{Console::write, &console};
+    Messages::Format(message, out, arguments...);
+  }
+  return console;
+}
+
+void formatsInserts() {
+  CHECK(print(MSG_ERROR_CODE, 0x80070002, L"The system cannot find the file specified.").text() ==
+        L"Error: 0x80070002 The system cannot find the file specified.\n");
+  CHECK(print(MSG_INSTALL_IMAGE_VERIFIED, 512, 0, 4294967295u).text() ==
+        L"Verified the installation image: 512 MB in 0 ms (4294967295 MB/s).\n");
+  CHECK(print(MSG_PARALLEL_JOB_FAILED, 3, 8, L"make", L"exited with 2").text() ==
+        L"[3/8] failed: make: exited with 2\n");
+
+  // Narrow strings are UTF-8, whatever the width of wchar_t.
+  CHECK(print(MSG_STATUS_ENVIRONMENT_VARIABLE, "LANG=\xc3\xa9\xf0\x9f\x90\xa7").text() ==
+        (sizeof(wchar_t) == 2 ? std::wstring{L"    LANG=\u00e9\xd83d\xdc27\n"}
+                              : std::wstring{L"    LANG=\u00e9\U0001f427\n"}));
+}
+
+void compilesTheText() {
+  CHECK(MSG_WSL_REGISTER_DISTRIBUTION_FAILED.id == 1001);
+  auto usage = print(MSG_USAGE).text();
+  CHECK(usage.find(L"Launches or configures a Linux distribution.\n\nUsage: \n") == 0);
+  // %% escapes a percent sign.
+  CHECK(usage.find(L"%LOCALAPPDATA%") != std::wstring::npos);
+  CHECK(usage.find(L"%%") == std::wstring::npos);
+  CHECK(usage.back() == L'\n');
+}
+
+void writesOncePerMessage() {
+  CHECK(print(MSG_USAGE).writes.size() == 1);
+  CHECK(print(MSG_INSTALL_SUCCESS).writes.size() == 1);
+
+  // Beyond the buffer, as it fills up.
+  Console console;
+  {
+    Messages::Output out{Console::write, &console};
+    out.Append(std::wstring(2 * Messages::Output::Capacity + 1, L'x'));
+    out.Append(L'y');
+  }
+  CHECK(console.writes.size() == 3);
+  CHECK(console.writes[0].size() == Messages::Output::Capacity);
+  CHECK(console.writes[2] == L"xy");
+}
+}  // namespace
+
+int main() {
+  RUN(formatsInserts);
+  RUN(compilesTheText);
+  RUN(writesOncePerMessage);
+  return TEST_EXIT_CODE();
+}
@@ -0,0 +1,93 @@
+#include "Check.h"
+#include "../NssQuery.h"
+
+#include <string>
+#include <vector>
+
+using Ubuntu::DefaultUserSearch;
+using Ubuntu::NssQuery;
+using Ubuntu::PlanNssQueries;
+
+namespace {
+std::vector<NssQuery::Kind> kinds(const std::vector<NssQuery>& plan) {
+  std::vector<NssQuery::Kind> result;
+  for (const auto& query : plan) {
+    result.push_back(query.kind);
+  }
+  return result;
+}
+
+void looksUpTheNamedUser() {
+  const std::string ldap = "passwd: files ldap\n";
+  for (const std::string* nsswitch : {static_cast<const std::string*>(nullptr), &ldap}) {
+    auto plan = PlanNssQueries("ubuntu", nsswitch);
+    CHECK((kinds(plan) == std::vector{NssQuery::Kind::PointLookup, NssQuery::Kind::Enumeration}));
+    CHECK(plan[0].Command() == "getent passwd 'ubuntu'");
+    CHECK(plan[1].Command() == "getent passwd");
+  }
+}
+
+void enumeratesLocalDatabases() {
+  std::string local = "passwd: files systemd\n";
+  CHECK((kinds(PlanNssQueries("", nullptr)) == std::vector{NssQuery::Kind::Enumeration}));
+  CHECK((kinds(PlanNssQueries("", &local)) == std::vector{NssQuery::Kind::Enumeration}));
+}
+
+void probesRemoteDatabases() {
+  std::string sss = "passwd: files sss\n";
+  auto plan = PlanNssQueries("", &sss);
+  CHECK((kinds(plan) == std::vector{NssQuery::Kind::UidRangeProbe, NssQuery::Kind::Enumeration}));
+  CHECK(plan[0].firstUid == DefaultUserSearch::FirstRegularUid);
+  CHECK(plan[0].lastUid - plan[0].firstUid + 1 == Ubuntu::UidProbeSize);
+  auto command = plan[0].Command();
+  CHECK(command.rfind("getent passwd 1000 1001 1002 ", 0) == 0);
+  CHECK(command.size() > 1063 - 1000 && command.substr(command.size() - 5) == " 1063");
+}
+
+void quotesNames() {
+  NssQuery query{NssQuery::Kind::PointLookup, "a'b; rm -rf /"};
+  CHECK(query.Command() == "getent passwd 'a'\\''b; rm -rf /'");
+}
+
+void tellsConclusiveOutcomes() {
+  NssQuery lookup{NssQuery::Kind::PointLookup, "u"};
+  DefaultUserSearch missing{"u"};
+  missing.Feed("v:x:1000:1000::/home/v:/bin/sh\n");
+  CHECK(!lookup.IsConclusive(missing));
+  DefaultUserSearch found{"u"};
+  found.Feed("u:x:1000:1000::/home/u:/bin/sh\n");
+  CHECK(lookup.IsConclusive(found));
+
+  NssQuery probe{NssQuery::Kind::UidRangeProbe, {}, 1000, 1063};
+  DefaultUserSearch noLogin;
+  noLogin.Feed("svc:x:1001:1001::/:/usr/sbin/nologin\n");
+  CHECK(!probe.IsConclusive(noLogin));
+  DefaultUserSearch regular;
+  regular.Feed("u:x:1042:1042::/home/u:/bin/bash\n");
+  CHECK(probe.IsConclusive(regular));
+  // A probe missing the lowest UIDs can't rule out a lower one.
+  NssQuery partial{NssQuery::Kind::UidRangeProbe, {}, 1040, 1063};
+  CHECK(!partial.IsConclusive(regular));
+
+  CHECK(NssQuery{}.IsConclusive(DefaultUserSearch{}));
+}
+
+void formatsRecords() {
+  using namespace std::chrono_literals;
+  auto text = Ubuntu::FormatNssQueryRecords({{NssQuery::Kind::UidRangeProbe, 1500us, 0, false},
+                                             {NssQuery::Kind::Enumeration, 2s, 3, true}});
+  CHECK(text ==
+        "UID range probe: 1 ms, 0 user(s), inconclusive\n"
+        "enumeration: 2000 ms, 3 user(s), conclusive\n");
+}
+}  // namespace
+
+int main() {
+  RUN(looksUpTheNamedUser);
+  RUN(enumeratesLocalDatabases);
+  RUN(probesRemoteDatabases);
+  RUN(quotesNames);
+  RUN(tellsConclusiveOutcomes);
+  RUN(formatsRecords);
+  return TEST_EXIT_CODE();
+}
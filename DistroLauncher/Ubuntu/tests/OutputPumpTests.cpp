@@ -0,0 +1,219 @@
+#include "Check.h"
+#include "../OutputPump.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <csignal>
+#include <cstdint>
+#include <string>
+
+using Ubuntu::ChunkedBuffer;
+using Ubuntu::OutputPump;
+
+namespace {
+void chunkedBufferKeepsEverything() {
+  ChunkedBuffer buffer;
+  std::string expected;
+  for (std::size_t i = 0; i < 3 * ChunkedBuffer::ChunkSize; i += 1000) {
+    std::string piece(1000, static_cast<char>('a' + i % 26));
+    CHECK(buffer.Append(piece));
+    expected += piece;
+  }
+  CHECK(buffer.size() == expected.size());
+  CHECK(!buffer.Overflowed());
+  CHECK(buffer.str() == expected);
+}
+
+void chunkedBufferStopsAtTheCeiling() {
+  ChunkedBuffer buffer{10};
+  CHECK(buffer.Append("12345"));
+  CHECK(!buffer.Append("67890abc"));
+  CHECK(buffer.Overflowed());
+  CHECK(buffer.str() == "1234567890");
+  // Nothing else gets in, even if it would fit.
+  CHECK(!buffer.Append(""));
+  CHECK(buffer.size() == 10);
+}
+
+void chunkedBufferHandlesExactChunks() {
+  ChunkedBuffer buffer;
+  std::string chunk(ChunkedBuffer::ChunkSize, 'x');
+  CHECK(buffer.Append(chunk));
+  CHECK(buffer.Append(chunk));
+  CHECK(buffer.Append("y"));
+  CHECK(buffer.size() == 2 * ChunkedBuffer::ChunkSize + 1);
+  CHECK(buffer.str() == chunk + chunk + "y");
+}
+
+// The byte expected at [offset] of the stream generated by [writeStream].
+char patternAt(std::uint64_t offset, char salt) {
+  return static_cast<char>((offset * 31 + salt) % 251);
+}
+
+// Writes [size] bytes of a pattern to [fd] in small, unaligned writes.
+void writeStream(int fd, std::uint64_t size, char salt, std::uint64_t& written) {
+  char buffer[3000];
+  std::size_t n = 0;
+  for (; n < sizeof(buffer) && written < size; ++n, ++written) {
+    buffer[n] = patternAt(written, salt);
+  }
+  for (std::size_t done = 0; done < n;) {
+    auto w = write(fd, buffer + done, n - done);
+    if (w <= 0) {
+      _exit(2);
+    }
+    done += static_cast<std::size_t>(w);
+  }
+}
+
+bool matchesPattern(const std::string& data, char salt) {
+  for (std::uint64_t i = 0; i < data.size(); ++i) {
+    if (data[i] != patternAt(i, salt)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Ubuntu::ReadFunction readFrom(int fd) {
+  return [fd](char* buffer, std::size_t size) -> std::size_t {
+    auto n = read(fd, buffer, size);
+    return n > 0 ? static_cast<std::size_t>(n) : 0;
+  };
+}
+
+// Spawns a child writing [outSize] and [errSize] bytes interleaved on two pipes, which would
+// deadlock if both weren't drained concurrently, and pumps them with the given [ceiling].
+void pumpChild(std::uint64_t outSize, std::uint64_t errSize, std::size_t ceiling,
+               std::string& out, std::string& err, bool& outOverflowed, bool& errOverflowed) {
+  int outPipe[2];
+  int errPipe[2];
+  CHECK(pipe(outPipe) == 0);
+  CHECK(pipe(errPipe) == 0);
+
+  pid_t child = fork();
+  if (child == 0) {
+    close(outPipe[0]);
+    close(errPipe[0]);
+    std::uint64_t outWritten = 0;
+    std::uint64_t errWritten = 0;
+    while (outWritten < outSize || errWritten < errSize) {
+      writeStream(outPipe[1], outSize, 'o', outWritten);
+      writeStream(errPipe[1], errSize, 'e', errWritten);
+    }
+    _exit(0);
+  }
+  close(outPipe[1]);
+  close(errPipe[1]);
+
+  {
+    OutputPump outPump{readFrom(outPipe[0]), ceiling};
+    OutputPump errPump{readFrom(errPipe[0]), ceiling};
+    outPump.Join();
+    errPump.Join();
+    out = outPump.Output().str();
+    err = errPump.Output().str();
+    outOverflowed = outPump.Output().Overflowed();
+    errOverflowed = errPump.Output().Overflowed();
+  }
+
+  int status = -1;
+  waitpid(child, &status, 0);
+  CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  close(outPipe[0]);
+  close(errPipe[0]);
+}
+
+void pumpsMegabytesFromBothStreams() {
+  constexpr std::uint64_t outSize = 48 * 1024 * 1024;
+  constexpr std::uint64_t errSize = 16 * 1024 * 1024 + 17;
+  std::string out;
+  std::string err;
+  bool outOverflowed = true;
+  bool errOverflowed = true;
+  pumpChild(outSize, errSize, 64 * 1024 * 1024, out, err, outOverflowed, errOverflowed);
+  CHECK(out.size() == outSize);
+  CHECK(err.size() == errSize);
+  CHECK(!outOverflowed);
+  CHECK(!errOverflowed);
+  CHECK(matchesPattern(out, 'o'));
+  CHECK(matchesPattern(err, 'e'));
+}
+
+void keepsDrainingPastTheCeiling() {
+  // The child must still be able to finish writing.
+  std::string out;
+  std::string err;
+  bool outOverflowed = false;
+  bool errOverflowed = true;
+  pumpChild(8 * 1024 * 1024, 1024, 1024 * 1024, out, err, outOverflowed, errOverflowed);
+  CHECK(outOverflowed);
+  CHECK(out.size() == 1024 * 1024);
+  CHECK(matchesPattern(out, 'o'));
+  CHECK(!errOverflowed);
+  CHECK(err.size() == 1024);
+}
+void consumerStopsThePump() {
+  int fds[2];
+  CHECK(pipe(fds) == 0);
+  pid_t child = fork();
+  if (child == 0) {
+    close(fds[0]);
+    // Would never end if read to the end.
+    std::uint64_t written = 0;
+    for (;;) {
+      writeStream(fds[1], UINT64_MAX, 'c', written);
+    }
+  }
+  close(fds[1]);
+
+  std::string received;
+  {
+    OutputPump pump{readFrom(fds[0]), [&received](std::string_view data) {
+                      received.append(data);
+                      return received.size() < 1024 * 1024;
+                    }};
+    pump.Join();
+    CHECK(pump.Stopped());
+    CHECK(pump.Output().empty());
+  }
+  CHECK(received.size() >= 1024 * 1024);
+  CHECK(matchesPattern(received, 'c'));
+
+  // Nobody reads anymore, as WslProcess would terminate the writer.
+  kill(child, SIGKILL);
+  waitpid(child, nullptr, 0);
+  close(fds[0]);
+}
+
+void consumerSeesEverythingUntilTheEnd() {
+  int fds[2];
+  CHECK(pipe(fds) == 0);
+  const std::string sent = "root:x:0:0:root:/root:/bin/bash\n";
+  CHECK(write(fds[1], sent.data(), sent.size()) == static_cast<ssize_t>(sent.size()));
+  close(fds[1]);
+  std::string received;
+  OutputPump pump{readFrom(fds[0]), [&received](std::string_view data) {
+                    received.append(data);
+                    return true;
+                  }};
+  pump.Join();
+  CHECK(!pump.Stopped());
+  CHECK(received == sent);
+  close(fds[0]);
+}
+}  // namespace
+
+int main() {
+  // A deadlock fails the test instead of hanging it.
+  alarm(60);
+  RUN(chunkedBufferKeepsEverything);
+  RUN(chunkedBufferStopsAtTheCeiling);
+  RUN(chunkedBufferHandlesExactChunks);
+  RUN(pumpsMegabytesFromBothStreams);
+  RUN(keepsDrainingPastTheCeiling);
+  RUN(consumerStopsThePump);
+  RUN(consumerSeesEverythingUntilTheEnd);
+  return TEST_EXIT_CODE();
+}
@@ -0,0 +1,113 @@
+#include "Check.h"
+#include "Host.h"
+#include "SimulatedWsl.h"
+#include "../Parallel.h"
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Parallel = Ubuntu::Parallel;
+using Ubuntu::Testing::Latency;
+using Ubuntu::Testing::HostSession;
+using Ubuntu::Testing::SimulatedWsl;
+using namespace std::chrono_literals;
+
+namespace {
+void splitsLines() {
+  const std::string output = "first\nsecond line\n\nlast";
+  // However it is chunked.
+  for (std::size_t size : {1, 2, 5, 100}) {
+    std::vector<std::string> lines;
+    Parallel::LineSplitter splitter{[&](std::string_view line) { lines.emplace_back(line); }};
+    for (std::size_t offset = 0; offset < output.size(); offset += size) {
+      splitter.Feed(std::string_view{output}.substr(offset, size));
+    }
+    CHECK(lines.size() == 3);
+    splitter.Finish();
+    CHECK(lines == (std::vector<std::string>{"first", "second line", "", "last"}));
+  }
+
+  std::vector<std::size_t> sizes;
+  Parallel::LineSplitter splitter{[&](std::string_view line) { sizes.push_back(line.size()); }};
+  splitter.Feed(std::string(Parallel::LineSplitter::MaxLineSize + 10, 'x'));
+  splitter.Feed("\n");
+  splitter.Finish();
+  CHECK(sizes == (std::vector<std::size_t>{Parallel::LineSplitter::MaxLineSize, 10}));
+}
+
+void runsEveryCommand() {
+  SimulatedWsl wsl{{}};
+  wsl.SetSessionFixture(HostSession::Start);
+  const std::vector<std::string> commands{"echo a; echo b", "echo oops >&2; exit 3", "printf c",
+                                          "true"};
+  std::map<std::size_t, std::vector<std::string>> lines;
+  std::vector<std::size_t> finished;
+  auto result = Parallel::Run(
+      wsl, commands, {2},
+      [&](std::size_t index, std::string_view line) { lines[index].emplace_back(line); },
+      [&](const Parallel::JobResult& job) { finished.push_back(job.index); });
+
+  CHECK(wsl.Commands().size() == 4);
+  CHECK(finished.size() == 4);
+  CHECK(result.jobs.size() == 4);
+  for (std::size_t i = 0; i < result.jobs.size(); ++i) {
+    CHECK(result.jobs[i].index == i);
+    CHECK(result.jobs[i].error.empty());
+  }
+  CHECK(result.jobs[0].Succeeded() && result.jobs[2].Succeeded() && result.jobs[3].Succeeded());
+  CHECK(result.jobs[1].exitCode == 3UL);
+  CHECK(result.ExitCode() == 3);
+  CHECK(lines[0] == (std::vector<std::string>{"a", "b"}));
+  CHECK(lines[1] == (std::vector<std::string>{"oops"}));
+  CHECK(lines[2] == (std::vector<std::string>{"c"}));
+  CHECK(lines.count(3) == 0);
+}
+
+void runsConcurrently() {
+  Latency latency;
+  latency.launch = 200ms;
+  SimulatedWsl wsl{{}, latency};
+  wsl.SetSessionFixture(HostSession::Start);
+  const std::vector<std::string> commands(4, "true");
+  auto start = std::chrono::steady_clock::now();
+  auto result = Parallel::Run(wsl, commands, {4}, [](std::size_t, std::string_view) {}, {});
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  CHECK(result.ExitCode() == 0);
+  // Four launches one after the other would take 800ms.
+  CHECK(elapsed < 600ms);
+
+  // More jobs than commands.
+  CHECK(Parallel::Run(wsl, {"true"}, {8}, [](std::size_t, std::string_view) {}, {}).jobs.size() ==
+        1);
+  CHECK(Parallel::Run(wsl, {}, {8}, [](std::size_t, std::string_view) {}, {}).jobs.empty());
+}
+
+void reportsSessionFailures() {
+  SimulatedWsl wsl{{}};
+  // The first launch fails.
+  bool launched = false;
+  wsl.SetSessionFixture([&launched](std::string_view command, Ubuntu::ConsumeFunction consume)
+                            -> std::unique_ptr<Ubuntu::WslBackend::Session> {
+    if (!std::exchange(launched, true)) {
+      return nullptr;
+    }
+    return HostSession::Start(command, std::move(consume));
+  });
+  auto result = Parallel::Run(wsl, {"broken", "echo fine"}, {1},
+                              [](std::size_t, std::string_view) {}, {});
+  CHECK(!result.jobs[0].exitCode && !result.jobs[0].error.empty());
+  CHECK(result.jobs[1].Succeeded());
+  CHECK(result.ExitCode() == 1);
+}
+}  // namespace
+
+int main() {
+  RUN(splitsLines);
+  RUN(runsEveryCommand);
+  RUN(runsConcurrently);
+  RUN(reportsSessionFailures);
+  return TEST_EXIT_CODE();
+}
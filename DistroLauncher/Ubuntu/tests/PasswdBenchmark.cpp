@@ -0,0 +1,112 @@
+#include "AllocationCounter.h"
+#include "../DelimiterScanner.h"
+#include "../Passwd.h"
+#include "../SplitView.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using Ubuntu::ScanKernel;
+using Ubuntu::UserEntry;
+using Ubuntu::Testing::AllocationsOf;
+
+namespace {
+// Looks like the output of `getent passwd` against a directory of [entries] users.
+std::string syntheticPasswd(std::size_t entries) {
+  std::string contents =
+      "root:x:0:0:root:/root:/bin/bash\n"
+      "daemon:x:1:1:daemon:/usr/sbin:/usr/sbin/nologin\n";
+  for (std::size_t i = 2; i < entries; ++i) {
+    auto uid = std::to_string(100'000 + i);
+    contents += "user" + uid + ":x:" + uid + ":" + uid + ":Some User,,,:/home/user" + uid +
+                (i % 10 == 0 ? ":/usr/sbin/nologin\n" : ":/bin/bash\n");
+  }
+  return contents;
+}
+
+// The way it was parsed before the scanner, for comparison.
+std::vector<UserEntry> parseWithSplitView(std::string_view contents) {
+  std::vector<UserEntry> users;
+  for (auto line : Ubuntu::SplitView{contents, '\n'}) {
+    if (auto user = Ubuntu::UserEntryFromString(line); user) {
+      users.push_back(std::move(user.value()));
+    }
+  }
+  std::stable_sort(users.begin(), users.end(),
+                   [](const UserEntry& a, const UserEntry& b) { return a.uid < b.uid; });
+  return users;
+}
+
+// Streams [contents] through a search for the first regular user, as pipes deliver it.
+std::size_t searchDefaultUser(std::string_view contents) {
+  constexpr std::size_t chunkSize = 64 * 1024;
+  Ubuntu::DefaultUserSearch search{{}};
+  for (std::size_t i = 0; i < contents.size(); i += chunkSize) {
+    if (!search.Feed(contents.substr(i, chunkSize))) {
+      break;
+    }
+  }
+  search.Finish();
+  return search.UsersSeen();
+}
+
+template <typename F>
+double nanosecondsPerRun(int runs, F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < runs; ++i) {
+    f();
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / runs;
+}
+
+// Defeats the optimizer.
+volatile std::size_t sink = 0;
+
+const char* kernelName(ScanKernel kernel) {
+  switch (kernel) {
+    case ScanKernel::Sse2:
+      return "scan sse2";
+    case ScanKernel::Avx2:
+      return "scan avx2";
+    default:
+      return "scan scalar";
+  }
+}
+
+template <typename F>
+void report(const char* step, std::size_t entries, F&& f) {
+  // About as many lines parsed whatever the size.
+  int runs = static_cast<int>(std::max<std::size_t>(5, 2'000'000 / entries));
+  double ns = nanosecondsPerRun(runs, f);
+  auto allocations = AllocationsOf(f);
+  std::printf("%-10zu %-14s %10.1f %14zu\n", entries, step, ns / entries, allocations);
+}
+}  // namespace
+
+int main() {
+  std::printf("%-10s %-14s %10s %14s\n", "entries", "step", "ns/line", "allocs/parse");
+  for (std::size_t entries : {1'000, 10'000, 100'000, 1'000'000}) {
+    const auto contents = syntheticPasswd(entries);
+
+    std::vector<std::uint32_t> positions;
+    for (auto kernel : {ScanKernel::Scalar, ScanKernel::Sse2, ScanKernel::Avx2}) {
+      if (!Ubuntu::IsSupported(kernel)) {
+        continue;
+      }
+      report(kernelName(kernel), entries, [&] {
+        positions.clear();
+        Ubuntu::ScanDelimiters(kernel, contents, positions);
+        sink = sink + positions.size();
+      });
+    }
+
+    report("splitview", entries, [&] { sink = sink + parseWithSplitView(contents).size(); });
+    report("parse", entries, [&] { sink = sink + Ubuntu::ParsePasswd(contents).size(); });
+    report("default user", entries, [&] { sink = sink + searchDefaultUser(contents); });
+  }
+  return 0;
+}
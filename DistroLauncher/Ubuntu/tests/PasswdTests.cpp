@@ -0,0 +1,291 @@
+#include "Check.h"
+#include "../DelimiterScanner.h"
+#include "../Passwd.h"
+#include "../SplitView.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+using Ubuntu::ParsePasswd;
+using Ubuntu::ScanKernel;
+using Ubuntu::UserEntry;
+
+namespace Ubuntu {
+bool operator==(const UserEntry& a, const UserEntry& b) {
+  return a.name == b.name && a.uid == b.uid && a.hasLogin == b.hasLogin;
+}
+}  // namespace Ubuntu
+
+namespace {
+// What ParsePasswd did before the scanner: split by lines, then by fields, with SplitView.
+std::vector<UserEntry> parseWithSplitView(std::string_view contents) {
+  std::vector<UserEntry> users;
+  for (auto line : Ubuntu::SplitView{contents, '\n'}) {
+    if (auto user = Ubuntu::UserEntryFromString(line); user) {
+      users.push_back(std::move(user.value()));
+    }
+  }
+  std::stable_sort(users.begin(), users.end(),
+                   [](const UserEntry& a, const UserEntry& b) { return a.uid < b.uid; });
+  return users;
+}
+
+std::vector<std::uint32_t> expectedDelimiters(std::string_view buffer) {
+  std::vector<std::uint32_t> positions;
+  for (std::uint32_t i = 0; i < buffer.size(); ++i) {
+    if (buffer[i] == '\n' || buffer[i] == ':') {
+      positions.push_back(i);
+    }
+  }
+  return positions;
+}
+
+const ScanKernel allKernels[] = {ScanKernel::Scalar, ScanKernel::Sse2, ScanKernel::Avx2};
+
+void parsesTypicalEntries() {
+  auto users = ParsePasswd(
+      "root:x:0:0:root:/root:/bin/bash\n"
+      "sync:x:4:65534:sync:/bin:/bin/sync\n"
+      "u:x:1000:1000:U,,,:/home/u:/usr/bin/zsh\n"
+      "nobody:x:65534:65534:nobody:/nonexistent:/usr/sbin/nologin\n"
+      "svc:x:999:999::/var/lib/svc:/bin/false");
+  CHECK(users.size() == 5);
+  CHECK((users[0] == UserEntry{"root", 0, true}));
+  CHECK((users[1] == UserEntry{"sync", 4, false}));
+  CHECK((users[2] == UserEntry{"svc", 999, false}));
+  CHECK((users[3] == UserEntry{"u", 1000, true}));
+  CHECK((users[4] == UserEntry{"nobody", 65534, false}));
+}
+
+void skipsIllFormedLines() {
+  for (std::string_view contents : {
+           "",
+           "\n\n",
+           "no colon at all",
+           ":x:1000:1000::/home:/bin/sh",      // no name
+           "a:x::1000::/home:/bin/sh",         // no UID
+           "a:x:uid:1000::/home:/bin/sh",      // UID isn't a number
+           "a:x:1000:1000::/home:",            // no shell
+           "a:x:1000:1000::/home",             // missing field
+           "a:x:1000:1000:/home:/bin/sh:\n",   // extra field is fine
+           "a:x:1000:1000::/home:/bin/sh:x:y", // extra fields are fine
+           "a:x:1000:1000::/home:/bin/sh\r\n", // CR belongs to the shell
+       }) {
+    CHECK(ParsePasswd(contents) == parseWithSplitView(contents));
+  }
+  CHECK(ParsePasswd("a:x:1000:1000:/home:/bin/sh:x:y\n").size() == 1);
+}
+
+void keepsTheOrderOfDuplicateUids() {
+  auto users = ParsePasswd("b:x:1000::::/bin/sh\na:x:1000::::/bin/sh\nc:x:0::::/bin/sh\n");
+  CHECK(users.size() == 3);
+  CHECK(users[0].name == "c");
+  CHECK(users[1].name == "b");
+  CHECK(users[2].name == "a");
+}
+
+void kernelsAgreeWithTheObviousLoop() {
+  std::mt19937 random{42};
+  const std::string_view alphabet = "::\n\nabcxyz0123/";
+  for (auto kernel : allKernels) {
+    if (!Ubuntu::IsSupported(kernel)) {
+      std::fprintf(stderr, "skipping unsupported kernel %d\n", static_cast<int>(kernel));
+      continue;
+    }
+    // Every length around the vector widths, at every alignment.
+    for (std::size_t size = 0; size < 200; ++size) {
+      std::string storage(size + 32, 'a');
+      for (auto& c : storage) {
+        c = alphabet[random() % alphabet.size()];
+      }
+      for (std::size_t offset = 0; offset < 32; offset += 7) {
+        std::string_view buffer{storage.data() + offset, size};
+        std::vector<std::uint32_t> positions{7, 7};
+        Ubuntu::ScanDelimiters(kernel, buffer, positions);
+        auto expected = expectedDelimiters(buffer);
+        expected.insert(expected.begin(), {7, 7});
+        CHECK(positions == expected);
+      }
+    }
+  }
+}
+
+// Lines made of random pieces of valid and broken fields.
+std::string randomPasswd(std::mt19937& random, std::size_t lines) {
+  static const char* pieces[] = {"user", "x", "1000", "0", "65534", "", "/bin/bash",
+                                 "/usr/sbin/nologin", "/bin/false", "12ab", "-1", "99999999999",
+                                 "\r", " "};
+  std::string contents;
+  for (std::size_t i = 0; i < lines; ++i) {
+    auto fields = random() % 10;
+    for (std::size_t f = 0; f < fields; ++f) {
+      if (f != 0) {
+        contents += ':';
+      }
+      contents += pieces[random() % std::size(pieces)];
+      if (f == 0) {
+        contents += std::to_string(i);
+      }
+    }
+    if (random() % 50 != 0) {
+      contents += '\n';
+    }
+  }
+  return contents;
+}
+
+void matchesSplitViewOnRandomInput() {
+  std::mt19937 random{7};
+  for (int round = 0; round < 200; ++round) {
+    auto contents = randomPasswd(random, random() % 100);
+    CHECK(ParsePasswd(contents) == parseWithSplitView(contents));
+  }
+}
+
+void matchesSplitViewAcrossBlocks() {
+  std::mt19937 random{1};
+  // Several blocks, with line ends landing anywhere around their boundaries.
+  auto contents = randomPasswd(random, 200'000);
+  auto users = ParsePasswd(contents);
+  CHECK(users.size() > 1000);
+  CHECK(users == parseWithSplitView(contents));
+
+  // A single line longer than a block.
+  std::string huge = "a:x:1:1:" + std::string(3 * 1024 * 1024, 'g') + ":/home:/bin/sh\n" +
+                     "b:x:2:2::/home:/bin/sh";
+  CHECK(ParsePasswd(huge) == parseWithSplitView(huge));
+  CHECK(ParsePasswd(huge).size() == 2);
+}
+
+// What DefaultUserSearch should come up with, worked out from the whole database.
+std::optional<UserEntry> expectedCandidate(std::string_view contents, const std::string& name) {
+  for (const auto& user : ParsePasswd(contents)) {
+    if (name.empty() ? user.uid >= 1000 && user.hasLogin : user.name == name) {
+      return user;
+    }
+  }
+  return std::nullopt;
+}
+
+void searchFindsTheCandidateWhateverTheChunks() {
+  std::mt19937 random{3};
+  for (int round = 0; round < 300; ++round) {
+    auto contents = randomPasswd(random, random() % 60);
+    std::string name = round % 3 == 0 ? "user" + std::to_string(random() % 60) : "";
+    std::size_t chunkSize = 1 + random() % 40;
+
+    Ubuntu::DefaultUserSearch search{name};
+    for (std::string_view rest = contents; !rest.empty() && !search.Done();) {
+      auto chunk = rest.substr(0, chunkSize);
+      rest.remove_prefix(chunk.size());
+      search.Feed(chunk);
+    }
+    search.Finish();
+
+    auto expected = expectedCandidate(contents, name);
+    CHECK(search.Candidate().has_value() == expected.has_value());
+    if (expected && search.Candidate()) {
+      // Entries sharing a name and UID may differ on the login shell only.
+      CHECK(search.Candidate()->name == expected->name);
+      CHECK(search.Candidate()->uid == expected->uid);
+    }
+    if (!search.Done()) {
+      CHECK(search.UsersSeen() == ParsePasswd(contents).size());
+    }
+  }
+}
+
+void searchStopsOnceTheAnswerIsFinal() {
+  Ubuntu::DefaultUserSearch regular;
+  CHECK(regular.Feed("root:x:0:0::/root:/bin/bash\nu2:x:1002:1002::/home:/bin/sh\n"));
+  CHECK(regular.Candidate()->name == "u2");
+  // No other user can beat the first regular UID.
+  CHECK(!regular.Feed("u:x:1000:1000::/home/u:/bin/sh\nv:x:1000:1000::/home/v:/bin/sh\n"));
+  CHECK(regular.Done());
+  CHECK(regular.Candidate()->name == "u");
+  CHECK(!regular.Feed("w:x:1000:1000::/home/w:/bin/sh\n"));
+  CHECK(regular.Candidate()->name == "u");
+
+  Ubuntu::DefaultUserSearch named{"v"};
+  CHECK(named.Feed("u:x:1000:1000::/home/u:/bin/sh\nv:x:10"));
+  CHECK(!named.Feed("01:1001::/home/v:/bin/sh\nv:x:1002:1002::/home/v:/bin/sh\n"));
+  CHECK(named.Candidate()->uid == 1001);
+  CHECK(named.UsersSeen() == 2);
+}
+
+void searchDropsOverlongLines() {
+  Ubuntu::DefaultUserSearch search;
+  std::string garbage(64 * 1024, 'g');
+  CHECK(search.Feed("a:x:1001:1001::/home:/bin/sh\nb:x:1000:1000:" + garbage));
+  CHECK(search.Feed(garbage));
+  CHECK(search.Feed(garbage + ":/home:/bin/sh\nc:x:1003:1003::/home:/bin/sh"));
+  search.Finish();
+  CHECK(search.UsersSeen() == 2);
+  CHECK(search.Candidate()->name == "a");
+}
+
+void choosesTheDefaultUser() {
+  const std::string passwd =
+      "root:x:0:0::/root:/bin/bash\n"
+      "u:x:1000:1000::/home/u:/bin/sh\n"
+      "v:x:1001:1001::/home/v:/bin/sh\n";
+  auto choose = [&passwd](std::string name, unsigned long currentUid, bool* asked = nullptr) {
+    Ubuntu::DefaultUserSearch search{std::move(name)};
+    search.Feed(passwd);
+    return Ubuntu::ChooseDefaultUser(search, [=] {
+      if (asked) {
+        *asked = true;
+      }
+      return currentUid;
+    });
+  };
+
+  // The user named in wsl.conf wins, without asking WSL.
+  bool asked = false;
+  auto named = choose("v", 0, &asked);
+  CHECK(named.ok && named.uid == 1001ul);
+  CHECK(!asked);
+  // Named but missing: left alone.
+  auto missing = choose("w", 0);
+  CHECK(missing.ok && !missing.uid);
+  // Someone other than root is already the default.
+  auto configured = choose({}, 1001);
+  CHECK(configured.ok && !configured.uid);
+  // Otherwise the first regular user.
+  auto first = choose({}, 0);
+  CHECK(first.ok && first.uid == 1000ul);
+
+  Ubuntu::DefaultUserSearch empty;
+  CHECK(!Ubuntu::ChooseDefaultUser(empty, [] { return 0ul; }).ok);
+  Ubuntu::DefaultUserSearch rootOnly;
+  rootOnly.Feed("root:x:0:0::/root:/bin/bash\n");
+  CHECK(!Ubuntu::ChooseDefaultUser(rootOnly, [] { return 0ul; }).ok);
+}
+
+void tellsLocalSources() {
+  CHECK(Ubuntu::PasswdIsLocal(""));
+  CHECK(Ubuntu::PasswdIsLocal("passwd: files systemd\ngroup: files ldap\n"));
+  CHECK(Ubuntu::PasswdIsLocal("passwd:\tcompat [NOTFOUND=return] files # ldap\r\n"));
+  CHECK(!Ubuntu::PasswdIsLocal("passwd: files ldap\n"));
+  CHECK(!Ubuntu::PasswdIsLocal("  passwd: sss files\n"));
+}
+}  // namespace
+
+int main() {
+  RUN(parsesTypicalEntries);
+  RUN(skipsIllFormedLines);
+  RUN(keepsTheOrderOfDuplicateUids);
+  RUN(kernelsAgreeWithTheObviousLoop);
+  RUN(matchesSplitViewOnRandomInput);
+  RUN(matchesSplitViewAcrossBlocks);
+  RUN(searchFindsTheCandidateWhateverTheChunks);
+  RUN(searchStopsOnceTheAnswerIsFinal);
+  RUN(searchDropsOverlongLines);
+  RUN(choosesTheDefaultUser);
+  RUN(tellsLocalSources);
+  return TEST_EXIT_CODE();
+}
@@ -0,0 +1,437 @@
+#include "SimulatedWsl.h"
+#include "../CloudInit.h"
+#include "../Provisioning.h"
+#include "../UserCreation.h"
+#include "../Utf8.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+namespace Ubuntu::Testing {
+namespace {
+void wait(std::chrono::microseconds delay) {
+  if (delay.count() > 0) {
+    std::this_thread::sleep_for(delay);
+  }
+}
+
+bool startsWith(std::string_view text, std::string_view prefix) {
+  return text.substr(0, prefix.size()) == prefix;
+}
+
+// Splits [arguments] into words, honouring single quotes as the shell does.
+std::vector<std::string> words(std::string_view arguments);
+
+// The [index]th colon-separated field of the passwd [line].
+std::string_view field(std::string_view line, std::size_t index);
+
+void emit(std::string& reply, std::string_view tag, std::string_view payload) {
+  reply += tag;
+  reply += ' ';
+  reply += std::to_string(payload.size());
+  reply += '\n';
+  reply += payload;
+  reply += '\n';
+}
+}  // namespace
+
+std::optional<WslBackend::Configuration> SimulatedWsl::GetConfiguration() {
+  wait(latency_.apiCall);
+  std::scoped_lock lock{mutex_};
+  return Configuration{distro_.version, distro_.defaultUid, distro_.flags};
+}
+
+bool SimulatedWsl::SetDefaultUid(unsigned long uid) {
+  wait(latency_.apiCall);
+  std::scoped_lock lock{mutex_};
+  distro_.defaultUid = uid;
+  return true;
+}
+
+std::optional<unsigned long> SimulatedWsl::LaunchInteractive(std::wstring_view command,
+                                                             bool useCurrentWorkingDirectory) {
+  auto reply = launch(WideToUtf8(command));
+  if (!reply.error.empty()) {
+    Print(reply.error);
+    return std::nullopt;
+  }
+  return static_cast<unsigned long>(reply.exitCode);
+}
+
+ProcessResult SimulatedWsl::Run(std::wstring_view command, std::chrono::milliseconds timeout,
+                                const ConsumeFunction* consume) {
+  // The simulation doesn't take long enough for the [timeout] to matter.
+  auto reply = launch(WideToUtf8(command));
+  if (!reply.error.empty()) {
+    // Couldn't even launch.
+    return reply;
+  }
+
+  // Same outcomes as WslProcess.
+  const bool silent = reply.stdOut.empty();
+  std::string_view out = reply.stdOut;
+  for (std::size_t offset = 0; offset < out.size(); offset += ChunkSize) {
+    auto chunk = out.substr(offset, ChunkSize);
+    wait(latency_.perChunk);
+    {
+      std::scoped_lock lock{mutex_};
+      bytesStreamed_ += chunk.size();
+    }
+    if (consume && !(*consume)(chunk)) {
+      return {{}, 0, {}, std::move(reply.stdErr)};
+    }
+  }
+  if (consume) {
+    reply.stdOut.clear();
+  }
+  if (reply.exitCode != 0) {
+    return {L"exited with error", reply.exitCode, std::move(reply.stdOut),
+            std::move(reply.stdErr)};
+  }
+  if (silent) {
+    return {L"could not read the process output", 0, {}, std::move(reply.stdErr)};
+  }
+  return {{}, 0, std::move(reply.stdOut), std::move(reply.stdErr)};
+}
+
+std::optional<std::string> SimulatedWsl::ReadFile(std::string_view path) {
+  wait(latency_.fileRead);
+  std::scoped_lock lock{mutex_};
+  if (auto found = distro_.files.find(path); found != distro_.files.end()) {
+    return found->second;
+  }
+  return std::nullopt;
+}
+
+// Output is handed out from the thread writing to the shell, which is allowed as WarmShell never
+// holds a lock while writing.
+class SimulatedWsl::Shell : public WslBackend::Session {
+ public:
+  Shell(SimulatedWsl& wsl, ConsumeFunction consume) : wsl_{wsl}, consume_{std::move(consume)} {}
+
+  ~Shell() override { end(); }
+
+  bool Write(std::string_view data) override {
+    if (ended_) {
+      return false;
+    }
+    pending_ += data;
+    for (auto eol = pending_.find('\n'); eol != std::string::npos; eol = pending_.find('\n')) {
+      std::string line = pending_.substr(0, eol);
+      pending_.erase(0, eol + 1);
+      interpret(line);
+      if (ended_) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  void interpret(std::string_view line) {
+    if (startsWith(line, "marker=")) {
+      auto value = words(line.substr(7));
+      marker_ = value.empty() ? std::string{} : value[0];
+      return;
+    }
+    if (line == "stop_on_failure=1") {
+      stopOnFailure_ = true;
+      return;
+    }
+    if (startsWith(line, "exit ")) {
+      end();
+      return;
+    }
+    if (!startsWith(line, "step ")) {
+      // The definitions.
+      return;
+    }
+    auto arguments = words(line.substr(5));
+    if (arguments.size() < 2) {
+      return;
+    }
+    ProcessResult reply;
+    {
+      std::scoped_lock lock{wsl_.mutex_};
+      ++wsl_.stepsRun_;
+      auto fixture = wsl_.fixture_ ? wsl_.fixture_(arguments[1]) : std::nullopt;
+      reply = fixture ? std::move(fixture.value()) : wsl_.answer(arguments[1]);
+      wsl_.bytesStreamed_ += reply.stdOut.size() + reply.stdErr.size();
+    }
+    if (!reply.error.empty()) {
+      end();
+      return;
+    }
+    wait(wsl_.latency_.perChunk);
+    std::string out = std::move(reply.stdOut);
+    out += reply.stdErr;
+    out += '\n' + marker_ + ' ' + arguments[0] + ' ' + std::to_string(reply.exitCode) + " 0\n";
+    consume_(out);
+    if (reply.exitCode != 0 && stopOnFailure_) {
+      end();
+    }
+  }
+
+  void end() {
+    if (!ended_) {
+      ended_ = true;
+      consume_({});
+    }
+  }
+
+  SimulatedWsl& wsl_;
+  ConsumeFunction consume_;
+  std::string pending_;
+  std::string marker_;
+  bool stopOnFailure_ = false;
+  bool ended_ = false;
+};
+
+std::unique_ptr<WslBackend::Session> SimulatedWsl::Spawn(std::wstring_view command,
+                                                         ConsumeFunction consume) {
+  if (sessionFixture_) {
+    {
+      std::scoped_lock lock{mutex_};
+      commands_.emplace_back(WideToUtf8(command));
+    }
+    wait(latency_.launch);
+    return sessionFixture_(WideToUtf8(command), std::move(consume));
+  }
+  auto reply = launch(WideToUtf8(command));
+  if (!reply.error.empty()) {
+    Print(reply.error);
+    return nullptr;
+  }
+  return std::make_unique<Shell>(*this, std::move(consume));
+}
+
+void SimulatedWsl::Print(std::wstring_view line) {
+  std::scoped_lock lock{mutex_};
+  printed_.emplace_back(line);
+}
+
+void SimulatedWsl::ShowProgress(std::wstring_view block) {
+  std::scoped_lock lock{mutex_};
+  progress_.emplace_back(block);
+}
+
+ProcessResult SimulatedWsl::launch(std::string_view command) {
+  {
+    std::scoped_lock lock{mutex_};
+    commands_.emplace_back(command);
+  }
+  wait(latency_.launch);
+  std::scoped_lock lock{mutex_};
+  if (auto reply = fixture_ ? fixture_(command) : std::nullopt; reply) {
+    return std::move(reply.value());
+  }
+  return answer(command);
+}
+
+ProcessResult SimulatedWsl::answer(std::string_view command) {
+  static const std::string script = WideToUtf8(Provisioning::Script);
+  if (auto prefix = command.size() - script.size();
+      command.size() >= script.size() && command.substr(prefix) == script) {
+    return provisioningReply(command.substr(0, prefix));
+  }
+  static const std::string pollScript = WideToUtf8(CloudInit::PollScript);
+  if (auto prefix = command.size() - pollScript.size();
+      command.size() >= pollScript.size() && command.substr(prefix) == pollScript) {
+    return cloudInitPollReply(command.substr(0, prefix));
+  }
+  static const std::string creationScript = WideToUtf8(UserCreation::Script);
+  if (auto prefix = command.size() - creationScript.size();
+      command.size() >= creationScript.size() && command.substr(prefix) == creationScript) {
+    return userCreationReply(command.substr(0, prefix));
+  }
+  if (startsWith(command, "getent passwd")) {
+    return getent(command.substr(13));
+  }
+  if (command == "rm /etc/resolv.conf") {
+    return {{}, distro_.files.erase("etc/resolv.conf") == 1 ? 0u : 1u};
+  }
+  return {{}, 0};
+}
+
+ProcessResult SimulatedWsl::provisioningReply(std::string_view variables) {
+  std::string reply;
+  bool removed = distro_.files.erase("etc/resolv.conf") == 1;
+  emit(reply, "step", removed ? "resolv.conf 0" : "resolv.conf 1");
+
+  bool skipCloudInit = variables.find("skip_cloud_init=1\n") != std::string_view::npos;
+  emit(reply, "systemd", skipCloudInit ? "skipped" : distro_.systemdState);
+  bool cloudInit = !skipCloudInit && !distro_.cloudInitStatuses.empty();
+  emit(reply, "cloud-init", cloudInit ? "enabled" : "disabled");
+  if (cloudInit) {
+    reply += "end 0\n\n";
+    return {{}, 0, std::move(reply)};
+  }
+
+  if (auto conf = distro_.files.find("etc/wsl.conf"); conf != distro_.files.end()) {
+    // As $(cat /etc/wsl.conf) does.
+    std::string_view contents = conf->second;
+    contents = contents.substr(0, contents.find_last_not_of('\n') + 1);
+    emit(reply, "step", "wsl.conf 0");
+    emit(reply, "conf", contents);
+  }
+
+  emit(reply, "step", "id 0");
+  emit(reply, "uid", std::to_string(distro_.defaultUid));
+
+  if (variables.find("skip_users=1\n") == std::string_view::npos) {
+    emit(reply, "step", "getent 0");
+    std::string_view passwd = distro_.passwd;
+    while (!passwd.empty()) {
+      auto line = passwd.substr(0, passwd.find('\n'));
+      passwd.remove_prefix(std::min(passwd.size(), line.size() + 1));
+      if (!line.empty()) {
+        emit(reply, "user", line);
+      }
+    }
+  }
+
+  reply += "end 0\n\n";
+  return {{}, 0, std::move(reply)};
+}
+
+ProcessResult SimulatedWsl::cloudInitPollReply(std::string_view variables) {
+  auto poll = cloudInitPolls_++;
+  std::string reply;
+  if (const auto& statuses = distro_.cloudInitStatuses; !statuses.empty()) {
+    emit(reply, "status", statuses[std::min(poll, statuses.size() - 1)]);
+  }
+
+  std::size_t offset = 0;
+  static constexpr std::string_view offsetVariable = "log_offset=";
+  if (auto found = variables.find(offsetVariable); found != std::string_view::npos) {
+    offset = std::stoul(std::string{variables.substr(found + offsetVariable.size())});
+  }
+  std::string_view log;
+  if (const auto& logs = distro_.cloudInitLogs; !logs.empty()) {
+    log = logs[std::min(poll, logs.size() - 1)];
+  }
+  // As tail and head do.
+  emit(reply, "log", log.substr(std::min(offset, log.size()), 64 * 1024));
+
+  reply += "end 0\n\n";
+  return {{}, 0, std::move(reply)};
+}
+
+ProcessResult SimulatedWsl::userCreationReply(std::string_view variables) {
+  static constexpr std::string_view nameVariable = "name=";
+  auto found = variables.find(nameVariable);
+  if (found == std::string_view::npos) {
+    return {{}, static_cast<std::size_t>(UserCreation::Result::Outcome::AddFailed)};
+  }
+  auto value = variables.substr(found + nameVariable.size());
+  auto name = words(value.substr(0, value.find('\n')));
+  if (name.size() != 1) {
+    return {{}, static_cast<std::size_t>(UserCreation::Result::Outcome::AddFailed)};
+  }
+
+  // As adduser does: the lowest free UID of the regular range.
+  unsigned long uid = 1000;
+  std::string_view passwd = distro_.passwd;
+  while (!passwd.empty()) {
+    auto line = passwd.substr(0, passwd.find('\n'));
+    passwd.remove_prefix(std::min(passwd.size(), line.size() + 1));
+    if (field(line, 0) == name[0]) {
+      return {{}, static_cast<std::size_t>(UserCreation::Result::Outcome::AlreadyExists)};
+    }
+    auto used = std::strtoul(std::string{field(line, 2)}.c_str(), nullptr, 10);
+    if (used >= uid && used < 60000) {
+      uid = used + 1;
+    }
+  }
+  auto line = name[0] + ":x:" + std::to_string(uid) + ':' + std::to_string(uid) + "::/home/" +
+              name[0] + ":/bin/bash\n";
+  distro_.passwd += line;
+  distro_.files["etc/passwd"] += line;
+  return {{}, 0};
+}
+
+ProcessResult SimulatedWsl::getent(std::string_view arguments) {
+  auto keys = words(arguments);
+  if (keys.empty()) {
+    return {{}, 0, distro_.passwd};
+  }
+
+  // One line per key found, in the order of the keys, exiting with 2 if any is missing.
+  std::map<std::string_view, std::size_t> byName;
+  std::map<std::string_view, std::size_t> byUid;
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    bool numeric = keys[i].find_first_not_of("0123456789") == std::string::npos;
+    (numeric ? byUid : byName).emplace(keys[i], i);
+  }
+  std::vector<std::string_view> found(keys.size());
+  std::string_view passwd = distro_.passwd;
+  while (!passwd.empty()) {
+    auto line = passwd.substr(0, passwd.find('\n'));
+    passwd.remove_prefix(std::min(passwd.size(), line.size() + 1));
+    for (auto [wanted, column] : {std::pair{&byName, 0}, std::pair{&byUid, 2}}) {
+      auto key = wanted->find(field(line, column));
+      if (key != wanted->end() && found[key->second].empty()) {
+        found[key->second] = line;
+      }
+    }
+  }
+  std::string out;
+  std::size_t exitCode = 0;
+  for (auto line : found) {
+    if (line.empty()) {
+      exitCode = 2;
+      continue;
+    }
+    out += line;
+    out += '\n';
+  }
+  return {{}, exitCode, std::move(out)};
+}
+
+namespace {
+std::vector<std::string> words(std::string_view arguments) {
+  std::vector<std::string> result;
+  std::string word;
+  bool inWord = false;
+  bool quoted = false;
+  bool escaped = false;
+  for (char c : arguments) {
+    if (escaped) {
+      word += c;
+      escaped = false;
+    } else if (c == '\'') {
+      quoted = !quoted;
+      inWord = true;
+    } else if (c == ' ' && !quoted) {
+      if (inWord) {
+        result.push_back(std::move(word));
+        word.clear();
+      }
+      inWord = false;
+    } else if (c == '\\' && !quoted) {
+      escaped = true;
+      inWord = true;
+    } else {
+      word += c;
+      inWord = true;
+    }
+  }
+  if (inWord) {
+    result.push_back(std::move(word));
+  }
+  return result;
+}
+
+std::string_view field(std::string_view line, std::size_t index) {
+  for (std::size_t i = 0; i < index; ++i) {
+    auto colon = line.find(':');
+    if (colon == std::string_view::npos) {
+      return {};
+    }
+    line.remove_prefix(colon + 1);
+  }
+  return line.substr(0, line.find(':'));
+}
+}  // namespace
+}  // namespace Ubuntu::Testing
@@ -0,0 +1,133 @@
+#pragma once
+
+// A WslBackend standing for a distro on any host, so the launcher's flows can be tested,
+// benchmarked and profiled on a plain Linux box. Commands aren't run but answered, either by
+// scripted fixtures or by a model of the few commands the launcher issues: the provisioning script,
+// getent, the user creation script, and anything else succeeding silently. Delays can be injected
+// to model the costs of the real WSL. As the real one, it can be called from several threads at
+// once, delays overlapping.
+
+#include "../WslBackend.h"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Ubuntu::Testing {
+// Delays injected into the simulated WSL, all zero by default.
+struct Latency {
+  // Each WSL API call not launching anything, e.g. reading the configuration from the registry.
+  std::chrono::microseconds apiCall{0};
+  // Starting a process in the distro, i.e. WslLaunch and its relay.
+  std::chrono::microseconds launch{0};
+  // Moving each chunk of output across the pipe.
+  std::chrono::microseconds perChunk{0};
+  // Reading a file over the 9P share.
+  std::chrono::microseconds fileRead{0};
+};
+
+class SimulatedWsl : public WslBackend {
+ public:
+  // Output is streamed in chunks of this size.
+  static constexpr std::size_t ChunkSize = 64 * 1024;
+
+  // What is in the simulated distro.
+  struct Distro {
+    // What `getent passwd` outputs.
+    std::string passwd;
+    // Contents of the files by path relative to the root, e.g. "etc/wsl.conf".
+    std::map<std::string, std::string, std::less<>> files;
+    unsigned long version = 2;
+    unsigned long defaultUid = 0;
+    unsigned long flags = Configuration::DefaultFlags;
+    // What `systemctl is-system-running` outputs.
+    std::string systemdState = "running";
+    // What `cloud-init status --format json` outputs at each poll, the last one repeating. Empty if
+    // cloud-init isn't enabled.
+    std::vector<std::string> cloudInitStatuses;
+    // What /var/log/cloud-init-output.log holds at each poll, the last one repeating.
+    std::vector<std::string> cloudInitLogs;
+  };
+
+  // A scripted answer to [command], overriding the model if not std::nullopt.
+  using Fixture = std::function<std::optional<ProcessResult>(std::string_view command)>;
+  // A scripted session for [command], replacing the model of spawned shells. Returns nullptr if it
+  // can't be started.
+  using SessionFixture =
+      std::function<std::unique_ptr<Session>(std::string_view command, ConsumeFunction consume)>;
+
+  explicit SimulatedWsl(Distro distro, Latency latency = {})
+      : distro_{std::move(distro)}, latency_{latency} {}
+
+  void SetFixture(Fixture fixture) { fixture_ = std::move(fixture); }
+  void SetSessionFixture(SessionFixture fixture) { sessionFixture_ = std::move(fixture); }
+
+  std::optional<Configuration> GetConfiguration() override;
+  bool SetDefaultUid(unsigned long uid) override;
+  std::optional<unsigned long> LaunchInteractive(std::wstring_view command,
+                                                 bool useCurrentWorkingDirectory) override;
+  ProcessResult Run(std::wstring_view command, std::chrono::milliseconds timeout,
+                    const ConsumeFunction* consume = nullptr) override;
+  // Models a shell reading a batch driver script (see Batch.h) from stdin, one line at a time: each
+  // step is answered as a command would be, without the cost of a launch. A step whose answer
+  // carries an error kills the shell, as does exit or a failure when told to stop on one.
+  std::unique_ptr<Session> Spawn(std::wstring_view command, ConsumeFunction consume) override;
+  std::optional<std::string> ReadFile(std::string_view path) override;
+  void Print(std::wstring_view line) override;
+  void ShowProgress(std::wstring_view block) override;
+
+  // The accessors below mustn't be called while the launcher is still running.
+  const Distro& State() const { return distro_; }
+
+  // The commands launched so far, in UTF-8.
+  const std::vector<std::string>& Commands() const { return commands_; }
+
+  // The bytes of stdout handed to the launcher so far.
+  std::size_t BytesStreamed() const { return bytesStreamed_; }
+
+  // What the launcher printed so far, one entry per line.
+  const std::vector<std::wstring>& Printed() const { return printed_; }
+
+  // Each block of progress shown so far, empty when cleared.
+  const std::vector<std::wstring>& Progress() const { return progress_; }
+
+  // The times cloud-init was polled.
+  std::size_t CloudInitPolls() const { return cloudInitPolls_; }
+
+  // The steps run by spawned shells so far.
+  std::size_t StepsRun() const { return stepsRun_; }
+
+ private:
+  class Shell;
+
+  // Records [command] and answers it as the fixture, or the distro, would.
+  ProcessResult launch(std::string_view command);
+
+  // Answers [command] as the distro would.
+  ProcessResult answer(std::string_view command);
+  ProcessResult provisioningReply(std::string_view command);
+  ProcessResult cloudInitPollReply(std::string_view variables);
+  ProcessResult userCreationReply(std::string_view variables);
+  ProcessResult getent(std::string_view arguments);
+
+  // Guards the distro and what is recorded, never held while waiting.
+  std::mutex mutex_;
+  Distro distro_;
+  Latency latency_;
+  Fixture fixture_;
+  SessionFixture sessionFixture_;
+  std::vector<std::string> commands_;
+  std::size_t bytesStreamed_ = 0;
+  std::vector<std::wstring> printed_;
+  std::vector<std::wstring> progress_;
+  std::size_t cloudInitPolls_ = 0;
+  std::size_t stepsRun_ = 0;
+};
+}  // namespace Ubuntu::Testing
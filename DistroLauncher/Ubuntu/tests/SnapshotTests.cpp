@@ -0,0 +1,108 @@
+#include "Check.h"
+#include "Host.h"
+#include "SimulatedWsl.h"
+#include "../ImageCache.h"
+#include "../Snapshot.h"
+#include "../Utf8.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace Snapshot = Ubuntu::Snapshot;
+namespace fs = std::filesystem;
+using Ubuntu::ProcessResult;
+using Ubuntu::Testing::SimulatedWsl;
+using Ubuntu::Testing::TemporaryDirectory;
+
+namespace {
+// A distro whose default user is 1000, without interop, archiving [archive] as long as it is entered as root.
+std::shared_ptr<SimulatedWsl> distro(std::string archive, std::size_t exitCode = 0) {
+  SimulatedWsl::Distro state;
+  state.defaultUid = 1000;
+  state.flags = 0x6;
+  auto wsl = std::make_shared<SimulatedWsl>(state);
+  const auto command = Ubuntu::WideToUtf8(Snapshot::Command);
+  // The fixture runs with the distro locked, so reading its state is safe.
+  wsl->SetFixture([wsl = wsl.get(), command, archive,
+                   exitCode](std::string_view launched) -> std::optional<ProcessResult> {
+    if (launched != command) {
+      return std::nullopt;
+    }
+    if (wsl->State().defaultUid != 0) {
+      return ProcessResult{{}, 2, {}, "tar: ./root: Cannot open: Permission denied\n"};
+    }
+    return ProcessResult{{}, exitCode, archive, exitCode == 0 ? "" : "tar: write error\n"};
+  });
+  return wsl;
+}
+
+std::string read(const fs::path& path) {
+  std::ifstream file{path, std::ios::binary};
+  return {std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+}
+
+void takesSnapshotsAsRoot() {
+  TemporaryDirectory directory;
+  // Several chunks of output.
+  std::string archive(3 * SimulatedWsl::ChunkSize + 17, 'x');
+  auto wsl = distro(archive);
+  auto result = Snapshot::Take(*wsl, directory.path);
+  CHECK(result.Succeeded());
+  CHECK(result.bytes == archive.size());
+  CHECK(wsl->State().defaultUid == 1000 && wsl->State().flags == 0x6);
+
+  std::atomic<bool> cancelled{false};
+  auto stored = Snapshot::Check(directory.path, cancelled);
+  CHECK(stored && stored->defaultUid == 1000 && stored->flags == 0x6);
+  CHECK(read(stored->image) == archive);
+}
+
+void keepsThePreviousSnapshotOnFailure() {
+  TemporaryDirectory directory;
+  CHECK(Snapshot::Take(*distro("first"), directory.path).Succeeded());
+
+  auto wsl = distro("second, broken", 2);
+  auto result = Snapshot::Take(*wsl, directory.path);
+  CHECK(!result.Succeeded());
+  CHECK(result.error.find(L"write error") != std::wstring::npos);
+  CHECK(wsl->State().defaultUid == 1000);
+
+  std::atomic<bool> cancelled{false};
+  auto stored = Snapshot::Check(directory.path, cancelled);
+  CHECK(stored && read(stored->image) == "first");
+}
+
+void rejectsWhatDoesntCheckOut() {
+  TemporaryDirectory directory;
+  std::atomic<bool> cancelled{false};
+  CHECK(!Snapshot::Check(directory.path, cancelled));
+
+  CHECK(Snapshot::Take(*distro("archive"), directory.path).Succeeded());
+  {
+    std::ofstream file{Ubuntu::ImageCache::ImagePath(directory.path), std::ios::binary};
+    file << "ARCHIVE";
+  }
+  CHECK(!Snapshot::Check(directory.path, cancelled));
+
+  // Snapshots taken before the flags were recorded get the default ones.
+  CHECK(Snapshot::Take(*distro("archive"), directory.path).Succeeded());
+  auto manifest = Ubuntu::ImageCache::Load(directory.path);
+  manifest->flags.reset();
+  CHECK(Ubuntu::ImageCache::Save(directory.path, *manifest));
+  auto stored = Snapshot::Check(directory.path, cancelled);
+  CHECK(stored && stored->flags == Ubuntu::WslBackend::Configuration::DefaultFlags);
+
+  // An image cache copy isn't a snapshot.
+  Ubuntu::ImageCache::Writer writer{directory.path};
+  CHECK(writer.Append("image") && writer.Commit("digest"));
+  CHECK(!Snapshot::Check(directory.path, cancelled));
+}
+}  // namespace
+
+int main() {
+  RUN(takesSnapshotsAsRoot);
+  RUN(keepsThePreviousSnapshotOnFailure);
+  RUN(rejectsWhatDoesntCheckOut);
+  return TEST_EXIT_CODE();
+}
@@ -0,0 +1,338 @@
+#include "Check.h"
+#include "../TarIndex.h"
+
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace Tar = Ubuntu::Tar;
+
+namespace {
+// Fills in the checksum of the header at [offset] of [bytes], computed with its own field filled
+// with spaces.
+void seal(std::string& bytes, std::size_t offset = 0) {
+  std::memset(&bytes[offset + 148], ' ', 8);
+  unsigned sum = 0;
+  for (std::size_t i = offset; i < offset + 512; ++i) {
+    sum += static_cast<unsigned char>(bytes[i]);
+  }
+  char checksum[8];
+  std::snprintf(checksum, sizeof(checksum), "%06o", sum);
+  std::memcpy(&bytes[offset + 148], checksum, 7);
+}
+
+// Builds archives the way GNU tar and pax writers lay them out.
+class Archive {
+ public:
+  // A header block. [prefix] only goes in ustar headers.
+  Archive& Header(std::string_view name, char type, std::uint64_t size,
+                  std::string_view linkName = {}, std::string_view prefix = {},
+                  bool ustar = true) {
+    std::string block(512, '\0');
+    name.copy(&block[0], 100);
+    octal(block, 100, 8, 0644);
+    octal(block, 108, 8, 0);
+    octal(block, 116, 8, 0);
+    octal(block, 124, 12, size);
+    octal(block, 136, 12, 0);
+    block[156] = type;
+    linkName.copy(&block[157], 100);
+    if (ustar) {
+      std::memcpy(&block[257], "ustar\0" "00", 8);
+      prefix.copy(&block[345], 155);
+    }
+    seal(block);
+    bytes += block;
+    return *this;
+  }
+
+  // The data of the last header, padded to a whole block.
+  Archive& Data(std::string_view data) {
+    bytes += data;
+    bytes += std::string((512 - data.size() % 512) % 512, '\0');
+    return *this;
+  }
+
+  Archive& File(std::string_view name, std::string_view contents, char type = '0') {
+    return Header(name, type, contents.size()).Data(contents);
+  }
+
+  // A GNU long name ('L') or long link name ('K') for the next entry.
+  Archive& LongName(char type, std::string_view value) {
+    std::string data{value};
+    data += '\0';
+    return Header("././@LongLink", type, data.size(), {}, {}, false).Data(data);
+  }
+
+  // A pax extended header ('x') or global one ('g') of "key=value" records.
+  Archive& Pax(std::initializer_list<std::pair<std::string_view, std::string_view>> records,
+               char type = 'x') {
+    std::string data;
+    for (auto [key, value] : records) {
+      // The length counts its own digits.
+      auto rest = 1 + key.size() + 1 + value.size() + 1;
+      auto length = rest + std::to_string(rest).size();
+      length = rest + std::to_string(length).size();
+      data += std::to_string(length) + " " + std::string{key} + "=" + std::string{value} + "\n";
+    }
+    return Header("PaxHeaders/entry", type, data.size()).Data(data);
+  }
+
+  Archive& End() {
+    bytes += std::string(1024, '\0');
+    return *this;
+  }
+
+  std::string bytes;
+
+ private:
+  static void octal(std::string& block, std::size_t offset, std::size_t size,
+                    std::uint64_t value) {
+    char text[16];
+    std::snprintf(text, sizeof(text), "%0*llo", static_cast<int>(size - 1),
+                  static_cast<unsigned long long>(value));
+    std::memcpy(&block[offset], text, size - 1);
+  }
+};
+
+Tar::Indexer captureAll() {
+  return Tar::Indexer{[](const Tar::Entry&) { return true; }};
+}
+
+Tar::Index index(std::string_view archive) {
+  auto indexer = captureAll();
+  CHECK(indexer.Feed(archive));
+  CHECK(indexer.Finished());
+  return indexer.Take();
+}
+
+void indexesUstarEntries() {
+  Archive archive;
+  archive.File("./etc/wsl.conf", "[user]\ndefault=ubuntu\n")
+      .Header("./etc/cloud/", '5', 0)
+      .Header("bin", '2', 0, "usr/bin")
+      .Header("cloud.cfg.d/90_dpkg.cfg", '0', 5, {}, "etc/cloud")
+      .Data("hello")
+      .End();
+  auto result = index(archive.bytes);
+  CHECK(result.entries.size() == 4);
+  CHECK(result.entries[0].name == "etc/wsl.conf" && result.entries[0].isRegularFile());
+  CHECK(result.entries[0].offset == 512 && result.entries[0].size == 22);
+  CHECK(result.entries[1].name == "etc/cloud" && result.entries[1].type == '5');
+  CHECK(result.entries[2].name == "bin" && result.entries[2].linkName == "usr/bin");
+  // Prefix and name joined.
+  auto dpkg = result.Find("etc/cloud/cloud.cfg.d/90_dpkg.cfg");
+  CHECK(dpkg && dpkg->offset == 5 * 512);
+  CHECK(result.Contents("etc/wsl.conf") &&
+        *result.Contents("etc/wsl.conf") == "[user]\ndefault=ubuntu\n");
+  CHECK(result.Contents("etc/cloud/cloud.cfg.d/90_dpkg.cfg") &&
+        *result.Contents("etc/cloud/cloud.cfg.d/90_dpkg.cfg") == "hello");
+
+  // The prefix field means nothing outside of ustar headers.
+  Archive old;
+  old.Header("name", '0', 0, {}, {}, false).End();
+  CHECK(index(old.bytes).entries.front().name == "name");
+}
+
+void capturesOnlyWhatIsAskedFor() {
+  Archive archive;
+  archive.File("etc/passwd", "root:x:0:0::/root:/bin/bash\n")
+      .File("etc/shadow", "secret")
+      .File("usr/lib/big", std::string(4096, 'x'))
+      .File("etc/hardlink", "", '1')
+      .End();
+  Tar::Indexer indexer{[](const Tar::Entry& entry) { return entry.name != "etc/shadow"; }, 1024};
+  CHECK(indexer.Feed(archive.bytes) && indexer.Finished());
+  const auto& result = indexer.Result();
+  CHECK(result.entries.size() == 4);
+  CHECK(result.Contents("etc/passwd") != nullptr);
+  CHECK(result.Contents("etc/shadow") == nullptr);
+  // Larger than the capture limit.
+  CHECK(result.Contents("usr/lib/big") == nullptr);
+  CHECK(result.Find("usr/lib/big")->size == 4096);
+  // Links have no contents of their own.
+  CHECK(result.Contents("etc/hardlink") == nullptr);
+}
+
+void appliesGnuLongNames() {
+  const std::string longName = "usr/share/" + std::string(150, 'n') + "/file";
+  const std::string longLink = "../" + std::string(120, 'l');
+  Archive archive;
+  archive.LongName('L', longName)
+      .File(longName.substr(0, 99), "data")
+      .LongName('K', longLink)
+      .LongName('L', "./" + longName + ".link")
+      .Header("truncated", '2', 0, longLink.substr(0, 99))
+      .File("short", "")
+      .End();
+  auto result = index(archive.bytes);
+  CHECK(result.entries.size() == 3);
+  CHECK(result.entries[0].name == longName);
+  CHECK(result.Contents(longName) && *result.Contents(longName) == "data");
+  CHECK(result.entries[1].name == longName + ".link" && result.entries[1].linkName == longLink);
+  // The overrides apply to the next entry only.
+  CHECK(result.entries[2].name == "short" && result.entries[2].linkName.empty());
+}
+
+void appliesPaxOverrides() {
+  const std::string longName = "var/lib/" + std::string(200, 'p');
+  Archive archive;
+  archive.Pax({{"comment", "ignored"}}, 'g')
+      .Pax({{"path", longName}, {"mtime", "1700000000.5"}, {"linkpath", "target"}})
+      .Header("short", '2', 0)
+      // A size beyond what the header field holds, here smaller for the test's sake.
+      .Pax({{"size", "600"}})
+      .Header("large", '0', 0)
+      .Data(std::string(600, 'z'))
+      .File("after", "ok")
+      .End();
+  auto result = index(archive.bytes);
+  CHECK(result.entries.size() == 3);
+  CHECK(result.entries[0].name == longName && result.entries[0].linkName == "target");
+  CHECK(result.entries[1].name == "large" && result.entries[1].size == 600);
+  CHECK(result.Contents("large") && result.Contents("large")->size() == 600);
+  // Its data and padding were skipped as the pax size said.
+  CHECK(result.Contents("after") && *result.Contents("after") == "ok");
+}
+
+void indexesAcrossChunkBoundaries() {
+  Archive archive;
+  archive.LongName('L', std::string(300, 'a'))
+      .File("ignored", std::string(1000, 'b'))
+      .Pax({{"path", "pax/path"}})
+      .File("x", std::string(513, 'c'))
+      .File("etc/hostname", "ubuntu\n")
+      .End();
+  auto whole = index(archive.bytes);
+
+  auto indexer = captureAll();
+  for (char c : archive.bytes) {
+    CHECK(indexer.Feed(std::string_view{&c, 1}));
+  }
+  CHECK(indexer.Finished());
+  const auto& bytewise = indexer.Result();
+  CHECK(bytewise.entries.size() == whole.entries.size());
+  for (std::size_t i = 0; i < whole.entries.size() && i < bytewise.entries.size(); ++i) {
+    CHECK(bytewise.entries[i].name == whole.entries[i].name);
+    CHECK(bytewise.entries[i].offset == whole.entries[i].offset);
+    CHECK(bytewise.entries[i].size == whole.entries[i].size);
+  }
+  CHECK(bytewise.files == whole.files);
+  CHECK(bytewise.Find(std::string(300, 'a'))->size == 1000);
+  CHECK(bytewise.Contents("pax/path") && bytewise.Contents("pax/path")->size() == 513);
+}
+
+void stopsAtTheEndOfArchive() {
+  Archive archive;
+  archive.File("first", "1");
+  auto withOneZeroBlock = archive.bytes + std::string(512, '\0');
+  archive.End();
+
+  auto indexer = captureAll();
+  CHECK(indexer.Feed(withOneZeroBlock));
+  CHECK(!indexer.Finished());
+
+  // Whatever follows the marker is ignored, even if it isn't a header.
+  auto finished = captureAll();
+  CHECK(finished.Feed(archive.bytes + "not a header" + std::string(10240, '\x7f')));
+  CHECK(finished.Finished());
+  CHECK(finished.Result().entries.size() == 1);
+
+  // A stream cut short isn't an error as such, just not finished.
+  auto cut = captureAll();
+  CHECK(cut.Feed(std::string_view{archive.bytes}.substr(0, 700)));
+  CHECK(!cut.Finished());
+}
+
+void rejectsInvalidHeaders() {
+  Archive archive;
+  archive.File("etc/passwd", "root").End();
+
+  auto badChecksum = archive.bytes;
+  badChecksum[10] ^= 1;
+  auto indexer = captureAll();
+  CHECK(!indexer.Feed(badChecksum));
+  // And stays so.
+  CHECK(!indexer.Feed(std::string(512, '\0')));
+  CHECK(!indexer.Finished());
+
+  Archive badSize;
+  badSize.Header("etc/passwd", '0', 0);
+  auto bytes = badSize.bytes;
+  CHECK(captureAll().Feed(bytes));
+  // Not octal.
+  bytes[124 + 3] = '9';
+  seal(bytes);
+  CHECK(!captureAll().Feed(bytes));
+
+  // A metadata entry too large to be a name.
+  Archive huge;
+  huge.Header("././@LongLink", 'L', 2 * 1024 * 1024, {}, {}, false);
+  CHECK(!captureAll().Feed(huge.bytes));
+}
+
+void readsBase256Sizes() {
+  Archive archive;
+  archive.Header("big", '0', 0);
+  auto bytes = archive.bytes;
+  // GNU tar stores sizes past 8 GiB in binary, flagged by the top bit.
+  std::string size(12, '\0');
+  size[0] = static_cast<char>(0x80);
+  size[7] = 0x02;  // 2^32
+  bytes.replace(124, 12, size);
+  seal(bytes);
+
+  Tar::Indexer indexer{nullptr};
+  CHECK(indexer.Feed(bytes));
+  CHECK(indexer.Feed(std::string(4096, 'x')));
+  // Still within the entry, which data isn't mistaken for headers.
+  CHECK(indexer.Result().entries.empty());
+  CHECK(indexer.Feed(std::string(1024, '\0')));
+  CHECK(!indexer.Finished());
+}
+
+void findsTheLastEntryOfAName() {
+  Archive archive;
+  archive.File("etc/wsl.conf", "first")
+      .Header("etc/wsl.conf", '2', 0, "elsewhere")
+      .File("./etc/wsl.conf", "last")
+      .End();
+  auto result = index(archive.bytes);
+  CHECK(result.entries.size() == 3);
+  auto found = result.Find("etc/wsl.conf");
+  CHECK(found == &result.entries.back());
+  CHECK(found->isRegularFile());
+  CHECK(result.Contents("etc/wsl.conf") && *result.Contents("etc/wsl.conf") == "last");
+  CHECK(result.Find("etc/missing") == nullptr);
+
+  // A later symlink hides the file, whose contents are still there from before.
+  Archive replaced;
+  replaced.File("etc/wsl.conf", "file").Header("etc/wsl.conf", '2', 0, "target").End();
+  auto replacedResult = index(replaced.bytes);
+  CHECK(replacedResult.Find("etc/wsl.conf")->type == '2');
+}
+
+void tellsWhatIsUnder() {
+  CHECK(Tar::IsUnder("etc/cloud/cloud.cfg", "etc/cloud"));
+  CHECK(Tar::IsUnder("etc/cloud", "etc/cloud"));
+  CHECK(!Tar::IsUnder("etc/cloudy", "etc/cloud"));
+  CHECK(!Tar::IsUnder("etc", "etc/cloud"));
+}
+}  // namespace
+
+int main() {
+  RUN(indexesUstarEntries);
+  RUN(capturesOnlyWhatIsAskedFor);
+  RUN(appliesGnuLongNames);
+  RUN(appliesPaxOverrides);
+  RUN(indexesAcrossChunkBoundaries);
+  RUN(stopsAtTheEndOfArchive);
+  RUN(rejectsInvalidHeaders);
+  RUN(readsBase256Sizes);
+  RUN(findsTheLastEntryOfAName);
+  RUN(tellsWhatIsUnder);
+  return TEST_EXIT_CODE();
+}
@@ -0,0 +1,134 @@
+#include "Check.h"
+#include "../Trace.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Trace = Ubuntu::Trace;
+
+namespace {
+std::size_t count(const std::string& text, std::string_view needle) {
+  std::size_t n = 0;
+  for (auto pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+    ++n;
+  }
+  return n;
+}
+
+void recordsNothingWhileDisabled() {
+  Trace::Reset();
+  { Trace::Span span{"ignored"}; }
+  CHECK(!Trace::Enabled());
+  CHECK(!Trace::Flush());
+  CHECK(Trace::ToJson().find("ignored") == std::string::npos);
+}
+
+void recordsNestedSpans() {
+  Trace::Reset();
+  Trace::Enable("unused.json");
+  {
+    Trace::Span outer{"outer"};
+    {
+      Trace::Span inner{"inner", std::string_view{"detail"}};
+      std::this_thread::sleep_for(std::chrono::milliseconds{2});
+    }
+  }
+  auto json = Trace::ToJson();
+  CHECK(count(json, "\"ph\":\"X\"") == 2);
+  // Spans are recorded as they end.
+  CHECK(json.find("\"inner\"") < json.find("\"outer\""));
+  CHECK(json.find("\"args\":{\"detail\":\"detail\"}") != std::string::npos);
+  CHECK(json.find("\"dur\":0.") == std::string::npos);
+  Trace::Reset();
+}
+
+void dropsSpansStartedBeforeAReset() {
+  Trace::Reset();
+  Trace::Enable("unused.json");
+  {
+    Trace::Span span{"stale"};
+    Trace::Reset();
+  }
+  Trace::Enable("unused.json");
+  CHECK(Trace::ToJson().find("stale") == std::string::npos);
+  Trace::Reset();
+}
+
+void tellsThreadsApart() {
+  Trace::Reset();
+  Trace::Enable("unused.json");
+  { Trace::Span span{"main"}; }
+  std::thread{[] { Trace::Span span{"worker"}; }}.join();
+  auto json = Trace::ToJson();
+  auto mainTid = json.substr(json.find("\"tid\":", json.find("\"main\"")), 8);
+  auto workerTid = json.substr(json.find("\"tid\":", json.find("\"worker\"")), 8);
+  CHECK(mainTid != workerTid);
+  Trace::Reset();
+}
+
+void escapesDetails() {
+  Trace::Reset();
+  Trace::Enable("unused.json");
+  { Trace::Span span{"narrow", std::string_view{"say \"hi\"\\\n\x01"}}; }
+  { Trace::Span span{"wide", std::wstring_view{L"café ☃ \U0001F427"}}; }
+  auto json = Trace::ToJson();
+  CHECK(json.find(R"("say \"hi\"\\\n\u0001")") != std::string::npos);
+  CHECK(json.find("\"caf\xC3\xA9 \xE2\x98\x83 \xF0\x9F\x90\xA7\"") != std::string::npos);
+  Trace::Reset();
+}
+
+void writesTheTraceFile() {
+  auto path = std::filesystem::temp_directory_path() / "launcher-trace-test.json";
+  std::filesystem::remove(path);
+  {
+    Trace::Session session{path};
+    Trace::Span span{"session"};
+  }
+  std::ifstream file{path};
+  std::string contents{std::istreambuf_iterator<char>{file}, {}};
+  CHECK(contents.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0) == 0);
+  CHECK(contents.find("\"session\"") != std::string::npos);
+  CHECK(contents.find("]}") != std::string::npos);
+  std::filesystem::remove(path);
+  Trace::Reset();
+}
+
+std::vector<std::string> observed;
+
+void observesSpansWithoutTracing() {
+  Trace::Reset();
+  observed.clear();
+  Trace::Observe([](const char* name, std::chrono::nanoseconds duration) {
+    observed.push_back(name);
+    CHECK(duration.count() >= 0);
+  });
+  { Trace::Span span{"observed", std::string_view{"detail"}}; }
+  Trace::Observe(nullptr);
+  { Trace::Span span{"unobserved"}; }
+  CHECK(observed == std::vector<std::string>{"observed"});
+  CHECK(Trace::ToJson().find("observed") == std::string::npos);
+}
+
+void sessionWithoutAPathDoesNothing() {
+  Trace::Reset();
+  Trace::Session session{{}};
+  CHECK(!Trace::Enabled());
+}
+}  // namespace
+
+int main() {
+  RUN(recordsNothingWhileDisabled);
+  RUN(recordsNestedSpans);
+  RUN(dropsSpansStartedBeforeAReset);
+  RUN(observesSpansWithoutTracing);
+  RUN(tellsThreadsApart);
+  RUN(escapesDetails);
+  RUN(writesTheTraceFile);
+  RUN(sessionWithoutAPathDoesNothing);
+  return TEST_EXIT_CODE();
+}
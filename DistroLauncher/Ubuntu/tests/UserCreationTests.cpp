@@ -0,0 +1,109 @@
+#include "Check.h"
+#include "SimulatedWsl.h"
+#include "../UserCreation.h"
+
+#include <string>
+
+namespace UserCreation = Ubuntu::UserCreation;
+using Outcome = UserCreation::Result::Outcome;
+using Ubuntu::ProcessResult;
+using Ubuntu::Testing::SimulatedWsl;
+
+namespace {
+const std::string defaultRegex = UserCreation::DefaultNameRegex;
+
+SimulatedWsl::Distro freshDistro() {
+  SimulatedWsl::Distro distro;
+  distro.passwd = "root:x:0:0:root:/root:/bin/bash\nnobody:x:65534:65534::/:/usr/sbin/nologin\n";
+  distro.files["etc/passwd"] = distro.passwd;
+  return distro;
+}
+
+void readsTheNameRegex() {
+  CHECK(UserCreation::NameRegex("") == defaultRegex);
+  CHECK(UserCreation::NameRegex("# NAME_REGEX=\"^x$\"\nSYS_NAME_REGEX=\"^y$\"\n") == defaultRegex);
+  CHECK(UserCreation::NameRegex("NAME_REGEX=\"^[a-z]+$\"\n") == "^[a-z]+$");
+  CHECK(UserCreation::NameRegex("  NAME_REGEX = '^a$'\r\nNAME_REGEX=^b$\n") == "^b$");
+  CHECK(UserCreation::NameRegex("NAME_REGEX_EXTRA=\"^x$\"\nNAME_REGEX=\n") == defaultRegex);
+}
+
+void checksNamesOnTheHost() {
+  CHECK(!UserCreation::CheckName("ubuntu", defaultRegex));
+  CHECK(!UserCreation::CheckName("a-b_c9", defaultRegex));
+  CHECK(!UserCreation::CheckName("machine$", defaultRegex));
+  CHECK(UserCreation::CheckName("", defaultRegex));
+  CHECK(UserCreation::CheckName("Ubuntu", defaultRegex));
+  CHECK(UserCreation::CheckName("9lives", defaultRegex));
+  CHECK(UserCreation::CheckName("john doe", defaultRegex));
+  CHECK(UserCreation::CheckName("o'brien", defaultRegex));
+  CHECK(UserCreation::CheckName(std::string(33, 'a'), defaultRegex));
+  CHECK(!UserCreation::CheckName(std::string(32, 'a'), defaultRegex));
+  // Left to adduser.
+  CHECK(!UserCreation::CheckName("Anyone", "^[a-z"));
+  CHECK(!UserCreation::CheckName("John.Doe", "^[A-Za-z.]+$"));
+}
+
+void refusesATypoWithoutLaunching() {
+  SimulatedWsl wsl{freshDistro()};
+  auto result = UserCreation::Create(wsl, "John", defaultRegex);
+  CHECK(result.outcome == Outcome::InvalidName);
+  CHECK(result.reason.find(defaultRegex) != std::string::npos);
+  CHECK(result.launches == 0);
+  CHECK(wsl.Commands().empty());
+
+  result = UserCreation::Create(wsl, "root", defaultRegex);
+  CHECK(result.outcome == Outcome::AlreadyExists);
+  CHECK(wsl.Commands().empty());
+}
+
+void createsInASingleLaunch() {
+  SimulatedWsl wsl{freshDistro()};
+  auto result = UserCreation::Create(wsl, "ubuntu", defaultRegex);
+  CHECK(result.outcome == Outcome::Created);
+  CHECK(result.launches == 1);
+  CHECK(wsl.Commands().size() == 1);
+  CHECK(wsl.Commands()[0].substr(0, 14) == "name='ubuntu'\n");
+  CHECK(result.user && result.user->name == "ubuntu" && result.user->uid == 1000);
+  CHECK(wsl.State().passwd.find("ubuntu:x:1000:") != std::string::npos);
+
+  // Then found on the host.
+  CHECK(UserCreation::Create(wsl, "ubuntu", defaultRegex).outcome == Outcome::AlreadyExists);
+  CHECK(wsl.Commands().size() == 1);
+}
+
+void quotesTheName() {
+  SimulatedWsl wsl{freshDistro()};
+  auto result = UserCreation::Create(wsl, "o'brien", "^.+$");
+  CHECK(result.outcome == Outcome::Created);
+  CHECK(wsl.Commands()[0].substr(0, 18) == "name='o'\\''brien'\n");
+  CHECK(result.user && result.user->name == "o'brien");
+}
+
+void reportsTheScriptOutcome() {
+  SimulatedWsl wsl{freshDistro()};
+  for (auto [exitCode, outcome] : {std::pair{1ul, Outcome::AddFailed},
+                                   std::pair{2ul, Outcome::RolledBack},
+                                   std::pair{3ul, Outcome::RollbackFailed},
+                                   std::pair{4ul, Outcome::AlreadyExists},
+                                   // adduser killed by a signal.
+                                   std::pair{130ul, Outcome::AddFailed}}) {
+    wsl.SetFixture([exitCode](std::string_view) { return ProcessResult{{}, exitCode}; });
+    auto result = UserCreation::Create(wsl, "ubuntu", defaultRegex);
+    CHECK(result.outcome == outcome);
+    CHECK(!result.user);
+  }
+
+  wsl.SetFixture([](std::string_view) { return ProcessResult{L"no such distro"}; });
+  CHECK(UserCreation::Create(wsl, "ubuntu", defaultRegex).outcome == Outcome::LaunchFailed);
+}
+}  // namespace
+
+int main() {
+  RUN(readsTheNameRegex);
+  RUN(checksNamesOnTheHost);
+  RUN(refusesATypoWithoutLaunching);
+  RUN(createsInASingleLaunch);
+  RUN(quotesTheName);
+  RUN(reportsTheScriptOutcome);
+  return TEST_EXIT_CODE();
+}
@@ -0,0 +1,114 @@
+#include "Check.h"
+#include "../UserDirectory.h"
+
+#include <string>
+#include <vector>
+
+using Ubuntu::NssQuery;
+using Ubuntu::UserDirectory;
+using Ubuntu::UserEntry;
+
+namespace {
+// Answers queries out of a fixed passwd database, as getent would, remembering them.
+struct FakeDistro {
+  std::string passwd;
+  bool broken = false;
+  std::vector<std::string> commands;
+
+  UserDirectory::QueryFunction query() {
+    return [this](const NssQuery& query) -> std::optional<std::vector<UserEntry>> {
+      commands.push_back(query.Command());
+      if (broken) {
+        return std::nullopt;
+      }
+      std::vector<UserEntry> found;
+      for (const auto& user : Ubuntu::ParsePasswd(passwd)) {
+        bool matches = query.kind == NssQuery::Kind::Enumeration ||
+                       (query.kind == NssQuery::Kind::PointLookup && user.name == query.name) ||
+                       (query.kind == NssQuery::Kind::UidRangeProbe && user.uid >= query.firstUid &&
+                        user.uid <= query.lastUid);
+        if (matches) {
+          found.push_back(user);
+        }
+      }
+      return found;
+    };
+  }
+};
+
+const char* passwd =
+    "root:x:0:0:root:/root:/bin/bash\n"
+    "u:x:1000:1000::/home/u:/bin/bash\n"
+    "v:x:1001:1001::/home/v:/bin/bash\n";
+
+void answersFromWhatIsKnown() {
+  FakeDistro distro{passwd};
+  UserDirectory users{distro.query()};
+  users.Populate(Ubuntu::ParsePasswd(passwd));
+  CHECK(users.FindByName("u")->uid == 1000);
+  CHECK(users.FindByUid(1001)->name == "v");
+  CHECK(users.FindByUid(0)->name == "root");
+  CHECK(users.QueriesRun() == 0);
+  CHECK(distro.commands.empty());
+}
+
+void looksUpWhatIsNotKnownOnce() {
+  FakeDistro distro{passwd};
+  UserDirectory users{distro.query()};
+  CHECK(users.FindByName("v")->uid == 1001);
+  CHECK(users.FindByName("v")->uid == 1001);
+  CHECK(users.FindByUid(1001)->name == "v");
+  CHECK(users.QueriesRun() == 1);
+  CHECK(distro.commands == std::vector<std::string>{"getent passwd 'v'"});
+
+  // Misses are remembered too.
+  CHECK(!users.FindByName("w"));
+  CHECK(!users.FindByName("w"));
+  CHECK(!users.FindByUid(4242));
+  CHECK(!users.FindByUid(4242));
+  CHECK(users.QueriesRun() == 3);
+  CHECK(distro.commands.back() == "getent passwd 4242");
+}
+
+void forgetsOnInvalidation() {
+  FakeDistro distro{passwd};
+  UserDirectory users{distro.query()};
+  users.Populate(Ubuntu::ParsePasswd(passwd));
+  CHECK(!users.FindByName("new"));
+  distro.passwd += "new:x:1002:1002::/home/new:/bin/bash\n";
+  CHECK(!users.FindByName("new"));
+
+  users.Invalidate();
+  CHECK(users.FindByName("new")->uid == 1002);
+  CHECK(users.QueriesRun() == 2);
+}
+
+void keepsTheFirstEntryOfANameOrUid() {
+  FakeDistro distro;
+  UserDirectory users{distro.query()};
+  users.Populate({{"a", 1000, true}, {"a", 1001, true}, {"b", 1000, false}});
+  CHECK(users.FindByName("a")->uid == 1000);
+  CHECK(users.FindByUid(1001)->name == "a");
+  CHECK(users.FindByUid(1000)->name == "a");
+  CHECK(users.FindByName("b")->uid == 1000);
+  CHECK(users.QueriesRun() == 0);
+}
+
+void doesNotRememberFailures() {
+  FakeDistro distro{passwd, true};
+  UserDirectory users{distro.query()};
+  CHECK(!users.FindByName("u"));
+  distro.broken = false;
+  CHECK(users.FindByName("u")->uid == 1000);
+  CHECK(users.QueriesRun() == 2);
+}
+}  // namespace
+
+int main() {
+  RUN(answersFromWhatIsKnown);
+  RUN(looksUpWhatIsNotKnownOnce);
+  RUN(forgetsOnInvalidation);
+  RUN(keepsTheFirstEntryOfANameOrUid);
+  RUN(doesNotRememberFailures);
+  return TEST_EXIT_CODE();
+}
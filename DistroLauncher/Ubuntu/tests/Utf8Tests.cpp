@@ -0,0 +1,57 @@
+#include "Check.h"
+#include "../Utf8.h"
+
+#include <string>
+
+using Ubuntu::Utf8ToWide;
+using Ubuntu::WideToUtf8;
+
+namespace {
+void convertsAscii() {
+  CHECK(Utf8ToWide("getent passwd 'u'") == L"getent passwd 'u'");
+  CHECK(WideToUtf8(L"getent passwd 'u'") == "getent passwd 'u'");
+  CHECK(Utf8ToWide("").empty());
+  CHECK(WideToUtf8(L"").empty());
+}
+
+void roundTripsEveryLength() {
+  // One, two, three and four bytes long, the latter being a surrogate pair in UTF-16.
+  const std::string utf8 = "\x24\xC2\xA3\xE2\x82\xAC\xF0\x90\x8D\x88";
+  const std::wstring wide = L"$£€\U00010348";
+  CHECK(Utf8ToWide(utf8) == wide);
+  CHECK(WideToUtf8(wide) == utf8);
+}
+
+void replacesInvalidSequences() {
+  // Stray continuation byte, overlong encoding, encoded surrogate, beyond U+10FFFF.
+  CHECK(Utf8ToWide("a\x80z") == L"a�z");
+  CHECK(Utf8ToWide("\xC0\xAF") == L"��");
+  CHECK(Utf8ToWide("\xE0\x80\xAF") == L"�");
+  CHECK(Utf8ToWide("\xED\xA0\x80") == L"�");
+  CHECK(Utf8ToWide("\xF4\x90\x80\x80") == L"�");
+}
+
+void resumesAfterATruncatedSequence() {
+  CHECK(Utf8ToWide("\xE2\x82z") == L"�z");
+  CHECK(Utf8ToWide("z\xF0\x90") == L"z�");
+}
+
+void replacesUnpairedSurrogates() {
+  if constexpr (sizeof(wchar_t) == 2) {
+    std::wstring lone{static_cast<wchar_t>(0xD800), L'z'};
+    CHECK(WideToUtf8(lone) == "\xEF\xBF\xBDz");
+  } else {
+    std::wstring lone{static_cast<wchar_t>(0xDC00), static_cast<wchar_t>(0x110000)};
+    CHECK(WideToUtf8(lone) == "\xEF\xBF\xBD\xEF\xBF\xBD");
+  }
+}
+}  // namespace
+
+int main() {
+  RUN(convertsAscii);
+  RUN(roundTripsEveryLength);
+  RUN(replacesInvalidSequences);
+  RUN(resumesAfterATruncatedSequence);
+  RUN(replacesUnpairedSurrogates);
+  return TEST_EXIT_CODE();
+}
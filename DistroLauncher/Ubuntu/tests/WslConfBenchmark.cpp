@@ -0,0 +1,82 @@
+#include "AllocationCounter.h"
+#include "../WslConf.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+using Ubuntu::WslConf;
+using Ubuntu::Testing::AllocationsOf;
+
+namespace {
+struct Input {
+  const char* name;
+  std::string contents;
+  std::size_t lines;
+};
+
+Input typical() {
+  std::string contents =
+      "[boot]\nsystemd=true\n\n[user]\ndefault=ubuntu\n\n[automount]\nenabled=true\n"
+      "options=\"metadata\"\n\n[interop]\nappendWindowsPath=false\n";
+  return {"typical", contents, 12};
+}
+
+Input large() {
+  std::string contents;
+  std::size_t lines = 0;
+  for (int section = 0; section < 1000; ++section) {
+    contents += "[section" + std::to_string(section) + "]\n";
+    ++lines;
+    for (int key = 0; key < 100; ++key) {
+      contents += "key" + std::to_string(key) + " = value" + std::to_string(key) + "\n";
+      ++lines;
+    }
+  }
+  return {"large", contents, lines};
+}
+
+Input malformed() {
+  std::string contents;
+  std::size_t lines = 0;
+  for (int i = 0; i < 50'000; ++i) {
+    contents += i % 3 == 0 ? "[unterminated\n" : i % 3 == 1 ? "no equal sign here\n" : "k=v\n";
+    contents += "; a comment\r\n";
+    lines += 2;
+  }
+  return {"malformed", contents, lines};
+}
+
+template <typename F>
+double nanosecondsPerRun(int runs, F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < runs; ++i) {
+    f();
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / runs;
+}
+
+// Defeats the optimizer.
+volatile std::size_t sink = 0;
+}  // namespace
+
+int main() {
+  std::printf("%-10s %10s %12s %10s %12s %14s\n", "input", "bytes", "ns/parse", "ns/line",
+              "ns/lookup", "allocs/parse");
+  for (const auto& input : {typical(), large(), malformed()}) {
+    int runs = input.contents.size() < 4096 ? 100'000 : 20;
+    auto parseOnce = [&input] { sink = sink + WslConf::Parse(input.contents).size(); };
+    double parse = nanosecondsPerRun(runs, parseOnce);
+    auto allocations = AllocationsOf(parseOnce);
+
+    auto conf = WslConf::Parse(input.contents);
+    double lookup = nanosecondsPerRun(1'000'000, [&conf] {
+      sink = sink + conf.DefaultUser().size() + conf.Systemd() + conf.AppendWindowsPath();
+    }) / 3;
+
+    std::printf("%-10s %10zu %12.0f %10.1f %12.1f %14zu\n", input.name, input.contents.size(),
+                parse, parse / input.lines, lookup, allocations);
+  }
+  return 0;
+}
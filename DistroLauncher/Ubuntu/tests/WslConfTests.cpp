@@ -0,0 +1,190 @@
+#include "Check.h"
+#include "../WslConf.h"
+
+#include <cstdlib>
+#include <new>
+#include <string>
+
+using Ubuntu::WslConf;
+
+namespace {
+// Counts heap allocations, to keep the parser honest about being allocation-light.
+std::size_t allocations = 0;
+}  // namespace
+
+void* operator new(std::size_t size) {
+  ++allocations;
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+namespace {
+void parsesSectionsAndKeys() {
+  auto conf = WslConf::Parse(
+      "[boot]\n"
+      "systemd=true\n"
+      "command = service docker start\n"
+      "\n"
+      "[user]\n"
+      "default=ubuntu\n"
+      "[automount]\n"
+      "root = /windir/\n"
+      "options = \"metadata,uid=1000\"\n"
+      "[interop]\n"
+      "appendWindowsPath=false\n");
+  CHECK(conf.size() == 6);
+  CHECK(conf.Diagnostics().empty());
+  CHECK(conf.DefaultUser() == "ubuntu");
+  CHECK(conf.Systemd());
+  CHECK(conf.BootCommand() == "service docker start");
+  CHECK(conf.AutomountEnabled());
+  CHECK(conf.AutomountRoot() == "/windir/");
+  CHECK(conf.AutomountOptions() == "metadata,uid=1000");
+  CHECK(conf.InteropEnabled());
+  CHECK(!conf.AppendWindowsPath());
+  CHECK(!conf.Get("user", "missing"));
+  CHECK(!conf.Get("missing", "default"));
+}
+
+void defaultsWhenEmpty() {
+  auto conf = WslConf::Parse("");
+  CHECK(conf.size() == 0);
+  CHECK(conf.DefaultUser().empty());
+  CHECK(!conf.Systemd());
+  CHECK(conf.AutomountEnabled());
+  CHECK(conf.AutomountRoot() == "/mnt/");
+  CHECK(conf.InteropEnabled());
+  CHECK(conf.AppendWindowsPath());
+}
+
+void namesAreCaseInsensitiveAndFirstWins() {
+  auto conf = WslConf::Parse(
+      "[User]\n"
+      "Default=first\n"
+      "[user]\n"
+      "default=second\n"
+      "DEFAULT=third\n");
+  CHECK(conf.size() == 3);
+  CHECK(conf.DefaultUser() == "first");
+  CHECK(conf.Get("USER", "dEfAuLt") == "first");
+}
+
+void handlesWindowsEditors() {
+  auto conf =
+      WslConf::Parse("\xEF\xBB\xBF[user]\r\ndefault = me \r\n\r\n[boot]\r\nsystemd=TRUE\r\n");
+  CHECK(conf.Diagnostics().empty());
+  CHECK(conf.DefaultUser() == "me");
+  CHECK(conf.Systemd());
+}
+
+void valuesKeepWhatTheyContain() {
+  auto conf = WslConf::Parse(
+      "[boot]\n"
+      "command=echo a=b # not a comment\n"
+      "[user]\n"
+      "default=\n"
+      "[interop]\n"
+      "enabled='maybe'\n"
+      "appendWindowsPath=\"unbalanced\n");
+  CHECK(conf.BootCommand() == "echo a=b # not a comment");
+  CHECK(conf.Get("user", "default") == "");
+  CHECK(conf.Get("interop", "enabled") == "maybe");
+  // Not a boolean, so the fallback applies.
+  CHECK(conf.InteropEnabled());
+  CHECK(conf.Get("interop", "appendWindowsPath") == "\"unbalanced");
+}
+
+void skipsAndReportsMalformedLines() {
+  auto conf = WslConf::Parse(
+      "orphan=1\n"
+      "# comment\n"
+      "; comment too\n"
+      "[user\n"
+      "default=lost\n"
+      "[boot]\n"
+      "just some words\n"
+      "=value\n"
+      "systemd=true\n"
+      "[]\n"
+      "key=in unnamed section\n");
+  CHECK(conf.DefaultUser().empty());
+  CHECK(conf.Systemd());
+  CHECK(conf.Get("", "key") == "in unnamed section");
+  const auto& diagnostics = conf.Diagnostics();
+  CHECK(diagnostics.size() == 5);
+  if (diagnostics.size() == 5) {
+    CHECK(diagnostics[0].line == 1);
+    CHECK(diagnostics[1].line == 4);
+    CHECK(diagnostics[2].line == 5);
+    CHECK(diagnostics[3].line == 7);
+    CHECK(diagnostics[4].line == 8);
+  }
+}
+
+void survivesMoves() {
+  // Short enough for the small string optimization, which moves the characters around.
+  auto conf = WslConf::Parse("[a]\nb=c\n");
+  WslConf moved = std::move(conf);
+  WslConf copy = moved;
+  CHECK(moved.Get("a", "b") == "c");
+  CHECK(copy.Get("a", "b") == "c");
+}
+
+void parsesLargeConfigsInOnePass() {
+  std::string contents;
+  for (int section = 0; section < 1000; ++section) {
+    contents += "[section" + std::to_string(section) + "]\n";
+    for (int key = 0; key < 100; ++key) {
+      contents += "key" + std::to_string(key) + " = value" + std::to_string(section * 100 + key) +
+                  "\n";
+    }
+  }
+  contents += "[user]\ndefault=last\n";
+
+  allocations = 0;
+  auto conf = WslConf::Parse(std::move(contents));
+  // The table itself, and nothing else.
+  CHECK(allocations == 1);
+  CHECK(conf.size() == 100'001);
+  CHECK(conf.DefaultUser() == "last");
+  CHECK(conf.Get("section999", "key99") == "value99999");
+  CHECK(conf.Get("SECTION500", "KEY0") == "value50000");
+  CHECK(!conf.Get("section1000", "key0"));
+}
+
+void toleratesGarbage() {
+  std::string contents;
+  unsigned seed = 42;
+  for (int i = 0; i < 1'000'000; ++i) {
+    seed = seed * 1103515245 + 12345;
+    contents.push_back(static_cast<char>(seed >> 16));
+  }
+  auto conf = WslConf::Parse(std::move(contents));
+  // Whatever it makes of it, lookups must still work.
+  (void)conf.DefaultUser();
+  CHECK(conf.size() + conf.Diagnostics().size() > 0);
+}
+}  // namespace
+
+int main() {
+  RUN(parsesSectionsAndKeys);
+  RUN(defaultsWhenEmpty);
+  RUN(namesAreCaseInsensitiveAndFirstWins);
+  RUN(handlesWindowsEditors);
+  RUN(valuesKeepWhatTheyContain);
+  RUN(skipsAndReportsMalformedLines);
+  RUN(survivesMoves);
+  RUN(parsesLargeConfigsInOnePass);
+  RUN(toleratesGarbage);
+  return TEST_EXIT_CODE();
+}
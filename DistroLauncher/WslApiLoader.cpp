@@ -6,6 +6,8 @@
 #include "stdafx.h"
 #include "WslApiLoader.h"
 
+using namespace Ubuntu::Messages::Catalog;
+
 WslApiLoader::WslApiLoader(const std::wstring& distributionName) :
     _distributionName(distributionName)
 {
@@ -13,7 +15,9 @@ WslApiLoader::WslApiLoader(const std::wstring& distributionName) :
     if (_wslApiDll != nullptr) {
         _isDistributionRegistered = (WSL_IS_DISTRIBUTION_REGISTERED)GetProcAddress(_wslApiDll, "WslIsDistributionRegistered");
         _registerDistribution = (WSL_REGISTER_DISTRIBUTION)GetProcAddress(_wslApiDll, "WslRegisterDistribution");
+        _unregisterDistribution = (WSL_UNREGISTER_DISTRIBUTION)GetProcAddress(_wslApiDll, "WslUnregisterDistribution");
         _configureDistribution = (WSL_CONFIGURE_DISTRIBUTION)GetProcAddress(_wslApiDll, "WslConfigureDistribution");
+        _getDistributionConfiguration = (WSL_GET_DISTRIBUTION_CONFIGURATION)GetProcAddress(_wslApiDll, "WslGetDistributionConfiguration");
         _launchInteractive = (WSL_LAUNCH_INTERACTIVE)GetProcAddress(_wslApiDll, "WslLaunchInteractive");
         _launch = (WSL_LAUNCH)GetProcAddress(_wslApiDll, "WslLaunch");
     }
@@ -28,22 +32,32 @@ WslApiLoader::~WslApiLoader()
 
 BOOL WslApiLoader::WslIsOptionalComponentInstalled()
 {
+    Ubuntu::Trace::Span span("WslIsOptionalComponentInstalled");
     return ((_wslApiDll != nullptr) && 
             (_isDistributionRegistered != nullptr) &&
             (_registerDistribution != nullptr) &&
+            (_unregisterDistribution != nullptr) &&
             (_configureDistribution != nullptr) &&
+            (_getDistributionConfiguration != nullptr) &&
             (_launchInteractive != nullptr) &&
             (_launch != nullptr));
 }
 
 BOOL WslApiLoader::WslIsDistributionRegistered()
 {
+    Ubuntu::Trace::Span span("WslIsDistributionRegistered");
     return _isDistributionRegistered(_distributionName.c_str());
 }
 
 HRESULT WslApiLoader::WslRegisterDistribution()
 {
-    HRESULT hr = _registerDistribution(_distributionName.c_str(), L"install.tar.gz");
+    return WslRegisterDistribution(L"install.tar.gz");
+}
+
+HRESULT WslApiLoader::WslRegisterDistribution(PCWSTR tarFilename)
+{
+    Ubuntu::Trace::Span span("WslRegisterDistribution", std::wstring_view{tarFilename});
+    HRESULT hr = _registerDistribution(_distributionName.c_str(), tarFilename);
     if (FAILED(hr)) {
         Helpers::PrintMessage(MSG_WSL_REGISTER_DISTRIBUTION_FAILED, hr);
     }
@@ -51,8 +65,20 @@ HRESULT WslApiLoader::WslRegisterDistribution()
     return hr;
 }
 
+HRESULT WslApiLoader::WslUnregisterDistribution()
+{
+    Ubuntu::Trace::Span span("WslUnregisterDistribution");
+    HRESULT hr = _unregisterDistribution(_distributionName.c_str());
+    if (FAILED(hr)) {
+        Helpers::PrintMessage(MSG_WSL_UNREGISTER_DISTRIBUTION_FAILED, hr);
+    }
+
+    return hr;
+}
+
 HRESULT WslApiLoader::WslConfigureDistribution(ULONG defaultUID, WSL_DISTRIBUTION_FLAGS wslDistributionFlags)
 {
+    Ubuntu::Trace::Span span("WslConfigureDistribution");
     HRESULT hr = _configureDistribution(_distributionName.c_str(), defaultUID, wslDistributionFlags);
     if (FAILED(hr)) {
         Helpers::PrintMessage(MSG_WSL_CONFIGURE_DISTRIBUTION_FAILED, hr);
@@ -61,8 +87,39 @@ HRESULT WslApiLoader::WslConfigureDistribution(ULONG defaultUID, WSL_DISTRIBUTIO
     return hr;
 }
 
+HRESULT WslApiLoader::WslGetDistributionConfiguration(ULONG *distributionVersion, ULONG *defaultUID, WSL_DISTRIBUTION_FLAGS *wslDistributionFlags, PSTR **defaultEnvironmentVariables, ULONG *defaultEnvironmentVariableCount)
+{
+    Ubuntu::Trace::Span span("WslGetDistributionConfiguration");
+    HRESULT hr = _getDistributionConfiguration(_distributionName.c_str(), distributionVersion, defaultUID, wslDistributionFlags, defaultEnvironmentVariables, defaultEnvironmentVariableCount);
+    if (FAILED(hr)) {
+        Helpers::PrintMessage(MSG_WSL_GET_DISTRIBUTION_CONFIGURATION_FAILED, hr);
+    }
+
+    return hr;
+}
+
+HRESULT WslApiLoader::WslGetDistributionConfiguration(WslDistributionConfiguration& configuration)
+{
+    PSTR* environment = nullptr;
+    ULONG environmentCount = 0;
+    HRESULT hr = WslGetDistributionConfiguration(&configuration.version, &configuration.defaultUid, &configuration.flags, &environment, &environmentCount);
+    if (FAILED(hr)) {
+        return hr;
+    }
+
+    configuration.defaultEnvironment.clear();
+    for (ULONG index = 0; index < environmentCount; index += 1) {
+        configuration.defaultEnvironment.emplace_back(environment[index]);
+        CoTaskMemFree(environment[index]);
+    }
+
+    CoTaskMemFree(environment);
+    return hr;
+}
+
 HRESULT WslApiLoader::WslLaunchInteractive(PCWSTR command, BOOL useCurrentWorkingDirectory, DWORD *exitCode)
 {
+    Ubuntu::Trace::Span span("WslLaunchInteractive", std::wstring_view(command));
     HRESULT hr = _launchInteractive(_distributionName.c_str(), command, useCurrentWorkingDirectory, exitCode);
     if (FAILED(hr)) {
         Helpers::PrintMessage(MSG_WSL_LAUNCH_INTERACTIVE_FAILED, command, hr);
@@ -73,6 +130,7 @@ HRESULT WslApiLoader::WslLaunchInteractive(PCWSTR command, BOOL useCurrentWorkin
 
 HRESULT WslApiLoader::WslLaunch(PCWSTR command, BOOL useCurrentWorkingDirectory, HANDLE stdIn, HANDLE stdOut, HANDLE stdErr, HANDLE *process)
 {
+    Ubuntu::Trace::Span span("WslLaunch", std::wstring_view(command));
     HRESULT hr = _launch(_distributionName.c_str(), command, useCurrentWorkingDirectory, stdIn, stdOut, stdErr, process);
     if (FAILED(hr)) {
         Helpers::PrintMessage(MSG_WSL_LAUNCH_FAILED, command, hr);
@@ -13,26 +13,53 @@
 
 typedef BOOL    (STDAPICALLTYPE* WSL_IS_DISTRIBUTION_REGISTERED)(PCWSTR);
 typedef HRESULT (STDAPICALLTYPE* WSL_REGISTER_DISTRIBUTION)(PCWSTR, PCWSTR);
+typedef HRESULT (STDAPICALLTYPE* WSL_UNREGISTER_DISTRIBUTION)(PCWSTR);
 typedef HRESULT (STDAPICALLTYPE* WSL_CONFIGURE_DISTRIBUTION)(PCWSTR, ULONG, WSL_DISTRIBUTION_FLAGS);
 typedef HRESULT (STDAPICALLTYPE* WSL_GET_DISTRIBUTION_CONFIGURATION)(PCWSTR, ULONG *, ULONG *, WSL_DISTRIBUTION_FLAGS *, PSTR **, ULONG *);
 typedef HRESULT (STDAPICALLTYPE* WSL_LAUNCH_INTERACTIVE)(PCWSTR, PCWSTR, BOOL, DWORD *);
 typedef HRESULT (STDAPICALLTYPE* WSL_LAUNCH)(PCWSTR, PCWSTR, BOOL, HANDLE, HANDLE, HANDLE, HANDLE *);
 
+// The configuration WSL keeps for a distribution, available without starting it.
+struct WslDistributionConfiguration
+{
+    ULONG version = 0;
+    ULONG defaultUid = (ULONG)-1;
+    WSL_DISTRIBUTION_FLAGS flags = WSL_DISTRIBUTION_FLAGS_NONE;
+    std::vector<std::string> defaultEnvironment;
+};
+
 class WslApiLoader
 {
   public:
     WslApiLoader(const std::wstring& distributionName);
     ~WslApiLoader();
 
+    const std::wstring& DistributionName() const { return _distributionName; }
+
     BOOL WslIsOptionalComponentInstalled();
 
     BOOL WslIsDistributionRegistered();
 
     HRESULT WslRegisterDistribution();
 
+    // Registers the distribution from [tarFilename] instead of the image shipped with the launcher.
+    HRESULT WslRegisterDistribution(PCWSTR tarFilename);
+
+    HRESULT WslUnregisterDistribution();
+
     HRESULT WslConfigureDistribution(ULONG defaultUID,
                                      WSL_DISTRIBUTION_FLAGS wslDistributionFlags);
 
+    // The caller owns the environment variables, to be freed with CoTaskMemFree.
+    HRESULT WslGetDistributionConfiguration(ULONG *distributionVersion,
+                                            ULONG *defaultUID,
+                                            WSL_DISTRIBUTION_FLAGS *wslDistributionFlags,
+                                            PSTR **defaultEnvironmentVariables,
+                                            ULONG *defaultEnvironmentVariableCount);
+
+    // Same as above, with the environment variables copied and freed.
+    HRESULT WslGetDistributionConfiguration(WslDistributionConfiguration& configuration);
+
     HRESULT WslLaunchInteractive(PCWSTR command,
                                  BOOL useCurrentWorkingDirectory,
                                  DWORD *exitCode);
@@ -49,7 +76,9 @@ class WslApiLoader
     HMODULE _wslApiDll;
     WSL_IS_DISTRIBUTION_REGISTERED _isDistributionRegistered;
     WSL_REGISTER_DISTRIBUTION _registerDistribution;
+    WSL_UNREGISTER_DISTRIBUTION _unregisterDistribution;
     WSL_CONFIGURE_DISTRIBUTION _configureDistribution;
+    WSL_GET_DISTRIBUTION_CONFIGURATION _getDistributionConfiguration;
     WSL_LAUNCH_INTERACTIVE _launchInteractive;
     WSL_LAUNCH _launch;
 };
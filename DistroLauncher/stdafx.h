@@ -17,6 +17,8 @@
 #include <stdio.h>
 #include <conio.h>
 #include <io.h>
+#include <fcntl.h>
+#include <fstream>
 #include <iostream>
 #include <string>
 #include <memory>
@@ -26,12 +28,27 @@
 #include <string_view>
 #include <vector>
 #include <wslapi.h>
+#include <appmodel.h>
 #include "WslApiLoader.h"
+
+// Message strings compiled from the .mc file, see Ubuntu/Messages.h.
+#include "Ubuntu/MessageCatalog.h"
+
 #include "Helpers.h"
 #include "DistributionInfo.h"
 
-// Message strings compiled from .MC file.
-#include "messages.h"
-
 // Ubuntu extensions
+#include "Ubuntu/TarIndex.h"
 #include "Ubuntu/InitTasks.h"
+#include "Ubuntu/ImageCache.h"
+#include "Ubuntu/ImageVerifier.h"
+#include "Ubuntu/Trace.h"
+#include "Ubuntu/LaunchStats.h"
+#include "Ubuntu/WslApiBackend.h"
+#include "Ubuntu/Batch.h"
+#include "Ubuntu/Broker.h"
+#include "Ubuntu/BrokerPipe.h"
+#include "Ubuntu/Parallel.h"
+#include "Ubuntu/Instances.h"
+#include "Ubuntu/Snapshot.h"
+#include "Ubuntu/Utf8.h"
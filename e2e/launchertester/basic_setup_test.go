@@ -23,8 +23,10 @@ func TestBasicSetup(t *testing.T) {
 	ctx, cancel := context.WithTimeout(context.Background(), 10*time.Minute)
 	defer cancel()
 	// TODO: try to inject user/password to stdin to avoid --root arg.
+	start := time.Now()
 	out, err := launcherCommand(ctx, "install", "--root").CombinedOutput() // Installing as root to avoid Stdin
 	require.NoErrorf(t, err, "Unexpected error installing: %s\n%v", out, err)
+	t.Logf("Installation took %s", time.Since(start))
 
 	testCases := map[string]func(t *testing.T){
 		"SystemdEnabled":          testSystemdIsEnabled,
@@ -33,6 +35,7 @@ func TestBasicSetup(t *testing.T) {
 		"UpgradePolicyIdempotent": testUpgradePolicyIdempotent,
 		"InteropIsEnabled":        testInteropIsEnabled,
 		"HelpFlag":                testHelpFlag,
+		"StatusDoesNotBoot":       testStatusDoesNotBoot,
 		"SnapdWorks":              testSnapdWorks,
 	}
 
@@ -166,8 +169,11 @@ func TestSetupWithCloudInit(t *testing.T) {
 				}()
 			}
 
+			start := time.Now()
 			out, err := launcherCommand(ctx, "install", args...).CombinedOutput() // Using the "install" command to avoid the shell after installation.
 			require.NoErrorf(t, err, "Unexpected error installing: %s\n%v", out, err)
+			// The cloud-init wait is skipped altogether on WSL1, which shows in the timings.
+			t.Logf("Installation took %s", time.Since(start))
 
 			// Seems out of order but setting the registry is concurrent with the installation, hopefully it will be set before the
 			// launcher checks for the default user. Either way the user assertion in the end of this test case will work as exoected.
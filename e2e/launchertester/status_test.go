@@ -0,0 +1,21 @@
+package launchertester
+
+import (
+	"context"
+	"testing"
+
+	"github.com/stretchr/testify/require"
+)
+
+func TestStatusNoInstall(t *testing.T) {
+	wslSetup(t)
+
+	ctx, cancel := context.WithTimeout(context.Background(), commandTimeout)
+	defer cancel()
+
+	out, err := launcherCommand(ctx, "status").CombinedOutput()
+	require.Errorf(t, err, "Command status should fail when the distro is not installed: %s", out)
+	require.Contains(t, string(out), "not installed", "Command status should tell the distro is not installed")
+
+	require.Equal(t, "DistroNotFound", distroState(t), "Using command status should not install the distro")
+}
@@ -195,6 +195,21 @@ func testHelpFlag(t *testing.T) {
 	require.Contains(t, string(out), usageFirstLine, "help command should have been picked up by the launcher")
 }
 
+// testStatusDoesNotBoot ensures the status command reports the configuration without starting the distro.
+func testStatusDoesNotBoot(t *testing.T) { //nolint: thelper, this is a test
+	terminateDistro(t)
+
+	ctx, cancel := context.WithTimeout(context.Background(), commandTimeout)
+	defer cancel()
+
+	out, err := launcherCommand(ctx, "status").CombinedOutput()
+	require.NoErrorf(t, err, "Unexpected failure executing status: %s", out)
+	require.Contains(t, string(out), "Default UID: 0", "Installed as root, the default UID should be 0")
+	require.Contains(t, string(out), "WSL version:", "Command status should print the WSL version")
+
+	require.Equal(t, "Stopped", distroState(t), "Using command status should not start the distro")
+}
+
 func testFileExists(t *testing.T, linuxPath string) {
 	stat, err := os.Stat(filepath.Join(`\\wsl.localhost\`, *distroName, linuxPath))
 	require.NoError(t, err, "Unexpected error checking file existence: %s", err)